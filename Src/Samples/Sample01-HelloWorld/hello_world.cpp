@@ -103,7 +103,9 @@ static const uint16_t s_TriangleTriList[] = {
  TinyRender::VertexBufferHandle vbh2;
  TinyRender::IndexBufferHandle ibh;
  TinyRender::ProgramHandle program;
- TinyRender::PSOHandle pso;
+ // Triangles are wound clockwise, cull counter-clockwise back faces. PSO is derived from program,
+ // vertex layout and this state.
+ static const uint64_t kState = (BGFX_STATE_DEFAULT & ~BGFX_STATE_CULL_MASK) | BGFX_STATE_CULL_CCW;
 
 void Init()
 {
@@ -127,8 +129,6 @@ void Init()
         TinyRender::createShader(g_pixelShader, strlen(g_pixelShader), TinyRender::ShaderType::ShaderType_Fragment);
 
     program = TinyRender::createProgram(vsh, fsh);
-
-    pso = TinyRender::createPSO(program, PosColorVertex::ms_layout, 0);
 }
 
 // 渲染
@@ -153,9 +153,13 @@ void Render()
         TinyRender::setViewRect(0, 0, 0, uint16_t(Width), uint16_t(Height));
     }
 
-    TinyRender::beginFrame(0);
+    // Set view 0 clear state.
+    TinyRender::setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x003366ff, 1.0f, 0);
+
+    // Make sure view 0 is cleared even if nothing is drawn into it.
+    TinyRender::touch(0);
 
-    TinyRender::drawMesh(vbh, ibh, program, pso, 0, nullptr);
+    TinyRender::drawMesh(0, vbh, ibh, program, kState);
 
     TinyRender::endFrame();
 }
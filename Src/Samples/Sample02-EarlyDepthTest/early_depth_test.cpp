@@ -94,10 +94,11 @@ static PosColorVertex s_TriangleVertices[] = {
     {-TriangleSize, -TriangleSize, 0.0f, 0xff00ff00},
 };
 
+// Behind first triangle, overlapping pixels fail depth test.
 static PosColorVertex s_TriangleVertices2[] = {
-    {-TriangleSize, TriangleSize, 0.0f, 0xff000000}, 
-    {TriangleSize, TriangleSize, 0.0f, 0xff0000ff}, 
-    {0, -TriangleSize, 0.0f, 0xff00ff00},
+    {-TriangleSize, TriangleSize, 0.5f, 0xff000000}, 
+    {TriangleSize, TriangleSize, 0.5f, 0xff0000ff}, 
+    {0, -TriangleSize, 0.5f, 0xff00ff00},
 };
 
 static const uint16_t s_TriangleTriList[] = {
@@ -108,7 +109,9 @@ static const uint16_t s_TriangleTriList[] = {
  TinyRender::VertexBufferHandle vbh2;
  TinyRender::IndexBufferHandle ibh;
  TinyRender::ProgramHandle program;
- TinyRender::PSOHandle pso;
+ // Triangles are wound clockwise, cull counter-clockwise back faces. PSO is derived from program,
+ // vertex layout and this state.
+ static const uint64_t kState = (BGFX_STATE_DEFAULT & ~BGFX_STATE_CULL_MASK) | BGFX_STATE_CULL_CCW;
 
 void Init()
 {
@@ -137,7 +140,8 @@ void Init()
 
     program = TinyRender::createProgram(vsh, fsh);
 
-    pso = TinyRender::createPSO(program, PosColorVertex::ms_layout, 0);
+    // Lay down depth of all draws first, so hidden pixels are never shaded.
+    TinyRender::setViewMode(0, TinyRender::ViewMode::DepthPrePass);
 }
 
 // 渲染
@@ -162,10 +166,14 @@ void Render()
         TinyRender::setViewRect(0, 0, 0, uint16_t(Width), uint16_t(Height));
     }
 
-    TinyRender::beginFrame(0);
+    // Set view 0 clear state.
+    TinyRender::setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x003366ff, 1.0f, 0);
 
-    TinyRender::drawMesh(vbh, ibh, program, pso, 0, nullptr);
-    TinyRender::drawMesh(vbh2, ibh, program, pso, 0, nullptr);
+    // Make sure view 0 is cleared even if nothing is drawn into it.
+    TinyRender::touch(0);
+
+    TinyRender::drawMesh(0, vbh, ibh, program, kState);
+    TinyRender::drawMesh(0, vbh2, ibh, program, kState);
 
     TinyRender::endFrame();
 }
@@ -0,0 +1,344 @@
+#include <bx/allocator.h>
+#include <bx/file.h>
+#include <bx/math.h>
+#include <bx/os.h>
+#include <bx/timer.h>
+
+#include "asset_loader.h"
+#include "bench_common.h"
+#include "entry.h"
+#include "tiny_render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+static double toMs(int64_t _ticks)
+{
+    return double(_ticks) * 1000.0 / double(bx::getHPFrequency());
+}
+
+/// Smooth noise so box filter and block compression do representative work.
+static bool writeTga(const char *_filePath, uint8_t *_pixels, uint16_t _size)
+{
+    const uint32_t seed = rand32();
+    for (uint32_t yy = 0; yy < _size; ++yy)
+    {
+        for (uint32_t xx = 0; xx < _size; ++xx)
+        {
+            uint8_t *pixel = &_pixels[(yy * _size + xx) * 4];
+            pixel[0] = uint8_t(xx * 255 / _size);
+            pixel[1] = uint8_t(yy * 255 / _size);
+            pixel[2] = uint8_t((xx ^ yy ^ seed) & 0xff);
+            pixel[3] = 255;
+        }
+    }
+
+    uint8_t header[18] = {};
+    header[2] = 2;
+    header[12] = uint8_t(_size);
+    header[13] = uint8_t(_size >> 8);
+    header[14] = uint8_t(_size);
+    header[15] = uint8_t(_size >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _filePath))
+    {
+        return false;
+    }
+
+    bx::Error err;
+    bx::write(writer, header, int32_t(sizeof(header)), &err);
+    bx::write(writer, _pixels, int32_t(_size * _size * 4), &err);
+    bx::close(writer);
+
+    return err.isOk();
+}
+
+static bool writeShader(const char *_filePath, uint32_t _size)
+{
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _filePath))
+    {
+        return false;
+    }
+
+    bx::Error err;
+    for (uint32_t ii = 0; ii < _size; ii += 32)
+    {
+        bx::write(writer, "float4 main() { return 0.0f; }\n", 32, &err);
+    }
+    bx::close(writer);
+
+    return err.isOk();
+}
+
+static bool writeMesh(const char *_filePath, uint32_t _numVertices, bx::AllocatorI *_allocator)
+{
+    VertexLayout layout;
+    layout.begin()
+        .add(Attrib::Position, 3, AttribType::Float)
+        .add(Attrib::Normal, 3, AttribType::Float)
+        .add(Attrib::TexCoord0, 2, AttribType::Float)
+        .end();
+
+    const uint32_t numIndices = _numVertices * 3;
+    float *vertices = (float *)bx::alloc(_allocator, layout.getSize(_numVertices));
+    uint32_t *indices = (uint32_t *)bx::alloc(_allocator, numIndices * sizeof(uint32_t));
+    for (uint32_t ii = 0; ii < _numVertices * 8; ++ii)
+    {
+        vertices[ii] = float(rand32() & 0xffff) / 65535.0f;
+    }
+    for (uint32_t ii = 0; ii < numIndices; ++ii)
+    {
+        indices[ii] = rand32() % _numVertices;
+    }
+
+    const bool result = meshSave(_filePath, vertices, _numVertices, layout, indices, numIndices, true);
+
+    bx::free(_allocator, indices);
+    bx::free(_allocator, vertices);
+
+    return result;
+}
+
+struct Loaded
+{
+    uint32_t num;
+};
+
+static void onLoaded(AssetHandle _handle, AssetState::Enum _state, void *_userData)
+{
+    BX_UNUSED(_handle);
+    Loaded &loaded = *(Loaded *)_userData;
+    loaded.num += AssetState::Ready == _state ? 1 : 0;
+}
+
+/// Live renderer allocations, without CPU-side ones.
+static uint32_t countResources()
+{
+    const Stats::Memory *memory = getStats()->memory;
+    return memory[MemoryCategory::VertexBuffer].numAllocs + memory[MemoryCategory::IndexBuffer].numAllocs +
+           memory[MemoryCategory::Shader].numAllocs + memory[MemoryCategory::Texture].numAllocs;
+}
+
+/// Loader leaves created resources to caller.
+static void releaseAsset(AssetLoader &_loader, AssetHandle _handle)
+{
+    if (AssetState::Ready == _loader.getState(_handle))
+    {
+        const ShaderHandle shader = _loader.getShader(_handle);
+        const TextureHandle texture = _loader.getTexture(_handle);
+        const VertexBufferHandle vertexBuffer = _loader.getVertexBuffer(_handle);
+        const IndexBufferHandle indexBuffer = _loader.getIndexBuffer(_handle);
+        if (isValid(shader))
+        {
+            destroy(shader);
+        }
+        if (isValid(texture))
+        {
+            destroy(texture);
+        }
+        if (isValid(vertexBuffer))
+        {
+            destroy(vertexBuffer);
+        }
+        if (isValid(indexBuffer))
+        {
+            destroy(indexBuffer);
+        }
+    }
+
+    _loader.free(_handle);
+}
+
+static AssetHandle loadAsset(AssetLoader &_loader, uint32_t _index, const char *_dir, TextureFormat::Enum _format,
+                             Loaded &_loaded)
+{
+    char filePath[BGFX_CONFIG_ASSET_MAX_PATH];
+    switch (_index % 3)
+    {
+    case 0:
+        bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.tga", _dir, _index);
+        return _loader.loadTexture(filePath, true, _format, AssetPriority::Normal, onLoaded, &_loaded);
+
+    case 1:
+        bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.mesh", _dir, _index);
+        return _loader.loadMesh(filePath, AssetPriority::Normal, onLoaded, &_loaded);
+
+    default:
+        bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.hlsl", _dir, _index);
+        return _loader.loadShader(filePath, ShaderType_Fragment, AssetPriority::Normal, onLoaded, &_loaded);
+    }
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t numAssets = 60;
+    uint32_t numThreads = BGFX_CONFIG_ASSET_IO_THREADS;
+    uint32_t textureSize = 512;
+    uint32_t frameMs = 16;
+    uint32_t maxSize = BGFX_CONFIG_ASSET_MAX_CREATE_SIZE;
+    TextureFormat::Enum format = TextureFormat::RGBA8;
+    const char *dir = ".";
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--assets") && ii + 1 < _argc)
+        {
+            numAssets = uint32_t(bx::clamp(atoi(_argv[++ii]), 3, BGFX_CONFIG_ASSET_MAX_REQUESTS));
+        }
+        else if (0 == strcmp(_argv[ii], "--threads") && ii + 1 < _argc)
+        {
+            numThreads = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, BGFX_CONFIG_ASSET_MAX_IO_THREADS));
+        }
+        else if (0 == strcmp(_argv[ii], "--texture-size") && ii + 1 < _argc)
+        {
+            textureSize = uint32_t(bx::clamp(atoi(_argv[++ii]), 4, 4096)) & ~3u;
+        }
+        else if (0 == strcmp(_argv[ii], "--frame-ms") && ii + 1 < _argc)
+        {
+            frameMs = uint32_t(bx::max(0, atoi(_argv[++ii])));
+        }
+        else if (0 == strcmp(_argv[ii], "--max-size") && ii + 1 < _argc)
+        {
+            maxSize = uint32_t(bx::max(1, atoi(_argv[++ii]))) << 10;
+        }
+        else if (0 == strcmp(_argv[ii], "--format") && ii + 1 < _argc)
+        {
+            ++ii;
+            format = 0 == strcmp(_argv[ii], "bc1")   ? TextureFormat::BC1
+                     : 0 == strcmp(_argv[ii], "bc7") ? TextureFormat::BC7
+                                                     : TextureFormat::RGBA8;
+        }
+        else if (0 == strcmp(_argv[ii], "--dir") && ii + 1 < _argc)
+        {
+            dir = _argv[++ii];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: asset_bench [--assets <n>] [--threads <n>] [--texture-size <pixels>] "
+                            "[--frame-ms <ms>] [--max-size <KiB>] [--format rgba8|bc1|bc7] [--dir <path>]\n");
+            return 1;
+        }
+    }
+
+    // Headless, bench runs on Noop renderer and measures loading, not GPU uploads.
+    InitParams init = {256, 256, 1, 1, NULL};
+    init.type = RendererType::Noop;
+    TinyRender::init(init);
+
+    bx::DefaultAllocator allocator;
+
+    // Every third asset is texture, mesh and shader.
+    uint8_t *pixels = (uint8_t *)bx::alloc(&allocator, textureSize * textureSize * 4);
+    for (uint32_t ii = 0; ii < numAssets; ++ii)
+    {
+        char filePath[BGFX_CONFIG_ASSET_MAX_PATH];
+        bool ok;
+        switch (ii % 3)
+        {
+        case 0:
+            bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.tga", dir, ii);
+            ok = writeTga(filePath, pixels, uint16_t(textureSize));
+            break;
+
+        case 1:
+            bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.mesh", dir, ii);
+            ok = writeMesh(filePath, 8192 + rand32() % 8192, &allocator);
+            break;
+
+        default:
+            bx::snprintf(filePath, sizeof(filePath), "%s/asset%u.hlsl", dir, ii);
+            ok = writeShader(filePath, 4096 + rand32() % 4096);
+            break;
+        }
+
+        if (!ok)
+        {
+            fprintf(stderr, "Can't write %s.\n", filePath);
+            return 1;
+        }
+    }
+    bx::free(&allocator, pixels);
+
+    AssetLoader loader;
+    if (!loader.create(numThreads))
+    {
+        fprintf(stderr, "Can't start asset loader.\n");
+        return 1;
+    }
+
+    AssetHandle *handles = (AssetHandle *)bx::alloc(&allocator, numAssets * sizeof(AssetHandle));
+    const uint32_t numResources = countResources();
+
+    // Blocking, each asset is waited for before next frame, like loading on API thread.
+    Loaded loaded = {0};
+    int64_t maxFrame = 0;
+    int64_t start = bx::getHPCounter();
+    for (uint32_t ii = 0; ii < numAssets; ++ii)
+    {
+        const int64_t frameStart = bx::getHPCounter();
+        handles[ii] = loadAsset(loader, ii, dir, format, loaded);
+        while (0 != loader.getNumPending())
+        {
+            loader.update(maxSize);
+        }
+        endFrame();
+        maxFrame = bx::max(maxFrame, bx::getHPCounter() - frameStart);
+        releaseAsset(loader, handles[ii]);
+    }
+    const int64_t syncTime = bx::getHPCounter() - start;
+
+    printf("{\"mode\": \"blocking\", \"assets\": %u, \"ready\": %u, \"total_ms\": %.2f, \"max_frame_ms\": %.2f}\n",
+           numAssets, loaded.num, toMs(syncTime), toMs(maxFrame));
+
+    // Asynchronous, all assets are queued at once and frames keep running while they load.
+    loaded.num = 0;
+    maxFrame = 0;
+    uint32_t numFrames = 0;
+    start = bx::getHPCounter();
+    for (uint32_t ii = 0; ii < numAssets; ++ii)
+    {
+        handles[ii] = loadAsset(loader, ii, dir, format, loaded);
+    }
+
+    while (0 != loader.getNumPending())
+    {
+        const int64_t frameStart = bx::getHPCounter();
+        loader.update(maxSize);
+        endFrame();
+        maxFrame = bx::max(maxFrame, bx::getHPCounter() - frameStart);
+        ++numFrames;
+
+        if (0 != frameMs)
+        {
+            bx::sleep(frameMs);
+        }
+    }
+    const int64_t asyncTime = bx::getHPCounter() - start;
+
+    const AssetLoaderStats &stats = loader.getStats();
+    printf("{\"mode\": \"async\", \"assets\": %u, \"ready\": %u, \"threads\": %u, \"frames\": %u, \"total_ms\": %.2f, "
+           "\"max_frame_ms\": %.2f, \"read_ms\": %.2f, \"decode_ms\": %.2f, \"create_ms\": %.2f, \"mib_read\": %.2f}\n",
+           numAssets, loaded.num, numThreads, numFrames, toMs(asyncTime), toMs(maxFrame), toMs(stats.readTime),
+           toMs(stats.decodeTime), toMs(stats.createTime), double(stats.bytesRead) / double(1 << 20));
+
+    for (uint32_t ii = 0; ii < numAssets; ++ii)
+    {
+        releaseAsset(loader, handles[ii]);
+    }
+    loader.destroy();
+    bx::free(&allocator, handles);
+    endFrame();
+
+    const uint32_t numLeaked = countResources() - numResources;
+    const uint32_t numLive = shutdownAndCheckMemory();
+    printf("{\"leaked\": %u, \"live_after_shutdown\": %u}\n", numLeaked, numLive);
+
+    return 0 == numLeaked && 0 == numLive ? 0 : 1;
+}
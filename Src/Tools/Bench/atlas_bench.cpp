@@ -0,0 +1,190 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/timer.h>
+
+#include "atlas.h"
+#include "bench_common.h"
+#include "tiny_render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+/// Icon sized images, mostly small and square-ish, some long strips like UI frames.
+static void randomSize(uint16_t &_width, uint16_t &_height, uint32_t _maxSize)
+{
+    const uint32_t kind = rand32() % 8;
+    if (0 == kind)
+    {
+        _width = uint16_t(_maxSize / 2 + rand32() % (_maxSize / 2));
+        _height = uint16_t(4 + rand32() % 12);
+    }
+    else
+    {
+        _width = uint16_t(8 + rand32() % (_maxSize / 2));
+        _height = uint16_t(bx::max(4, int32_t(_width) + int32_t(rand32() % 9) - 4));
+    }
+}
+
+static double toUs(int64_t _ticks, uint32_t _num)
+{
+    return double(_ticks) * 1000000.0 / double(bx::getHPFrequency()) / double(bx::max(_num, 1u));
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t numImages = 2000;
+    uint32_t pageSize = 1024;
+    uint32_t numMips = 3;
+    uint32_t maxSize = 64;
+    uint32_t numChurn = 4;
+    float maxWaste = 0.1f;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--images") && ii + 1 < _argc)
+        {
+            numImages = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, BGFX_CONFIG_ATLAS_MAX_REGIONS / 2));
+        }
+        else if (0 == strcmp(_argv[ii], "--page") && ii + 1 < _argc)
+        {
+            pageSize = uint32_t(bx::clamp(atoi(_argv[++ii]), 64, 16384));
+        }
+        else if (0 == strcmp(_argv[ii], "--mips") && ii + 1 < _argc)
+        {
+            numMips = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, 8));
+        }
+        else if (0 == strcmp(_argv[ii], "--max-size") && ii + 1 < _argc)
+        {
+            maxSize = uint32_t(bx::clamp(atoi(_argv[++ii]), 32, 1024));
+        }
+        else if (0 == strcmp(_argv[ii], "--churn") && ii + 1 < _argc)
+        {
+            numChurn = uint32_t(bx::max(0, atoi(_argv[++ii])));
+        }
+        else if (0 == strcmp(_argv[ii], "--waste") && ii + 1 < _argc)
+        {
+            maxWaste = bx::clamp(float(atof(_argv[++ii])), 0.0f, 1.0f);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: atlas_bench [--images <n>] [--page <pixels>] [--mips <n>] [--max-size <pixels>] "
+                            "[--churn <rounds>] [--waste <fraction>]\n");
+            return 1;
+        }
+    }
+
+    // Headless, bench runs on Noop renderer and measures packing and CPU side of uploads.
+    InitParams init = {256, 256, 1, 1, NULL};
+    init.type = RendererType::Noop;
+    TinyRender::init(init);
+
+    bx::DefaultAllocator allocator;
+
+    uint8_t *image = (uint8_t *)bx::alloc(&allocator, maxSize * maxSize * 4);
+    for (uint32_t ii = 0; ii < maxSize * maxSize * 4; ++ii)
+    {
+        image[ii] = uint8_t(rand32());
+    }
+
+    AtlasRegionHandle *handles =
+        (AtlasRegionHandle *)bx::alloc(&allocator, numImages * sizeof(AtlasRegionHandle));
+
+    Atlas atlas;
+    if (!atlas.create(uint16_t(pageSize), uint8_t(numMips), uint16_t(1 << (numMips - 1))))
+    {
+        fprintf(stderr, "Invalid atlas parameters.\n");
+        return 1;
+    }
+
+    uint32_t numAdded = 0;
+    uint32_t numFailed = 0;
+    int64_t addTime = 0;
+    for (uint32_t ii = 0; ii < numImages; ++ii)
+    {
+        uint16_t width;
+        uint16_t height;
+        randomSize(width, height, maxSize);
+
+        const int64_t start = bx::getHPCounter();
+        handles[ii] = atlas.add(image, width, height, maxSize * 4);
+        addTime += bx::getHPCounter() - start;
+
+        numAdded += isValid(handles[ii]) ? 1 : 0;
+        numFailed += isValid(handles[ii]) ? 0 : 1;
+    }
+
+    int64_t start = bx::getHPCounter();
+    atlas.update();
+    const int64_t firstUpdateTime = bx::getHPCounter() - start;
+    endFrame();
+
+    const AtlasStats &stats = atlas.getStats();
+    const double pageTexels = double(pageSize) * double(pageSize);
+    printf("{\"phase\": \"fill\", \"images\": %u, \"failed\": %u, \"pages\": %u, \"occupancy\": %.3f, "
+           "\"add_us\": %.2f, \"update_ms\": %.2f}\n",
+           numAdded, numFailed, stats.numPages, double(stats.usedTexels) / (pageTexels * stats.numPages),
+           toUs(addTime, numImages), toUs(firstUpdateTime, 1) / 1000.0);
+
+    // Each round replaces half of images, like UI screens changing, then compacts.
+    for (uint32_t round = 0; round < numChurn; ++round)
+    {
+        int64_t removeTime = 0;
+        int64_t churnAddTime = 0;
+        uint32_t numReplaced = 0;
+        for (uint32_t ii = 0; ii < numImages; ++ii)
+        {
+            if (0 != (rand32() & 1) || !isValid(handles[ii]))
+            {
+                continue;
+            }
+
+            start = bx::getHPCounter();
+            atlas.remove(handles[ii]);
+            removeTime += bx::getHPCounter() - start;
+
+            uint16_t width;
+            uint16_t height;
+            randomSize(width, height, maxSize);
+
+            start = bx::getHPCounter();
+            handles[ii] = atlas.add(image, width, height, maxSize * 4);
+            churnAddTime += bx::getHPCounter() - start;
+            ++numReplaced;
+        }
+
+        const uint64_t packedBefore = stats.packedTexels;
+
+        start = bx::getHPCounter();
+        const uint32_t numMoved = atlas.compact(maxWaste);
+        const int64_t compactTime = bx::getHPCounter() - start;
+
+        start = bx::getHPCounter();
+        atlas.update();
+        const int64_t updateTime = bx::getHPCounter() - start;
+        endFrame();
+
+        numAdded = 0;
+        for (uint32_t ii = 0; ii < numImages; ++ii)
+        {
+            numAdded += isValid(handles[ii]) ? 1 : 0;
+        }
+
+        printf("{\"phase\": \"churn\", \"round\": %u, \"replaced\": %u, \"images\": %u, \"pages\": %u, "
+               "\"occupancy\": %.3f, \"packed_before\": %.3f, \"packed_after\": %.3f, \"moved\": %u, "
+               "\"remove_us\": %.2f, \"add_us\": %.2f, \"compact_ms\": %.2f, \"update_ms\": %.2f}\n",
+               round, numReplaced, numAdded, stats.numPages,
+               double(stats.usedTexels) / (pageTexels * stats.numPages),
+               double(packedBefore) / (pageTexels * stats.numPages),
+               double(stats.packedTexels) / (pageTexels * stats.numPages), numMoved, toUs(removeTime, numReplaced),
+               toUs(churnAddTime, numReplaced), toUs(compactTime, 1) / 1000.0, toUs(updateTime, 1) / 1000.0);
+    }
+
+    atlas.destroy();
+    bx::free(&allocator, handles);
+    bx::free(&allocator, image);
+
+    return 0 == shutdownAndCheckMemory() ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/timer.h>
+
+#include "bc.h"
+#include "bench_common.h"
+#include "job.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+struct Workload
+{
+    const char *m_name;
+    TextureFormat::Enum m_format;
+    uint32_t m_numChannels; //!< Channels compared for PSNR.
+    bool m_opaque;          //!< Encode opaque copy, BC1 alpha is punch-through only.
+};
+
+static const Workload s_workloads[] = {
+    {"bc1", TextureFormat::BC1, 3, true},
+    {"bc3", TextureFormat::BC3, 4, false},
+    {"bc4", TextureFormat::BC4, 1, false},
+    {"bc5", TextureFormat::BC5, 2, false},
+    {"bc7", TextureFormat::BC7, 4, false},
+    {"bc7_opaque", TextureFormat::BC7, 3, true},
+};
+
+static const char *s_qualityName[BcQuality::Count] = {"fast", "normal", "high"};
+
+/// Gradients, hard edges and some noise, rough stand-in for albedo texture.
+static void fillImage(uint8_t *_data, uint32_t _size, bool _opaque)
+{
+    for (uint32_t yy = 0; yy < _size; ++yy)
+    {
+        for (uint32_t xx = 0; xx < _size; ++xx)
+        {
+            uint8_t *pixel = &_data[(yy * _size + xx) * 4];
+            const uint32_t noise = rand32();
+            const bool checker = 0 != (((xx >> 5) ^ (yy >> 5)) & 1);
+            pixel[0] = uint8_t(xx * 255 / _size + (noise & 7));
+            pixel[1] = uint8_t(checker ? 200 - (yy * 128 / _size) : yy * 255 / _size);
+            pixel[2] = uint8_t(((xx + yy) * 127 / _size) ^ ((noise >> 8) & 15));
+            pixel[3] = uint8_t(checker || _opaque ? 255 : (xx * 7 + yy * 3) & 255);
+        }
+    }
+}
+
+static double calcPsnr(const uint8_t *_a, const uint8_t *_b, uint32_t _numPixels, uint32_t _numChannels)
+{
+    uint64_t sum = 0;
+    for (uint32_t ii = 0; ii < _numPixels; ++ii)
+    {
+        for (uint32_t ch = 0; ch < _numChannels; ++ch)
+        {
+            const int32_t diff = int32_t(_a[ii * 4 + ch]) - int32_t(_b[ii * 4 + ch]);
+            sum += uint64_t(diff * diff);
+        }
+    }
+
+    if (0 == sum)
+    {
+        return 99.0;
+    }
+
+    const double mse = double(sum) / (double(_numPixels) * _numChannels);
+    return 10.0 * bx::log(float(255.0 * 255.0 / mse)) / bx::log(10.0f);
+}
+
+static void run(const Workload &_workload, BcQuality::Enum _quality, const uint8_t *_image, uint32_t _size,
+                uint32_t _iterations, JobPool &_pool, bx::AllocatorI *_allocator)
+{
+    const uint32_t blocksSize = bcGetSize(_workload.m_format, _size, _size);
+    uint8_t *blocks = (uint8_t *)bx::alloc(_allocator, blocksSize);
+    uint8_t *decoded = (uint8_t *)bx::alloc(_allocator, _size * _size * 4);
+
+    int64_t best = INT64_MAX;
+    for (uint32_t ii = 0; ii < _iterations; ++ii)
+    {
+        const int64_t start = bx::getHPCounter();
+        bcEncode(blocks, _workload.m_format, _image, _size, _size, _size * 4, _quality, &_pool);
+        best = bx::min(best, bx::getHPCounter() - start);
+    }
+
+    bcDecode(decoded, _size * 4, _workload.m_format, blocks, _size, _size);
+
+    const double ms = double(best) * 1000.0 / double(bx::getHPFrequency());
+    const double mbytes = double(_size) * _size * 4 / (1024.0 * 1024.0);
+
+    printf("{\"format\": \"%s\", \"quality\": \"%s\", \"size\": %u, \"threads\": %u, \"best_ms\": %.2f, "
+           "\"mb_per_sec\": %.1f, \"psnr\": %.2f}\n",
+           _workload.m_name, s_qualityName[_quality], _size, _pool.getNumThreads(), ms, mbytes * 1000.0 / ms,
+           calcPsnr(_image, decoded, _size * _size, _workload.m_numChannels));
+
+    bx::free(_allocator, decoded);
+    bx::free(_allocator, blocks);
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t size = 1024;
+    uint32_t numThreads = 8;
+    uint32_t iterations = 3;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--size") && ii + 1 < _argc)
+        {
+            size = uint32_t(bx::clamp(atoi(_argv[++ii]), 4, 16384));
+        }
+        else if (0 == strcmp(_argv[ii], "--threads") && ii + 1 < _argc)
+        {
+            numThreads = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, BGFX_CONFIG_MAX_WORKER_THREADS + 1));
+        }
+        else if (0 == strcmp(_argv[ii], "--iterations") && ii + 1 < _argc)
+        {
+            iterations = uint32_t(bx::max(1, atoi(_argv[++ii])));
+        }
+        else
+        {
+            fprintf(stderr, "Usage: bc_bench [--size <pixels>] [--threads <n>] [--iterations <n>]\n");
+            return 1;
+        }
+    }
+
+    bx::DefaultAllocator allocator;
+
+    uint8_t *image = (uint8_t *)bx::alloc(&allocator, size * size * 4);
+    fillImage(image, size, false);
+
+    uint8_t *opaqueImage = (uint8_t *)bx::alloc(&allocator, size * size * 4);
+    fillImage(opaqueImage, size, true);
+
+    // Calling thread works too.
+    JobPool pool;
+    pool.create(numThreads - 1);
+
+    for (uint32_t ii = 0; ii < BX_COUNTOF(s_workloads); ++ii)
+    {
+        for (uint32_t quality = 0; quality < BcQuality::Count; ++quality)
+        {
+            const Workload &workload = s_workloads[ii];
+            run(workload, BcQuality::Enum(quality), workload.m_opaque ? opaqueImage : image, size, iterations, pool,
+                &allocator);
+        }
+    }
+
+    pool.destroy();
+    bx::free(&allocator, opaqueImage);
+    bx::free(&allocator, image);
+
+    return 0;
+}
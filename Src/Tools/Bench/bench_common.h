@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "tiny_render.h"
+
+/// Random number state, fixed seed so every run of a bench sees the same workload.
+inline uint32_t s_rng = 0x12345678;
+
+/// Xorshift random number.
+inline uint32_t rand32()
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/// Number of failed `CHECK`s, benches return non-zero exit code when it isn't 0.
+inline uint32_t s_numErrors = 0;
+
+#define CHECK(_condition)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(_condition))                                                                                             \
+        {                                                                                                              \
+            fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #_condition);                             \
+            ++s_numErrors;                                                                                             \
+        }                                                                                                              \
+    } while (0)
+
+/// Shut renderer down and check no memory category has live allocations left, renderer must
+/// release everything it tracked.
+///
+/// @returns Number of categories with live memory, each one is reported to stderr.
+///
+inline uint32_t shutdownAndCheckMemory()
+{
+    TinyRender::shutdown();
+
+    uint32_t numLive = 0;
+    const TinyRender::Stats *stats = TinyRender::getStats();
+    for (uint32_t ii = 0; ii < TinyRender::MemoryCategory::Count; ++ii)
+    {
+        const TinyRender::Stats::Memory &memory = stats->memory[ii];
+        if (0 != memory.current || 0 != memory.numAllocs)
+        {
+            fprintf(stderr, "Memory category %u has %lld bytes in %u allocations after shutdown.\n", ii,
+                    (long long)memory.current, memory.numAllocs);
+            ++numLive;
+        }
+    }
+
+    return numLive;
+}
@@ -0,0 +1,217 @@
+#include <bx/allocator.h>
+#include <bx/timer.h>
+
+#include "bench_common.h"
+#include "descriptor_allocator.h"
+
+#include <stdio.h>
+
+using namespace TinyRender;
+
+/// Static ranges, exhaustion, and deferred free reused only when its frame slot comes around again.
+static void checkStatic(bx::AllocatorI *_allocator)
+{
+    const uint32_t numStatic = 1024;
+    const uint32_t numFrames = 3;
+    const uint32_t rangeSize = 64;
+
+    DescriptorAllocator da;
+    CHECK(da.create(numStatic, 256, 32, numFrames, _allocator));
+    CHECK(numStatic + 32 * numFrames == da.getNumDescriptors());
+
+    TlsfAllocation ranges[numStatic / rangeSize];
+    uint64_t used = 0;
+    for (uint32_t ii = 0; ii < BX_COUNTOF(ranges); ++ii)
+    {
+        ranges[ii] = da.alloc(rangeSize);
+        CHECK(TlsfAllocator::isValid(ranges[ii]));
+        CHECK(ranges[ii].m_offset + rangeSize <= numStatic);
+        CHECK(0 == ranges[ii].m_offset % rangeSize);
+
+        const uint64_t bit = UINT64_C(1) << (ranges[ii].m_offset / rangeSize);
+        CHECK(0 == (used & bit));
+        used |= bit;
+    }
+
+    // Exhausted.
+    CHECK(!TlsfAllocator::isValid(da.alloc(1)));
+
+    // Freed in slot 0, GPU may still read it until slot 0 is recorded again.
+    const uint32_t offset = ranges[5].m_offset;
+    da.free(ranges[5]);
+    CHECK(!TlsfAllocator::isValid(da.alloc(rangeSize)));
+    da.beginFrame(1);
+    CHECK(!TlsfAllocator::isValid(da.alloc(rangeSize)));
+    da.beginFrame(2);
+    CHECK(!TlsfAllocator::isValid(da.alloc(rangeSize)));
+    da.beginFrame(0);
+    ranges[5] = da.alloc(rangeSize);
+    CHECK(TlsfAllocator::isValid(ranges[5]) && offset == ranges[5].m_offset);
+
+    // Freed ranges merge once they are released.
+    for (uint32_t ii = 0; ii < BX_COUNTOF(ranges); ++ii)
+    {
+        da.free(ranges[ii]);
+    }
+    da.beginFrame(1);
+    da.beginFrame(2);
+    da.beginFrame(0);
+    const TlsfAllocation all = da.alloc(numStatic);
+    CHECK(TlsfAllocator::isValid(all) && 0 == all.m_offset);
+
+    da.destroy();
+}
+
+/// Transient ranges stay within their frame slot range, are exhausted at slot size and reset per frame.
+static void checkTransient(bx::AllocatorI *_allocator)
+{
+    const uint32_t numStatic = 256;
+    const uint32_t numTransient = 100;
+    const uint32_t numFrames = 3;
+
+    DescriptorAllocator da;
+    CHECK(da.create(numStatic, 64, numTransient, numFrames, _allocator));
+
+    for (uint32_t frame = 0; frame < numFrames * 2; ++frame)
+    {
+        const uint32_t slot = frame % numFrames;
+        da.beginFrame(slot);
+
+        const uint32_t begin = numStatic + slot * numTransient;
+        uint32_t expected = begin;
+        for (uint32_t ii = 0; ii < numTransient / 10; ++ii)
+        {
+            const uint32_t index = da.allocTransient(10);
+            CHECK(expected == index);
+            expected += 10;
+        }
+        CHECK(UINT32_MAX == da.allocTransient(1));
+        CHECK(da.getNumDescriptors() >= begin + numTransient);
+    }
+
+    // Transient allocations don't touch static part.
+    const TlsfAllocation all = da.alloc(numStatic);
+    CHECK(TlsfAllocator::isValid(all) && 0 == all.m_offset);
+
+    da.destroy();
+}
+
+struct Live
+{
+    TlsfAllocation m_allocation;
+    uint32_t m_num;
+};
+
+/// Random frames of allocations and frees, every descriptor state tracked on side. Returns ns per operation.
+static double checkRandom(bx::AllocatorI *_allocator)
+{
+    const uint32_t numStatic = 64 << 10;
+    const uint32_t maxAllocs = 4096;
+    const uint32_t numFrames = 3;
+    const uint32_t numFramesRun = 2000;
+
+    enum
+    {
+        Free,
+        Used,
+        Pending,
+    };
+
+    DescriptorAllocator da;
+    CHECK(da.create(numStatic, maxAllocs, 256, numFrames, _allocator));
+
+    uint8_t *state = (uint8_t *)bx::alloc(_allocator, numStatic);
+    uint8_t *pendingSlot = (uint8_t *)bx::alloc(_allocator, numStatic);
+    bx::memSet(state, Free, numStatic);
+
+    Live *live = (Live *)bx::alloc(_allocator, maxAllocs * sizeof(Live));
+    uint32_t numLive = 0;
+
+    int64_t elapsed = 0;
+    uint32_t numOps = 0;
+    for (uint32_t frame = 0; frame < numFramesRun; ++frame)
+    {
+        const uint32_t slot = frame % numFrames;
+
+        int64_t start = bx::getHPCounter();
+        da.beginFrame(slot);
+        elapsed += bx::getHPCounter() - start;
+
+        for (uint32_t ii = 0; ii < numStatic; ++ii)
+        {
+            if (Pending == state[ii] && slot == pendingSlot[ii])
+            {
+                state[ii] = Free;
+            }
+        }
+
+        for (uint32_t op = 0; op < 64; ++op, ++numOps)
+        {
+            if (0 != (rand32() & 1) && numLive < maxAllocs)
+            {
+                const uint32_t num = 1 + rand32() % 64;
+
+                start = bx::getHPCounter();
+                const TlsfAllocation allocation = da.alloc(num);
+                elapsed += bx::getHPCounter() - start;
+
+                if (!TlsfAllocator::isValid(allocation))
+                {
+                    continue;
+                }
+
+                CHECK(allocation.m_offset + num <= numStatic);
+                for (uint32_t ii = 0; ii < num; ++ii)
+                {
+                    CHECK(Free == state[allocation.m_offset + ii]);
+                    state[allocation.m_offset + ii] = Used;
+                }
+
+                live[numLive].m_allocation = allocation;
+                live[numLive].m_num = num;
+                ++numLive;
+            }
+            else if (0 != numLive)
+            {
+                const uint32_t idx = rand32() % numLive;
+                const Live entry = live[idx];
+                live[idx] = live[--numLive];
+
+                start = bx::getHPCounter();
+                da.free(entry.m_allocation);
+                elapsed += bx::getHPCounter() - start;
+
+                for (uint32_t ii = 0; ii < entry.m_num; ++ii)
+                {
+                    state[entry.m_allocation.m_offset + ii] = Pending;
+                    pendingSlot[entry.m_allocation.m_offset + ii] = uint8_t(slot);
+                }
+            }
+        }
+
+        const uint32_t index = da.allocTransient(256);
+        CHECK(numStatic + slot * 256 == index);
+    }
+
+    bx::free(_allocator, live);
+    bx::free(_allocator, pendingSlot);
+    bx::free(_allocator, state);
+    da.destroy();
+
+    return double(elapsed) * 1e9 / double(bx::getHPFrequency()) / double(numOps + numFramesRun);
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    BX_UNUSED(_argc, _argv);
+
+    bx::DefaultAllocator allocator;
+
+    checkStatic(&allocator);
+    checkTransient(&allocator);
+    const double nsPerOp = checkRandom(&allocator);
+
+    printf("{\"ns_per_op\": %.1f, \"errors\": %u}\n", nsPerOp, s_numErrors);
+
+    return 0 == s_numErrors ? 0 : 1;
+}
@@ -0,0 +1,343 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/timer.h>
+
+#include "meshlet.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+static double toMs(int64_t _ticks)
+{
+    return double(_ticks) * 1000.0 / double(bx::getHPFrequency());
+}
+
+/// Cube sphere, `_segments` x `_segments` quads per face, outward facing triangles.
+static void generateSphere(float *_vertices, uint32_t *_indices, uint32_t _segments)
+{
+    static const float s_faces[6][3][3] = {
+        {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
+        {{-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+        {{0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+        {{0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}},
+        {{0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+        {{0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+    };
+
+    const uint32_t side = _segments + 1;
+    uint32_t numIndices = 0;
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        const bx::Vec3 normal = bx::load<bx::Vec3>(s_faces[face][0]);
+        const bx::Vec3 uu = bx::load<bx::Vec3>(s_faces[face][1]);
+        const bx::Vec3 vv = bx::load<bx::Vec3>(s_faces[face][2]);
+        const uint32_t base = face * side * side;
+
+        for (uint32_t yy = 0; yy < side; ++yy)
+        {
+            for (uint32_t xx = 0; xx < side; ++xx)
+            {
+                const float ss = float(xx) / float(_segments) * 2.0f - 1.0f;
+                const float tt = float(yy) / float(_segments) * 2.0f - 1.0f;
+                const bx::Vec3 pos = bx::normalize(bx::add(normal, bx::add(bx::mul(uu, ss), bx::mul(vv, tt))));
+                bx::store(&_vertices[(base + yy * side + xx) * 3], pos);
+            }
+        }
+
+        for (uint32_t yy = 0; yy < _segments; ++yy)
+        {
+            for (uint32_t xx = 0; xx < _segments; ++xx)
+            {
+                const uint32_t i00 = base + yy * side + xx;
+                const uint32_t i10 = i00 + 1;
+                const uint32_t i01 = i00 + side;
+                const uint32_t i11 = i01 + 1;
+                _indices[numIndices++] = i00;
+                _indices[numIndices++] = i10;
+                _indices[numIndices++] = i11;
+                _indices[numIndices++] = i00;
+                _indices[numIndices++] = i11;
+                _indices[numIndices++] = i01;
+            }
+        }
+    }
+}
+
+static int compareTriangle(const void *_lhs, const void *_rhs)
+{
+    return memcmp(_lhs, _rhs, 3 * sizeof(uint32_t));
+}
+
+/// Triangle as its rotation starting with smallest index, so winding is kept in comparison.
+static void canonicalTriangle(uint32_t *_dst, const uint32_t *_src)
+{
+    const uint32_t first = _src[0] < _src[1] ? (_src[0] < _src[2] ? 0 : 2) : (_src[1] < _src[2] ? 1 : 2);
+    for (uint32_t ii = 0; ii < 3; ++ii)
+    {
+        _dst[ii] = _src[(first + ii) % 3];
+    }
+}
+
+/// Every source triangle emitted once with its winding, clusters tile index buffer in order and respect
+/// limits.
+static uint32_t validateBuild(const MeshletCluster *_clusters, uint32_t _numClusters, const uint32_t *_dstIndices,
+                              const uint32_t *_indices, uint32_t _numIndices, uint32_t _numVertices,
+                              uint32_t _maxVertices, uint32_t _maxTriangles, bx::AllocatorI *_allocator)
+{
+    uint32_t numErrors = 0;
+
+    uint32_t *src = (uint32_t *)bx::alloc(_allocator, _numIndices * sizeof(uint32_t));
+    uint32_t *dst = (uint32_t *)bx::alloc(_allocator, _numIndices * sizeof(uint32_t));
+    for (uint32_t ii = 0; ii < _numIndices; ii += 3)
+    {
+        canonicalTriangle(&src[ii], &_indices[ii]);
+        canonicalTriangle(&dst[ii], &_dstIndices[ii]);
+    }
+    qsort(src, _numIndices / 3, 3 * sizeof(uint32_t), compareTriangle);
+    qsort(dst, _numIndices / 3, 3 * sizeof(uint32_t), compareTriangle);
+    if (0 != memcmp(src, dst, _numIndices * sizeof(uint32_t)))
+    {
+        fprintf(stderr, "Clustered triangles don't match source triangles.\n");
+        ++numErrors;
+    }
+    bx::free(_allocator, dst);
+    bx::free(_allocator, src);
+
+    uint8_t *seen = (uint8_t *)bx::alloc(_allocator, _numVertices);
+    bx::memSet(seen, 0, _numVertices);
+
+    uint32_t nextIndex = 0;
+    for (uint32_t ii = 0; ii < _numClusters; ++ii)
+    {
+        const MeshletCluster &cluster = _clusters[ii];
+
+        uint32_t numVertices = 0;
+        for (uint32_t jj = 0; jj < cluster.m_numTriangles * 3u; ++jj)
+        {
+            const uint32_t vertex = _dstIndices[cluster.m_firstIndex + jj];
+            numVertices += 0 == seen[vertex] ? 1 : 0;
+            seen[vertex] = 1;
+        }
+        for (uint32_t jj = 0; jj < cluster.m_numTriangles * 3u; ++jj)
+        {
+            seen[_dstIndices[cluster.m_firstIndex + jj]] = 0;
+        }
+
+        if (nextIndex != cluster.m_firstIndex || 0 == cluster.m_numTriangles ||
+            cluster.m_numTriangles > _maxTriangles || numVertices > _maxVertices ||
+            numVertices != cluster.m_numVertices)
+        {
+            fprintf(stderr, "Cluster %u is invalid, first index %u, %u triangles, %u vertices (%u stored).\n", ii,
+                    cluster.m_firstIndex, cluster.m_numTriangles, numVertices, cluster.m_numVertices);
+            ++numErrors;
+        }
+
+        nextIndex = cluster.m_firstIndex + cluster.m_numTriangles * 3;
+    }
+    bx::free(_allocator, seen);
+
+    if (nextIndex != _numIndices)
+    {
+        fprintf(stderr, "Clusters cover %u of %u indices.\n", nextIndex, _numIndices);
+        ++numErrors;
+    }
+
+    if (_numClusters > meshletBuildBound(_numIndices, _maxVertices, _maxTriangles))
+    {
+        fprintf(stderr, "Cluster count %u exceeds bound.\n", _numClusters);
+        ++numErrors;
+    }
+
+    return numErrors;
+}
+
+/// Ranges are ascending, disjoint unions of whole clusters, matching stats. Clusters rejected by cone have
+/// no triangle facing eye.
+static uint32_t validateCull(const IndexRange *_ranges, uint32_t _numRanges, const MeshletCullStats &_stats,
+                             const MeshletCluster *_clusters, uint32_t _numClusters, const uint32_t *_dstIndices,
+                             const float *_vertices, const float *_viewProj, const float *_eye)
+{
+    uint32_t numErrors = 0;
+
+    uint32_t cluster = 0;
+    uint32_t numTriangles = 0;
+    uint32_t numVisible = 0;
+    for (uint32_t ii = 0; ii < _numRanges; ++ii)
+    {
+        const IndexRange &range = _ranges[ii];
+        while (cluster < _numClusters && _clusters[cluster].m_firstIndex < range.m_firstIndex)
+        {
+            ++cluster;
+        }
+
+        uint32_t end = range.m_firstIndex;
+        while (cluster < _numClusters && _clusters[cluster].m_firstIndex == end &&
+               end < range.m_firstIndex + range.m_numIndices)
+        {
+            end += _clusters[cluster].m_numTriangles * 3;
+            ++numVisible;
+            ++cluster;
+        }
+
+        if (0 == range.m_numIndices || end != range.m_firstIndex + range.m_numIndices)
+        {
+            fprintf(stderr, "Range %u [%u, %u) isn't union of clusters.\n", ii, range.m_firstIndex,
+                    range.m_firstIndex + range.m_numIndices);
+            ++numErrors;
+        }
+        numTriangles += range.m_numIndices / 3;
+    }
+
+    if (numTriangles != _stats.m_numTriangles || numVisible != _stats.m_numVisible ||
+        _numClusters != _stats.m_numVisible + _stats.m_numFrustum + _stats.m_numBackface)
+    {
+        fprintf(stderr, "Cull stats don't match ranges.\n");
+        ++numErrors;
+    }
+
+    // Cull clusters one by one to find the ones rejected by normal cone.
+    const bx::Vec3 eye = bx::load<bx::Vec3>(_eye);
+    for (uint32_t ii = 0; ii < _numClusters; ++ii)
+    {
+        IndexRange range;
+        MeshletCullStats stats;
+        meshletCull(&range, &_clusters[ii], 1, NULL, _viewProj, _eye, &stats);
+        if (0 == stats.m_numBackface)
+        {
+            continue;
+        }
+
+        for (uint32_t jj = 0; jj < _clusters[ii].m_numTriangles; ++jj)
+        {
+            const uint32_t *triangle = &_dstIndices[_clusters[ii].m_firstIndex + jj * 3];
+            const bx::Vec3 p0 = bx::load<bx::Vec3>(&_vertices[triangle[0] * 3]);
+            const bx::Vec3 p1 = bx::load<bx::Vec3>(&_vertices[triangle[1] * 3]);
+            const bx::Vec3 p2 = bx::load<bx::Vec3>(&_vertices[triangle[2] * 3]);
+            const bx::Vec3 normal = bx::cross(bx::sub(p1, p0), bx::sub(p2, p0));
+            const bx::Vec3 dir = bx::sub(p0, eye);
+            if (bx::dot(dir, normal) < -1e-4f * bx::length(dir) * bx::length(normal))
+            {
+                fprintf(stderr, "Cluster %u was cone culled, but its triangle %u faces eye.\n", ii, jj);
+                ++numErrors;
+                break;
+            }
+        }
+    }
+
+    return numErrors;
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t segments = 128;
+    uint32_t maxVertices = BGFX_CONFIG_MESHLET_MAX_VERTICES;
+    uint32_t maxTriangles = BGFX_CONFIG_MESHLET_MAX_TRIANGLES;
+    uint32_t numViews = 64;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--segments") && ii + 1 < _argc)
+        {
+            segments = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, 1024));
+        }
+        else if (0 == strcmp(_argv[ii], "--max-vertices") && ii + 1 < _argc)
+        {
+            maxVertices = uint32_t(bx::clamp(atoi(_argv[++ii]), 3, 255));
+        }
+        else if (0 == strcmp(_argv[ii], "--max-triangles") && ii + 1 < _argc)
+        {
+            maxTriangles = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, 512));
+        }
+        else if (0 == strcmp(_argv[ii], "--views") && ii + 1 < _argc)
+        {
+            numViews = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, 4096));
+        }
+        else
+        {
+            fprintf(stderr, "Usage: meshlet_bench [--segments <n>] [--max-vertices <n>] [--max-triangles <n>] "
+                            "[--views <n>]\n");
+            return 1;
+        }
+    }
+
+    bx::DefaultAllocator allocator;
+
+    const uint32_t numVertices = 6 * (segments + 1) * (segments + 1);
+    const uint32_t numIndices = 6 * segments * segments * 6;
+
+    float *vertices = (float *)bx::alloc(&allocator, numVertices * 3 * sizeof(float));
+    uint32_t *indices = (uint32_t *)bx::alloc(&allocator, numIndices * sizeof(uint32_t));
+    uint32_t *dstIndices = (uint32_t *)bx::alloc(&allocator, numIndices * sizeof(uint32_t));
+    generateSphere(vertices, indices, segments);
+
+    VertexLayout layout;
+    layout.begin().add(Attrib::Position, 3, AttribType::Float).end();
+
+    const uint32_t bound = meshletBuildBound(numIndices, maxVertices, maxTriangles);
+    MeshletCluster *clusters = (MeshletCluster *)bx::alloc(&allocator, bound * sizeof(MeshletCluster));
+    IndexRange *ranges = (IndexRange *)bx::alloc(&allocator, bound * sizeof(IndexRange));
+
+    int64_t start = bx::getHPCounter();
+    const uint32_t numClusters = meshletBuild(clusters, dstIndices, indices, numIndices, true, vertices, numVertices,
+                                              layout, maxVertices, maxTriangles, &allocator);
+    const int64_t buildTime = bx::getHPCounter() - start;
+
+    uint32_t numErrors = validateBuild(clusters, numClusters, dstIndices, indices, numIndices, numVertices,
+                                       maxVertices, maxTriangles, &allocator);
+
+    printf("{\"phase\": \"build\", \"triangles\": %u, \"clusters\": %u, \"build_ms\": %.2f, "
+           "\"mtris_per_s\": %.2f, \"errors\": %u}\n",
+           numIndices / 3, numClusters, toMs(buildTime), double(numIndices / 3) / toMs(buildTime) / 1000.0,
+           numErrors);
+
+    // Camera orbits sphere, from close up with most clusters outside frustum to far with whole sphere visible.
+    float proj[16];
+    bx::mtxProj(proj, 60.0f, 1.0f, 0.1f, 100.0f, false);
+
+    int64_t cullTime = 0;
+    uint64_t numVisible = 0;
+    uint64_t numFrustum = 0;
+    uint64_t numBackface = 0;
+    uint32_t numCullErrors = 0;
+    for (uint32_t ii = 0; ii < numViews; ++ii)
+    {
+        const float angle = float(ii) * bx::kPi2 / float(numViews);
+        const float distance = bx::lerp(1.2f, 6.0f, float(ii % 8) / 7.0f);
+        const float eye[3] = {bx::sin(angle) * distance, bx::cos(angle * 0.5f) * 0.5f, bx::cos(angle) * distance};
+        const bx::Vec3 at = {eye[0] * 0.5f, 0.0f, eye[2] * 0.5f};
+
+        float view[16];
+        float viewProj[16];
+        bx::mtxLookAt(view, bx::load<bx::Vec3>(eye), 1.5f > distance ? at : bx::Vec3{0.0f, 0.0f, 0.0f});
+        bx::mtxMul(viewProj, view, proj);
+
+        MeshletCullStats stats;
+        start = bx::getHPCounter();
+        const uint32_t numRanges = meshletCull(ranges, clusters, numClusters, NULL, viewProj, eye, &stats);
+        cullTime += bx::getHPCounter() - start;
+
+        numVisible += stats.m_numVisible;
+        numFrustum += stats.m_numFrustum;
+        numBackface += stats.m_numBackface;
+        numCullErrors +=
+            validateCull(ranges, numRanges, stats, clusters, numClusters, dstIndices, vertices, viewProj, eye);
+    }
+    numErrors += numCullErrors;
+
+    const double numCulled = double(numClusters) * numViews;
+    printf("{\"phase\": \"cull\", \"views\": %u, \"visible\": %.3f, \"frustum\": %.3f, \"backface\": %.3f, "
+           "\"cull_us\": %.2f, \"mclusters_per_s\": %.2f, \"errors\": %u}\n",
+           numViews, double(numVisible) / numCulled, double(numFrustum) / numCulled, double(numBackface) / numCulled,
+           toMs(cullTime) * 1000.0 / numViews, numCulled / toMs(cullTime) / 1000.0, numCullErrors);
+
+    bx::free(&allocator, ranges);
+    bx::free(&allocator, clusters);
+    bx::free(&allocator, dstIndices);
+    bx::free(&allocator, indices);
+    bx::free(&allocator, vertices);
+
+    return 0 == numErrors ? 0 : 1;
+}
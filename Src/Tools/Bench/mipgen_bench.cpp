@@ -0,0 +1,103 @@
+#include <bx/allocator.h>
+#include <bx/timer.h>
+
+#include "bench_common.h"
+#include "job.h"
+#include "mipgen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+struct Workload
+{
+    const char *m_name;
+    TextureFormat::Enum m_format;
+    MipFilter::Enum m_filter;
+};
+
+static const Workload s_workloads[] = {
+    {"rgba8_box", TextureFormat::RGBA8, MipFilter::Box},
+    {"srgba8_box", TextureFormat::SRGBA8, MipFilter::Box},
+    {"rgba16f_box", TextureFormat::RGBA16F, MipFilter::Box},
+    {"r32f_box", TextureFormat::R32F, MipFilter::Box},
+    {"rgba8_kaiser", TextureFormat::RGBA8, MipFilter::Kaiser},
+    {"srgba8_kaiser", TextureFormat::SRGBA8, MipFilter::Kaiser},
+};
+
+static void run(const Workload &_workload, uint16_t _size, uint32_t _iterations, JobPool &_pool,
+                bx::AllocatorI *_allocator)
+{
+    TextureInfo info;
+    calcTextureSize(info, _size, _size, false, true, _workload.m_format);
+
+    // Noise mip 0, mips content doesn't affect filter speed.
+    uint8_t *data = (uint8_t *)bx::alloc(_allocator, info.storageSize, 16);
+    const uint32_t topSize = uint32_t(_size) * _size * info.bitsPerPixel / 8;
+    for (uint32_t ii = 0; ii < topSize / 4; ++ii)
+    {
+        ((uint32_t *)data)[ii] = rand32() & 0x3c003c00; // Keeps halfs and floats finite.
+    }
+
+    int64_t best = INT64_MAX;
+    for (uint32_t ii = 0; ii < _iterations; ++ii)
+    {
+        const int64_t start = bx::getHPCounter();
+        mipGenerate(data, info, _workload.m_filter, &_pool, _allocator);
+        best = bx::min(best, bx::getHPCounter() - start);
+    }
+
+    const double ms = double(best) * 1000.0 / double(bx::getHPFrequency());
+    const double mpixels = double(_size) * _size / 1e6;
+
+    printf("{\"workload\": \"%s\", \"size\": %u, \"mips\": %u, \"threads\": %u, \"best_ms\": %.2f, "
+           "\"mpixels_per_sec\": %.1f}\n",
+           _workload.m_name, _size, info.numMips, _pool.getNumThreads(), ms, mpixels * 1000.0 / ms);
+
+    bx::free(_allocator, data, 16);
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint16_t size = 4096;
+    uint32_t numThreads = 8;
+    uint32_t iterations = 10;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--size") && ii + 1 < _argc)
+        {
+            size = uint16_t(bx::clamp(atoi(_argv[++ii]), 1, 16384));
+        }
+        else if (0 == strcmp(_argv[ii], "--threads") && ii + 1 < _argc)
+        {
+            numThreads = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, BGFX_CONFIG_MAX_WORKER_THREADS + 1));
+        }
+        else if (0 == strcmp(_argv[ii], "--iterations") && ii + 1 < _argc)
+        {
+            iterations = uint32_t(bx::max(1, atoi(_argv[++ii])));
+        }
+        else
+        {
+            fprintf(stderr, "Usage: mipgen_bench [--size <pixels>] [--threads <n>] [--iterations <n>]\n");
+            return 1;
+        }
+    }
+
+    bx::DefaultAllocator allocator;
+
+    // Calling thread works too.
+    JobPool pool;
+    pool.create(numThreads - 1);
+
+    for (uint32_t ii = 0; ii < BX_COUNTOF(s_workloads); ++ii)
+    {
+        run(s_workloads[ii], size, iterations, pool, &allocator);
+    }
+
+    pool.destroy();
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/timer.h>
+
+#include "bench_common.h"
+#include "thumbnail.h"
+#include "tiny_render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+using namespace TinyRender;
+
+static const char *s_vertexShader = R"(
+float4 main(float3 pos : POSITION) : SV_POSITION
+{
+    return float4(pos, 1.0f);
+}
+)";
+
+static const char *s_pixelShader = R"(
+float4 main() : SV_Target
+{
+    return float4(1.0f, 1.0f, 1.0f, 1.0f);
+}
+)";
+
+static float randUnorm()
+{
+    return float(rand32() & 0xffff) / 65535.0f;
+}
+
+/// User plus kernel time of all process threads, driver threads included.
+static double getProcessCpuSeconds()
+{
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+    const uint64_t kernel100ns = (uint64_t(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    const uint64_t user100ns = (uint64_t(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return double(kernel100ns + user100ns) * 1e-7;
+}
+
+struct Mesh
+{
+    VertexBufferHandle m_vbh;
+    IndexBufferHandle m_ibh;
+};
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t numJobs = 1000;
+    uint32_t numMeshes = 16;
+    uint16_t size = 128;
+    uint16_t numTargets = 64;
+    const char *outDir = ".";
+    bool d3d12 = false;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--jobs") && ii + 1 < _argc)
+        {
+            numJobs = bx::max(1, atoi(_argv[++ii]));
+        }
+        else if (0 == strcmp(_argv[ii], "--size") && ii + 1 < _argc)
+        {
+            size = uint16_t(bx::clamp(atoi(_argv[++ii]), 1, 4096));
+        }
+        else if (0 == strcmp(_argv[ii], "--targets") && ii + 1 < _argc)
+        {
+            numTargets = uint16_t(bx::clamp(atoi(_argv[++ii]), 1, BGFX_CONFIG_MAX_VIEWS));
+        }
+        else if (0 == strcmp(_argv[ii], "--out") && ii + 1 < _argc)
+        {
+            outDir = _argv[++ii];
+        }
+        else if (0 == strcmp(_argv[ii], "--d3d12"))
+        {
+            d3d12 = true;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "Usage: thumbnail_bench [--jobs <n>] [--size <pixels>] [--targets <n>] [--out <dir>] [--d3d12]\n");
+            return 1;
+        }
+    }
+
+    // Headless, without `--d3d12` bench runs on Noop renderer and measures frontend, readback
+    // plumbing, encoding and file output.
+    InitParams init = {size, size, 1, 1, NULL};
+    init.type = d3d12 ? RendererType::Direct3D12 : RendererType::Noop;
+    TinyRender::init(init);
+
+    const ShaderHandle vsh = createShader(s_vertexShader, uint32_t(strlen(s_vertexShader)), ShaderType_Vertex);
+    const ShaderHandle fsh = createShader(s_pixelShader, uint32_t(strlen(s_pixelShader)), ShaderType_Fragment);
+    const ProgramHandle program = createProgram(vsh, fsh);
+
+    VertexLayout layout;
+    layout.begin().add(Attrib::Position, 3, AttribType::Float).end();
+
+    bx::DefaultAllocator allocator;
+
+    Mesh *meshes = (Mesh *)bx::alloc(&allocator, numMeshes * sizeof(Mesh));
+    for (uint32_t ii = 0; ii < numMeshes; ++ii)
+    {
+        const uint32_t numVertices = 64 + rand32() % 960;
+        const uint32_t numIndices = (numVertices - 2) * 3;
+
+        float *vertices = (float *)bx::alloc(&allocator, numVertices * 3 * sizeof(float));
+        for (uint32_t jj = 0; jj < numVertices * 3; ++jj)
+        {
+            vertices[jj] = randUnorm() * 2.0f - 1.0f;
+        }
+        meshes[ii].m_vbh = createVertexBuffer(vertices, numVertices * 3 * sizeof(float), layout);
+        bx::free(&allocator, vertices);
+
+        uint16_t *indices = (uint16_t *)bx::alloc(&allocator, numIndices * sizeof(uint16_t));
+        for (uint32_t jj = 0; jj < numIndices; ++jj)
+        {
+            indices[jj] = uint16_t(jj / 3 + jj % 3);
+        }
+        meshes[ii].m_ibh = createIndexBuffer(indices, numIndices * sizeof(uint16_t));
+        bx::free(&allocator, indices);
+    }
+
+    // Camera orbits mesh, one view angle per job.
+    ThumbnailJob *jobs = (ThumbnailJob *)bx::alloc(&allocator, numJobs * sizeof(ThumbnailJob));
+    char *paths = (char *)bx::alloc(&allocator, numJobs * 256);
+    for (uint32_t ii = 0; ii < numJobs; ++ii)
+    {
+        ThumbnailJob &job = jobs[ii];
+        const Mesh &mesh = meshes[ii % numMeshes];
+        job.m_vbh = mesh.m_vbh;
+        job.m_ibh = mesh.m_ibh;
+        job.m_program = program;
+        job.m_state = BGFX_STATE_DEFAULT & ~BGFX_STATE_CULL_MASK; // Random triangles face both ways.
+
+        const float angle = float(ii) * bx::kPi2 / float(numJobs);
+        const bx::Vec3 at = {0.0f, 0.0f, 0.0f};
+        const bx::Vec3 eye = {bx::sin(angle) * 3.0f, 1.0f, bx::cos(angle) * 3.0f};
+        bx::mtxLookAt(job.m_view, eye, at);
+        bx::mtxProj(job.m_proj, 60.0f, 1.0f, 0.1f, 100.0f, false);
+
+        snprintf(&paths[ii * 256], 256, "%s/thumb_%05u.tga", outDir, ii);
+        job.m_filePath = &paths[ii * 256];
+    }
+
+    ThumbnailBatch batch;
+    batch.create(size, size, numTargets);
+
+    const double cpuStart = getProcessCpuSeconds();
+    const int64_t start = bx::getHPCounter();
+
+    const uint32_t numWritten = batch.render(jobs, numJobs);
+
+    const double seconds = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+    const double cpuSeconds = bx::max(getProcessCpuSeconds() - cpuStart, 1e-6);
+
+    printf("{\"renderer\": \"%s\", \"jobs\": %u, \"written\": %u, \"size\": %u, \"targets\": %u, "
+           "\"bytes\": %llu, \"seconds\": %.3f, \"cpu_seconds\": %.3f, \"thumbnails_per_sec\": %.1f, "
+           "\"thumbnails_per_sec_per_core\": %.1f}\n",
+           getRendererName(getRendererType()), numJobs, numWritten, size, batch.getNumTargets(),
+           (unsigned long long)batch.getNumBytesWritten(), seconds, cpuSeconds, double(numWritten) / seconds,
+           double(numWritten) / cpuSeconds);
+
+    batch.destroy();
+
+    bx::free(&allocator, paths);
+    bx::free(&allocator, jobs);
+    bx::free(&allocator, meshes);
+
+    return 0 == shutdownAndCheckMemory() ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/timer.h>
+#include <bx/uint32_t.h>
+
+#include "bench_common.h"
+#include "profiler.h"
+#include "tiny_render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+using namespace TinyRender;
+
+static const char *s_vertexShader = R"(
+float4 main(float3 pos : POSITION) : SV_POSITION
+{
+    return float4(pos, 1.0f);
+}
+)";
+
+static const char *s_pixelShader = R"(
+float4 main() : SV_Target
+{
+    return float4(1.0f, 1.0f, 1.0f, 1.0f);
+}
+)";
+
+/// Log-uniform size in [_min, _max].
+static uint32_t randSize(uint32_t _min, uint32_t _max)
+{
+    const uint32_t minLog2 = 31 - bx::uint32_cntlz(_min);
+    const uint32_t maxLog2 = 31 - bx::uint32_cntlz(_max);
+    const uint32_t log2 = minLog2 + rand32() % (maxLog2 - minLog2 + 1);
+    return bx::clamp((1u << log2) + rand32() % (1u << log2), _min, _max);
+}
+
+struct Scene
+{
+    const char *m_name;
+    uint32_t m_numDraws;
+    uint32_t m_numPsos;
+    uint32_t m_numLayouts; //!< Up to 16, every layout has position plus a subset of normal, color, uv, tangent.
+    uint32_t m_numMeshes;
+    uint32_t m_minVertices;
+    uint32_t m_maxVertices;
+    float m_transformChurn; //!< Fraction of draws whose transform changes every frame.
+};
+
+static const Scene s_scenes[] = {
+    {"draws_1k", 1000, 8, 2, 64, 16, 1 << 10, 0.1f},
+    {"draws_10k", 10000, 32, 4, 256, 16, 256, 0.5f},
+    {"pso_heavy", 2000, 256, 16, 64, 64, 64, 1.0f},
+    {"big_meshes", 200, 4, 1, 16, 16 << 10, 64 << 10, 0.0f},
+};
+
+static void initLayout(VertexLayout &_layout, uint32_t _bits)
+{
+    _layout.begin().add(Attrib::Position, 3, AttribType::Float);
+
+    if (0 != (_bits & 1))
+    {
+        _layout.add(Attrib::Normal, 3, AttribType::Float);
+    }
+
+    if (0 != (_bits & 2))
+    {
+        _layout.add(Attrib::Color0, 4, AttribType::Uint8, true);
+    }
+
+    if (0 != (_bits & 4))
+    {
+        _layout.add(Attrib::TexCoord0, 2, AttribType::Float);
+    }
+
+    if (0 != (_bits & 8))
+    {
+        _layout.add(Attrib::Tangent, 4, AttribType::Float);
+    }
+
+    _layout.end();
+}
+
+struct Mesh
+{
+    VertexBufferHandle m_vbh;
+    IndexBufferHandle m_ibh;
+    uint32_t m_layout;
+};
+
+static int compareDouble(const void *_lhs, const void *_rhs)
+{
+    const double lhs = *(const double *)_lhs;
+    const double rhs = *(const double *)_rhs;
+    return lhs < rhs ? -1 : lhs > rhs ? 1 : 0;
+}
+
+static double percentile(const double *_sorted, uint32_t _num, double _p)
+{
+    return _sorted[bx::min<uint32_t>(_num - 1, uint32_t(_p * _num))];
+}
+
+static void run(const Scene &_scene, ProgramHandle _program, uint32_t _numFrames, uint32_t _numWarmup,
+                bx::AllocatorI *_allocator)
+{
+    const uint32_t numLayouts = bx::clamp<uint32_t>(_scene.m_numLayouts, 1, 16);
+    const uint32_t numPsos = bx::max(_scene.m_numPsos, numLayouts);
+    const uint32_t psosPerLayout = numPsos / numLayouts;
+
+    VertexLayout layouts[16];
+    for (uint32_t ii = 0; ii < numLayouts; ++ii)
+    {
+        initLayout(layouts[ii], ii);
+    }
+
+    // PSO `ii` uses layout `ii % numLayouts`, all share state.
+    PSOHandle *psos = (PSOHandle *)bx::alloc(_allocator, numPsos * sizeof(PSOHandle));
+    for (uint32_t ii = 0; ii < numPsos; ++ii)
+    {
+        psos[ii] = createPSO(_program, layouts[ii % numLayouts], BGFX_STATE_DEFAULT);
+    }
+
+    Mesh *meshes = (Mesh *)bx::alloc(_allocator, _scene.m_numMeshes * sizeof(Mesh));
+    for (uint32_t ii = 0; ii < _scene.m_numMeshes; ++ii)
+    {
+        Mesh &mesh = meshes[ii];
+        mesh.m_layout = ii % numLayouts;
+
+        const VertexLayout &layout = layouts[mesh.m_layout];
+        const uint32_t numVertices = randSize(_scene.m_minVertices, _scene.m_maxVertices);
+        const uint32_t numIndices = (numVertices - 2) * 3;
+
+        const uint32_t vertexSize = layout.getSize(numVertices);
+        uint8_t *vertices = (uint8_t *)bx::alloc(_allocator, vertexSize);
+        bx::memSet(vertices, 0, vertexSize);
+        mesh.m_vbh = createVertexBuffer(vertices, vertexSize, layout);
+        bx::free(_allocator, vertices);
+
+        // Triangle strip as list, index size follows vertex count.
+        const bool index32 = numVertices > UINT16_MAX;
+        const uint32_t indexSize = numIndices * (index32 ? 4 : 2);
+        uint8_t *indices = (uint8_t *)bx::alloc(_allocator, indexSize);
+        for (uint32_t jj = 0; jj < numIndices; ++jj)
+        {
+            const uint32_t index = jj / 3 + jj % 3;
+            if (index32)
+            {
+                ((uint32_t *)indices)[jj] = index;
+            }
+            else
+            {
+                ((uint16_t *)indices)[jj] = uint16_t(index);
+            }
+        }
+        mesh.m_ibh = createIndexBuffer(indices, indexSize, index32 ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+        bx::free(_allocator, indices);
+    }
+
+    float *transforms = (float *)bx::alloc(_allocator, _scene.m_numDraws * 16 * sizeof(float));
+    for (uint32_t ii = 0; ii < _scene.m_numDraws; ++ii)
+    {
+        bx::mtxTranslate(&transforms[ii * 16], float(ii % 100), float(ii / 100), 0.0f);
+    }
+
+    const uint32_t numChurn = uint32_t(_scene.m_transformChurn * _scene.m_numDraws);
+
+    double *frameMs = (double *)bx::alloc(_allocator, _numFrames * sizeof(double));
+    int64_t submitTicks = 0;
+    int64_t sortTicks = 0;
+    int64_t timerFreq = 1;
+
+    const double toMs = 1000.0 / double(bx::getHPFrequency());
+
+    for (uint32_t frame = 0; frame < _numWarmup + _numFrames; ++frame)
+    {
+        const int64_t frameStart = bx::getHPCounter();
+
+        for (uint32_t ii = 0; ii < numChurn; ++ii)
+        {
+            const uint32_t draw = rand32() % _scene.m_numDraws;
+            bx::mtxRotateXY(&transforms[draw * 16], 0.0f, float(frame) * 0.01f);
+        }
+
+        for (uint32_t ii = 0; ii < _scene.m_numDraws; ++ii)
+        {
+            const Mesh &mesh = meshes[ii % _scene.m_numMeshes];
+            const PSOHandle pso = psos[mesh.m_layout + numLayouts * (ii % psosPerLayout)];
+            drawMesh(0, mesh.m_vbh, mesh.m_ibh, _program, pso, 0, &transforms[ii * 16]);
+        }
+
+        endFrame();
+
+        if (frame >= _numWarmup)
+        {
+            const Stats *stats = getStats();
+            frameMs[frame - _numWarmup] = double(bx::getHPCounter() - frameStart) * toMs;
+            submitTicks += stats->cpuTimeSubmit;
+            sortTicks += stats->cpuTimeSort;
+            timerFreq = stats->cpuTimerFreq;
+        }
+    }
+
+    qsort(frameMs, _numFrames, sizeof(double), compareDouble);
+
+    const Stats *stats = getStats();
+    int64_t memoryPeak = 0;
+    for (uint32_t ii = 0; ii < MemoryCategory::Count; ++ii)
+    {
+        memoryPeak += stats->memory[ii].peak;
+    }
+
+    const double tickNs = 1e9 / double(timerFreq);
+
+    printf("{\"scene\": \"%s\", \"renderer\": \"%s\", \"draws\": %u, \"psos\": %u, \"layouts\": %u, "
+           "\"meshes\": %u, \"frames\": %u, \"submit_ns_per_draw\": %.1f, \"sort_us_per_frame\": %.1f, "
+           "\"frame_ms_p50\": %.3f, \"frame_ms_p90\": %.3f, \"frame_ms_p99\": %.3f, \"frame_ms_max\": %.3f, "
+           "\"memory\": %lld, \"memory_peak\": %lld}\n",
+           _scene.m_name, getRendererName(getRendererType()), _scene.m_numDraws, numPsos, numLayouts,
+           _scene.m_numMeshes, _numFrames,
+           double(submitTicks) * tickNs / (double(_scene.m_numDraws) * _numFrames),
+           double(sortTicks) * tickNs * 1e-3 / _numFrames, percentile(frameMs, _numFrames, 0.5),
+           percentile(frameMs, _numFrames, 0.9), percentile(frameMs, _numFrames, 0.99), frameMs[_numFrames - 1],
+           (long long)stats->memoryCurrent, (long long)memoryPeak);
+
+    bx::free(_allocator, frameMs);
+    bx::free(_allocator, transforms);
+    bx::free(_allocator, meshes);
+    bx::free(_allocator, psos);
+}
+
+/// Cost of one empty profiler scope, best of several passes. Scopes go to calling thread ring like any
+/// other, recorded events are dropped afterwards.
+static void measureProfilerScope(uint32_t _numScopes)
+{
+    const uint32_t numPasses = 5;
+    const double targetNs = 20.0;
+
+    int64_t best = INT64_MAX;
+    for (uint32_t pass = 0; pass < numPasses; ++pass)
+    {
+        const int64_t start = bx::getHPCounter();
+        for (uint32_t ii = 0; ii < _numScopes; ++ii)
+        {
+            BGFX_PROFILER_SCOPE("Bench::scope");
+        }
+        best = bx::min(best, bx::getHPCounter() - start);
+    }
+
+    profilerReset();
+
+    const double nsPerScope = double(best) * 1e9 / double(bx::getHPFrequency()) / double(_numScopes);
+    printf("{\"profiler\": %s, \"scopes\": %u, \"ns_per_scope\": %.2f, \"target_ns\": %.0f, "
+           "\"within_target\": %s}\n",
+           BGFX_CONFIG_PROFILER ? "true" : "false", _numScopes, nsPerScope, targetNs,
+           nsPerScope < targetNs ? "true" : "false");
+}
+
+// D3D12 backend needs a window to present to, it's created hidden. Without `--window` bench runs on Noop
+// renderer and measures frontend only.
+static HWND createWindow(int _width, int _height)
+{
+    const wchar_t className[] = L"TinyRender Bench";
+
+    WNDCLASSW wc = {};
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = GetModuleHandleW(NULL);
+    wc.lpszClassName = className;
+    RegisterClassW(&wc);
+
+    return CreateWindowExW(0, className, className, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, _width, _height,
+                           NULL, NULL, wc.hInstance, NULL);
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t numFrames = 100;
+    const char *filter = NULL;
+    bool window = false;
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--frames") && ii + 1 < _argc)
+        {
+            numFrames = bx::max(1, atoi(_argv[++ii]));
+        }
+        else if (0 == strcmp(_argv[ii], "--scene") && ii + 1 < _argc)
+        {
+            filter = _argv[++ii];
+        }
+        else if (0 == strcmp(_argv[ii], "--window"))
+        {
+            window = true;
+        }
+        else
+        {
+            fprintf(stderr, "Usage: tinyrender_bench [--frames <n>] [--scene <name>] [--window]\n");
+            return 1;
+        }
+    }
+
+    const int width = 1280;
+    const int height = 720;
+
+    InitParams init = {width, height, 1, 1, window ? createWindow(width, height) : NULL};
+    init.type = window ? RendererType::Count : RendererType::Noop;
+    TinyRender::init(init);
+
+    const ShaderHandle vsh = createShader(s_vertexShader, uint32_t(strlen(s_vertexShader)), ShaderType_Vertex);
+    const ShaderHandle fsh = createShader(s_pixelShader, uint32_t(strlen(s_pixelShader)), ShaderType_Fragment);
+    const ProgramHandle program = createProgram(vsh, fsh);
+
+    float view[16];
+    float proj[16];
+    bx::mtxIdentity(view);
+    bx::mtxIdentity(proj);
+    setViewTransform(0, view, proj);
+    setViewRect(0, 0, 0, uint16_t(width), uint16_t(height));
+    setViewClear(0, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x003366ff, 1.0f, 0);
+
+    measureProfilerScope(1 << 20);
+
+    bx::DefaultAllocator allocator;
+
+    for (uint32_t ii = 0; ii < BX_COUNTOF(s_scenes); ++ii)
+    {
+        if (NULL == filter || 0 == strcmp(filter, s_scenes[ii].m_name))
+        {
+            run(s_scenes[ii], program, numFrames, 10, &allocator);
+        }
+    }
+
+    return 0 == shutdownAndCheckMemory() ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include <bx/allocator.h>
+#include <bx/timer.h>
+#include <bx/uint32_t.h>
+
+#include "bench_common.h"
+#include "tlsf.h"
+
+#include <stdio.h>
+
+using namespace TinyRender;
+
+/// Log-uniform size in [_min, _max], roughly what mesh buffer sizes look like.
+static uint32_t randSize(uint32_t _min, uint32_t _max)
+{
+    const uint32_t minLog2 = 31 - bx::uint32_cntlz(_min);
+    const uint32_t maxLog2 = 31 - bx::uint32_cntlz(_max);
+    const uint32_t log2 = minLog2 + rand32() % (maxLog2 - minLog2 + 1);
+    return bx::clamp((1u << log2) + rand32() % (1u << log2), _min, _max);
+}
+
+/// Walk physical block chain and check it against live allocations and free lists.
+static uint32_t validate(const TlsfAllocator &_tlsf, const TlsfAllocation *_live, const uint32_t *_sizes,
+                         uint32_t _numLive)
+{
+    uint32_t numErrors = 0;
+
+    for (uint32_t ii = 0; ii < _numLive; ++ii)
+    {
+        const TlsfAllocator::Node &node = _tlsf.m_nodes[_live[ii].m_node];
+        if (!node.m_used || node.m_offset << _tlsf.m_granularityLog2 != _live[ii].m_offset ||
+            _tlsf.getSize(_live[ii]) < _sizes[ii])
+        {
+            fprintf(stderr, "Allocation at %u doesn't match its block.\n", _live[ii].m_offset);
+            ++numErrors;
+        }
+    }
+
+    uint32_t node = UINT32_MAX;
+    if (0 != _numLive)
+    {
+        node = _live[0].m_node;
+    }
+    for (uint32_t ii = 0; ii < BX_COUNTOF(_tlsf.m_heads) && UINT32_MAX == node; ++ii)
+    {
+        node = _tlsf.m_heads[ii];
+    }
+    while (UINT32_MAX != node && UINT32_MAX != _tlsf.m_nodes[node].m_prevPhys)
+    {
+        node = _tlsf.m_nodes[node].m_prevPhys;
+    }
+
+    uint32_t offset = 0;
+    uint32_t usedSize = 0;
+    uint32_t numUsed = 0;
+    uint32_t numFree = 0;
+    bool prevFree = false;
+    for (uint32_t it = node; UINT32_MAX != it; it = _tlsf.m_nodes[it].m_nextPhys)
+    {
+        const TlsfAllocator::Node &block = _tlsf.m_nodes[it];
+        if (block.m_offset != offset || 0 == block.m_size || (prevFree && !block.m_used))
+        {
+            fprintf(stderr, "Block at %u is out of place, unmerged or empty.\n", block.m_offset);
+            ++numErrors;
+            break;
+        }
+
+        offset += block.m_size;
+        usedSize += block.m_used ? block.m_size : 0;
+        numUsed += block.m_used ? 1 : 0;
+        numFree += block.m_used ? 0 : 1;
+        prevFree = !block.m_used;
+    }
+
+    TlsfStats stats;
+    _tlsf.getStats(stats);
+    if (offset != _tlsf.m_size || usedSize != _tlsf.m_usedSize || numUsed != _numLive ||
+        numUsed != stats.m_numAllocs || numFree != stats.m_numFreeBlocks)
+    {
+        fprintf(stderr, "Block chain doesn't match allocator state.\n");
+        ++numErrors;
+    }
+
+    return numErrors;
+}
+
+struct Workload
+{
+    const char *m_name;
+    uint32_t m_heapSize;
+    uint32_t m_minSize;
+    uint32_t m_maxSize;
+    float m_fill; //!< Target fraction of heap in use during churn.
+};
+
+static const Workload s_workloads[] = {
+    {"small_buffers", 64 << 20, 256, 64 << 10, 0.5f},
+    {"mixed_meshes", 256 << 20, 1 << 10, 4 << 20, 0.6f},
+    {"high_pressure", 64 << 20, 256, 1 << 20, 0.85f},
+};
+
+static uint32_t run(const Workload &_workload, bx::AllocatorI *_allocator)
+{
+    const uint32_t maxAllocs = 64 << 10;
+    const uint32_t numOps = 1 << 20;
+
+    TlsfAllocator tlsf;
+    tlsf.create(_workload.m_heapSize, maxAllocs, 256, _allocator);
+
+    TlsfAllocation *live = (TlsfAllocation *)bx::alloc(_allocator, maxAllocs * sizeof(TlsfAllocation));
+    uint32_t *sizes = (uint32_t *)bx::alloc(_allocator, maxAllocs * sizeof(uint32_t));
+    uint32_t numLive = 0;
+    uint32_t numFailed = 0;
+    uint32_t numErrors = 0;
+
+    const uint32_t target = uint32_t(_workload.m_fill * _workload.m_heapSize);
+
+    int64_t elapsed = -bx::getHPCounter();
+    for (uint32_t ii = 0; ii < numOps; ++ii)
+    {
+        const bool grow = tlsf.m_usedSize << tlsf.m_granularityLog2 < target;
+        if ((grow || 0 == numLive) && numLive < maxAllocs)
+        {
+            const uint32_t size = randSize(_workload.m_minSize, _workload.m_maxSize);
+            TlsfAllocation allocation = tlsf.alloc(size);
+            if (TlsfAllocator::isValid(allocation))
+            {
+                sizes[numLive] = size;
+                live[numLive++] = allocation;
+            }
+            else
+            {
+                ++numFailed;
+            }
+        }
+        else
+        {
+            const uint32_t idx = rand32() % numLive;
+            tlsf.free(live[idx]);
+            live[idx] = live[--numLive];
+            sizes[idx] = sizes[numLive];
+        }
+    }
+    elapsed += bx::getHPCounter();
+
+    numErrors += validate(tlsf, live, sizes, numLive);
+
+    TlsfStats stats;
+    tlsf.getStats(stats);
+
+    const double nsPerOp = double(elapsed) * 1e9 / double(bx::getHPFrequency()) / numOps;
+
+    printf("{\"workload\": \"%s\", \"ops\": %u, \"ns_per_op\": %.1f, \"failed\": %u, \"allocs\": %u, "
+           "\"used\": %u, \"free\": %u, \"largest_free\": %u, \"free_blocks\": %u, \"fragmentation\": %.3f, "
+           "\"errors\": %u}\n",
+           _workload.m_name, numOps, nsPerOp, numFailed, stats.m_numAllocs, stats.m_usedSize, stats.m_freeSize,
+           stats.m_largestFree, stats.m_numFreeBlocks, stats.m_fragmentation, numErrors);
+
+    for (uint32_t ii = 0; ii < numLive; ++ii)
+    {
+        tlsf.free(live[ii]);
+    }
+
+    numErrors += validate(tlsf, NULL, NULL, 0);
+    tlsf.getStats(stats);
+    if (1 != stats.m_numFreeBlocks || stats.m_freeSize != stats.m_totalSize)
+    {
+        fprintf(stderr, "Free blocks were not merged.\n");
+        ++numErrors;
+    }
+
+    bx::free(_allocator, sizes);
+    bx::free(_allocator, live);
+    tlsf.destroy();
+
+    return numErrors;
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    BX_UNUSED(_argc, _argv);
+
+    bx::DefaultAllocator allocator;
+
+    uint32_t numErrors = 0;
+    for (uint32_t ii = 0; ii < BX_COUNTOF(s_workloads); ++ii)
+    {
+        numErrors += run(s_workloads[ii], &allocator);
+    }
+
+    return 0 == numErrors ? 0 : 1;
+}
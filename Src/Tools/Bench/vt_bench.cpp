@@ -0,0 +1,287 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/os.h>
+#include <bx/timer.h>
+
+#include "bench_common.h"
+#include "job.h"
+#include "tiny_render.h"
+#include "vt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TinyRender;
+
+struct Format
+{
+    const char *m_name;
+    TextureFormat::Enum m_format;
+};
+
+static const Format s_formats[] = {
+    {"rgba8", TextureFormat::RGBA8},
+    {"bc1", TextureFormat::BC1},
+    {"bc7", TextureFormat::BC7},
+};
+
+/// Tile grid with gradients, so every tile and mip holds different data.
+static void fillImage(uint8_t *_data, uint32_t _width, uint32_t _height)
+{
+    for (uint32_t yy = 0; yy < _height; ++yy)
+    {
+        for (uint32_t xx = 0; xx < _width; ++xx)
+        {
+            uint8_t *pixel = &_data[(yy * _width + xx) * 4];
+            pixel[0] = uint8_t(xx * 255 / _width);
+            pixel[1] = uint8_t(yy * 255 / _height);
+            pixel[2] = uint8_t((xx ^ yy) & 0xff);
+            pixel[3] = 255;
+        }
+    }
+}
+
+/// Tiles of mip `_mip` covered by view `_viewSize` texels square at `_centerX`, `_centerY` of mip 0,
+/// clamped to mip.
+static void getViewTiles(const VirtualTexture &_vt, float _centerX, float _centerY, float _viewSize, uint8_t _mip,
+                         int32_t _outRect[4])
+{
+    const float tileSize = float(uint32_t(_vt.getTileSize()) << _mip);
+    _outRect[0] = bx::max(int32_t(bx::floor((_centerX - _viewSize * 0.5f) / tileSize)), 0);
+    _outRect[1] = bx::max(int32_t(bx::floor((_centerY - _viewSize * 0.5f) / tileSize)), 0);
+    _outRect[2] = bx::min(int32_t(bx::floor((_centerX + _viewSize * 0.5f) / tileSize)), _vt.getNumTilesX(_mip) - 1);
+    _outRect[3] = bx::min(int32_t(bx::floor((_centerY + _viewSize * 0.5f) / tileSize)), _vt.getNumTilesY(_mip) - 1);
+}
+
+/// Requests of view, sampled at `_mip`, like feedback pass would produce.
+static void requestView(VirtualTexture &_vt, float _centerX, float _centerY, float _viewSize, uint8_t _mip)
+{
+    int32_t rect[4];
+    getViewTiles(_vt, _centerX, _centerY, _viewSize, _mip, rect);
+
+    for (int32_t yy = rect[1]; yy <= rect[3]; ++yy)
+    {
+        for (int32_t xx = rect[0]; xx <= rect[2]; ++xx)
+        {
+            _vt.request(_mip, uint16_t(xx), uint16_t(yy));
+        }
+    }
+}
+
+/// Cache invariants, view tiles must be resident only when they were all loaded, `--sync` after `flush`.
+static uint32_t checkCache(const VirtualTexture &_vt, uint32_t _numSlots, float _centerX, float _centerY,
+                           float _viewSize, uint8_t _mip, bool _viewLoaded)
+{
+    uint32_t numErrors = 0;
+    const VirtualTextureStats &stats = _vt.getStats();
+
+    if (stats.numResident > _numSlots || 0 != stats.numFailed)
+    {
+        fprintf(stderr, "%u tiles resident in %u slots, %llu failed.\n", stats.numResident, _numSlots,
+                (unsigned long long)stats.numFailed);
+        ++numErrors;
+    }
+
+    // Coarsest mip is pinned.
+    const uint8_t coarsest = uint8_t(_vt.getNumMips() - 1);
+    for (uint16_t yy = 0; yy < _vt.getNumTilesY(coarsest); ++yy)
+    {
+        for (uint16_t xx = 0; xx < _vt.getNumTilesX(coarsest); ++xx)
+        {
+            if (!_vt.isResident(coarsest, xx, yy))
+            {
+                fprintf(stderr, "Pinned tile %u, %u of mip %u was evicted.\n", xx, yy, coarsest);
+                ++numErrors;
+            }
+        }
+    }
+
+    if (_viewLoaded)
+    {
+        int32_t rect[4];
+        getViewTiles(_vt, _centerX, _centerY, _viewSize, _mip, rect);
+
+        for (int32_t yy = rect[1]; yy <= rect[3]; ++yy)
+        {
+            for (int32_t xx = rect[0]; xx <= rect[2]; ++xx)
+            {
+                if (!_vt.isResident(_mip, uint16_t(xx), uint16_t(yy)))
+                {
+                    fprintf(stderr, "View tile %d, %d of mip %u isn't resident after flush.\n", xx, yy, _mip);
+                    ++numErrors;
+                }
+            }
+        }
+    }
+
+    return numErrors;
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    uint32_t size = 32;
+    uint32_t tileSize = 120;
+    uint32_t border = 4;
+    uint32_t numSlots = 16;
+    uint32_t numFrames = 600;
+    uint32_t frameMs = 4;
+    bool sync = false;
+    const Format *format = &s_formats[0];
+    const char *filePath = "vt_bench.trvt";
+
+    for (int ii = 1; ii < _argc; ++ii)
+    {
+        if (0 == strcmp(_argv[ii], "--size") && ii + 1 < _argc)
+        {
+            size = uint32_t(bx::clamp(atoi(_argv[++ii]), 1, 128));
+        }
+        else if (0 == strcmp(_argv[ii], "--tile") && ii + 1 < _argc)
+        {
+            tileSize = uint32_t(bx::clamp(atoi(_argv[++ii]), 8, 1024));
+        }
+        else if (0 == strcmp(_argv[ii], "--border") && ii + 1 < _argc)
+        {
+            border = uint32_t(bx::clamp(atoi(_argv[++ii]), 0, 16));
+        }
+        else if (0 == strcmp(_argv[ii], "--slots") && ii + 1 < _argc)
+        {
+            numSlots = uint32_t(bx::clamp(atoi(_argv[++ii]), 2, 256));
+        }
+        else if (0 == strcmp(_argv[ii], "--frames") && ii + 1 < _argc)
+        {
+            numFrames = uint32_t(bx::max(1, atoi(_argv[++ii])));
+        }
+        else if (0 == strcmp(_argv[ii], "--frame-ms") && ii + 1 < _argc)
+        {
+            frameMs = uint32_t(bx::max(0, atoi(_argv[++ii])));
+        }
+        else if (0 == strcmp(_argv[ii], "--sync"))
+        {
+            sync = true;
+        }
+        else if (0 == strcmp(_argv[ii], "--format") && ii + 1 < _argc)
+        {
+            const char *name = _argv[++ii];
+            format = NULL;
+            for (uint32_t jj = 0; jj < BX_COUNTOF(s_formats); ++jj)
+            {
+                format = 0 == strcmp(name, s_formats[jj].m_name) ? &s_formats[jj] : format;
+            }
+
+            if (NULL == format)
+            {
+                fprintf(stderr, "Unknown format %s.\n", name);
+                return 1;
+            }
+        }
+        else if (0 == strcmp(_argv[ii], "--out") && ii + 1 < _argc)
+        {
+            filePath = _argv[++ii];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: vt_bench [--size <tiles>] [--tile <pixels>] [--border <pixels>] "
+                            "[--slots <n>] [--frames <n>] [--frame-ms <ms>] [--sync] "
+                            "[--format rgba8|bc1|bc7] [--out <file>]\n");
+            return 1;
+        }
+    }
+
+    // Virtual texture is `size` tiles square.
+    const uint32_t width = bx::uint32_min(size * tileSize, 16384);
+
+    // Headless, bench runs on Noop renderer and measures cooking, loader and cache.
+    InitParams init = {256, 256, 1, 1, NULL};
+    init.type = RendererType::Noop;
+    TinyRender::init(init);
+
+    bx::DefaultAllocator allocator;
+
+    JobPool pool;
+    pool.create(3);
+
+    uint8_t *image = (uint8_t *)bx::alloc(&allocator, width * width * 4);
+    fillImage(image, width, width);
+
+    int64_t start = bx::getHPCounter();
+    const bool cooked = vtCook(filePath, image, uint16_t(width), uint16_t(width), uint16_t(tileSize),
+                               uint16_t(border), format->m_format, BcQuality::Fast, &pool);
+    const double cookMs = double(bx::getHPCounter() - start) * 1000.0 / double(bx::getHPFrequency());
+    bx::free(&allocator, image);
+    pool.destroy();
+
+    VirtualTexture vt;
+    if (!cooked || !vt.create(filePath, uint16_t(numSlots), uint16_t(numSlots)))
+    {
+        fprintf(stderr, "Can't cook or open %s, size must be power of two tiles.\n", filePath);
+        return 1;
+    }
+
+    // View pans diagonally across texture and zooms in and out, coarser mips when zoomed out.
+    const uint32_t numPinned = vt.getNumTilesX(vt.getNumMips() - 1) * vt.getNumTilesY(vt.getNumMips() - 1);
+    uint64_t numRequested = 0;
+    uint64_t numMissing = 0;
+    uint32_t numErrors = 0;
+    int64_t updateTime = 0;
+    start = bx::getHPCounter();
+    for (uint32_t ii = 0; ii < numFrames; ++ii)
+    {
+        const float tt = float(ii) / float(numFrames);
+        const float zoom = 0.5f + 0.5f * bx::sin(tt * bx::kPi2 * 2.0f);
+        const uint8_t mip = uint8_t(bx::min(uint32_t(zoom * 3.0f), uint32_t(vt.getNumMips() - 1)));
+        const float viewSize = float(tileSize) * (2.5f + 1.5f * zoom) * float(1 << mip);
+        const float center = float(width) * (0.5f + 0.45f * bx::sin(tt * bx::kPi2));
+
+        requestView(vt, center, float(width) - center, viewSize, mip);
+
+        const int64_t updateStart = bx::getHPCounter();
+        vt.update();
+        updateTime += bx::getHPCounter() - updateStart;
+
+        const uint32_t frameRequested = vt.getStats().numRequested;
+        const uint32_t frameMissing = vt.getStats().numMissing;
+        numRequested += frameRequested;
+        numMissing += frameMissing;
+
+        endFrame();
+
+        // Loader gets frame time to read tiles, `--sync` waits for every load instead, for results
+        // independent of disk speed.
+        if (sync)
+        {
+            vt.flush();
+        }
+        else if (0 != frameMs)
+        {
+            bx::sleep(frameMs);
+        }
+
+        // Whole view is loaded by flush when every missing tile was queued and requested tiles fit
+        // next to pinned ones.
+        const bool viewLoaded = sync && frameMissing <= BGFX_CONFIG_VT_MAX_LOADS &&
+                                frameRequested + numPinned <= numSlots * numSlots;
+        numErrors += checkCache(vt, numSlots * numSlots, center, float(width) - center, viewSize, mip, viewLoaded);
+    }
+    const double seconds = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+
+    vt.flush();
+    const VirtualTextureStats &stats = vt.getStats();
+
+    printf("{\"renderer\": \"%s\", \"format\": \"%s\", \"width\": %u, \"tile\": %u, \"border\": %u, "
+           "\"mips\": %u, \"slots\": %u, \"frames\": %u, \"sync\": %s, \"cook_ms\": %.1f, \"seconds\": %.3f, "
+           "\"update_us\": %.1f, \"requested\": %llu, \"hit_rate\": %.3f, \"loaded\": %llu, \"evicted\": %llu, "
+           "\"dropped\": %llu, \"failed\": %llu, \"resident\": %u, \"errors\": %u}\n",
+           getRendererName(getRendererType()), format->m_name, width, tileSize, border, vt.getNumMips(),
+           numSlots * numSlots, numFrames, sync ? "true" : "false", cookMs, seconds,
+           double(updateTime) * 1000000.0 / double(bx::getHPFrequency()) / double(numFrames),
+           (unsigned long long)numRequested,
+           0 != numRequested ? 1.0 - double(numMissing) / double(numRequested) : 1.0,
+           (unsigned long long)stats.numLoaded, (unsigned long long)stats.numEvicted,
+           (unsigned long long)stats.numDropped, (unsigned long long)stats.numFailed, stats.numResident, numErrors);
+
+    vt.destroy();
+    numErrors += shutdownAndCheckMemory();
+
+    return 0 == numErrors ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include <bx/timer.h>
+
+#include "capture.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <windows.h>
+
+using namespace TinyRender;
+
+// D3D12 backend needs a window to present to, it's created hidden so replay runs as fast as it can.
+// With `--noop` capture is replayed headless, which measures frontend only.
+static HWND createWindow(int _width, int _height)
+{
+    const wchar_t className[] = L"TinyRender Replay";
+
+    WNDCLASSW wc = {};
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = GetModuleHandleW(NULL);
+    wc.lpszClassName = className;
+    RegisterClassW(&wc);
+
+    return CreateWindowExW(0, className, className, WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, _width, _height,
+                           NULL, NULL, wc.hInstance, NULL);
+}
+
+int main(int _argc, const char *const *_argv)
+{
+    const bool noop = 3 == _argc && 0 == strcmp(_argv[2], "--noop");
+    if (2 != _argc && !noop)
+    {
+        fprintf(stderr, "Usage: replay <capture.trcp> [--noop]\n");
+        return 1;
+    }
+
+    // Replayer holds handle remap tables, keep it off the stack.
+    static CaptureReplay s_replay;
+
+    InitParams init = {};
+    if (!s_replay.open(_argv[1], init))
+    {
+        fprintf(stderr, "Failed to open capture '%s'.\n", _argv[1]);
+        return 1;
+    }
+
+    init.type = noop ? RendererType::Noop : RendererType::Count;
+    init.hwnd = noop ? NULL : createWindow(init.width, init.height);
+    if (!noop && NULL == init.hwnd)
+    {
+        fprintf(stderr, "Failed to create window.\n");
+        return 1;
+    }
+
+    if (!TinyRender::init(init))
+    {
+        fprintf(stderr, "Failed to initialize renderer.\n");
+        return 1;
+    }
+
+    const double toMs = 1000.0 / double(bx::getHPFrequency());
+
+    uint32_t numFrames = 0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+
+    const int64_t start = bx::getHPCounter();
+    for (int64_t frameStart = start;; ++numFrames)
+    {
+        MSG msg;
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            DispatchMessageW(&msg);
+        }
+
+        if (!s_replay.replayFrame())
+        {
+            break;
+        }
+
+        const int64_t now = bx::getHPCounter();
+        const double ms = double(now - frameStart) * toMs;
+        minMs = 0 == numFrames ? ms : bx::min(minMs, ms);
+        maxMs = bx::max(maxMs, ms);
+        frameStart = now;
+    }
+    const double totalMs = double(bx::getHPCounter() - start) * toMs;
+
+    if (s_replay.m_error)
+    {
+        fprintf(stderr, "Capture is corrupt, stopped after %u frames.\n", numFrames);
+    }
+
+    printf("{\"capture\": \"%s\", \"renderer\": \"%s\", \"frames\": %u, \"total_ms\": %.3f, \"avg_ms\": %.3f, "
+           "\"min_ms\": %.3f, \"max_ms\": %.3f}\n",
+           _argv[1], getRendererName(getRendererType()), numFrames, totalMs,
+           0 == numFrames ? 0.0 : totalMs / numFrames, minMs, maxMs);
+
+    return s_replay.m_error ? 1 : 0;
+}
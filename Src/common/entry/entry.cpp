@@ -76,6 +76,16 @@ BX_PRAGMA_DIAGNOSTIC_POP();
 		return s_fileWriter;
 	}
 
+	bx::FileReaderI* createFileReader()
+	{
+		return new FileReader();
+	}
+
+	void destroyFileReader(bx::FileReaderI* _reader)
+	{
+		delete static_cast<FileReader*>(_reader);
+	}
+
 	bx::AllocatorI*  getAllocator()
 	{
 		if (NULL == g_allocator)
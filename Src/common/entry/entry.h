@@ -18,6 +18,13 @@ namespace entry
 	///
 	bx::FileWriterI* getFileWriter();
 
+	/// Create file reader that resolves paths like `getFileReader` does. Shared reader can't be used
+	/// from several threads, each thread reading files creates its own.
+	bx::FileReaderI* createFileReader();
+
+	///
+	void destroyFileReader(bx::FileReaderI* _reader);
+
     ///
 	bx::AllocatorI*  getAllocator();
 
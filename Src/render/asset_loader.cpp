@@ -0,0 +1,835 @@
+#include <bx/file.h>
+#include <bx/timer.h>
+
+#include "asset_loader.h"
+#include "bc.h"
+#include "entry.h"
+#include "mipgen.h"
+#include "tiny_render_p.h"
+
+namespace TinyRender
+{
+
+#define TINYRENDER_MESH_MAGIC BX_MAKEFOURCC('T', 'R', 'M', 'S')
+#define TINYRENDER_MESH_VERSION 1
+
+struct MeshHeader
+{
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint32_t m_numVertices;
+    uint32_t m_numIndices;
+    uint8_t m_index32;
+    uint8_t m_reserved[3];
+    VertexLayout m_layout;
+};
+
+bool meshSave(const char *_filePath, const void *_vertices, uint32_t _numVertices, const VertexLayout &_layout,
+              const void *_indices, uint32_t _numIndices, bool _index32)
+{
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _filePath))
+    {
+        return false;
+    }
+
+    MeshHeader header;
+    bx::memSet(&header, 0, sizeof(header));
+    header.m_magic = TINYRENDER_MESH_MAGIC;
+    header.m_version = TINYRENDER_MESH_VERSION;
+    header.m_numVertices = _numVertices;
+    header.m_numIndices = _numIndices;
+    header.m_index32 = _index32 ? 1 : 0;
+    header.m_layout = _layout;
+
+    bx::Error err;
+    bx::write(writer, &header, int32_t(sizeof(header)), &err);
+    bx::write(writer, _vertices, int32_t(_layout.getSize(_numVertices)), &err);
+    if (0 != _numIndices)
+    {
+        bx::write(writer, _indices, int32_t(_numIndices * (_index32 ? 4 : 2)), &err);
+    }
+    bx::close(writer);
+
+    return err.isOk();
+}
+
+static const uint32_t kTgaHeaderSize = 18;
+
+/// Decode 24 or 32 bit, raw or RLE compressed TGA to RGBA8, top row first.
+static bool decodeTga(uint8_t *_dst, const uint8_t *_src, uint32_t _size, uint16_t _width, uint16_t _height)
+{
+    const uint8_t type = _src[2];
+    const uint32_t bytesPerPixel = _src[16] / 8;
+    const bool topLeft = 0 != (_src[17] & 0x20);
+
+    const uint8_t *src = _src + kTgaHeaderSize + _src[0];
+    const uint8_t *end = _src + _size;
+
+    const uint32_t numPixels = uint32_t(_width) * _height;
+    uint32_t pixel = 0;
+    while (pixel < numPixels)
+    {
+        // Raw image is one long raw packet.
+        uint32_t count = numPixels - pixel;
+        bool run = false;
+        if (10 == type)
+        {
+            if (src >= end)
+            {
+                return false;
+            }
+            run = 0 != (*src & 0x80);
+            count = bx::min<uint32_t>((*src & 0x7f) + 1, numPixels - pixel);
+            ++src;
+        }
+
+        if (src + (run ? 1 : count) * bytesPerPixel > end)
+        {
+            return false;
+        }
+
+        for (uint32_t ii = 0; ii < count; ++ii, ++pixel)
+        {
+            const uint32_t xx = pixel % _width;
+            const uint32_t yy = topLeft ? pixel / _width : _height - 1 - pixel / _width;
+            uint8_t *dst = &_dst[(yy * _width + xx) * 4];
+
+            // TGA stores BGRA.
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = 4 == bytesPerPixel ? src[3] : 255;
+
+            src += run ? 0 : bytesPerPixel;
+        }
+
+        src += run ? bytesPerPixel : 0;
+    }
+
+    return true;
+}
+
+AssetLoader::AssetLoader() : m_request(NULL), m_numWorkers(0), m_quit(false), m_numDecoded(0), m_numLoading(0)
+{
+    bx::memSet(m_numQueued, 0, sizeof(m_numQueued));
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+}
+
+AssetLoader::~AssetLoader()
+{
+    destroy();
+}
+
+bool AssetLoader::create(uint32_t _numThreads)
+{
+    BX_ASSERT(NULL == m_request, "Asset loader already created.");
+
+    if (0 == _numThreads || _numThreads > BGFX_CONFIG_ASSET_MAX_IO_THREADS)
+    {
+        return false;
+    }
+
+    m_request = (Request *)bx::alloc(getAllocator(MemoryCategory::Command),
+                                     BGFX_CONFIG_ASSET_MAX_REQUESTS * sizeof(Request));
+    m_handle.reset();
+    bx::memSet(m_numQueued, 0, sizeof(m_numQueued));
+    m_numDecoded = 0;
+    m_numLoading = 0;
+    m_quit = false;
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+
+    for (m_numWorkers = 0; m_numWorkers < _numThreads; ++m_numWorkers)
+    {
+        Worker &worker = m_worker[m_numWorkers];
+        worker.m_loader = this;
+        worker.m_reader = entry::createFileReader();
+        if (!worker.m_thread.init(workerFunc, &worker, 0, "TinyRender asset I/O"))
+        {
+            entry::destroyFileReader(worker.m_reader);
+            destroy();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void AssetLoader::destroy()
+{
+    if (NULL == m_request)
+    {
+        return;
+    }
+
+    {
+        bx::MutexScope lock(m_mutex);
+        m_quit = true;
+    }
+
+    for (uint32_t ii = 0; ii < m_numWorkers; ++ii)
+    {
+        m_queued.post();
+    }
+
+    for (uint32_t ii = 0; ii < m_numWorkers; ++ii)
+    {
+        m_worker[ii].m_thread.shutdown();
+        entry::destroyFileReader(m_worker[ii].m_reader);
+    }
+    m_numWorkers = 0;
+
+    // I/O threads are gone, requests they released are freed already.
+    while (0 != m_handle.getNumHandles())
+    {
+        const uint16_t idx = m_handle.getHandleAt(0);
+        freeData(m_request[idx]);
+        m_handle.free(idx);
+    }
+
+    bx::free(getAllocator(MemoryCategory::Command), m_request);
+    m_request = NULL;
+}
+
+AssetHandle AssetLoader::loadShader(const char *_filePath, ShaderType _type, AssetPriority::Enum _priority,
+                                    AssetFn _fn, void *_userData)
+{
+    const AssetHandle handle = load(_filePath, AssetType::Shader, _priority, _fn, _userData);
+    if (isValid(handle))
+    {
+        m_request[handle.idx].m_shaderType = _type;
+        m_queued.post();
+    }
+
+    return handle;
+}
+
+AssetHandle AssetLoader::loadTexture(const char *_filePath, bool _hasMips, TextureFormat::Enum _format,
+                                     AssetPriority::Enum _priority, AssetFn _fn, void *_userData)
+{
+    if (TextureFormat::RGBA8 != _format && TextureFormat::SRGBA8 != _format && !bcIsSupported(_format))
+    {
+        AssetHandle handle = BGFX_INVALID_HANDLE;
+        return handle;
+    }
+
+    const AssetHandle handle = load(_filePath, AssetType::Texture, _priority, _fn, _userData);
+    if (isValid(handle))
+    {
+        m_request[handle.idx].m_hasMips = _hasMips;
+        m_request[handle.idx].m_format = _format;
+        m_queued.post();
+    }
+
+    return handle;
+}
+
+AssetHandle AssetLoader::loadMesh(const char *_filePath, AssetPriority::Enum _priority, AssetFn _fn,
+                                  void *_userData)
+{
+    const AssetHandle handle = load(_filePath, AssetType::Mesh, _priority, _fn, _userData);
+    if (isValid(handle))
+    {
+        m_queued.post();
+    }
+
+    return handle;
+}
+
+void AssetLoader::setPriority(AssetHandle _handle, AssetPriority::Enum _priority)
+{
+    bx::MutexScope lock(m_mutex);
+
+    if (!isValid(_handle) || !m_handle.isValid(_handle.idx))
+    {
+        BX_TRACE("WARNING: Priority of invalid asset %d can't be set.", _handle.idx);
+        return;
+    }
+
+    Request &request = m_request[_handle.idx];
+    if (AssetState::Queued == request.m_state && _priority != request.m_priority)
+    {
+        removeQueued(_handle.idx);
+        request.m_priority = _priority;
+        m_queue[_priority][m_numQueued[_priority]++] = _handle.idx;
+    }
+    else
+    {
+        request.m_priority = _priority;
+    }
+}
+
+bool AssetLoader::cancel(AssetHandle _handle)
+{
+    bx::MutexScope lock(m_mutex);
+
+    if (!isValid(_handle) || !m_handle.isValid(_handle.idx))
+    {
+        BX_TRACE("WARNING: Invalid asset %d can't be canceled.", _handle.idx);
+        return false;
+    }
+
+    Request &request = m_request[_handle.idx];
+    switch (request.m_state)
+    {
+    case AssetState::Queued:
+        removeQueued(_handle.idx);
+        break;
+
+    case AssetState::Loading:
+        request.m_canceled = true;
+        return true;
+
+    case AssetState::Decoded:
+        removeDecoded(_handle.idx);
+        freeData(request);
+        break;
+
+    case AssetState::Canceled:
+        return true;
+
+    default:
+        return false;
+    }
+
+    request.m_state = AssetState::Canceled;
+    ++m_stats.numCanceled;
+
+    return true;
+}
+
+void AssetLoader::free(AssetHandle _handle)
+{
+    if (!isValid(_handle))
+    {
+        return;
+    }
+
+    cancel(_handle);
+
+    bx::MutexScope lock(m_mutex);
+
+    // Released handle was already traced by cancel.
+    if (!m_handle.isValid(_handle.idx))
+    {
+        return;
+    }
+
+    // Failed requests wait in decoded list for their callback.
+    Request &request = m_request[_handle.idx];
+    if (AssetState::Loading == request.m_state)
+    {
+        request.m_released = true;
+        return;
+    }
+
+    if (AssetState::Failed == request.m_state)
+    {
+        removeDecoded(_handle.idx);
+    }
+
+    freeData(request);
+    m_handle.free(_handle.idx);
+}
+
+uint32_t AssetLoader::update(uint32_t _maxSize)
+{
+    BGFX_PROFILER_SCOPE("AssetLoader::update");
+
+    // Pick batch under lock, create resources without it so I/O threads keep going.
+    uint16_t batch[BGFX_CONFIG_ASSET_MAX_REQUESTS];
+    uint32_t numBatch = 0;
+    {
+        bx::MutexScope lock(m_mutex);
+
+        uint32_t size = 0;
+        for (int32_t priority = AssetPriority::Count - 1; priority >= 0; --priority)
+        {
+            for (uint32_t ii = 0; ii < m_numDecoded && (0 == numBatch || size < _maxSize);)
+            {
+                const uint16_t idx = m_decoded[ii];
+                if (priority != m_request[idx].m_priority)
+                {
+                    ++ii;
+                    continue;
+                }
+
+                size += m_request[idx].m_size;
+                m_request[idx].m_batched = true;
+                batch[numBatch++] = idx;
+                bx::memMove(&m_decoded[ii], &m_decoded[ii + 1], (m_numDecoded - ii - 1) * sizeof(uint16_t));
+                --m_numDecoded;
+            }
+        }
+    }
+
+    uint32_t num = 0;
+    for (uint32_t ii = 0; ii < numBatch; ++ii)
+    {
+        const AssetHandle handle = {batch[ii]};
+        Request &request = m_request[handle.idx];
+
+        // Callback of earlier asset in batch may have canceled or freed this one, its handle may
+        // even be reused by new request already.
+        AssetState::Enum state;
+        {
+            bx::MutexScope lock(m_mutex);
+            const bool batched = m_handle.isValid(handle.idx) && request.m_batched;
+            request.m_batched = false;
+            state = request.m_state;
+            if (!batched || (AssetState::Decoded != state && AssetState::Failed != state))
+            {
+                continue;
+            }
+        }
+
+        if (AssetState::Decoded == state)
+        {
+            const int64_t start = bx::getHPCounter();
+            const bool ok = createResources(request);
+            m_stats.createTime += bx::getHPCounter() - start;
+
+            bx::MutexScope lock(m_mutex);
+            freeData(request);
+            request.m_state = ok ? AssetState::Ready : AssetState::Failed;
+            ++(ok ? m_stats.numReady : m_stats.numFailed);
+        }
+
+        ++num;
+        if (NULL != request.m_fn)
+        {
+            request.m_fn(handle, request.m_state, request.m_userData);
+        }
+    }
+
+    return num;
+}
+
+AssetState::Enum AssetLoader::getState(AssetHandle _handle) const
+{
+    if (!isValid(_handle))
+    {
+        return AssetState::Invalid;
+    }
+
+    // I/O threads free handles of requests released while loading.
+    bx::MutexScope lock(m_mutex);
+    return m_handle.isValid(_handle.idx) ? m_request[_handle.idx].m_state : AssetState::Invalid;
+}
+
+ShaderHandle AssetLoader::getShader(AssetHandle _handle) const
+{
+    BX_ASSERT(AssetState::Ready == getState(_handle), "Asset isn't ready.");
+    return m_request[_handle.idx].m_shader;
+}
+
+TextureHandle AssetLoader::getTexture(AssetHandle _handle) const
+{
+    BX_ASSERT(AssetState::Ready == getState(_handle), "Asset isn't ready.");
+    return m_request[_handle.idx].m_texture;
+}
+
+VertexBufferHandle AssetLoader::getVertexBuffer(AssetHandle _handle) const
+{
+    BX_ASSERT(AssetState::Ready == getState(_handle), "Asset isn't ready.");
+    return m_request[_handle.idx].m_vertexBuffer;
+}
+
+IndexBufferHandle AssetLoader::getIndexBuffer(AssetHandle _handle) const
+{
+    BX_ASSERT(AssetState::Ready == getState(_handle), "Asset isn't ready.");
+    return m_request[_handle.idx].m_indexBuffer;
+}
+
+uint32_t AssetLoader::getNumPending() const
+{
+    bx::MutexScope lock(m_mutex);
+
+    uint32_t num = m_numDecoded + m_numLoading;
+    for (uint32_t ii = 0; ii < AssetPriority::Count; ++ii)
+    {
+        num += m_numQueued[ii];
+    }
+
+    return num;
+}
+
+const AssetLoaderStats &AssetLoader::getStats()
+{
+    bx::MutexScope lock(m_mutex);
+
+    m_stats.numQueued = 0;
+    for (uint32_t ii = 0; ii < AssetPriority::Count; ++ii)
+    {
+        m_stats.numQueued += m_numQueued[ii];
+    }
+    m_stats.numLoading = m_numLoading;
+    m_stats.numDecoded = m_numDecoded;
+
+    return m_stats;
+}
+
+int32_t AssetLoader::workerFunc(bx::Thread *_self, void *_userData)
+{
+    BX_UNUSED(_self);
+    Worker &worker = *(Worker *)_userData;
+    AssetLoader &loader = *worker.m_loader;
+
+    for (;;)
+    {
+        loader.m_queued.wait();
+
+        uint16_t idx = kInvalidHandle;
+        {
+            bx::MutexScope lock(loader.m_mutex);
+            if (loader.m_quit)
+            {
+                break;
+            }
+
+            // Canceled requests leave their post behind, queue can be empty.
+            for (int32_t priority = AssetPriority::Count - 1; priority >= 0 && kInvalidHandle == idx; --priority)
+            {
+                if (0 != loader.m_numQueued[priority])
+                {
+                    idx = loader.m_queue[priority][0];
+                    loader.removeQueued(idx);
+                }
+            }
+
+            if (kInvalidHandle == idx)
+            {
+                continue;
+            }
+
+            loader.m_request[idx].m_state = AssetState::Loading;
+            ++loader.m_numLoading;
+        }
+
+        Request &request = loader.m_request[idx];
+
+        int64_t start = bx::getHPCounter();
+        bool ok = loader.readFile(worker, request);
+        const int64_t readTime = bx::getHPCounter() - start;
+
+        bool canceled;
+        {
+            bx::MutexScope lock(loader.m_mutex);
+            canceled = request.m_canceled;
+        }
+
+        start = bx::getHPCounter();
+        ok = ok && !canceled && loader.decode(request);
+        const int64_t decodeTime = bx::getHPCounter() - start;
+
+        bx::MutexScope lock(loader.m_mutex);
+        --loader.m_numLoading;
+        loader.m_stats.readTime += readTime;
+        loader.m_stats.decodeTime += decodeTime;
+
+        if (request.m_released)
+        {
+            loader.freeData(request);
+            loader.m_handle.free(idx);
+            ++loader.m_stats.numCanceled;
+        }
+        else if (request.m_canceled)
+        {
+            loader.freeData(request);
+            request.m_state = AssetState::Canceled;
+            ++loader.m_stats.numCanceled;
+        }
+        else
+        {
+            if (!ok)
+            {
+                loader.freeData(request);
+                ++loader.m_stats.numFailed;
+            }
+            request.m_state = ok ? AssetState::Decoded : AssetState::Failed;
+            loader.m_decoded[loader.m_numDecoded++] = idx;
+        }
+    }
+
+    return 0;
+}
+
+AssetHandle AssetLoader::load(const char *_filePath, AssetType::Enum _type, AssetPriority::Enum _priority,
+                              AssetFn _fn, void *_userData)
+{
+    BX_ASSERT(NULL != m_request, "Asset loader is not created.");
+
+    AssetHandle handle = BGFX_INVALID_HANDLE;
+
+    const uint32_t len = bx::strLen(_filePath);
+    if (len >= BGFX_CONFIG_ASSET_MAX_PATH)
+    {
+        BX_TRACE("WARNING: Asset path %s is too long.", _filePath);
+        return handle;
+    }
+
+    bx::MutexScope lock(m_mutex);
+
+    handle.idx = m_handle.alloc();
+    if (!isValid(handle))
+    {
+        return handle;
+    }
+
+    Request &request = m_request[handle.idx];
+    bx::memCopy(request.m_filePath, _filePath, len + 1);
+    request.m_type = _type;
+    request.m_priority = _priority;
+    request.m_state = AssetState::Queued;
+    request.m_fn = _fn;
+    request.m_userData = _userData;
+    request.m_canceled = false;
+    request.m_released = false;
+    request.m_batched = false;
+    request.m_shaderType = ShaderType_Vertex;
+    request.m_format = TextureFormat::RGBA8;
+    request.m_hasMips = false;
+    request.m_data = NULL;
+    request.m_size = 0;
+    request.m_shader.idx = kInvalidHandle;
+    request.m_texture.idx = kInvalidHandle;
+    request.m_vertexBuffer.idx = kInvalidHandle;
+    request.m_indexBuffer.idx = kInvalidHandle;
+
+    m_queue[_priority][m_numQueued[_priority]++] = handle.idx;
+
+    return handle;
+}
+
+bool AssetLoader::readFile(Worker &_worker, Request &_request)
+{
+    BGFX_PROFILER_SCOPE("AssetLoader::readFile");
+
+    bx::FileReaderI *reader = _worker.m_reader;
+    if (!bx::open(reader, _request.m_filePath))
+    {
+        BX_TRACE("WARNING: Can't open asset %s.", _request.m_filePath);
+        return false;
+    }
+
+    const int64_t size = bx::getSize(reader);
+    if (0 >= size || INT32_MAX < size)
+    {
+        bx::close(reader);
+        return false;
+    }
+
+    _request.m_size = uint32_t(size);
+    _request.m_data = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Staging), _request.m_size);
+
+    bx::Error err;
+    const int32_t num = bx::read(reader, _request.m_data, int32_t(_request.m_size), &err);
+    bx::close(reader);
+
+    {
+        bx::MutexScope lock(m_mutex);
+        m_stats.bytesRead += uint64_t(bx::max(num, 0));
+    }
+
+    return err.isOk() && uint32_t(num) == _request.m_size;
+}
+
+bool AssetLoader::decode(Request &_request)
+{
+    BGFX_PROFILER_SCOPE("AssetLoader::decode");
+
+    switch (_request.m_type)
+    {
+    case AssetType::Shader:
+        return decodeShader(_request);
+
+    case AssetType::Texture:
+        return decodeTexture(_request);
+
+    case AssetType::Mesh:
+        return decodeMesh(_request);
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool AssetLoader::decodeShader(Request &_request)
+{
+    // Compiling on API thread would stall frame, `createShader` takes bytecode as it is.
+    uint32_t size = 0;
+    uint8_t *code = compileShader(_request.m_data, _request.m_size, _request.m_shaderType, size);
+    if (NULL == code)
+    {
+        BX_TRACE("WARNING: Asset %s doesn't compile.", _request.m_filePath);
+        return false;
+    }
+
+    bx::free(getAllocator(MemoryCategory::Staging), _request.m_data);
+    _request.m_data = code;
+    _request.m_size = size;
+
+    return true;
+}
+
+bool AssetLoader::decodeTexture(Request &_request)
+{
+    const uint8_t *src = _request.m_data;
+    if (_request.m_size < kTgaHeaderSize || (2 != src[2] && 10 != src[2]) || (24 != src[16] && 32 != src[16]) ||
+        0 != src[1])
+    {
+        BX_TRACE("WARNING: Asset %s isn't 24 or 32 bit TGA.", _request.m_filePath);
+        return false;
+    }
+
+    const uint16_t width = uint16_t(src[12] | (src[13] << 8));
+    const uint16_t height = uint16_t(src[14] | (src[15] << 8));
+    const uint32_t blockSize = getBlockSize(_request.m_format);
+    if (0 == width || 0 == height || 0 != width % blockSize || 0 != height % blockSize)
+    {
+        return false;
+    }
+
+    // Block compressed textures are encoded from RGBA8 chain.
+    const TextureFormat::Enum format =
+        TextureFormat::SRGBA8 == _request.m_format ? TextureFormat::SRGBA8 : TextureFormat::RGBA8;
+
+    TextureInfo info;
+    calcTextureSize(info, width, height, false, _request.m_hasMips, format);
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+    uint8_t *data = (uint8_t *)bx::alloc(allocator, info.storageSize);
+    if (!decodeTga(data, src, _request.m_size, width, height))
+    {
+        bx::free(allocator, data);
+        return false;
+    }
+
+    if (_request.m_hasMips)
+    {
+        mipGenerate(data, info, MipFilter::Box, NULL, allocator);
+    }
+
+    if (format != _request.m_format)
+    {
+        TextureInfo bcInfo;
+        calcTextureSize(bcInfo, width, height, false, _request.m_hasMips, _request.m_format);
+
+        uint8_t *blocks = (uint8_t *)bx::alloc(allocator, bcInfo.storageSize);
+        bcEncodeTexture(blocks, _request.m_format, data, info, BcQuality::Normal, NULL);
+        bx::free(allocator, data);
+
+        data = blocks;
+        info = bcInfo;
+    }
+
+    bx::free(allocator, _request.m_data);
+    _request.m_data = data;
+    _request.m_size = info.storageSize;
+    _request.m_width = width;
+    _request.m_height = height;
+
+    return true;
+}
+
+bool AssetLoader::decodeMesh(Request &_request)
+{
+    MeshHeader header;
+    if (_request.m_size < sizeof(header))
+    {
+        return false;
+    }
+    bx::memCopy(&header, _request.m_data, sizeof(header));
+
+    const uint32_t indexSize = header.m_index32 ? 4 : 2;
+    const uint64_t vertexBytes = uint64_t(header.m_numVertices) * header.m_layout.m_stride;
+    const uint64_t size = sizeof(header) + vertexBytes + uint64_t(header.m_numIndices) * indexSize;
+    if (TINYRENDER_MESH_MAGIC != header.m_magic || TINYRENDER_MESH_VERSION != header.m_version ||
+        0 == header.m_layout.m_stride || 0 == header.m_numVertices || size != _request.m_size)
+    {
+        BX_TRACE("WARNING: Asset %s isn't valid mesh.", _request.m_filePath);
+        return false;
+    }
+
+    // Vertices and indices are used in place.
+    _request.m_layout = header.m_layout;
+    _request.m_dataOffset = sizeof(header);
+    _request.m_indexOffset = uint32_t(sizeof(header) + vertexBytes);
+    _request.m_numIndices = header.m_numIndices;
+    _request.m_index32 = 0 != header.m_index32;
+
+    return true;
+}
+
+bool AssetLoader::createResources(Request &_request)
+{
+    switch (_request.m_type)
+    {
+    case AssetType::Shader:
+        _request.m_shader = createShader(_request.m_data, _request.m_size, _request.m_shaderType);
+        return isValid(_request.m_shader);
+
+    case AssetType::Texture:
+        _request.m_texture = createTexture2D(_request.m_width, _request.m_height, _request.m_hasMips,
+                                             _request.m_format, _request.m_data, _request.m_size);
+        return isValid(_request.m_texture);
+
+    case AssetType::Mesh:
+        _request.m_vertexBuffer = createVertexBuffer(&_request.m_data[_request.m_dataOffset],
+                                                     _request.m_indexOffset - _request.m_dataOffset, _request.m_layout);
+        if (0 != _request.m_numIndices)
+        {
+            _request.m_indexBuffer = createIndexBuffer(&_request.m_data[_request.m_indexOffset],
+                                                       _request.m_size - _request.m_indexOffset,
+                                                       _request.m_index32 ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+            return isValid(_request.m_vertexBuffer) && isValid(_request.m_indexBuffer);
+        }
+        return isValid(_request.m_vertexBuffer);
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+void AssetLoader::removeQueued(uint16_t _idx)
+{
+    const AssetPriority::Enum priority = m_request[_idx].m_priority;
+    uint16_t *queue = m_queue[priority];
+    for (uint32_t ii = 0; ii < m_numQueued[priority]; ++ii)
+    {
+        if (_idx == queue[ii])
+        {
+            bx::memMove(&queue[ii], &queue[ii + 1], (m_numQueued[priority] - ii - 1) * sizeof(uint16_t));
+            --m_numQueued[priority];
+            return;
+        }
+    }
+}
+
+void AssetLoader::removeDecoded(uint16_t _idx)
+{
+    for (uint32_t ii = 0; ii < m_numDecoded; ++ii)
+    {
+        if (_idx == m_decoded[ii])
+        {
+            bx::memMove(&m_decoded[ii], &m_decoded[ii + 1], (m_numDecoded - ii - 1) * sizeof(uint16_t));
+            --m_numDecoded;
+            return;
+        }
+    }
+}
+
+void AssetLoader::freeData(Request &_request)
+{
+    if (NULL != _request.m_data)
+    {
+        bx::free(getAllocator(MemoryCategory::Staging), _request.m_data);
+        _request.m_data = NULL;
+    }
+}
+
+} // namespace TinyRender
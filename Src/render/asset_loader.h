@@ -0,0 +1,262 @@
+#pragma once
+
+#include <bx/handlealloc.h>
+#include <bx/mutex.h>
+#include <bx/semaphore.h>
+#include <bx/thread.h>
+
+#include "defines.h"
+#include "tiny_render.h"
+
+namespace bx { struct FileReaderI; }
+
+namespace TinyRender
+{
+
+BGFX_HANDLE(AssetHandle)
+
+/// Asset kinds `AssetLoader` reads.
+struct AssetType
+{
+    enum Enum
+    {
+        Shader,  //!< Shader source, compiled to bytecode on I/O thread.
+        Texture, //!< TGA image, 24 or 32 bits, raw or RLE.
+        Mesh,    //!< Mesh written by `meshSave`.
+
+        Count
+    };
+};
+
+/// Load priority, higher priority requests are read and created first.
+struct AssetPriority
+{
+    enum Enum
+    {
+        Low,
+        Normal,
+        High,
+
+        Count
+    };
+};
+
+/// Asset request state.
+struct AssetState
+{
+    enum Enum
+    {
+        Invalid,  //!< Handle isn't live.
+        Queued,   //!< Waiting for I/O thread.
+        Loading,  //!< Being read and decoded on I/O thread.
+        Decoded,  //!< Waiting for `AssetLoader::update` to create it.
+        Ready,    //!< Resources created.
+        Failed,   //!< File couldn't be read, decoded or created.
+        Canceled, //!< Canceled before it was created.
+
+        Count
+    };
+};
+
+/// Called from `AssetLoader::update` when asset becomes ready or fails.
+typedef void (*AssetFn)(AssetHandle _handle, AssetState::Enum _state, void *_userData);
+
+/// Asset loader statistics, totals since `AssetLoader::create` unless noted.
+struct AssetLoaderStats
+{
+    uint32_t numQueued;   //!< Requests waiting for I/O thread now.
+    uint32_t numLoading;  //!< Requests on I/O threads now.
+    uint32_t numDecoded;  //!< Requests waiting for `update` now.
+    uint64_t numReady;    //!< Assets created.
+    uint64_t numFailed;   //!< Requests that failed.
+    uint64_t numCanceled; //!< Requests canceled.
+    uint64_t bytesRead;   //!< File bytes read.
+    int64_t readTime;     //!< Time I/O threads spent reading, summed over threads, in `bx::getHPCounter` ticks.
+    int64_t decodeTime;   //!< Time I/O threads spent decoding.
+    int64_t createTime;   //!< Time `update` spent creating resources.
+};
+
+/// Write mesh file `AssetLoader::loadMesh` reads, through `entry::getFileWriter`. File is header with
+/// vertex layout, then vertices, then indices.
+///
+/// @param[in] _index32 Indices are 32-bit.
+///
+/// @returns False when file can't be written.
+///
+bool meshSave(const char *_filePath, const void *_vertices, uint32_t _numVertices, const VertexLayout &_layout,
+              const void *_indices, uint32_t _numIndices, bool _index32);
+
+/// Loads shaders, textures and meshes asynchronously.
+///
+/// Files are read and decoded on I/O threads, each with its own `entry::createFileReader` reader,
+/// highest priority first, in request order within priority. Textures are converted to RGBA8, get
+/// their mips generated and are block compressed there too. Decoded assets wait until `update`,
+/// which creates their resources on API thread, several per call, within byte budget. Everything
+/// except I/O threads must be called from API thread.
+///
+/// Created resources belong to caller, who destroys them with `TinyRender::destroy`. `free` and
+/// `destroy` release requests, not resources.
+///
+struct AssetLoader
+{
+    AssetLoader();
+    ~AssetLoader();
+
+    /// Start I/O threads.
+    ///
+    /// @param[in] _numThreads I/O threads, up to `BGFX_CONFIG_ASSET_MAX_IO_THREADS`. Several threads
+    ///   keep decoding going while others wait on disk.
+    ///
+    bool create(uint32_t _numThreads = BGFX_CONFIG_ASSET_IO_THREADS);
+
+    /// Cancel pending requests, wait for I/O threads and free all requests.
+    void destroy();
+
+    /// Queue shader load.
+    ///
+    /// @returns Invalid handle when all `BGFX_CONFIG_ASSET_MAX_REQUESTS` requests are in use or path
+    ///   is too long.
+    ///
+    AssetHandle loadShader(const char *_filePath, ShaderType _type,
+                           AssetPriority::Enum _priority = AssetPriority::Normal, AssetFn _fn = NULL,
+                           void *_userData = NULL);
+
+    /// Queue texture load. See `loadShader`.
+    ///
+    /// @param[in] _hasMips Generate full mip chain.
+    /// @param[in] _format `TextureFormat::RGBA8`, `TextureFormat::SRGBA8` or block compressed format
+    ///   `bcEncode` supports, image size must then be multiple of 4.
+    ///
+    AssetHandle loadTexture(const char *_filePath, bool _hasMips, TextureFormat::Enum _format = TextureFormat::RGBA8,
+                            AssetPriority::Enum _priority = AssetPriority::Normal, AssetFn _fn = NULL,
+                            void *_userData = NULL);
+
+    /// Queue mesh load. See `loadShader`.
+    AssetHandle loadMesh(const char *_filePath, AssetPriority::Enum _priority = AssetPriority::Normal,
+                         AssetFn _fn = NULL, void *_userData = NULL);
+
+    /// Change priority of queued request. Requests already being loaded aren't affected, invalid or
+    /// released handles are ignored.
+    void setPriority(AssetHandle _handle, AssetPriority::Enum _priority);
+
+    /// Cancel request that isn't created yet. Request being read is dropped when its I/O thread
+    /// finishes.
+    ///
+    /// @returns False when request is already ready or failed, or handle is invalid or released.
+    ///
+    bool cancel(AssetHandle _handle);
+
+    /// Release request handle. Pending request is canceled first, invalid or released handles are ignored.
+    void free(AssetHandle _handle);
+
+    /// Create decoded assets, highest priority first, and call their callbacks. Call once per frame.
+    ///
+    /// @param[in] _maxSize Data size created in one call, at least one asset is created when any is
+    ///   decoded.
+    ///
+    /// @returns Number of assets created or failed.
+    ///
+    uint32_t update(uint32_t _maxSize = BGFX_CONFIG_ASSET_MAX_CREATE_SIZE);
+
+    AssetState::Enum getState(AssetHandle _handle) const;
+
+    /// Returns shader of ready shader asset.
+    ShaderHandle getShader(AssetHandle _handle) const;
+
+    /// Returns texture of ready texture asset.
+    TextureHandle getTexture(AssetHandle _handle) const;
+
+    /// Returns vertex buffer of ready mesh asset.
+    VertexBufferHandle getVertexBuffer(AssetHandle _handle) const;
+
+    /// Returns index buffer of ready mesh asset, invalid for mesh without indices.
+    IndexBufferHandle getIndexBuffer(AssetHandle _handle) const;
+
+    /// Returns number of requests queued, loading or decoded.
+    uint32_t getNumPending() const;
+
+    /// Returns statistics, counters of requests in flight are current at the time of call.
+    const AssetLoaderStats &getStats();
+
+  private:
+    struct Request
+    {
+        char m_filePath[BGFX_CONFIG_ASSET_MAX_PATH];
+        AssetType::Enum m_type;
+        AssetPriority::Enum m_priority;
+        AssetState::Enum m_state;
+        AssetFn m_fn;
+        void *m_userData;
+        bool m_canceled; //!< Canceled while loading.
+        bool m_released; //!< Freed while loading.
+        bool m_batched;  //!< Taken from decoded list by `update`, not created yet.
+
+        ShaderType m_shaderType;
+        TextureFormat::Enum m_format;
+        bool m_hasMips;
+
+        uint8_t *m_data; //!< File contents, or decoded texture.
+        uint32_t m_size;
+        uint32_t m_dataOffset; //!< Start of vertices, or texture data.
+        uint32_t m_indexOffset;
+        uint32_t m_numIndices;
+        bool m_index32;
+        uint16_t m_width;
+        uint16_t m_height;
+        VertexLayout m_layout;
+
+        ShaderHandle m_shader;
+        TextureHandle m_texture;
+        VertexBufferHandle m_vertexBuffer;
+        IndexBufferHandle m_indexBuffer;
+    };
+
+    struct Worker
+    {
+        AssetLoader *m_loader;
+        bx::FileReaderI *m_reader;
+        bx::Thread m_thread;
+    };
+
+    static int32_t workerFunc(bx::Thread *_self, void *_userData);
+
+    AssetHandle load(const char *_filePath, AssetType::Enum _type, AssetPriority::Enum _priority, AssetFn _fn,
+                     void *_userData);
+
+    bool readFile(Worker &_worker, Request &_request);
+
+    bool decode(Request &_request);
+
+    bool decodeShader(Request &_request);
+
+    bool decodeTexture(Request &_request);
+
+    bool decodeMesh(Request &_request);
+
+    bool createResources(Request &_request);
+
+    void removeQueued(uint16_t _idx);
+
+    void removeDecoded(uint16_t _idx);
+
+    void freeData(Request &_request);
+
+    bx::HandleAllocT<BGFX_CONFIG_ASSET_MAX_REQUESTS> m_handle;
+    Request *m_request;
+    Worker m_worker[BGFX_CONFIG_ASSET_MAX_IO_THREADS];
+    uint32_t m_numWorkers;
+    bool m_quit;
+
+    mutable bx::Mutex m_mutex; //!< Guards everything I/O threads touch.
+    bx::Semaphore m_queued;    //!< Posted for each queued request, and for each worker on quit.
+
+    uint16_t m_queue[AssetPriority::Count][BGFX_CONFIG_ASSET_MAX_REQUESTS]; //!< Queued requests per priority.
+    uint16_t m_numQueued[AssetPriority::Count];
+    uint16_t m_decoded[BGFX_CONFIG_ASSET_MAX_REQUESTS]; //!< Decoded and failed requests, in finish order.
+    uint16_t m_numDecoded;
+    uint16_t m_numLoading;
+
+    AssetLoaderStats m_stats;
+};
+
+} // namespace TinyRender
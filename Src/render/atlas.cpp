@@ -0,0 +1,665 @@
+#include <bx/sort.h>
+#include <bx/uint32_t.h>
+
+#include "atlas.h"
+#include "mipgen.h"
+#include "tiny_render_p.h"
+
+namespace TinyRender
+{
+
+Atlas::Atlas()
+    : m_entry(NULL), m_scratch(NULL), m_pageBytes(0), m_numPages(0), m_maxPages(0), m_pageSize(0), m_padding(0),
+      m_align(1), m_numMips(1), m_format(TextureFormat::Count)
+{
+    bx::memSet(m_page, 0, sizeof(m_page));
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+}
+
+Atlas::~Atlas()
+{
+    destroy();
+}
+
+bool Atlas::create(uint16_t _pageSize, uint8_t _numMips, uint16_t _padding, TextureFormat::Enum _format,
+                   uint16_t _maxPages)
+{
+    BX_ASSERT(NULL == m_entry, "Atlas already created.");
+
+    if (!bx::isPowerOf2(_pageSize) || _pageSize > 16384 || 0 == _numMips ||
+        _numMips > calcNumMips(true, _pageSize, _pageSize) ||
+        (TextureFormat::RGBA8 != _format && TextureFormat::SRGBA8 != _format) || 0 == _maxPages ||
+        _maxPages > BGFX_CONFIG_ATLAS_MAX_PAGES || 2 * uint32_t(_padding) >= _pageSize)
+    {
+        BX_TRACE("WARNING: Invalid atlas page size %d, %d mips, padding %d, format %d, %d pages.", _pageSize,
+                 _numMips, _padding, _format, _maxPages);
+        return false;
+    }
+
+    TextureInfo info;
+    calcTextureSize(info, _pageSize, _pageSize, false, true, _format);
+
+    m_pageBytes = info.storageSize;
+    m_pageSize = _pageSize;
+    m_numMips = _numMips;
+    m_padding = _padding;
+    m_align = uint16_t(1 << (_numMips - 1));
+    m_format = _format;
+    m_maxPages = _maxPages;
+    m_numPages = 0;
+
+    // Every node is at least one alignment unit wide, one more while new node is merged in.
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Command);
+    m_entry = (Entry *)bx::alloc(allocator, BGFX_CONFIG_ATLAS_MAX_REGIONS * sizeof(Entry));
+    m_scratch = (SkylineNode *)bx::alloc(allocator, (m_pageSize / m_align + 1) * sizeof(SkylineNode));
+    m_regionHandle.reset();
+
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+
+    return true;
+}
+
+void Atlas::destroy()
+{
+    if (NULL == m_entry)
+    {
+        return;
+    }
+
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        Page &page = m_page[ii];
+        TinyRender::destroy(page.m_texture);
+        bx::free(getAllocator(MemoryCategory::Texture), page.m_data);
+        bx::free(getAllocator(MemoryCategory::Command), page.m_skyline);
+        bx::free(getAllocator(MemoryCategory::Command), page.m_free);
+    }
+    bx::memSet(m_page, 0, sizeof(m_page));
+    m_numPages = 0;
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Command);
+    bx::free(allocator, m_scratch);
+    bx::free(allocator, m_entry);
+    m_scratch = NULL;
+    m_entry = NULL;
+    m_regionHandle.reset();
+}
+
+AtlasRegionHandle Atlas::add(const void *_data, uint16_t _width, uint16_t _height, uint32_t _pitch)
+{
+    BGFX_PROFILER_SCOPE("Atlas::add");
+
+    AtlasRegionHandle handle = BGFX_INVALID_HANDLE;
+
+    const uint32_t width = calcAllocSize(_width);
+    const uint32_t height = calcAllocSize(_height);
+    if (0 == _width || 0 == _height || width > m_pageSize || height > m_pageSize)
+    {
+        return handle;
+    }
+
+    handle.idx = m_regionHandle.alloc();
+    if (!TinyRender::isValid(handle))
+    {
+        return handle;
+    }
+
+    // Best fitting free rect, smallest one image fits.
+    uint16_t pageIdx = UINT16_MAX;
+    uint32_t freeIdx = UINT32_MAX;
+    uint32_t bestArea = UINT32_MAX;
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        const Page &page = m_page[ii];
+        for (uint32_t jj = 0; jj < page.m_numFree; ++jj)
+        {
+            const Rect &rect = page.m_free[jj];
+            const uint32_t area = uint32_t(rect.m_width) * rect.m_height;
+            if (rect.m_width >= width && rect.m_height >= height && area < bestArea)
+            {
+                pageIdx = ii;
+                freeIdx = jj;
+                bestArea = area;
+            }
+        }
+    }
+
+    Rect alloc;
+    if (UINT16_MAX != pageIdx)
+    {
+        Page &page = m_page[pageIdx];
+        alloc = page.m_free[freeIdx];
+        page.m_free[freeIdx] = page.m_free[--page.m_numFree];
+    }
+    else
+    {
+        for (uint16_t ii = 0; ii < m_numPages && UINT16_MAX == pageIdx; ++ii)
+        {
+            pageIdx = allocSkyline(m_page[ii], uint16_t(width), uint16_t(height), alloc) ? ii : UINT16_MAX;
+        }
+
+        if (UINT16_MAX == pageIdx && createPage())
+        {
+            pageIdx = uint16_t(m_numPages - 1);
+            allocSkyline(m_page[pageIdx], uint16_t(width), uint16_t(height), alloc);
+        }
+    }
+
+    if (UINT16_MAX == pageIdx)
+    {
+        m_regionHandle.free(handle.idx);
+        handle.idx = kInvalidHandle;
+        return handle;
+    }
+
+    Entry &entry = m_entry[handle.idx];
+    entry.m_region.width = _width;
+    entry.m_region.height = _height;
+    place(handle, pageIdx, alloc);
+
+    Page &page = m_page[pageIdx];
+    page.m_numRegions++;
+    page.m_usedTexels += uint32_t(alloc.m_width) * alloc.m_height;
+
+    writeImage(entry, _data, UINT32_MAX == _pitch ? uint32_t(_width) * 4 : _pitch);
+    updateStats();
+
+    return handle;
+}
+
+void Atlas::remove(AtlasRegionHandle _handle)
+{
+    BX_ASSERT(isValid(_handle), "Invalid atlas region handle.");
+
+    const Entry &entry = m_entry[_handle.idx];
+    Page &page = m_page[entry.m_region.page];
+    m_regionHandle.free(_handle.idx);
+
+    page.m_numRegions--;
+    page.m_usedTexels -= uint32_t(entry.m_alloc.m_width) * entry.m_alloc.m_height;
+    if (0 == page.m_numRegions)
+    {
+        resetPage(page);
+    }
+    else if (page.m_numFree < BGFX_CONFIG_ATLAS_MAX_FREE_RECTS)
+    {
+        // Rects that don't fit free list stay lost until page is compacted or emptied.
+        page.m_free[page.m_numFree++] = entry.m_alloc;
+    }
+
+    updateStats();
+}
+
+struct CompactItem
+{
+    uint16_t m_handle;
+    uint16_t m_width;
+    uint16_t m_height;
+    uint16_t m_x;
+    uint16_t m_y;
+};
+
+static int32_t compareCompactItem(const void *_lhs, const void *_rhs)
+{
+    const CompactItem &lhs = *(const CompactItem *)_lhs;
+    const CompactItem &rhs = *(const CompactItem *)_rhs;
+
+    if (lhs.m_height != rhs.m_height)
+    {
+        return lhs.m_height > rhs.m_height ? -1 : 1;
+    }
+
+    if (lhs.m_width != rhs.m_width)
+    {
+        return lhs.m_width > rhs.m_width ? -1 : 1;
+    }
+
+    return int32_t(lhs.m_handle) - int32_t(rhs.m_handle);
+}
+
+uint32_t Atlas::compact(float _maxWaste)
+{
+    BGFX_PROFILER_SCOPE("Atlas::compact");
+
+    const uint32_t maxWaste = uint32_t(_maxWaste * float(m_pageSize) * float(m_pageSize));
+    const uint16_t numRegions = m_regionHandle.getNumHandles();
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+    CompactItem *items = NULL;
+    uint8_t *data = NULL;
+    uint32_t numMoved = 0;
+
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        Page &page = m_page[ii];
+        if (0 == page.m_numRegions || page.m_packedTexels - page.m_usedTexels <= maxWaste)
+        {
+            continue;
+        }
+
+        if (NULL == items)
+        {
+            items = (CompactItem *)bx::alloc(allocator, numRegions * sizeof(CompactItem));
+            data = (uint8_t *)bx::alloc(allocator, m_pageBytes);
+        }
+
+        // Allocations shrink back to what region needs, reused free rects may be larger.
+        uint32_t numItems = 0;
+        for (uint16_t jj = 0; jj < numRegions; ++jj)
+        {
+            const uint16_t handle = m_regionHandle.getHandleAt(jj);
+            const Entry &entry = m_entry[handle];
+            if (ii == entry.m_region.page)
+            {
+                CompactItem &item = items[numItems++];
+                item.m_handle = handle;
+                item.m_width = uint16_t(calcAllocSize(entry.m_region.width));
+                item.m_height = uint16_t(calcAllocSize(entry.m_region.height));
+            }
+        }
+
+        bx::quickSort(items, numItems, sizeof(CompactItem), compareCompactItem);
+
+        m_scratch[0].m_x = 0;
+        m_scratch[0].m_y = 0;
+        m_scratch[0].m_width = m_pageSize;
+        uint32_t numNodes = 1;
+
+        bool fits = true;
+        for (uint32_t jj = 0; jj < numItems && fits; ++jj)
+        {
+            CompactItem &item = items[jj];
+            uint32_t index;
+            fits = findSkyline(m_scratch, numNodes, item.m_width, item.m_height, index, item.m_x, item.m_y);
+            if (fits)
+            {
+                numNodes = addSkyline(m_scratch, numNodes, index, item.m_x, item.m_y, item.m_width, item.m_height);
+            }
+        }
+
+        if (!fits)
+        {
+            continue;
+        }
+
+        // Allocation origins are aligned, so each mip of allocation moves as a whole.
+        bx::memCopy(data, page.m_data, m_pageBytes);
+        resetPage(page);
+        bx::memCopy(page.m_skyline, m_scratch, numNodes * sizeof(SkylineNode));
+        page.m_numNodes = numNodes;
+        page.m_numRegions = numItems;
+
+        for (uint32_t jj = 0; jj < numItems; ++jj)
+        {
+            const CompactItem &item = items[jj];
+            const AtlasRegionHandle handle = {item.m_handle};
+            const Rect from = m_entry[item.m_handle].m_alloc;
+            const Rect to = {item.m_x, item.m_y, item.m_width, item.m_height};
+
+            for (uint8_t mip = 0; mip < m_numMips; ++mip)
+            {
+                const uint32_t pitch = uint32_t(m_pageSize >> mip) * 4;
+                const uint32_t rowBytes = uint32_t(to.m_width >> mip) * 4;
+                const uint8_t *src = &data[getMipOffset(mip) + (from.m_y >> mip) * pitch + (from.m_x >> mip) * 4];
+                uint8_t *dst = &page.m_data[getMipOffset(mip) + (to.m_y >> mip) * pitch + (to.m_x >> mip) * 4];
+                for (uint32_t yy = 0; yy < uint32_t(to.m_height >> mip); ++yy)
+                {
+                    bx::memCopy(&dst[yy * pitch], &src[yy * pitch], rowBytes);
+                }
+            }
+
+            numMoved += from.m_x != to.m_x || from.m_y != to.m_y ? 1 : 0;
+            place(handle, ii, to);
+            page.m_usedTexels += uint32_t(to.m_width) * to.m_height;
+            markDirty(page, to);
+        }
+
+        for (uint32_t jj = 0; jj < numNodes; ++jj)
+        {
+            page.m_packedTexels += uint32_t(m_scratch[jj].m_y) * m_scratch[jj].m_width;
+        }
+    }
+
+    if (NULL != items)
+    {
+        bx::free(allocator, data);
+        bx::free(allocator, items);
+    }
+
+    m_stats.numMoved += numMoved;
+    updateStats();
+
+    return numMoved;
+}
+
+void Atlas::update()
+{
+    BGFX_PROFILER_SCOPE("Atlas::update");
+
+    const uint8_t numMips = calcNumMips(true, m_pageSize, m_pageSize);
+
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        Page &page = m_page[ii];
+        uint16_t *dirty = page.m_dirty;
+        if (dirty[0] >= dirty[2])
+        {
+            continue;
+        }
+
+        // Mips past separated ones mix images, they are filtered from last separated mip of whole page.
+        TextureInfo tail;
+        calcTextureSize(tail, uint16_t(m_pageSize >> (m_numMips - 1)), uint16_t(m_pageSize >> (m_numMips - 1)),
+                        false, true, m_format);
+        if (1 < tail.numMips)
+        {
+            mipGenerate(&page.m_data[getMipOffset(uint8_t(m_numMips - 1))], tail, MipFilter::Box, NULL,
+                        getAllocator(MemoryCategory::Staging));
+        }
+
+        for (uint8_t mip = 0; mip < numMips; ++mip)
+        {
+            const uint32_t size = bx::max(1, m_pageSize >> mip);
+            const uint32_t round = (1u << mip) - 1;
+            const uint32_t x0 = dirty[0] >> mip;
+            const uint32_t y0 = dirty[1] >> mip;
+            const uint32_t x1 = bx::uint32_min((dirty[2] + round) >> mip, size);
+            const uint32_t y1 = bx::uint32_min((dirty[3] + round) >> mip, size);
+
+            updateTexture2D(page.m_texture, mip, uint16_t(x0), uint16_t(y0), uint16_t(x1 - x0), uint16_t(y1 - y0),
+                            &page.m_data[getMipOffset(mip) + (y0 * size + x0) * 4], size * 4);
+            m_stats.numUploaded += (x1 - x0) * (y1 - y0);
+        }
+
+        dirty[0] = UINT16_MAX;
+        dirty[1] = UINT16_MAX;
+        dirty[2] = 0;
+        dirty[3] = 0;
+    }
+}
+
+const AtlasRegion &Atlas::getRegion(AtlasRegionHandle _handle) const
+{
+    BX_ASSERT(isValid(_handle), "Invalid atlas region handle.");
+    return m_entry[_handle.idx].m_region;
+}
+
+void Atlas::resetPage(Page &_page)
+{
+    _page.m_skyline[0].m_x = 0;
+    _page.m_skyline[0].m_y = 0;
+    _page.m_skyline[0].m_width = m_pageSize;
+    _page.m_numNodes = 1;
+    _page.m_numFree = 0;
+    _page.m_numRegions = 0;
+    _page.m_usedTexels = 0;
+    _page.m_packedTexels = 0;
+}
+
+bool Atlas::createPage()
+{
+    if (m_numPages >= m_maxPages)
+    {
+        return false;
+    }
+
+    Page &page = m_page[m_numPages];
+    page.m_texture = createTexture2D(m_pageSize, m_pageSize, true, m_format, NULL, 0);
+    if (!TinyRender::isValid(page.m_texture))
+    {
+        return false;
+    }
+
+    page.m_data = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Texture), m_pageBytes);
+    page.m_skyline =
+        (SkylineNode *)bx::alloc(getAllocator(MemoryCategory::Command), (m_pageSize / m_align + 1) * sizeof(SkylineNode));
+    page.m_free = (Rect *)bx::alloc(getAllocator(MemoryCategory::Command), BGFX_CONFIG_ATLAS_MAX_FREE_RECTS * sizeof(Rect));
+    bx::memSet(page.m_data, 0, m_pageBytes);
+    resetPage(page);
+
+    // Texture is created uninitialized, first update uploads whole page.
+    const Rect rect = {0, 0, m_pageSize, m_pageSize};
+    page.m_dirty[0] = UINT16_MAX;
+    page.m_dirty[1] = UINT16_MAX;
+    page.m_dirty[2] = 0;
+    page.m_dirty[3] = 0;
+    markDirty(page, rect);
+
+    ++m_numPages;
+
+    return true;
+}
+
+bool Atlas::findSkyline(const SkylineNode *_skyline, uint32_t _numNodes, uint16_t _width, uint16_t _height,
+                        uint32_t &_outIndex, uint16_t &_outX, uint16_t &_outY) const
+{
+    // Bottom-left, lowest top edge wins, leftmost on tie.
+    uint32_t bestTop = UINT32_MAX;
+    for (uint32_t ii = 0; ii < _numNodes; ++ii)
+    {
+        const uint32_t xx = _skyline[ii].m_x;
+        if (xx + _width > m_pageSize)
+        {
+            break;
+        }
+
+        uint32_t yy = 0;
+        uint32_t widthLeft = _width;
+        for (uint32_t jj = ii; 0 != widthLeft; ++jj)
+        {
+            yy = bx::uint32_max(yy, _skyline[jj].m_y);
+            widthLeft -= bx::uint32_min(widthLeft, _skyline[jj].m_width);
+        }
+
+        if (yy + _height <= m_pageSize && yy + _height < bestTop)
+        {
+            bestTop = yy + _height;
+            _outIndex = ii;
+            _outX = uint16_t(xx);
+            _outY = uint16_t(yy);
+        }
+    }
+
+    return UINT32_MAX != bestTop;
+}
+
+uint32_t Atlas::addSkyline(SkylineNode *_skyline, uint32_t _numNodes, uint32_t _index, uint16_t _x, uint16_t _y,
+                           uint16_t _width, uint16_t _height) const
+{
+    bx::memMove(&_skyline[_index + 1], &_skyline[_index], (_numNodes - _index) * sizeof(SkylineNode));
+    _skyline[_index].m_x = _x;
+    _skyline[_index].m_y = uint16_t(_y + _height);
+    _skyline[_index].m_width = _width;
+    ++_numNodes;
+
+    // Trim nodes new one covers.
+    const uint32_t right = uint32_t(_x) + _width;
+    for (uint32_t ii = _index + 1; ii < _numNodes;)
+    {
+        SkylineNode &node = _skyline[ii];
+        if (node.m_x >= right)
+        {
+            break;
+        }
+
+        const uint32_t shrink = right - node.m_x;
+        if (node.m_width <= shrink)
+        {
+            bx::memMove(&_skyline[ii], &_skyline[ii + 1], (_numNodes - ii - 1) * sizeof(SkylineNode));
+            --_numNodes;
+            continue;
+        }
+
+        node.m_x = uint16_t(node.m_x + shrink);
+        node.m_width = uint16_t(node.m_width - shrink);
+        break;
+    }
+
+    // Merge neighbours at same height.
+    for (uint32_t ii = 0; ii + 1 < _numNodes;)
+    {
+        if (_skyline[ii].m_y == _skyline[ii + 1].m_y)
+        {
+            _skyline[ii].m_width = uint16_t(_skyline[ii].m_width + _skyline[ii + 1].m_width);
+            bx::memMove(&_skyline[ii + 1], &_skyline[ii + 2], (_numNodes - ii - 2) * sizeof(SkylineNode));
+            --_numNodes;
+            continue;
+        }
+        ++ii;
+    }
+
+    return _numNodes;
+}
+
+bool Atlas::allocSkyline(Page &_page, uint16_t _width, uint16_t _height, Rect &_outRect)
+{
+    uint32_t index;
+    uint16_t xx;
+    uint16_t yy;
+    if (!findSkyline(_page.m_skyline, _page.m_numNodes, _width, _height, index, xx, yy))
+    {
+        return false;
+    }
+
+    _page.m_numNodes = addSkyline(_page.m_skyline, _page.m_numNodes, index, xx, yy, _width, _height);
+
+    _page.m_packedTexels = 0;
+    for (uint32_t ii = 0; ii < _page.m_numNodes; ++ii)
+    {
+        _page.m_packedTexels += uint32_t(_page.m_skyline[ii].m_y) * _page.m_skyline[ii].m_width;
+    }
+
+    _outRect.m_x = xx;
+    _outRect.m_y = yy;
+    _outRect.m_width = _width;
+    _outRect.m_height = _height;
+
+    return true;
+}
+
+void Atlas::place(AtlasRegionHandle _handle, uint16_t _page, const Rect &_alloc)
+{
+    Entry &entry = m_entry[_handle.idx];
+    entry.m_alloc = _alloc;
+
+    AtlasRegion &region = entry.m_region;
+    region.page = _page;
+    region.x = uint16_t(_alloc.m_x + m_padding);
+    region.y = uint16_t(_alloc.m_y + m_padding);
+
+    const float texel = 1.0f / float(m_pageSize);
+    region.uv[0] = float(region.x) * texel;
+    region.uv[1] = float(region.y) * texel;
+    region.uv[2] = float(region.x + region.width) * texel;
+    region.uv[3] = float(region.y + region.height) * texel;
+}
+
+void Atlas::writeImage(const Entry &_entry, const void *_data, uint32_t _pitch)
+{
+    const AtlasRegion &region = _entry.m_region;
+    const Rect &alloc = _entry.m_alloc;
+    Page &page = m_page[region.page];
+
+    // Whole allocation is filled, edge replicated into padding and alignment.
+    const uint32_t pitch = uint32_t(m_pageSize) * 4;
+    const uint32_t left = m_padding;
+    const uint32_t right = alloc.m_width - m_padding - region.width;
+    for (uint32_t yy = 0; yy < alloc.m_height; ++yy)
+    {
+        const uint32_t srcY = uint32_t(bx::clamp<int32_t>(int32_t(yy) - m_padding, 0, region.height - 1));
+        const uint8_t *src = (const uint8_t *)_data + srcY * _pitch;
+        uint8_t *dst = &page.m_data[(alloc.m_y + yy) * pitch + alloc.m_x * 4];
+
+        for (uint32_t xx = 0; xx < left; ++xx)
+        {
+            bx::memCopy(&dst[xx * 4], src, 4);
+        }
+
+        bx::memCopy(&dst[left * 4], src, uint32_t(region.width) * 4);
+
+        const uint8_t *last = &src[(region.width - 1) * 4];
+        for (uint32_t xx = 0; xx < right; ++xx)
+        {
+            bx::memCopy(&dst[(left + region.width + xx) * 4], last, 4);
+        }
+    }
+
+    if (1 < m_numMips)
+    {
+        // Allocation is mip aligned, its mips are filtered on their own and copied in.
+        TextureInfo info;
+        calcTextureSize(info, alloc.m_width, alloc.m_height, false, true, m_format);
+
+        bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+        uint8_t *mips = (uint8_t *)bx::alloc(allocator, info.storageSize);
+        for (uint32_t yy = 0; yy < alloc.m_height; ++yy)
+        {
+            bx::memCopy(&mips[yy * alloc.m_width * 4], &page.m_data[(alloc.m_y + yy) * pitch + alloc.m_x * 4],
+                        uint32_t(alloc.m_width) * 4);
+        }
+
+        mipGenerate(mips, info, MipFilter::Box, NULL, allocator);
+
+        const uint8_t *src = mips;
+        for (uint8_t mip = 1; mip < m_numMips; ++mip)
+        {
+            src += uint32_t(alloc.m_width >> (mip - 1)) * (alloc.m_height >> (mip - 1)) * 4;
+
+            const uint32_t width = alloc.m_width >> mip;
+            const uint32_t mipPitch = uint32_t(m_pageSize >> mip) * 4;
+            uint8_t *dst = &page.m_data[getMipOffset(mip) + (alloc.m_y >> mip) * mipPitch + (alloc.m_x >> mip) * 4];
+            for (uint32_t yy = 0; yy < uint32_t(alloc.m_height >> mip); ++yy)
+            {
+                bx::memCopy(&dst[yy * mipPitch], &src[yy * width * 4], width * 4);
+            }
+        }
+
+        bx::free(allocator, mips);
+    }
+
+    markDirty(page, alloc);
+}
+
+void Atlas::markDirty(Page &_page, const Rect &_rect)
+{
+    uint16_t *dirty = _page.m_dirty;
+    dirty[0] = bx::min(dirty[0], _rect.m_x);
+    dirty[1] = bx::min(dirty[1], _rect.m_y);
+    dirty[2] = bx::max(dirty[2], uint16_t(_rect.m_x + _rect.m_width));
+    dirty[3] = bx::max(dirty[3], uint16_t(_rect.m_y + _rect.m_height));
+}
+
+uint32_t Atlas::getMipOffset(uint8_t _mip) const
+{
+    uint32_t offset = 0;
+    for (uint8_t ii = 0; ii < _mip; ++ii)
+    {
+        const uint32_t size = m_pageSize >> ii;
+        offset += size * size * 4;
+    }
+
+    return offset;
+}
+
+uint32_t Atlas::calcAllocSize(uint16_t _size) const
+{
+    return bx::alignUp(uint32_t(_size) + 2 * m_padding, m_align);
+}
+
+void Atlas::updateStats()
+{
+    m_stats.numPages = m_numPages;
+    m_stats.numRegions = m_regionHandle.getNumHandles();
+    m_stats.numFreeRects = 0;
+    m_stats.usedTexels = 0;
+    m_stats.packedTexels = 0;
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        const Page &page = m_page[ii];
+        m_stats.numFreeRects += page.m_numFree;
+        m_stats.usedTexels += page.m_usedTexels;
+        m_stats.packedTexels += page.m_packedTexels;
+    }
+}
+
+} // namespace TinyRender
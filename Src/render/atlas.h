@@ -0,0 +1,198 @@
+#pragma once
+
+#include <bx/handlealloc.h>
+
+#include "defines.h"
+#include "tiny_render.h"
+
+namespace TinyRender
+{
+
+BGFX_HANDLE(AtlasRegionHandle)
+
+/// Image placed in atlas page.
+struct AtlasRegion
+{
+    uint16_t page;   //!< Page index, see `Atlas::getTexture`.
+    uint16_t x;      //!< Left column of image in page.
+    uint16_t y;      //!< Top row of image in page.
+    uint16_t width;  //!< Image width.
+    uint16_t height; //!< Image height.
+    float uv[4];     //!< Image rectangle `u0, v0, u1, v1`, at texel edges.
+};
+
+/// Atlas statistics, texel counts are summed over all pages.
+struct AtlasStats
+{
+    uint32_t numPages;     //!< Pages created.
+    uint32_t numRegions;   //!< Live regions.
+    uint32_t numFreeRects; //!< Space of removed regions waiting to be reused.
+    uint64_t usedTexels;   //!< Texels allocated to live regions, padding and alignment included.
+    uint64_t packedTexels; //!< Texels under skylines, used or not.
+    uint64_t numMoved;     //!< Regions moved by `compact`, total.
+    uint64_t numUploaded;  //!< Texels uploaded by `update`, all mips, total.
+};
+
+/// Runtime texture atlas, packs many small images into few shared pages, so sprites and UI drawn
+/// with them can be batched by page.
+///
+/// Each page is square RGBA8 or SRGBA8 texture with full mip chain, packed with skyline bottom-left
+/// heuristic. Every image gets `_padding` texels of replicated edge on each side, and its allocation
+/// is aligned to `1 << (_numMips - 1)` texels both in position and size, so first `_numMips` mips of
+/// each image are filtered only from its own texels. Mips below that mix images, clamp sampler LOD to
+/// `_numMips - 1`. Padding of `1 << (_numMips - 1)` keeps one border texel around image on every
+/// of those mips.
+///
+/// Removed regions leave their allocation on page free list, where later images that fit reuse it.
+/// Page becomes empty again when its last region is removed. `compact` repacks fragmented pages,
+/// moving regions within their page, so region UVs must be fetched again after it moved any.
+///
+/// Page contents are kept on CPU, changes are uploaded by `update`.
+///
+struct Atlas
+{
+    Atlas();
+    ~Atlas();
+
+    /// @param[in] _pageSize Page width and height, power of two.
+    /// @param[in] _numMips Mips kept separate between images, 1 for none.
+    /// @param[in] _padding Border texels around each image.
+    /// @param[in] _format `TextureFormat::RGBA8` or `TextureFormat::SRGBA8`, images are in it too.
+    /// @param[in] _maxPages Pages created at most, up to `BGFX_CONFIG_ATLAS_MAX_PAGES`.
+    ///
+    /// @returns False when parameters are invalid.
+    ///
+    bool create(uint16_t _pageSize, uint8_t _numMips = 1, uint16_t _padding = 1,
+                TextureFormat::Enum _format = TextureFormat::RGBA8, uint16_t _maxPages = BGFX_CONFIG_ATLAS_MAX_PAGES);
+
+    /// Destroy pages after current frame is submitted.
+    void destroy();
+
+    /// Add image. Free rects of removed regions are tried first, best fit, then skylines of pages in
+    /// order, then new page is created.
+    ///
+    /// @param[in] _data Image pixels in atlas format.
+    /// @param[in] _pitch Bytes between rows of `_data`, `UINT32_MAX` for rows without padding.
+    ///
+    /// @returns Invalid handle when image with padding is larger than page, or atlas is full.
+    ///
+    AtlasRegionHandle add(const void *_data, uint16_t _width, uint16_t _height, uint32_t _pitch = UINT32_MAX);
+
+    /// Remove region, its allocation can be reused by next `add`.
+    void remove(AtlasRegionHandle _handle);
+
+    /// Repack pages where packed space not used by live regions exceeds `_maxWaste` of page area. Regions
+    /// are placed tallest first into fresh skyline of their page, page is left alone if they don't
+    /// all fit.
+    ///
+    /// @returns Number of regions moved.
+    ///
+    uint32_t compact(float _maxWaste = 0.25f);
+
+    /// Upload changed part of each page. Call once per frame, before drawing with atlas.
+    void update();
+
+    /// Returns region placement, valid until it's removed or moved by `compact`.
+    const AtlasRegion &getRegion(AtlasRegionHandle _handle) const;
+
+    /// Returns page texture.
+    TextureHandle getTexture(uint16_t _page) const
+    {
+        return m_page[_page].m_texture;
+    }
+
+    uint16_t getNumPages() const
+    {
+        return m_numPages;
+    }
+
+    /// Returns true if `_handle` is live region of this atlas.
+    bool isValid(AtlasRegionHandle _handle) const
+    {
+        return TinyRender::isValid(_handle) && _handle.idx < BGFX_CONFIG_ATLAS_MAX_REGIONS &&
+               m_regionHandle.isValid(_handle.idx);
+    }
+
+    const AtlasStats &getStats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    /// Top edge of used space over columns `[m_x, m_x + m_width)`.
+    struct SkylineNode
+    {
+        uint16_t m_x;
+        uint16_t m_y;
+        uint16_t m_width;
+    };
+
+    struct Rect
+    {
+        uint16_t m_x;
+        uint16_t m_y;
+        uint16_t m_width;
+        uint16_t m_height;
+    };
+
+    struct Page
+    {
+        TextureHandle m_texture;
+        uint8_t *m_data;         //!< All mips, laid out as described in `calcTextureSize`.
+        SkylineNode *m_skyline;  //!< Nodes left to right, covering whole page width.
+        Rect *m_free;            //!< Allocations of removed regions.
+        uint32_t m_numNodes;
+        uint32_t m_numFree;
+        uint32_t m_numRegions;
+        uint32_t m_usedTexels;
+        uint32_t m_packedTexels;
+        uint16_t m_dirty[4];     //!< Mip 0 rectangle to upload, min x, min y, max x, max y.
+    };
+
+    /// Region with its allocation, allocation can be larger than needed when it reused free rect.
+    struct Entry
+    {
+        AtlasRegion m_region;
+        Rect m_alloc;
+    };
+
+    void resetPage(Page &_page);
+
+    bool createPage();
+
+    bool findSkyline(const SkylineNode *_skyline, uint32_t _numNodes, uint16_t _width, uint16_t _height,
+                     uint32_t &_outIndex, uint16_t &_outX, uint16_t &_outY) const;
+
+    uint32_t addSkyline(SkylineNode *_skyline, uint32_t _numNodes, uint32_t _index, uint16_t _x, uint16_t _y,
+                        uint16_t _width, uint16_t _height) const;
+
+    bool allocSkyline(Page &_page, uint16_t _width, uint16_t _height, Rect &_outRect);
+
+    void place(AtlasRegionHandle _handle, uint16_t _page, const Rect &_alloc);
+
+    void writeImage(const Entry &_entry, const void *_data, uint32_t _pitch);
+
+    void markDirty(Page &_page, const Rect &_rect);
+
+    uint32_t getMipOffset(uint8_t _mip) const;
+
+    uint32_t calcAllocSize(uint16_t _size) const;
+
+    void updateStats();
+
+    bx::HandleAllocT<BGFX_CONFIG_ATLAS_MAX_REGIONS> m_regionHandle;
+    Entry *m_entry;
+    SkylineNode *m_scratch; //!< Trial skyline of `compact`.
+    Page m_page[BGFX_CONFIG_ATLAS_MAX_PAGES];
+    uint32_t m_pageBytes;
+    uint16_t m_numPages;
+    uint16_t m_maxPages;
+    uint16_t m_pageSize;
+    uint16_t m_padding;
+    uint16_t m_align;
+    uint8_t m_numMips;
+    TextureFormat::Enum m_format;
+    AtlasStats m_stats;
+};
+
+} // namespace TinyRender
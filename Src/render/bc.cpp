@@ -0,0 +1,1397 @@
+#include <bx/math.h>
+#include <bx/simd_t.h>
+#include <bx/uint32_t.h>
+
+#include "bc.h"
+#include "job.h"
+
+namespace TinyRender
+{
+
+using bx::simd128_t;
+
+// BC7 partition tables. Two subset partitions are bit masks, bit `ii` set when pixel `ii` is in
+// subset 1.
+static const uint16_t s_bc7Partition2[64] = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8,
+    0xff00, 0xfff0, 0xf000, 0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110,
+    0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c, 0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696,
+    0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660, 0x0272, 0x04e4, 0x4e40, 0x2720,
+    0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+static const uint8_t s_bc7Partition3[64][16] = {
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}, {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+    {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2}, {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2}, {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+    {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2}, {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0}, {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0}, {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+    {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2}, {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+    {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1}, {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2}, {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0}, {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+    {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0}, {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1}, {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1}, {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1}, {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1}, {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2}, {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+    {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2}, {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2}, {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+    {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+    {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1}, {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0},
+};
+
+/// Anchor pixel of subset 1 in two subset partitions.
+static const uint8_t s_bc7Anchor2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2,  8, 2,  2, 8, 8,  15, 2,  8,  2, 2,
+    8,  8,  2,  2,  15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6, 6,  2, 6, 8,  15, 15, 2, 2,
+    15, 15, 15, 15, 15, 2,  2,  15,
+};
+
+/// Anchor pixels of subsets 1 and 2 in three subset partitions.
+static const uint8_t s_bc7Anchor3[2][64] = {
+    {
+        3,  3, 15, 15, 8,  3,  15, 15, 8,  8,  6,  6,  6,  5,  3, 3,  3,  3,  8,  15, 3,  3,
+        6,  10, 5,  8,  8,  6,  8,  5,  15, 15, 8, 15, 3,  5,  6,  10, 8,  15, 15, 3,  15, 5,
+        15, 15, 15, 15, 3,  15, 5,  5,  5,  8,  5, 10, 5,  10, 8,  13, 15, 12, 3,  3,
+    },
+    {
+        15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,  15, 8,  15, 3,  15, 8,
+        15, 8,  3,  15, 6,  10, 15, 15, 10, 8,  15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15,
+        3,  6,  6,  8,  15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8,
+    },
+};
+
+static const uint8_t s_bc7Weight2[4] = {0, 21, 43, 64};
+static const uint8_t s_bc7Weight3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+static const uint8_t s_bc7Weight4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Bc7Mode
+{
+    uint8_t numSubsets;
+    uint8_t partitionBits;
+    uint8_t rotationBits;
+    uint8_t indexSelectionBits;
+    uint8_t colorBits;
+    uint8_t alphaBits;
+    uint8_t endpointPBits; //!< One p-bit per endpoint.
+    uint8_t sharedPBits;   //!< One p-bit per subset.
+    uint8_t indexBits;
+    uint8_t indexBits2; //!< Second index set, separate alpha indices of modes 4 and 5.
+};
+
+static const Bc7Mode s_bc7Mode[8] = {
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0}, //
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0}, //
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0}, //
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0}, //
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3}, //
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2}, //
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0}, //
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}, //
+};
+
+static const uint32_t kBc7Mode1Candidates[BcQuality::Count] = {0, 4, 16};
+static const uint32_t kRefineIterations[BcQuality::Count] = {0, 1, 3};
+
+/// Little endian bit stream of one block, first field in lowest bits of first byte.
+struct BitWriter
+{
+    BitWriter(uint8_t *_data, uint32_t _size) : m_data(_data), m_pos(0)
+    {
+        bx::memSet(_data, 0, _size);
+    }
+
+    void write(uint32_t _value, uint32_t _bits)
+    {
+        for (uint32_t ii = 0; ii < _bits; ++ii, ++m_pos)
+        {
+            m_data[m_pos >> 3] |= uint8_t(((_value >> ii) & 1) << (m_pos & 7));
+        }
+    }
+
+    uint8_t *m_data;
+    uint32_t m_pos;
+};
+
+struct BitReader
+{
+    BitReader(const uint8_t *_data) : m_data(_data), m_pos(0) {}
+
+    uint32_t read(uint32_t _bits)
+    {
+        uint32_t value = 0;
+        for (uint32_t ii = 0; ii < _bits; ++ii, ++m_pos)
+        {
+            value |= uint32_t((m_data[m_pos >> 3] >> (m_pos & 7)) & 1) << ii;
+        }
+        return value;
+    }
+
+    const uint8_t *m_data;
+    uint32_t m_pos;
+};
+
+static uint32_t getBlockBytes(TextureFormat::Enum _format)
+{
+    return TextureFormat::BC1 == _format || TextureFormat::BC4 == _format ? 8 : 16;
+}
+
+static uint32_t square(int32_t _value)
+{
+    return uint32_t(_value * _value);
+}
+
+/// Copy 4x4 block at pixel `_x`, `_y`, replicating last row and column past image edge.
+static void fetchBlock(uint8_t _block[16][4], const uint8_t *_src, uint32_t _srcPitch, uint32_t _x, uint32_t _y,
+                       uint32_t _width, uint32_t _height)
+{
+    for (uint32_t yy = 0; yy < 4; ++yy)
+    {
+        const uint8_t *row = _src + bx::uint32_min(_y + yy, _height - 1) * _srcPitch;
+        for (uint32_t xx = 0; xx < 4; ++xx)
+        {
+            bx::memCopy(_block[yy * 4 + xx], &row[bx::uint32_min(_x + xx, _width - 1) * 4], 4);
+        }
+    }
+}
+
+/// Mean and principal axis of pixels `_pixels` of block, from covariance by power iteration.
+/// Channels past `_numChannels` are left out.
+static void principalAxis(float _mean[4], float _axis[4], const uint8_t _block[16][4], const uint8_t *_pixels,
+                          uint32_t _num, uint32_t _numChannels)
+{
+    BX_ALIGN_DECL(16, float mask[4]) = {1.0f, 1.0f, 1.0f, 4 == _numChannels ? 1.0f : 0.0f};
+    const simd128_t channelMask = bx::simd_ld<simd128_t>(mask);
+
+    simd128_t color[16];
+    simd128_t sum = bx::simd_zero<simd128_t>();
+    for (uint32_t ii = 0; ii < _num; ++ii)
+    {
+        const uint8_t *pixel = _block[_pixels[ii]];
+        color[ii] = bx::simd_mul(
+            bx::simd_ld<simd128_t>(float(pixel[0]), float(pixel[1]), float(pixel[2]), float(pixel[3])), channelMask);
+        sum = bx::simd_add(sum, color[ii]);
+    }
+
+    const simd128_t mean = bx::simd_mul(sum, bx::simd_splat<simd128_t>(1.0f / float(_num)));
+
+    // Covariance rows, one madd per row and pixel.
+    simd128_t cov[4] = {
+        bx::simd_zero<simd128_t>(),
+        bx::simd_zero<simd128_t>(),
+        bx::simd_zero<simd128_t>(),
+        bx::simd_zero<simd128_t>(),
+    };
+    for (uint32_t ii = 0; ii < _num; ++ii)
+    {
+        BX_ALIGN_DECL(16, float diff[4]);
+        const simd128_t dd = bx::simd_sub(color[ii], mean);
+        bx::simd_st(diff, dd);
+        for (uint32_t row = 0; row < 4; ++row)
+        {
+            cov[row] = bx::simd_madd(dd, bx::simd_splat<simd128_t>(diff[row]), cov[row]);
+        }
+    }
+
+    BX_ALIGN_DECL(16, float matrix[4][4]);
+    for (uint32_t row = 0; row < 4; ++row)
+    {
+        bx::simd_st(matrix[row], cov[row]);
+    }
+    bx::simd_st(_mean, mean);
+
+    float axis[4] = {1.0f, 1.0f, 1.0f, 4 == _numChannels ? 1.0f : 0.0f};
+    for (uint32_t iter = 0; iter < 8; ++iter)
+    {
+        float next[4];
+        float len = 0.0f;
+        for (uint32_t row = 0; row < 4; ++row)
+        {
+            next[row] = matrix[row][0] * axis[0] + matrix[row][1] * axis[1] + matrix[row][2] * axis[2] +
+                        matrix[row][3] * axis[3];
+            len += next[row] * next[row];
+        }
+
+        if (len < 1e-12f)
+        {
+            break;
+        }
+
+        const float invLen = 1.0f / bx::sqrt(len);
+        for (uint32_t row = 0; row < 4; ++row)
+        {
+            axis[row] = next[row] * invLen;
+        }
+    }
+
+    bx::memCopy(_axis, axis, sizeof(axis));
+}
+
+/// Endpoints at extreme projections of pixels on axis.
+static void axisEndpoints(float _endpoint[2][4], const float _mean[4], const float _axis[4],
+                          const uint8_t _block[16][4], const uint8_t *_pixels, uint32_t _num)
+{
+    float tmin = 0.0f;
+    float tmax = 0.0f;
+    for (uint32_t ii = 0; ii < _num; ++ii)
+    {
+        const uint8_t *pixel = _block[_pixels[ii]];
+        float tt = 0.0f;
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            tt += (float(pixel[ch]) - _mean[ch]) * _axis[ch];
+        }
+        tmin = bx::min(tmin, tt);
+        tmax = bx::max(tmax, tt);
+    }
+
+    for (uint32_t ch = 0; ch < 4; ++ch)
+    {
+        _endpoint[0][ch] = bx::clamp(_mean[ch] + tmin * _axis[ch], 0.0f, 255.0f);
+        _endpoint[1][ch] = bx::clamp(_mean[ch] + tmax * _axis[ch], 0.0f, 255.0f);
+    }
+}
+
+/// Least squares endpoints for given per pixel interpolation weights `_weight[ii]` of endpoint 1.
+/// Returns false when weights don't constrain both endpoints.
+static bool solveEndpoints(float _endpoint[2][4], const uint8_t _block[16][4], const uint8_t *_pixels,
+                           const float *_weight, uint32_t _num, uint32_t _numChannels)
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[4] = {};
+    float bx_[4] = {};
+    for (uint32_t ii = 0; ii < _num; ++ii)
+    {
+        const float beta = _weight[ii];
+        const float alpha = 1.0f - beta;
+        aa += alpha * alpha;
+        ab += alpha * beta;
+        bb += beta * beta;
+
+        const uint8_t *pixel = _block[_pixels[ii]];
+        for (uint32_t ch = 0; ch < _numChannels; ++ch)
+        {
+            ax[ch] += alpha * float(pixel[ch]);
+            bx_[ch] += beta * float(pixel[ch]);
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (bx::abs(det) < 1e-6f)
+    {
+        return false;
+    }
+
+    const float invDet = 1.0f / det;
+    for (uint32_t ch = 0; ch < _numChannels; ++ch)
+    {
+        _endpoint[0][ch] = bx::clamp((bb * ax[ch] - ab * bx_[ch]) * invDet, 0.0f, 255.0f);
+        _endpoint[1][ch] = bx::clamp((aa * bx_[ch] - ab * ax[ch]) * invDet, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static uint16_t pack565(const float _color[4])
+{
+    const uint32_t rr = uint32_t(_color[0] * 31.0f / 255.0f + 0.5f);
+    const uint32_t gg = uint32_t(_color[1] * 63.0f / 255.0f + 0.5f);
+    const uint32_t bb = uint32_t(_color[2] * 31.0f / 255.0f + 0.5f);
+    return uint16_t((rr << 11) | (gg << 5) | bb);
+}
+
+static void unpack565(uint8_t _color[4], uint16_t _packed)
+{
+    const uint32_t rr = (_packed >> 11) & 0x1f;
+    const uint32_t gg = (_packed >> 5) & 0x3f;
+    const uint32_t bb = _packed & 0x1f;
+    _color[0] = uint8_t((rr << 3) | (rr >> 2));
+    _color[1] = uint8_t((gg << 2) | (gg >> 4));
+    _color[2] = uint8_t((bb << 3) | (bb >> 2));
+    _color[3] = 255;
+}
+
+static void bc1Palette(uint8_t _palette[4][4], uint16_t _color0, uint16_t _color1, bool _fourColor)
+{
+    unpack565(_palette[0], _color0);
+    unpack565(_palette[1], _color1);
+
+    for (uint32_t ch = 0; ch < 3; ++ch)
+    {
+        const uint32_t c0 = _palette[0][ch];
+        const uint32_t c1 = _palette[1][ch];
+        if (_fourColor)
+        {
+            _palette[2][ch] = uint8_t((2 * c0 + c1 + 1) / 3);
+            _palette[3][ch] = uint8_t((c0 + 2 * c1 + 1) / 3);
+        }
+        else
+        {
+            _palette[2][ch] = uint8_t((c0 + c1 + 1) / 2);
+            _palette[3][ch] = 0;
+        }
+    }
+    _palette[2][3] = 255;
+    _palette[3][3] = _fourColor ? 255 : 0;
+}
+
+struct Bc1Fit
+{
+    uint16_t m_color[2];
+    uint32_t m_indices;
+    uint32_t m_error;
+};
+
+/// Evaluate 565 endpoints, transparent pixels take index 3 of three color mode.
+static void bc1Evaluate(Bc1Fit &_fit, uint8_t _index[16], const uint8_t _block[16][4], const bool _transparent[16],
+                        uint16_t _color0, uint16_t _color1, bool _fourColor)
+{
+    // Endpoint order selects mode, four color needs color0 > color1.
+    if (_fourColor ? _color0 < _color1 : _color0 > _color1)
+    {
+        bx::swap(_color0, _color1);
+    }
+
+    uint8_t palette[4][4];
+    bc1Palette(palette, _color0, _color1, _fourColor);
+
+    // Equal endpoints decode in three color mode, stay on index 0 to be same in both.
+    const uint32_t numColors = _color0 == _color1 ? 1 : _fourColor ? 4 : 3;
+
+    _fit.m_color[0] = _color0;
+    _fit.m_color[1] = _color1;
+    _fit.m_indices = 0;
+    _fit.m_error = 0;
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        uint32_t best = 0;
+        if (_transparent[ii])
+        {
+            best = 3;
+        }
+        else
+        {
+            uint32_t bestError = UINT32_MAX;
+            for (uint32_t idx = 0; idx < numColors; ++idx)
+            {
+                const uint32_t error = square(_block[ii][0] - palette[idx][0]) +
+                                       square(_block[ii][1] - palette[idx][1]) +
+                                       square(_block[ii][2] - palette[idx][2]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = idx;
+                }
+            }
+            _fit.m_error += bestError;
+        }
+
+        _index[ii] = uint8_t(best);
+        _fit.m_indices |= best << (ii * 2);
+    }
+}
+
+/// Encode color part of BC1, BC3 passes `_punchThrough` false and gets four color mode only.
+static void bc1EncodeColor(uint8_t _dst[8], const uint8_t _block[16][4], BcQuality::Enum _quality,
+                           bool _punchThrough)
+{
+    bool transparent[16];
+    uint8_t pixels[16];
+    uint32_t num = 0;
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        transparent[ii] = _punchThrough && _block[ii][3] < 128;
+        if (!transparent[ii])
+        {
+            pixels[num++] = uint8_t(ii);
+        }
+    }
+
+    Bc1Fit best;
+    best.m_color[0] = 0;
+    best.m_color[1] = 0;
+    best.m_indices = UINT32_MAX;
+    best.m_error = UINT32_MAX;
+
+    if (0 != num)
+    {
+        float mean[4];
+        float axis[4];
+        float initial[2][4];
+        principalAxis(mean, axis, _block, pixels, num, 3);
+        axisEndpoints(initial, mean, axis, _block, pixels, num);
+
+        // Three color mode is the only one with transparency, on high quality it's also tried on
+        // opaque blocks where its midpoint may fit better.
+        const bool tryFourColor = num == 16;
+        const bool tryThreeColor = num != 16 || (_punchThrough && BcQuality::High == _quality);
+
+        for (uint32_t mode = 0; mode < 2; ++mode)
+        {
+            const bool fourColor = 0 == mode;
+            if (fourColor ? !tryFourColor : !tryThreeColor)
+            {
+                continue;
+            }
+
+            float endpoint[2][4];
+            bx::memCopy(endpoint, initial, sizeof(endpoint));
+
+            for (uint32_t iter = 0; iter <= kRefineIterations[_quality]; ++iter)
+            {
+                Bc1Fit fit;
+                uint8_t index[16];
+                bc1Evaluate(fit, index, _block, transparent, pack565(endpoint[0]), pack565(endpoint[1]), fourColor);
+                if (fit.m_error < best.m_error)
+                {
+                    best = fit;
+                }
+
+                // Weight of color1 for each index, after evaluate swapped endpoints to mode order.
+                static const float s_weight4[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+                static const float s_weight3[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+                float weight[16];
+                for (uint32_t ii = 0; ii < num; ++ii)
+                {
+                    weight[ii] = (fourColor ? s_weight4 : s_weight3)[index[pixels[ii]]];
+                }
+
+                if (0 == fit.m_error || iter == kRefineIterations[_quality] ||
+                    !solveEndpoints(endpoint, _block, pixels, weight, num, 3))
+                {
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        // All transparent, three color mode with all indices 3.
+        best.m_indices = UINT32_MAX;
+    }
+
+    _dst[0] = uint8_t(best.m_color[0]);
+    _dst[1] = uint8_t(best.m_color[0] >> 8);
+    _dst[2] = uint8_t(best.m_color[1]);
+    _dst[3] = uint8_t(best.m_color[1] >> 8);
+    _dst[4] = uint8_t(best.m_indices);
+    _dst[5] = uint8_t(best.m_indices >> 8);
+    _dst[6] = uint8_t(best.m_indices >> 16);
+    _dst[7] = uint8_t(best.m_indices >> 24);
+}
+
+static void bc1DecodeColor(uint8_t _block[16][4], const uint8_t _src[8], bool _forceFourColor)
+{
+    const uint16_t color0 = uint16_t(_src[0] | (_src[1] << 8));
+    const uint16_t color1 = uint16_t(_src[2] | (_src[3] << 8));
+    const uint32_t indices = _src[4] | (_src[5] << 8) | (_src[6] << 16) | (uint32_t(_src[7]) << 24);
+
+    uint8_t palette[4][4];
+    bc1Palette(palette, color0, color1, _forceFourColor || color0 > color1);
+
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        bx::memCopy(_block[ii], palette[(indices >> (ii * 2)) & 3], 4);
+    }
+}
+
+static void bc4Palette(uint8_t _palette[8], uint32_t _value0, uint32_t _value1)
+{
+    _palette[0] = uint8_t(_value0);
+    _palette[1] = uint8_t(_value1);
+    if (_value0 > _value1)
+    {
+        for (uint32_t ii = 1; ii < 7; ++ii)
+        {
+            _palette[ii + 1] = uint8_t(((7 - ii) * _value0 + ii * _value1 + 3) / 7);
+        }
+    }
+    else
+    {
+        for (uint32_t ii = 1; ii < 5; ++ii)
+        {
+            _palette[ii + 1] = uint8_t(((5 - ii) * _value0 + ii * _value1 + 2) / 5);
+        }
+        _palette[6] = 0;
+        _palette[7] = 255;
+    }
+}
+
+static uint32_t bc4Evaluate(uint64_t &_indices, const uint8_t _values[16], uint32_t _value0, uint32_t _value1)
+{
+    uint8_t palette[8];
+    bc4Palette(palette, _value0, _value1);
+
+    uint32_t error = 0;
+    _indices = 0;
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        uint32_t best = 0;
+        uint32_t bestError = UINT32_MAX;
+        for (uint32_t idx = 0; idx < 8; ++idx)
+        {
+            const uint32_t err = square(_values[ii] - palette[idx]);
+            if (err < bestError)
+            {
+                bestError = err;
+                best = idx;
+            }
+        }
+        error += bestError;
+        _indices |= uint64_t(best) << (ii * 3);
+    }
+    return error;
+}
+
+static void bc4Encode(uint8_t _dst[8], const uint8_t _values[16], BcQuality::Enum _quality)
+{
+    uint32_t minValue = 255;
+    uint32_t maxValue = 0;
+    uint32_t minInner = 255; // Range without 0 and 255, six value mode has those for free.
+    uint32_t maxInner = 0;
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        minValue = bx::uint32_min(minValue, _values[ii]);
+        maxValue = bx::uint32_max(maxValue, _values[ii]);
+        if (0 != _values[ii] && 255 != _values[ii])
+        {
+            minInner = bx::uint32_min(minInner, _values[ii]);
+            maxInner = bx::uint32_max(maxInner, _values[ii]);
+        }
+    }
+
+    uint32_t value0 = maxValue;
+    uint32_t value1 = minValue;
+    uint64_t indices;
+    uint32_t error = bc4Evaluate(indices, _values, value0, value1);
+
+    // Shrinking range trades error at extremes for finer steps in between.
+    const uint32_t search = BcQuality::High == _quality ? 3 : 0;
+    for (uint32_t hi = 0; hi <= search && 0 != error; ++hi)
+    {
+        for (uint32_t lo = 0; lo <= search; ++lo)
+        {
+            if ((0 == hi && 0 == lo) || maxValue < minValue + hi + lo + 1)
+            {
+                continue;
+            }
+
+            uint64_t candidate;
+            const uint32_t candidateError = bc4Evaluate(candidate, _values, maxValue - hi, minValue + lo);
+            if (candidateError < error)
+            {
+                error = candidateError;
+                indices = candidate;
+                value0 = maxValue - hi;
+                value1 = minValue + lo;
+            }
+        }
+    }
+
+    if (BcQuality::Fast != _quality && 0 != error && minInner <= maxInner)
+    {
+        uint64_t candidate;
+        const uint32_t candidateError = bc4Evaluate(candidate, _values, minInner, maxInner);
+        if (candidateError < error)
+        {
+            error = candidateError;
+            indices = candidate;
+            value0 = minInner;
+            value1 = maxInner;
+        }
+    }
+
+    _dst[0] = uint8_t(value0);
+    _dst[1] = uint8_t(value1);
+    for (uint32_t ii = 0; ii < 6; ++ii)
+    {
+        _dst[2 + ii] = uint8_t(indices >> (ii * 8));
+    }
+}
+
+static void bc4Decode(uint8_t _values[16], const uint8_t _src[8])
+{
+    uint8_t palette[8];
+    bc4Palette(palette, _src[0], _src[1]);
+
+    uint64_t indices = 0;
+    for (uint32_t ii = 0; ii < 6; ++ii)
+    {
+        indices |= uint64_t(_src[2 + ii]) << (ii * 8);
+    }
+
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        _values[ii] = palette[(indices >> (ii * 3)) & 7];
+    }
+}
+
+static const uint8_t *getBc7Weights(uint32_t _indexBits)
+{
+    return 2 == _indexBits ? s_bc7Weight2 : 3 == _indexBits ? s_bc7Weight3 : s_bc7Weight4;
+}
+
+static uint8_t bc7Interpolate(uint32_t _value0, uint32_t _value1, uint32_t _weight)
+{
+    return uint8_t(((64 - _weight) * _value0 + _weight * _value1 + 32) >> 6);
+}
+
+/// Expand `_bits` bit value to 8 bits by replicating high bits.
+static uint8_t bc7Unquantize(uint32_t _value, uint32_t _bits)
+{
+    _value <<= 8 - _bits;
+    return uint8_t(_value | (_value >> _bits));
+}
+
+static uint32_t bc7Subset(uint32_t _numSubsets, uint32_t _partition, uint32_t _pixel)
+{
+    switch (_numSubsets)
+    {
+    case 2:
+        return (s_bc7Partition2[_partition] >> _pixel) & 1;
+    case 3:
+        return s_bc7Partition3[_partition][_pixel];
+    default:
+        return 0;
+    }
+}
+
+static bool bc7IsAnchor(uint32_t _numSubsets, uint32_t _partition, uint32_t _pixel)
+{
+    return 0 == _pixel || (2 == _numSubsets && s_bc7Anchor2[_partition] == _pixel) ||
+           (3 == _numSubsets && (s_bc7Anchor3[0][_partition] == _pixel || s_bc7Anchor3[1][_partition] == _pixel));
+}
+
+static void bc7Decode(uint8_t _block[16][4], const uint8_t _src[16])
+{
+    BitReader reader(_src);
+
+    uint32_t mode = 0;
+    while (mode < 8 && 0 == reader.read(1))
+    {
+        ++mode;
+    }
+
+    if (8 == mode)
+    {
+        // Reserved mode decodes to transparent black.
+        bx::memSet(_block, 0, 64);
+        return;
+    }
+
+    const Bc7Mode &info = s_bc7Mode[mode];
+    const uint32_t partition = reader.read(info.partitionBits);
+    const uint32_t rotation = reader.read(info.rotationBits);
+    const uint32_t indexSelection = reader.read(info.indexSelectionBits);
+    const uint32_t numEndpoints = info.numSubsets * 2;
+
+    uint8_t endpoint[6][4];
+    for (uint32_t ch = 0; ch < 3; ++ch)
+    {
+        for (uint32_t ee = 0; ee < numEndpoints; ++ee)
+        {
+            endpoint[ee][ch] = uint8_t(reader.read(info.colorBits));
+        }
+    }
+
+    for (uint32_t ee = 0; ee < numEndpoints; ++ee)
+    {
+        endpoint[ee][3] = uint8_t(reader.read(info.alphaBits));
+    }
+
+    uint32_t pbit[6] = {};
+    if (0 != info.endpointPBits)
+    {
+        for (uint32_t ee = 0; ee < numEndpoints; ++ee)
+        {
+            pbit[ee] = reader.read(1);
+        }
+    }
+    else if (0 != info.sharedPBits)
+    {
+        for (uint32_t ss = 0; ss < info.numSubsets; ++ss)
+        {
+            pbit[ss * 2 + 0] = pbit[ss * 2 + 1] = reader.read(1);
+        }
+    }
+
+    const uint32_t hasPBit = info.endpointPBits | info.sharedPBits;
+    for (uint32_t ee = 0; ee < numEndpoints; ++ee)
+    {
+        for (uint32_t ch = 0; ch < 3; ++ch)
+        {
+            endpoint[ee][ch] = bc7Unquantize((endpoint[ee][ch] << hasPBit) | pbit[ee], info.colorBits + hasPBit);
+        }
+
+        endpoint[ee][3] = 0 != info.alphaBits
+                              ? bc7Unquantize((endpoint[ee][3] << hasPBit) | pbit[ee], info.alphaBits + hasPBit)
+                              : 255;
+    }
+
+    uint8_t index[16];
+    uint8_t index2[16] = {};
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        index[ii] = uint8_t(reader.read(info.indexBits - (bc7IsAnchor(info.numSubsets, partition, ii) ? 1 : 0)));
+    }
+
+    if (0 != info.indexBits2)
+    {
+        for (uint32_t ii = 0; ii < 16; ++ii)
+        {
+            index2[ii] = uint8_t(reader.read(info.indexBits2 - (0 == ii ? 1 : 0)));
+        }
+    }
+
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        const uint32_t subset = bc7Subset(info.numSubsets, partition, ii);
+        const uint8_t *e0 = endpoint[subset * 2 + 0];
+        const uint8_t *e1 = endpoint[subset * 2 + 1];
+
+        uint32_t colorWeight;
+        uint32_t alphaWeight;
+        if (0 == info.indexBits2)
+        {
+            colorWeight = alphaWeight = getBc7Weights(info.indexBits)[index[ii]];
+        }
+        else if (0 == indexSelection)
+        {
+            colorWeight = getBc7Weights(info.indexBits)[index[ii]];
+            alphaWeight = getBc7Weights(info.indexBits2)[index2[ii]];
+        }
+        else
+        {
+            colorWeight = getBc7Weights(info.indexBits2)[index2[ii]];
+            alphaWeight = getBc7Weights(info.indexBits)[index[ii]];
+        }
+
+        uint8_t *pixel = _block[ii];
+        for (uint32_t ch = 0; ch < 3; ++ch)
+        {
+            pixel[ch] = bc7Interpolate(e0[ch], e1[ch], colorWeight);
+        }
+        pixel[3] = bc7Interpolate(e0[3], e1[3], alphaWeight);
+
+        if (0 != rotation)
+        {
+            bx::swap(pixel[3], pixel[rotation - 1]);
+        }
+    }
+}
+
+/// Endpoints of one BC7 subset, quantized with p-bits.
+struct Bc7Subset
+{
+    uint8_t m_code[2][4]; //!< Quantized endpoints without p-bit.
+    uint8_t m_pbit[2];
+    uint8_t m_color[2][4]; //!< Endpoints as decoder expands them.
+    uint32_t m_error;
+};
+
+/// Quantize float endpoints to `_colorBits` plus p-bit, choosing p-bits with least endpoint error.
+/// Channels past `_numChannels` are opaque alpha.
+static void bc7Quantize(Bc7Subset &_subset, const float _endpoint[2][4], uint32_t _numChannels, uint32_t _colorBits,
+                        bool _sharedPBit)
+{
+    const uint32_t bits = _colorBits + 1;
+    const float scale = float((1 << bits) - 1) / 255.0f;
+    const int32_t maxCode = (1 << _colorBits) - 1;
+
+    uint8_t code[2][2][4];
+    uint8_t color[2][2][4];
+    float error[2][2] = {};
+    for (uint32_t ee = 0; ee < 2; ++ee)
+    {
+        for (uint32_t pp = 0; pp < 2; ++pp)
+        {
+            for (uint32_t ch = 0; ch < 4; ++ch)
+            {
+                if (ch >= _numChannels)
+                {
+                    code[ee][pp][ch] = 0;
+                    color[ee][pp][ch] = 255;
+                    continue;
+                }
+
+                const float value = (_endpoint[ee][ch] * scale - float(pp)) * 0.5f;
+                const int32_t quantized = bx::clamp<int32_t>(int32_t(value + 0.5f), 0, maxCode);
+                code[ee][pp][ch] = uint8_t(quantized);
+                color[ee][pp][ch] = bc7Unquantize((uint32_t(quantized) << 1) | pp, bits);
+
+                const float diff = float(color[ee][pp][ch]) - _endpoint[ee][ch];
+                error[ee][pp] += diff * diff;
+            }
+        }
+    }
+
+    for (uint32_t ee = 0; ee < 2; ++ee)
+    {
+        const uint32_t pp = _sharedPBit ? (error[0][1] + error[1][1] < error[0][0] + error[1][0] ? 1 : 0)
+                                        : (error[ee][1] < error[ee][0] ? 1 : 0);
+        bx::memCopy(_subset.m_code[ee], code[ee][pp], 4);
+        bx::memCopy(_subset.m_color[ee], color[ee][pp], 4);
+        _subset.m_pbit[ee] = uint8_t(pp);
+    }
+}
+
+/// Pick nearest of interpolated colors for each pixel of subset, returns squared error.
+static uint32_t bc7Indices(uint8_t _index[16], const Bc7Subset &_subset, const uint8_t _block[16][4],
+                           const uint8_t *_pixels, uint32_t _num, uint32_t _indexBits)
+{
+    const uint32_t numLevels = 1 << _indexBits;
+    const uint8_t *weights = getBc7Weights(_indexBits);
+
+    uint8_t palette[16][4];
+    for (uint32_t level = 0; level < numLevels; ++level)
+    {
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            palette[level][ch] = bc7Interpolate(_subset.m_color[0][ch], _subset.m_color[1][ch], weights[level]);
+        }
+    }
+
+    // Projection on endpoint line picks two neighbouring levels, nearer of them wins.
+    int32_t dir[4];
+    int32_t lenSq = 0;
+    for (uint32_t ch = 0; ch < 4; ++ch)
+    {
+        dir[ch] = int32_t(_subset.m_color[1][ch]) - int32_t(_subset.m_color[0][ch]);
+        lenSq += dir[ch] * dir[ch];
+    }
+    const float scale = 0 != lenSq ? 64.0f / float(lenSq) : 0.0f;
+
+    uint32_t error = 0;
+    for (uint32_t ii = 0; ii < _num; ++ii)
+    {
+        const uint8_t *pixel = _block[_pixels[ii]];
+
+        int32_t dot = 0;
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            dot += (int32_t(pixel[ch]) - int32_t(_subset.m_color[0][ch])) * dir[ch];
+        }
+        const float weight = float(dot) * scale;
+
+        uint32_t level = 0;
+        while (level + 2 < numLevels && float(weights[level + 1]) <= weight)
+        {
+            ++level;
+        }
+
+        uint32_t best = 0;
+        uint32_t bestError = UINT32_MAX;
+        for (uint32_t end = level + 2; level < end; ++level)
+        {
+            const uint32_t err = square(pixel[0] - palette[level][0]) + square(pixel[1] - palette[level][1]) +
+                                 square(pixel[2] - palette[level][2]) + square(pixel[3] - palette[level][3]);
+            if (err < bestError)
+            {
+                bestError = err;
+                best = level;
+            }
+        }
+
+        _index[_pixels[ii]] = uint8_t(best);
+        error += bestError;
+    }
+    return error;
+}
+
+/// Fit endpoints and indices of one subset, refining endpoints by least squares.
+static void bc7FitSubset(Bc7Subset &_subset, uint8_t _index[16], const uint8_t _block[16][4], const uint8_t *_pixels,
+                         uint32_t _num, uint32_t _numChannels, uint32_t _colorBits, bool _sharedPBit,
+                         uint32_t _indexBits, uint32_t _numIterations)
+{
+    float mean[4];
+    float axis[4];
+    float endpoint[2][4];
+    principalAxis(mean, axis, _block, _pixels, _num, _numChannels);
+    axisEndpoints(endpoint, mean, axis, _block, _pixels, _num);
+
+    const uint8_t *weights = getBc7Weights(_indexBits);
+
+    _subset.m_error = UINT32_MAX;
+    for (uint32_t iter = 0; iter <= _numIterations; ++iter)
+    {
+        Bc7Subset candidate;
+        uint8_t index[16];
+        bc7Quantize(candidate, endpoint, _numChannels, _colorBits, _sharedPBit);
+        candidate.m_error = bc7Indices(index, candidate, _block, _pixels, _num, _indexBits);
+
+        if (candidate.m_error < _subset.m_error)
+        {
+            _subset = candidate;
+            for (uint32_t ii = 0; ii < _num; ++ii)
+            {
+                _index[_pixels[ii]] = index[_pixels[ii]];
+            }
+        }
+
+        if (0 == candidate.m_error || iter == _numIterations)
+        {
+            break;
+        }
+
+        float weight[16];
+        for (uint32_t ii = 0; ii < _num; ++ii)
+        {
+            weight[ii] = float(weights[index[_pixels[ii]]]) / 64.0f;
+        }
+
+        if (!solveEndpoints(endpoint, _block, _pixels, weight, _num, _numChannels))
+        {
+            break;
+        }
+    }
+}
+
+/// Anchor index must have top bit clear, swap endpoints and invert subset indices otherwise.
+static void bc7FixAnchor(Bc7Subset &_subset, uint8_t _index[16], uint32_t _anchor, uint32_t _indexBits,
+                         uint32_t _numSubsets, uint32_t _partition, uint32_t _subsetIdx)
+{
+    const uint32_t maxIndex = (1 << _indexBits) - 1;
+    if (0 == (_index[_anchor] >> (_indexBits - 1)))
+    {
+        return;
+    }
+
+    for (uint32_t ch = 0; ch < 4; ++ch)
+    {
+        bx::swap(_subset.m_code[0][ch], _subset.m_code[1][ch]);
+        bx::swap(_subset.m_color[0][ch], _subset.m_color[1][ch]);
+    }
+    bx::swap(_subset.m_pbit[0], _subset.m_pbit[1]);
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        if (bc7Subset(_numSubsets, _partition, ii) == _subsetIdx)
+        {
+            _index[ii] = uint8_t(maxIndex - _index[ii]);
+        }
+    }
+}
+
+static void bc7WriteIndices(BitWriter &_writer, const uint8_t _index[16], uint32_t _indexBits, uint32_t _numSubsets,
+                            uint32_t _partition)
+{
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        _writer.write(_index[ii], _indexBits - (bc7IsAnchor(_numSubsets, _partition, ii) ? 1 : 0));
+    }
+}
+
+/// Mode 6, one RGBA subset with 7-bit endpoints, per endpoint p-bits and 4-bit indices.
+static uint32_t bc7EncodeMode6(uint8_t _dst[16], const uint8_t _block[16][4], uint32_t _numIterations)
+{
+    static const uint8_t s_all[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+    Bc7Subset subset;
+    uint8_t index[16];
+    bc7FitSubset(subset, index, _block, s_all, 16, 4, 7, false, 4, _numIterations);
+    bc7FixAnchor(subset, index, 0, 4, 1, 0, 0);
+
+    BitWriter writer(_dst, 16);
+    writer.write(1 << 6, 7);
+    for (uint32_t ch = 0; ch < 4; ++ch)
+    {
+        writer.write(subset.m_code[0][ch], 7);
+        writer.write(subset.m_code[1][ch], 7);
+    }
+    writer.write(subset.m_pbit[0], 1);
+    writer.write(subset.m_pbit[1], 1);
+    bc7WriteIndices(writer, index, 4, 1, 0);
+
+    return subset.m_error;
+}
+
+/// Per pixel moments r, g, b, rr, gg, bb, rg, rb, gb, summed by partition ranking.
+static void bc7Moments(int32_t _moment[16][9], const uint8_t _block[16][4])
+{
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        const int32_t rr = _block[ii][0];
+        const int32_t gg = _block[ii][1];
+        const int32_t bb = _block[ii][2];
+        int32_t *moment = _moment[ii];
+        moment[0] = rr;
+        moment[1] = gg;
+        moment[2] = bb;
+        moment[3] = rr * rr;
+        moment[4] = gg * gg;
+        moment[5] = bb * bb;
+        moment[6] = rr * gg;
+        moment[7] = rr * bb;
+        moment[8] = gg * bb;
+    }
+}
+
+/// Sum of squared distances from subset principal axes, quick partition ranking. Residual is
+/// covariance trace less its largest eigenvalue, estimated by Rayleigh quotient after two power
+/// iterations.
+static float bc7PartitionEstimate(const int32_t _moment[16][9], uint32_t _partition)
+{
+    int32_t sum[2][9] = {};
+    int32_t num[2] = {};
+    for (uint32_t ii = 0; ii < 16; ++ii)
+    {
+        const uint32_t subset = (s_bc7Partition2[_partition] >> ii) & 1;
+        for (uint32_t mm = 0; mm < 9; ++mm)
+        {
+            sum[subset][mm] += _moment[ii][mm];
+        }
+        ++num[subset];
+    }
+
+    float estimate = 0.0f;
+    for (uint32_t ss = 0; ss < 2; ++ss)
+    {
+        const int32_t *moment = sum[ss];
+        const float invNum = 1.0f / float(num[ss]);
+        const float mean[3] = {float(moment[0]) * invNum, float(moment[1]) * invNum, float(moment[2]) * invNum};
+        const float crr = float(moment[3]) - mean[0] * float(moment[0]);
+        const float cgg = float(moment[4]) - mean[1] * float(moment[1]);
+        const float cbb = float(moment[5]) - mean[2] * float(moment[2]);
+        const float crg = float(moment[6]) - mean[0] * float(moment[1]);
+        const float crb = float(moment[7]) - mean[0] * float(moment[2]);
+        const float cgb = float(moment[8]) - mean[1] * float(moment[2]);
+
+        const float v1[3] = {crr + crg + crb, crg + cgg + cgb, crb + cgb + cbb};
+        const float v2[3] = {
+            crr * v1[0] + crg * v1[1] + crb * v1[2],
+            crg * v1[0] + cgg * v1[1] + cgb * v1[2],
+            crb * v1[0] + cgb * v1[1] + cbb * v1[2],
+        };
+        const float lenSq = v1[0] * v1[0] + v1[1] * v1[1] + v1[2] * v1[2];
+        const float eigen = lenSq > 1e-6f ? (v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2]) / lenSq : 0.0f;
+
+        estimate += crr + cgg + cbb - eigen;
+    }
+    return estimate;
+}
+
+/// Mode 1, two RGB subsets with 6-bit endpoints, shared p-bit per subset and 3-bit indices.
+static uint32_t bc7EncodeMode1(uint8_t _dst[16], const uint8_t _block[16][4], uint32_t _partition,
+                               uint32_t _numIterations)
+{
+    Bc7Subset subset[2];
+    uint8_t index[16];
+    uint32_t error = 0;
+    for (uint32_t ss = 0; ss < 2; ++ss)
+    {
+        uint8_t pixels[16];
+        uint32_t num = 0;
+        for (uint32_t ii = 0; ii < 16; ++ii)
+        {
+            if (bc7Subset(2, _partition, ii) == ss)
+            {
+                pixels[num++] = uint8_t(ii);
+            }
+        }
+
+        bc7FitSubset(subset[ss], index, _block, pixels, num, 3, 6, true, 3, _numIterations);
+        error += subset[ss].m_error;
+    }
+
+    bc7FixAnchor(subset[0], index, 0, 3, 2, _partition, 0);
+    bc7FixAnchor(subset[1], index, s_bc7Anchor2[_partition], 3, 2, _partition, 1);
+
+    BitWriter writer(_dst, 16);
+    writer.write(1 << 1, 2);
+    writer.write(_partition, 6);
+    for (uint32_t ch = 0; ch < 3; ++ch)
+    {
+        for (uint32_t ss = 0; ss < 2; ++ss)
+        {
+            writer.write(subset[ss].m_code[0][ch], 6);
+            writer.write(subset[ss].m_code[1][ch], 6);
+        }
+    }
+    writer.write(subset[0].m_pbit[0], 1);
+    writer.write(subset[1].m_pbit[0], 1);
+    bc7WriteIndices(writer, index, 3, 2, _partition);
+
+    return error;
+}
+
+static void bc7Encode(uint8_t _dst[16], const uint8_t _block[16][4], BcQuality::Enum _quality)
+{
+    const uint32_t numIterations = kRefineIterations[_quality];
+    uint32_t error = bc7EncodeMode6(_dst, _block, numIterations);
+
+    bool opaque = true;
+    for (uint32_t ii = 0; ii < 16 && opaque; ++ii)
+    {
+        opaque = 255 == _block[ii][3];
+    }
+
+    const uint32_t numCandidates = kBc7Mode1Candidates[_quality];
+    if (!opaque || 0 == numCandidates || 0 == error)
+    {
+        return;
+    }
+
+    // Rank partitions cheaply, full fit only the best few.
+    int32_t moment[16][9];
+    bc7Moments(moment, _block);
+
+    float estimate[64];
+    uint8_t order[64];
+    for (uint32_t pp = 0; pp < 64; ++pp)
+    {
+        estimate[pp] = bc7PartitionEstimate(moment, pp);
+        order[pp] = uint8_t(pp);
+    }
+
+    for (uint32_t ii = 0; ii < numCandidates; ++ii)
+    {
+        for (uint32_t jj = ii + 1; jj < 64; ++jj)
+        {
+            if (estimate[order[jj]] < estimate[order[ii]])
+            {
+                bx::swap(order[ii], order[jj]);
+            }
+        }
+
+        uint8_t candidate[16];
+        const uint32_t candidateError = bc7EncodeMode1(candidate, _block, order[ii], numIterations);
+        if (candidateError < error)
+        {
+            error = candidateError;
+            bx::memCopy(_dst, candidate, 16);
+        }
+    }
+}
+
+static void encodeBlock(uint8_t *_dst, TextureFormat::Enum _format, const uint8_t _block[16][4],
+                        BcQuality::Enum _quality)
+{
+    uint8_t values[16];
+    switch (_format)
+    {
+    case TextureFormat::BC1:
+        bc1EncodeColor(_dst, _block, _quality, true);
+        break;
+
+    case TextureFormat::BC3:
+        for (uint32_t ii = 0; ii < 16; ++ii)
+        {
+            values[ii] = _block[ii][3];
+        }
+        bc4Encode(_dst, values, _quality);
+        bc1EncodeColor(_dst + 8, _block, _quality, false);
+        break;
+
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+        for (uint32_t ch = 0, num = TextureFormat::BC4 == _format ? 1 : 2; ch < num; ++ch)
+        {
+            for (uint32_t ii = 0; ii < 16; ++ii)
+            {
+                values[ii] = _block[ii][ch];
+            }
+            bc4Encode(_dst + ch * 8, values, _quality);
+        }
+        break;
+
+    case TextureFormat::BC7:
+        bc7Encode(_dst, _block, _quality);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void decodeBlock(uint8_t _block[16][4], TextureFormat::Enum _format, const uint8_t *_src)
+{
+    uint8_t values[16];
+    switch (_format)
+    {
+    case TextureFormat::BC1:
+        bc1DecodeColor(_block, _src, false);
+        break;
+
+    case TextureFormat::BC3:
+        bc1DecodeColor(_block, _src + 8, true);
+        bc4Decode(values, _src);
+        for (uint32_t ii = 0; ii < 16; ++ii)
+        {
+            _block[ii][3] = values[ii];
+        }
+        break;
+
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+        bx::memSet(_block, 0, 64);
+        for (uint32_t ch = 0, num = TextureFormat::BC4 == _format ? 1 : 2; ch < num; ++ch)
+        {
+            bc4Decode(values, _src + ch * 8);
+            for (uint32_t ii = 0; ii < 16; ++ii)
+            {
+                _block[ii][ch] = values[ii];
+            }
+        }
+        for (uint32_t ii = 0; ii < 16; ++ii)
+        {
+            _block[ii][3] = 255;
+        }
+        break;
+
+    case TextureFormat::BC7:
+        bc7Decode(_block, _src);
+        break;
+
+    default:
+        bx::memSet(_block, 0, 64);
+        break;
+    }
+}
+
+struct BcEncodeJob
+{
+    uint8_t *m_dst;
+    const uint8_t *m_src;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_srcPitch;
+    uint32_t m_blocksX;
+    uint32_t m_blockBytes;
+    TextureFormat::Enum m_format;
+    BcQuality::Enum m_quality;
+};
+
+static void bcEncodeRows(void *_userData, uint32_t _begin, uint32_t _end)
+{
+    const BcEncodeJob &job = *(const BcEncodeJob *)_userData;
+
+    for (uint32_t by = _begin; by < _end; ++by)
+    {
+        uint8_t *dst = job.m_dst + by * job.m_blocksX * job.m_blockBytes;
+        for (uint32_t bx_ = 0; bx_ < job.m_blocksX; ++bx_, dst += job.m_blockBytes)
+        {
+            uint8_t block[16][4];
+            fetchBlock(block, job.m_src, job.m_srcPitch, bx_ * 4, by * 4, job.m_width, job.m_height);
+            encodeBlock(dst, job.m_format, block, job.m_quality);
+        }
+    }
+}
+
+bool bcIsSupported(TextureFormat::Enum _format)
+{
+    switch (_format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC3:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC7:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t bcGetSize(TextureFormat::Enum _format, uint32_t _width, uint32_t _height)
+{
+    return ((_width + 3) / 4) * ((_height + 3) / 4) * getBlockBytes(_format);
+}
+
+void bcEncode(void *_dst, TextureFormat::Enum _format, const void *_src, uint32_t _width, uint32_t _height,
+              uint32_t _srcPitch, BcQuality::Enum _quality, JobPool *_pool)
+{
+    BX_ASSERT(bcIsSupported(_format), "Format %d isn't block compressed.", _format);
+    BX_ASSERT(_quality < BcQuality::Count, "Invalid quality %d.", _quality);
+
+    BcEncodeJob job;
+    job.m_dst = (uint8_t *)_dst;
+    job.m_src = (const uint8_t *)_src;
+    job.m_width = _width;
+    job.m_height = _height;
+    job.m_srcPitch = _srcPitch;
+    job.m_blocksX = (_width + 3) / 4;
+    job.m_blockBytes = getBlockBytes(_format);
+    job.m_format = _format;
+    job.m_quality = _quality;
+
+    const uint32_t blocksY = (_height + 3) / 4;
+    if (NULL != _pool)
+    {
+        _pool->parallelFor(bcEncodeRows, &job, blocksY);
+    }
+    else
+    {
+        bcEncodeRows(&job, 0, blocksY);
+    }
+}
+
+void bcDecode(void *_dst, uint32_t _dstPitch, TextureFormat::Enum _format, const void *_src, uint32_t _width,
+              uint32_t _height)
+{
+    BX_ASSERT(bcIsSupported(_format), "Format %d isn't block compressed.", _format);
+
+    const uint32_t blockBytes = getBlockBytes(_format);
+    const uint8_t *src = (const uint8_t *)_src;
+    uint8_t *dst = (uint8_t *)_dst;
+
+    for (uint32_t by = 0; by < _height; by += 4)
+    {
+        for (uint32_t bx_ = 0; bx_ < _width; bx_ += 4, src += blockBytes)
+        {
+            uint8_t block[16][4];
+            decodeBlock(block, _format, src);
+
+            // Partial edge blocks write only pixels inside image.
+            for (uint32_t yy = 0, numY = bx::uint32_min(4, _height - by); yy < numY; ++yy)
+            {
+                const uint32_t numX = bx::uint32_min(4, _width - bx_);
+                bx::memCopy(&dst[(by + yy) * _dstPitch + bx_ * 4], block[yy * 4], numX * 4);
+            }
+        }
+    }
+}
+
+bool bcEncodeTexture(void *_dst, TextureFormat::Enum _format, const void *_src, const TextureInfo &_srcInfo,
+                     BcQuality::Enum _quality, JobPool *_pool)
+{
+    if (!bcIsSupported(_format) ||
+        (TextureFormat::RGBA8 != _srcInfo.format && TextureFormat::SRGBA8 != _srcInfo.format))
+    {
+        BX_TRACE("WARNING: Can't encode texture format %d to %d.", _srcInfo.format, _format);
+        return false;
+    }
+
+    const uint8_t *src = (const uint8_t *)_src;
+    uint8_t *dst = (uint8_t *)_dst;
+    for (uint32_t side = 0, numSides = _srcInfo.cubeMap ? 6 : 1; side < numSides; ++side)
+    {
+        for (uint32_t mip = 0; mip < _srcInfo.numMips; ++mip)
+        {
+            const uint32_t width = bx::uint32_max(1, _srcInfo.width >> mip);
+            const uint32_t height = bx::uint32_max(1, _srcInfo.height >> mip);
+
+            bcEncode(dst, _format, src, width, height, width * 4, _quality, _pool);
+            src += width * height * 4;
+            dst += bcGetSize(_format, width, height);
+        }
+    }
+
+    return true;
+}
+
+} // namespace TinyRender
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "tiny_render.h"
+
+namespace TinyRender
+{
+
+struct JobPool;
+
+/// Block compression encoder quality presets.
+struct BcQuality
+{
+    enum Enum
+    {
+        Fast,   //!< Principal axis endpoints, no refinement. BC7 uses mode 6 only.
+        Normal, //!< One least squares refinement. BC7 also tries 4 best mode 1 partitions on opaque blocks.
+        High,   //!< Three refinements and endpoint search. BC7 tries 16 best mode 1 partitions.
+
+        Count
+    };
+};
+
+/// Returns true if `_format` is block compressed format `bcEncode` and `bcDecode` handle.
+bool bcIsSupported(TextureFormat::Enum _format);
+
+/// Size of `_width` x `_height` image in `_format`, rows of 4x4 blocks without padding.
+uint32_t bcGetSize(TextureFormat::Enum _format, uint32_t _width, uint32_t _height);
+
+/// Encode RGBA8 image. BC4 takes red channel, BC5 red and green. BC1 alpha below 128 becomes
+/// transparent. Edge blocks of sizes not multiple of 4 replicate last row and column.
+///
+/// @param[out] _dst Blocks, `bcGetSize` bytes.
+/// @param[in] _format Block compressed format.
+/// @param[in] _src RGBA8 or SRGBA8 pixels, encoded as they are.
+/// @param[in] _width Image width.
+/// @param[in] _height Image height.
+/// @param[in] _srcPitch Bytes between source rows.
+/// @param[in] _quality Encoder preset.
+/// @param[in] _pool Job pool, rows of blocks are encoded in parallel. NULL runs on calling thread.
+///
+void bcEncode(void *_dst, TextureFormat::Enum _format, const void *_src, uint32_t _width, uint32_t _height,
+              uint32_t _srcPitch, BcQuality::Enum _quality, JobPool *_pool);
+
+/// Decode blocks to RGBA8. BC4 decodes to (r, 0, 0, 255) and BC5 to (r, g, 0, 255), like GPU
+/// samples them. All 8 BC7 modes are decoded.
+void bcDecode(void *_dst, uint32_t _dstPitch, TextureFormat::Enum _format, const void *_src, uint32_t _width,
+              uint32_t _height);
+
+/// Encode every side and mip of RGBA8 or SRGBA8 texture, for texture cooking.
+///
+/// @param[out] _dst Texture laid out as described in `calcTextureSize` for `_format` and `_srcInfo`
+///   size, cube map and mips.
+/// @param[in] _src Source texture, `_srcInfo` describes its layout.
+///
+/// @returns False when source or destination format isn't supported.
+///
+bool bcEncodeTexture(void *_dst, TextureFormat::Enum _format, const void *_src, const TextureInfo &_srcInfo,
+                     BcQuality::Enum _quality, JobPool *_pool);
+
+} // namespace TinyRender
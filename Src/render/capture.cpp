@@ -0,0 +1,571 @@
+#include <bx/file.h>
+
+#include "capture.h"
+#include "tiny_render_p.h"
+
+namespace TinyRender
+{
+
+bool CaptureWriter::begin(const char *_filePath)
+{
+    BX_ASSERT(!m_active, "Capture already in progress.");
+
+    m_err.reset();
+    m_active = bx::open(&m_writer, _filePath, false, &m_err);
+    return m_active;
+}
+
+void CaptureWriter::end()
+{
+    if (m_active)
+    {
+        bx::close(&m_writer);
+        m_active = false;
+    }
+}
+
+void CaptureWriter::writeHeader(const InitParams &_init)
+{
+    CaptureHeader header;
+    header.m_magic = TINYRENDER_CAPTURE_MAGIC;
+    header.m_version = TINYRENDER_CAPTURE_VERSION;
+    header.m_width = _init.width;
+    header.m_height = _init.height;
+    header.m_samples = _init.samples;
+    header.m_maxDepth = _init.maxDepth;
+    write(header);
+}
+
+void CaptureWriter::writeData(const void *_data, uint32_t _size)
+{
+    write(_size);
+    bx::write(&m_writer, _data, int32_t(_size), &m_err);
+}
+
+void CaptureWriter::writeRows(const void *_data, uint32_t _rowSize, uint32_t _numRows, uint32_t _pitch)
+{
+    write(_rowSize * _numRows);
+    for (uint32_t ii = 0; ii < _numRows; ++ii)
+    {
+        bx::write(&m_writer, (const uint8_t *)_data + ii * _pitch, int32_t(_rowSize), &m_err);
+    }
+}
+
+void CaptureWriter::writeMtx(const void *_mtx)
+{
+    write(uint8_t(NULL != _mtx));
+    if (NULL != _mtx)
+    {
+        bx::write(&m_writer, _mtx, int32_t(16 * sizeof(float)), &m_err);
+    }
+}
+
+CaptureReplay::CaptureReplay() : m_data(NULL), m_size(0), m_pos(0), m_error(false) {}
+
+CaptureReplay::~CaptureReplay()
+{
+    close();
+}
+
+bool CaptureReplay::open(const char *_filePath, InitParams &_init)
+{
+    close();
+
+    bx::FileReader reader;
+    if (!bx::open(&reader, _filePath))
+    {
+        return false;
+    }
+
+    const int64_t size = bx::getSize(&reader);
+    if (int64_t(sizeof(CaptureHeader)) > size || INT32_MAX < size)
+    {
+        bx::close(&reader);
+        return false;
+    }
+
+    m_size = uint32_t(size);
+    m_data = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Command), m_size);
+
+    bx::Error err;
+    bx::read(&reader, m_data, int32_t(m_size), &err);
+    bx::close(&reader);
+
+    CaptureHeader header;
+    bx::memCopy(&header, m_data, sizeof(header));
+    if (!err.isOk() || TINYRENDER_CAPTURE_MAGIC != header.m_magic || TINYRENDER_CAPTURE_VERSION != header.m_version)
+    {
+        close();
+        return false;
+    }
+
+    _init.width = header.m_width;
+    _init.height = header.m_height;
+    _init.samples = header.m_samples;
+    _init.maxDepth = header.m_maxDepth;
+
+    m_pos = sizeof(header);
+    m_error = false;
+
+    bx::memSet(m_vertexBuffers, 0xff, sizeof(m_vertexBuffers));
+    bx::memSet(m_indexBuffers, 0xff, sizeof(m_indexBuffers));
+    bx::memSet(m_dynamicVertexBuffers, 0xff, sizeof(m_dynamicVertexBuffers));
+    bx::memSet(m_dynamicIndexBuffers, 0xff, sizeof(m_dynamicIndexBuffers));
+    bx::memSet(m_shaders, 0xff, sizeof(m_shaders));
+    bx::memSet(m_programs, 0xff, sizeof(m_programs));
+    bx::memSet(m_psos, 0xff, sizeof(m_psos));
+    bx::memSet(m_frameBuffers, 0xff, sizeof(m_frameBuffers));
+    bx::memSet(m_textures, 0xff, sizeof(m_textures));
+
+    return true;
+}
+
+void CaptureReplay::close()
+{
+    if (NULL != m_data)
+    {
+        bx::free(getAllocator(MemoryCategory::Command), m_data);
+        m_data = NULL;
+        m_size = 0;
+        m_pos = 0;
+    }
+}
+
+const uint8_t *CaptureReplay::read(uint32_t _size)
+{
+    // Truncated record reads zeros, caller checks `m_error` before acting on it.
+    static const uint8_t s_zero[128] = {};
+
+    if (m_error || m_size - m_pos < _size)
+    {
+        BX_ASSERT(_size <= sizeof(s_zero), "Read past end of capture.");
+        m_error = true;
+        return s_zero;
+    }
+
+    const uint8_t *data = &m_data[m_pos];
+    m_pos += _size;
+    return data;
+}
+
+const uint8_t *CaptureReplay::readData(uint32_t &_size)
+{
+    _size = read<uint32_t>();
+    if (m_error || m_size - m_pos < _size)
+    {
+        m_error = true;
+        _size = 0;
+        return NULL;
+    }
+
+    return read(_size);
+}
+
+const float *CaptureReplay::readMtx()
+{
+    return 0 != read<uint8_t>() ? (const float *)read(16 * sizeof(float)) : NULL;
+}
+
+bool CaptureReplay::replayFrame()
+{
+    while (!m_error && m_pos < m_size)
+    {
+        const uint8_t cmd = read<uint8_t>();
+
+        switch (cmd)
+        {
+        case CaptureCmd::CreateVertexBuffer: {
+            const uint16_t idx = read<uint16_t>();
+            const VertexLayout layout = read<VertexLayout>();
+            const uint16_t flags = read<uint16_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && idx < BX_COUNTOF(m_vertexBuffers))
+            {
+                m_vertexBuffers[idx] = createVertexBuffer(data, size, layout, flags).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateIndexBuffer: {
+            const uint16_t idx = read<uint16_t>();
+            const uint16_t flags = read<uint16_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && idx < BX_COUNTOF(m_indexBuffers))
+            {
+                m_indexBuffers[idx] = createIndexBuffer(data, size, flags).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateShader: {
+            const uint16_t idx = read<uint16_t>();
+            const ShaderType type = ShaderType(read<uint8_t>());
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && idx < BX_COUNTOF(m_shaders))
+            {
+                m_shaders[idx] = createShader(data, size, type).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateProgram: {
+            const uint16_t idx = read<uint16_t>();
+            const ShaderHandle vsh = readHandle<ShaderHandle>(m_shaders);
+            const ShaderHandle fsh = readHandle<ShaderHandle>(m_shaders);
+            if (!m_error && idx < BX_COUNTOF(m_programs))
+            {
+                m_programs[idx] = createProgram(vsh, fsh).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::CreatePSO: {
+            const uint16_t idx = read<uint16_t>();
+            const ProgramHandle program = readHandle<ProgramHandle>(m_programs);
+            const VertexLayout layout = read<VertexLayout>();
+            const uint64_t flags = read<uint64_t>();
+            if (!m_error && idx < BX_COUNTOF(m_psos))
+            {
+                m_psos[idx] = createPSO(program, layout, flags).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::SetViewTransform: {
+            const ViewId id = read<ViewId>();
+            const float *view = readMtx();
+            const float *proj = readMtx();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS)
+            {
+                setViewTransform(id, view, proj);
+            }
+        }
+        break;
+
+        case CaptureCmd::SetViewRect: {
+            const ViewId id = read<ViewId>();
+            const uint16_t x = read<uint16_t>();
+            const uint16_t y = read<uint16_t>();
+            const uint16_t width = read<uint16_t>();
+            const uint16_t height = read<uint16_t>();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS)
+            {
+                setViewRect(id, x, y, width, height);
+            }
+        }
+        break;
+
+        case CaptureCmd::Touch: {
+            const ViewId id = read<ViewId>();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS)
+            {
+                touch(id);
+            }
+        }
+        break;
+
+        case CaptureCmd::EndFrame:
+            endFrame();
+            return true;
+
+        case CaptureCmd::DrawMesh: {
+            const ViewId id = read<ViewId>();
+            const VertexBufferHandle vbh = readHandle<VertexBufferHandle>(m_vertexBuffers);
+            const IndexBufferHandle ibh = readHandle<IndexBufferHandle>(m_indexBuffers);
+            const uint32_t first = read<uint32_t>();
+            const uint32_t num = read<uint32_t>();
+            const ProgramHandle program = readHandle<ProgramHandle>(m_programs);
+            const PSOHandle pso = readHandle<PSOHandle>(m_psos);
+            const uint64_t state = read<uint64_t>();
+            const float *mtx = readMtx();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS && isValid(vbh))
+            {
+                drawMesh(id, vbh, ibh, first, num, program, pso, state, mtx);
+            }
+        }
+        break;
+
+        case CaptureCmd::DrawMeshTransient: {
+            const ViewId id = read<ViewId>();
+            const VertexLayout layout = read<VertexLayout>();
+            uint32_t vertexSize;
+            const uint8_t *vertexData = readData(vertexSize);
+            const bool hasIb = 0 != read<uint8_t>();
+            const bool index16 = 0 != read<uint8_t>();
+            uint32_t indexSize;
+            const uint8_t *indexData = readData(indexSize);
+            const ProgramHandle program = readHandle<ProgramHandle>(m_programs);
+            const PSOHandle pso = readHandle<PSOHandle>(m_psos);
+            const uint64_t state = read<uint64_t>();
+            const float *mtx = readMtx();
+            if (m_error || 0 == layout.m_stride || id >= BGFX_CONFIG_MAX_VIEWS)
+            {
+                break;
+            }
+
+            TransientVertexBuffer tvb;
+            TransientIndexBuffer tib;
+            if (!allocTransientVertexBuffer(&tvb, vertexSize / layout.m_stride, layout))
+            {
+                break;
+            }
+            bx::memCopy(tvb.data, vertexData, tvb.size);
+
+            if (hasIb)
+            {
+                if (!allocTransientIndexBuffer(&tib, indexSize / (index16 ? 2 : 4), !index16))
+                {
+                    break;
+                }
+                bx::memCopy(tib.data, indexData, tib.size);
+            }
+
+            drawMesh(id, &tvb, hasIb ? &tib : NULL, program, pso, state, mtx);
+        }
+        break;
+
+        case CaptureCmd::CreateDynamicVertexBuffer: {
+            const uint16_t idx = read<uint16_t>();
+            const uint32_t num = read<uint32_t>();
+            const VertexLayout layout = read<VertexLayout>();
+            const uint16_t flags = read<uint16_t>();
+            if (!m_error && idx < BX_COUNTOF(m_dynamicVertexBuffers))
+            {
+                m_dynamicVertexBuffers[idx] = createDynamicVertexBuffer(num, layout, flags).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateDynamicIndexBuffer: {
+            const uint16_t idx = read<uint16_t>();
+            const uint32_t num = read<uint32_t>();
+            const uint16_t flags = read<uint16_t>();
+            if (!m_error && idx < BX_COUNTOF(m_dynamicIndexBuffers))
+            {
+                m_dynamicIndexBuffers[idx] = createDynamicIndexBuffer(num, flags).idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::UpdateDynamicVertexBuffer: {
+            const DynamicVertexBufferHandle handle = readHandle<DynamicVertexBufferHandle>(m_dynamicVertexBuffers);
+            const uint32_t start = read<uint32_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && isValid(handle))
+            {
+                update(handle, start, data, size);
+            }
+        }
+        break;
+
+        case CaptureCmd::UpdateDynamicIndexBuffer: {
+            const DynamicIndexBufferHandle handle = readHandle<DynamicIndexBufferHandle>(m_dynamicIndexBuffers);
+            const uint32_t start = read<uint32_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && isValid(handle))
+            {
+                update(handle, start, data, size);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyDynamicVertexBuffer: {
+            const DynamicVertexBufferHandle handle = readHandle<DynamicVertexBufferHandle>(m_dynamicVertexBuffers);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyDynamicIndexBuffer: {
+            const DynamicIndexBufferHandle handle = readHandle<DynamicIndexBufferHandle>(m_dynamicIndexBuffers);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::DrawMeshDynamic: {
+            const ViewId id = read<ViewId>();
+            const DynamicVertexBufferHandle dvbh = readHandle<DynamicVertexBufferHandle>(m_dynamicVertexBuffers);
+            const DynamicIndexBufferHandle dibh = readHandle<DynamicIndexBufferHandle>(m_dynamicIndexBuffers);
+            const uint32_t first = read<uint32_t>();
+            const uint32_t num = read<uint32_t>();
+            const ProgramHandle program = readHandle<ProgramHandle>(m_programs);
+            const PSOHandle pso = readHandle<PSOHandle>(m_psos);
+            const uint64_t state = read<uint64_t>();
+            const float *mtx = readMtx();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS && isValid(dvbh) && isValid(dibh))
+            {
+                drawMesh(id, dvbh, dibh, first, num, program, pso, state, mtx);
+            }
+        }
+        break;
+
+        case CaptureCmd::DrawMeshDynamicVb: {
+            const ViewId id = read<ViewId>();
+            const DynamicVertexBufferHandle dvbh = readHandle<DynamicVertexBufferHandle>(m_dynamicVertexBuffers);
+            const IndexBufferHandle ibh = readHandle<IndexBufferHandle>(m_indexBuffers);
+            const uint32_t first = read<uint32_t>();
+            const uint32_t num = read<uint32_t>();
+            const ProgramHandle program = readHandle<ProgramHandle>(m_programs);
+            const PSOHandle pso = readHandle<PSOHandle>(m_psos);
+            const uint64_t state = read<uint64_t>();
+            const float *mtx = readMtx();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS && isValid(dvbh))
+            {
+                drawMesh(id, dvbh, ibh, first, num, program, pso, state, mtx);
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateFrameBuffer: {
+            const uint16_t idx = read<uint16_t>();
+            const uint16_t width = read<uint16_t>();
+            const uint16_t height = read<uint16_t>();
+            const uint8_t format = read<uint8_t>();
+            const uint8_t depthFormat = read<uint8_t>();
+            if (!m_error && idx < BX_COUNTOF(m_frameBuffers) && format < TextureFormat::Count &&
+                depthFormat <= TextureFormat::Count)
+            {
+                m_frameBuffers[idx] = createFrameBuffer(width, height, TextureFormat::Enum(format),
+                                                        TextureFormat::Enum(depthFormat))
+                                          .idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyFrameBuffer: {
+            const FrameBufferHandle handle = readHandle<FrameBufferHandle>(m_frameBuffers);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::SetViewFrameBuffer: {
+            const ViewId id = read<ViewId>();
+            const FrameBufferHandle handle = readHandle<FrameBufferHandle>(m_frameBuffers);
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS)
+            {
+                setViewFrameBuffer(id, handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::CreateTexture: {
+            const uint16_t idx = read<uint16_t>();
+            const uint16_t width = read<uint16_t>();
+            const uint16_t height = read<uint16_t>();
+            const bool cubeMap = 0 != read<uint8_t>();
+            const bool hasMips = 0 != read<uint8_t>();
+            const uint8_t format = read<uint8_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && idx < BX_COUNTOF(m_textures) && format < TextureFormat::Count &&
+                !isDepth(TextureFormat::Enum(format)))
+            {
+                m_textures[idx] =
+                    (cubeMap ? createTextureCube(width, hasMips, TextureFormat::Enum(format), 0 != size ? data : NULL,
+                                                 size)
+                             : createTexture2D(width, height, hasMips, TextureFormat::Enum(format),
+                                               0 != size ? data : NULL, size))
+                        .idx;
+            }
+        }
+        break;
+
+        case CaptureCmd::UpdateTexture2D: {
+            const TextureHandle handle = readHandle<TextureHandle>(m_textures);
+            const uint8_t mip = read<uint8_t>();
+            const uint16_t x = read<uint16_t>();
+            const uint16_t y = read<uint16_t>();
+            const uint16_t width = read<uint16_t>();
+            const uint16_t height = read<uint16_t>();
+            uint32_t size;
+            const uint8_t *data = readData(size);
+            if (!m_error && isValid(handle) && 0 != height)
+            {
+                updateTexture2D(handle, mip, x, y, width, height, data, UINT32_MAX);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyTexture: {
+            const TextureHandle handle = readHandle<TextureHandle>(m_textures);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyVertexBuffer: {
+            const VertexBufferHandle handle = readHandle<VertexBufferHandle>(m_vertexBuffers);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyIndexBuffer: {
+            const IndexBufferHandle handle = readHandle<IndexBufferHandle>(m_indexBuffers);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::DestroyShader: {
+            const ShaderHandle handle = readHandle<ShaderHandle>(m_shaders);
+            if (!m_error && isValid(handle))
+            {
+                destroy(handle);
+            }
+        }
+        break;
+
+        case CaptureCmd::SetViewMode: {
+            const ViewId id = read<ViewId>();
+            const uint8_t mode = read<uint8_t>();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS && mode < ViewMode::Count)
+            {
+                setViewMode(id, ViewMode::Enum(mode));
+            }
+        }
+        break;
+
+        case CaptureCmd::SetViewClear: {
+            const ViewId id = read<ViewId>();
+            const uint16_t flags = read<uint16_t>();
+            const uint32_t rgba = read<uint32_t>();
+            const float depth = read<float>();
+            const uint8_t stencil = read<uint8_t>();
+            if (!m_error && id < BGFX_CONFIG_MAX_VIEWS)
+            {
+                setViewClear(id, flags, rgba, depth, stencil);
+            }
+        }
+        break;
+
+        default:
+            BX_TRACE("Invalid capture command %d at offset %d.", cmd, m_pos - 1);
+            m_error = true;
+            break;
+        }
+    }
+
+    return false;
+}
+
+} // namespace TinyRender
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <bx/file.h>
+
+#include "tiny_render.h"
+
+namespace TinyRender
+{
+
+/// Capture file is `CaptureHeader` followed by records. Record is `CaptureCmd` byte followed by
+/// command arguments in call order. Buffers are stored as `uint32_t` size followed by data,
+/// matrices as `uint8_t` presence flag followed by 16 floats.
+///
+#define TINYRENDER_CAPTURE_MAGIC BX_MAKEFOURCC('T', 'R', 'C', 'P')
+#define TINYRENDER_CAPTURE_VERSION 8
+
+struct CaptureHeader
+{
+    uint32_t m_magic;
+    uint32_t m_version;
+    int32_t m_width;
+    int32_t m_height;
+    int32_t m_samples;
+    int32_t m_maxDepth;
+};
+
+struct CaptureCmd
+{
+    enum Enum
+    {
+        CreateVertexBuffer,         //!< handle, layout, flags, data
+        CreateIndexBuffer,          //!< handle, flags, data
+        CreateShader,               //!< handle, type, data
+        CreateProgram,              //!< handle, vsh, fsh
+        CreatePSO,                  //!< handle, program, layout, flags
+        SetViewTransform,           //!< id, view mtx, proj mtx
+        SetViewRect,                //!< id, x, y, width, height
+        Touch,                      //!< id
+        EndFrame,                   //!<
+        DrawMesh,                   //!< id, vbh, ibh, first, num, program, pso, state, mtx
+        DrawMeshTransient,          //!< id, stride, vertex data, has ib, index16, index data, program, pso, state, mtx
+        CreateDynamicVertexBuffer,  //!< handle, num, layout, flags
+        CreateDynamicIndexBuffer,   //!< handle, num, flags
+        UpdateDynamicVertexBuffer,  //!< handle, start, data
+        UpdateDynamicIndexBuffer,   //!< handle, start, data
+        DestroyDynamicVertexBuffer, //!< handle
+        DestroyDynamicIndexBuffer,  //!< handle
+        DrawMeshDynamic,            //!< id, dvbh, dibh, first, num, program, pso, state, mtx
+        DrawMeshDynamicVb,          //!< id, dvbh, ibh, first, num, program, pso, state, mtx
+        CreateFrameBuffer,          //!< handle, width, height, format, depth format
+        DestroyFrameBuffer,         //!< handle
+        SetViewFrameBuffer,         //!< id, handle
+        SetViewMode,                //!< id, mode
+        SetViewClear,               //!< id, flags, rgba, depth, stencil
+        CreateTexture,              //!< handle, width, height, cube map, has mips, format, data
+        UpdateTexture2D,            //!< handle, mip, x, y, width, height, data
+        DestroyTexture,             //!< handle
+        DestroyVertexBuffer,        //!< handle
+        DestroyIndexBuffer,         //!< handle
+        DestroyShader,              //!< handle
+
+        Count
+    };
+};
+
+/// Records public API calls. Used by `tiny_render.cpp` wrappers, see `captureBegin`.
+struct CaptureWriter
+{
+    CaptureWriter() : m_active(false) {}
+
+    bool begin(const char *_filePath);
+    void end();
+
+    bool isActive() const
+    {
+        return m_active;
+    }
+
+    void writeHeader(const InitParams &_init);
+
+    void cmd(CaptureCmd::Enum _cmd)
+    {
+        write(uint8_t(_cmd));
+    }
+
+    template <typename Ty> void write(const Ty &_value)
+    {
+        bx::write(&m_writer, &_value, int32_t(sizeof(Ty)), &m_err);
+    }
+
+    void writeData(const void *_data, uint32_t _size);
+
+    /// Write `_numRows` rows `_pitch` bytes apart as one buffer without row padding.
+    void writeRows(const void *_data, uint32_t _rowSize, uint32_t _numRows, uint32_t _pitch);
+
+    void writeMtx(const void *_mtx);
+
+    bx::FileWriter m_writer;
+    bx::Error m_err;
+    bool m_active;
+};
+
+/// Replays capture file against current renderer. Whole file is loaded into memory, so replay
+/// speed doesn't depend on disk. Handles are remapped, replay can run on renderer that already
+/// has resources.
+///
+struct CaptureReplay
+{
+    CaptureReplay();
+    ~CaptureReplay();
+
+    /// Load capture. `_init` receives capture init params, `hwnd` is left untouched.
+    bool open(const char *_filePath, InitParams &_init);
+
+    void close();
+
+    /// Replay commands up to and including next `endFrame`.
+    ///
+    /// @returns `false` when capture is exhausted or corrupt.
+    ///
+    bool replayFrame();
+
+    template <typename Ty> Ty read()
+    {
+        Ty value;
+        bx::memCopy(&value, read(sizeof(Ty)), sizeof(Ty));
+        return value;
+    }
+
+    const uint8_t *read(uint32_t _size);
+    const uint8_t *readData(uint32_t &_size);
+    const float *readMtx();
+
+    template <typename HandleT, uint32_t NumT> HandleT readHandle(const uint16_t (&_map)[NumT])
+    {
+        const uint16_t idx = read<uint16_t>();
+        HandleT handle = {idx < NumT ? _map[idx] : kInvalidHandle};
+        return handle;
+    }
+
+    uint8_t *m_data;
+    uint32_t m_size;
+    uint32_t m_pos;
+    bool m_error;
+
+    uint16_t m_vertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+    uint16_t m_indexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
+    uint16_t m_dynamicVertexBuffers[BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS];
+    uint16_t m_dynamicIndexBuffers[BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS];
+    uint16_t m_shaders[BGFX_CONFIG_MAX_SHADERS];
+    uint16_t m_programs[BGFX_CONFIG_MAX_PROGRAMS];
+    uint16_t m_psos[BGFX_CONFIG_MAX_PSOS];
+    uint16_t m_frameBuffers[BGFX_CONFIG_MAX_FRAME_BUFFERS];
+    uint16_t m_textures[BGFX_CONFIG_MAX_TEXTURES];
+};
+
+} // namespace TinyRender
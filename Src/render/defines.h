@@ -32,6 +32,172 @@
 	)
 
 
+#define BGFX_STATE_WRITE_R                        UINT64_C(0x0000000000000001) //!< Enable R write.
+#define BGFX_STATE_WRITE_G                        UINT64_C(0x0000000000000002) //!< Enable G write.
+#define BGFX_STATE_WRITE_B                        UINT64_C(0x0000000000000004) //!< Enable B write.
+#define BGFX_STATE_WRITE_A                        UINT64_C(0x0000000000000008) //!< Enable alpha write.
+#define BGFX_STATE_WRITE_Z                        UINT64_C(0x0000004000000000) //!< Enable depth write.
+/// Enable RGB write.
+#define BGFX_STATE_WRITE_RGB (0 \
+	| BGFX_STATE_WRITE_R \
+	| BGFX_STATE_WRITE_G \
+	| BGFX_STATE_WRITE_B \
+	)
+
+/// Write all channels mask.
+#define BGFX_STATE_WRITE_MASK (0 \
+	| BGFX_STATE_WRITE_RGB \
+	| BGFX_STATE_WRITE_A \
+	| BGFX_STATE_WRITE_Z \
+	)
+
+#define BGFX_STATE_DEPTH_TEST_LESS                UINT64_C(0x0000000000000010) //!< Enable depth test, less.
+#define BGFX_STATE_DEPTH_TEST_LEQUAL              UINT64_C(0x0000000000000020) //!< Enable depth test, less or equal.
+#define BGFX_STATE_DEPTH_TEST_EQUAL               UINT64_C(0x0000000000000030) //!< Enable depth test, equal.
+#define BGFX_STATE_DEPTH_TEST_GEQUAL              UINT64_C(0x0000000000000040) //!< Enable depth test, greater or equal.
+#define BGFX_STATE_DEPTH_TEST_GREATER             UINT64_C(0x0000000000000050) //!< Enable depth test, greater.
+#define BGFX_STATE_DEPTH_TEST_NOTEQUAL            UINT64_C(0x0000000000000060) //!< Enable depth test, not equal.
+#define BGFX_STATE_DEPTH_TEST_NEVER               UINT64_C(0x0000000000000070) //!< Enable depth test, never.
+#define BGFX_STATE_DEPTH_TEST_ALWAYS              UINT64_C(0x0000000000000080) //!< Enable depth test, always.
+#define BGFX_STATE_DEPTH_TEST_SHIFT               4                            //!< Depth test state bit shift
+#define BGFX_STATE_DEPTH_TEST_MASK                UINT64_C(0x00000000000000f0) //!< Depth test state bit mask
+
+/**
+ * Use BGFX_STATE_BLEND_FUNC(_src, _dst) or BGFX_STATE_BLEND_FUNC_SEPARATE(_srcRGB, _dstRGB, _srcA, _dstA)
+ * helper macros.
+ *
+ */
+#define BGFX_STATE_BLEND_ZERO                     UINT64_C(0x0000000000001000) //!< 0, 0, 0, 0
+#define BGFX_STATE_BLEND_ONE                      UINT64_C(0x0000000000002000) //!< 1, 1, 1, 1
+#define BGFX_STATE_BLEND_SRC_COLOR                UINT64_C(0x0000000000003000) //!< Rs, Gs, Bs, As
+#define BGFX_STATE_BLEND_INV_SRC_COLOR            UINT64_C(0x0000000000004000) //!< 1-Rs, 1-Gs, 1-Bs, 1-As
+#define BGFX_STATE_BLEND_SRC_ALPHA                UINT64_C(0x0000000000005000) //!< As, As, As, As
+#define BGFX_STATE_BLEND_INV_SRC_ALPHA            UINT64_C(0x0000000000006000) //!< 1-As, 1-As, 1-As, 1-As
+#define BGFX_STATE_BLEND_DST_ALPHA                UINT64_C(0x0000000000007000) //!< Ad, Ad, Ad, Ad
+#define BGFX_STATE_BLEND_INV_DST_ALPHA            UINT64_C(0x0000000000008000) //!< 1-Ad, 1-Ad, 1-Ad ,1-Ad
+#define BGFX_STATE_BLEND_DST_COLOR                UINT64_C(0x0000000000009000) //!< Rd, Gd, Bd, Ad
+#define BGFX_STATE_BLEND_INV_DST_COLOR            UINT64_C(0x000000000000a000) //!< 1-Rd, 1-Gd, 1-Bd, 1-Ad
+#define BGFX_STATE_BLEND_SRC_ALPHA_SAT            UINT64_C(0x000000000000b000) //!< f, f, f, 1; f = min(As, 1-Ad)
+#define BGFX_STATE_BLEND_FACTOR                   UINT64_C(0x000000000000c000) //!< Blend factor
+#define BGFX_STATE_BLEND_INV_FACTOR               UINT64_C(0x000000000000d000) //!< 1-Blend factor
+#define BGFX_STATE_BLEND_SHIFT                    12                           //!< Blend state bit shift
+#define BGFX_STATE_BLEND_MASK                     UINT64_C(0x000000000ffff000) //!< Blend state bit mask
+
+/**
+ * Use BGFX_STATE_BLEND_EQUATION(_equation) or BGFX_STATE_BLEND_EQUATION_SEPARATE(_equationRGB, _equationA)
+ * helper macros.
+ *
+ */
+#define BGFX_STATE_BLEND_EQUATION_ADD             UINT64_C(0x0000000000000000) //!< Blend add: src + dst.
+#define BGFX_STATE_BLEND_EQUATION_SUB             UINT64_C(0x0000000010000000) //!< Blend subtract: src - dst.
+#define BGFX_STATE_BLEND_EQUATION_REVSUB          UINT64_C(0x0000000020000000) //!< Blend reverse subtract: dst - src.
+#define BGFX_STATE_BLEND_EQUATION_MIN             UINT64_C(0x0000000030000000) //!< Blend min: min(src, dst).
+#define BGFX_STATE_BLEND_EQUATION_MAX             UINT64_C(0x0000000040000000) //!< Blend max: max(src, dst).
+#define BGFX_STATE_BLEND_EQUATION_SHIFT           28                           //!< Blend equation bit shift
+#define BGFX_STATE_BLEND_EQUATION_MASK            UINT64_C(0x00000003f0000000) //!< Blend equation bit mask
+
+/**
+ * Cull state. When `BGFX_STATE_CULL_*` is not specified culling is disabled.
+ *
+ */
+#define BGFX_STATE_CULL_CW                        UINT64_C(0x0000001000000000) //!< Cull clockwise triangles.
+#define BGFX_STATE_CULL_CCW                       UINT64_C(0x0000002000000000) //!< Cull counter-clockwise triangles.
+#define BGFX_STATE_CULL_SHIFT                     36                           //!< Culling mode bit shift
+#define BGFX_STATE_CULL_MASK                      UINT64_C(0x0000003000000000) //!< Culling mode bit mask
+
+#define BGFX_STATE_FRONT_CCW                      UINT64_C(0x0000008000000000) //!< Front counter-clockwise (default is clockwise).
+#define BGFX_STATE_BLEND_ALPHA_TO_COVERAGE        UINT64_C(0x0000000800000000) //!< Enable alpha to coverage.
+#define BGFX_STATE_MSAA                           UINT64_C(0x0100000000000000) //!< Enable MSAA rasterization, line antialiasing until MSAA targets exist.
+
+/**
+ * Primitive type. When `BGFX_STATE_PT_*` is not specified primitive type is triangle list. Indexed
+ * strips restart at index 0xffff, or 0xffffffff with 32-bit indices.
+ *
+ */
+#define BGFX_STATE_PT_TRISTRIP                    UINT64_C(0x0001000000000000) //!< Tristrip.
+#define BGFX_STATE_PT_LINES                       UINT64_C(0x0002000000000000) //!< Lines.
+#define BGFX_STATE_PT_LINESTRIP                   UINT64_C(0x0003000000000000) //!< Line strip.
+#define BGFX_STATE_PT_POINTS                      UINT64_C(0x0004000000000000) //!< Points.
+#define BGFX_STATE_PT_SHIFT                       48                           //!< Primitive type bit shift
+#define BGFX_STATE_PT_MASK                        UINT64_C(0x0007000000000000) //!< Primitive type bit mask
+
+#define BGFX_STATE_RESERVED_SHIFT                 61                           //!< Internal bits shift
+#define BGFX_STATE_RESERVED_MASK                  UINT64_C(0xe000000000000000) //!< Internal bits mask
+
+#define BGFX_STATE_NONE                           UINT64_C(0x0000000000000000) //!< No state.
+
+/// Default state is write to RGB, alpha, and depth with depth test less enabled, with clockwise
+/// culling and MSAA (when writing into MSAA frame buffer, which can't be created yet, otherwise this
+/// flag only enables line antialiasing).
+#define BGFX_STATE_DEFAULT (0 \
+	| BGFX_STATE_WRITE_RGB \
+	| BGFX_STATE_WRITE_A \
+	| BGFX_STATE_WRITE_Z \
+	| BGFX_STATE_DEPTH_TEST_LESS \
+	| BGFX_STATE_CULL_CW \
+	| BGFX_STATE_MSAA \
+	)
+
+/// Blend function separate.
+#define BGFX_STATE_BLEND_FUNC_SEPARATE(_srcRGB, _dstRGB, _srcA, _dstA) (UINT64_C(0) \
+	| ( ( (uint64_t)(_srcRGB)|( (uint64_t)(_dstRGB)<<4) )   )               \
+	| ( ( (uint64_t)(_srcA  )|( (uint64_t)(_dstA  )<<4) )<<8)               \
+	)
+
+/// Blend equation separate.
+#define BGFX_STATE_BLEND_EQUATION_SEPARATE(_equationRGB, _equationA) ( (uint64_t)(_equationRGB)|( (uint64_t)(_equationA)<<3) )
+
+/// Blend function.
+#define BGFX_STATE_BLEND_FUNC(_src, _dst) BGFX_STATE_BLEND_FUNC_SEPARATE(_src, _dst, _src, _dst)
+
+/// Blend equation.
+#define BGFX_STATE_BLEND_EQUATION(_equation) BGFX_STATE_BLEND_EQUATION_SEPARATE(_equation, _equation)
+
+/// Utility predefined blend modes.
+
+/// Additive blending.
+#define BGFX_STATE_BLEND_ADD (0                                         \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ONE) \
+	)
+
+/// Alpha blend.
+#define BGFX_STATE_BLEND_ALPHA (0                                                       \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA) \
+	)
+
+/// Selects darker color of blend.
+#define BGFX_STATE_BLEND_DARKEN (0                                      \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ONE) \
+	| BGFX_STATE_BLEND_EQUATION(BGFX_STATE_BLEND_EQUATION_MIN)          \
+	)
+
+/// Selects lighter color of blend.
+#define BGFX_STATE_BLEND_LIGHTEN (0                                     \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ONE) \
+	| BGFX_STATE_BLEND_EQUATION(BGFX_STATE_BLEND_EQUATION_MAX)          \
+	)
+
+/// Multiplies colors.
+#define BGFX_STATE_BLEND_MULTIPLY (0                                           \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_DST_COLOR, BGFX_STATE_BLEND_ZERO) \
+	)
+
+/// Opaque pixels will cover the pixels directly below them without any math or algorithm applied to them.
+#define BGFX_STATE_BLEND_NORMAL (0                                                \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_INV_SRC_ALPHA) \
+	)
+
+/// Multiplies the inverse of the blend and base colors.
+#define BGFX_STATE_BLEND_SCREEN (0                                                \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_INV_SRC_COLOR) \
+	)
+
+/// Decreases the brightness of the base color based on the value of the blend color.
+#define BGFX_STATE_BLEND_LINEAR_BURN (0                                                 \
+	| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_DST_COLOR, BGFX_STATE_BLEND_INV_DST_COLOR) \
+	| BGFX_STATE_BLEND_EQUATION(BGFX_STATE_BLEND_EQUATION_SUB)                          \
+	)
+
 #define BGFX_CLEAR_NONE                           UINT16_C(0x0000) //!< No clear flags.
 #define BGFX_CLEAR_COLOR                          UINT16_C(0x0001) //!< Clear color.
 #define BGFX_CLEAR_DEPTH                          UINT16_C(0x0002) //!< Clear depth.
@@ -58,6 +224,14 @@
 #	define BGFX_CONFIG_MAX_INDEX_BUFFERS (4<<10)
 #endif // BGFX_CONFIG_MAX_INDEX_BUFFERS
 
+#ifndef BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS
+#	define BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS (4<<10)
+#endif // BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS
+
+#ifndef BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS
+#	define BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS (4<<10)
+#endif // BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS
+
 #ifndef BGFX_CONFIG_MAX_SHADERS
 #	define BGFX_CONFIG_MAX_SHADERS 512
 #endif // BGFX_CONFIG_MAX_FRAGMENT_SHADERS
@@ -66,6 +240,26 @@
 #	define BGFX_CONFIG_MAX_PSOS (4<<10)
 #endif // BGFX_CONFIG_MAX_PSOS
 
+#ifndef BGFX_CONFIG_MAX_TEXTURES
+#	define BGFX_CONFIG_MAX_TEXTURES (4<<10)
+#endif // BGFX_CONFIG_MAX_TEXTURES
+
+#ifndef BGFX_CONFIG_MAX_FRAME_BUFFERS
+#	define BGFX_CONFIG_MAX_FRAME_BUFFERS 128
+#endif // BGFX_CONFIG_MAX_FRAME_BUFFERS
+
+#ifndef BGFX_CONFIG_MAX_READBACKS
+#	define BGFX_CONFIG_MAX_READBACKS 256
+#endif // BGFX_CONFIG_MAX_READBACKS
+
+#ifndef BGFX_CONFIG_MAX_DRAW_CALLS
+#	define BGFX_CONFIG_MAX_DRAW_CALLS ((64<<10)-1)
+#endif // BGFX_CONFIG_MAX_DRAW_CALLS
+
+#ifndef BGFX_CONFIG_MAX_MATRIX_CACHE
+#	define BGFX_CONFIG_MAX_MATRIX_CACHE (BGFX_CONFIG_MAX_DRAW_CALLS+1)
+#endif // BGFX_CONFIG_MAX_MATRIX_CACHE
+
 #ifndef BGFX_CONFIG_SORT_KEY_NUM_BITS_PROGRAM
 #	define BGFX_CONFIG_SORT_KEY_NUM_BITS_PROGRAM 9
 #endif // BGFX_CONFIG_SORT_KEY_NUM_BITS_PROGRAM
@@ -81,4 +275,120 @@
 
 #ifndef BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
 #	define BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT 5
-#endif // BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
\ No newline at end of file
+#endif // BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
+
+#ifndef BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE
+#	define BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE (6<<20)
+#endif // BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE
+
+#ifndef BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE
+#	define BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE (2<<20)
+#endif // BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE
+
+#ifndef BGFX_CONFIG_UPLOAD_BUFFER_SIZE
+#	define BGFX_CONFIG_UPLOAD_BUFFER_SIZE (4<<20)
+#endif // BGFX_CONFIG_UPLOAD_BUFFER_SIZE
+
+#ifndef BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE
+#	define BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE (32<<20)
+#endif // BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE
+
+#ifndef BGFX_CONFIG_BUFFER_POOL_MAX_PAGES
+#	define BGFX_CONFIG_BUFFER_POOL_MAX_PAGES 64
+#endif // BGFX_CONFIG_BUFFER_POOL_MAX_PAGES
+
+#ifndef BGFX_CONFIG_BUFFER_POOL_MAX_ALLOCS
+#	define BGFX_CONFIG_BUFFER_POOL_MAX_ALLOCS (4<<10)
+#endif // BGFX_CONFIG_BUFFER_POOL_MAX_ALLOCS
+
+#ifndef BGFX_CONFIG_MAX_DESCRIPTORS
+#	define BGFX_CONFIG_MAX_DESCRIPTORS (64<<10)
+#endif // BGFX_CONFIG_MAX_DESCRIPTORS
+
+#ifndef BGFX_CONFIG_MAX_DESCRIPTOR_ALLOCS
+#	define BGFX_CONFIG_MAX_DESCRIPTOR_ALLOCS (16<<10)
+#endif // BGFX_CONFIG_MAX_DESCRIPTOR_ALLOCS
+
+#ifndef BGFX_CONFIG_MAX_TRANSIENT_DESCRIPTORS
+#	define BGFX_CONFIG_MAX_TRANSIENT_DESCRIPTORS (16<<10)
+#endif // BGFX_CONFIG_MAX_TRANSIENT_DESCRIPTORS
+
+#ifndef BGFX_CONFIG_MAX_ROOT_CONSTANTS
+#	define BGFX_CONFIG_MAX_ROOT_CONSTANTS 4
+#endif // BGFX_CONFIG_MAX_ROOT_CONSTANTS
+
+#ifndef BGFX_CONFIG_MAX_WORKER_THREADS
+#	define BGFX_CONFIG_MAX_WORKER_THREADS 32
+#endif // BGFX_CONFIG_MAX_WORKER_THREADS
+
+#ifndef BGFX_CONFIG_WORKER_THREADS
+#	define BGFX_CONFIG_WORKER_THREADS 7
+#endif // BGFX_CONFIG_WORKER_THREADS
+
+#ifndef BGFX_CONFIG_MIPGEN_BAND_ROWS
+#	define BGFX_CONFIG_MIPGEN_BAND_ROWS 16
+#endif // BGFX_CONFIG_MIPGEN_BAND_ROWS
+
+#ifndef BGFX_CONFIG_VT_MAX_LOADS
+#	define BGFX_CONFIG_VT_MAX_LOADS 32
+#endif // BGFX_CONFIG_VT_MAX_LOADS
+
+#ifndef BGFX_CONFIG_VT_MAX_UPLOADS
+#	define BGFX_CONFIG_VT_MAX_UPLOADS 16
+#endif // BGFX_CONFIG_VT_MAX_UPLOADS
+
+#ifndef BGFX_CONFIG_VT_MAX_REQUESTS
+#	define BGFX_CONFIG_VT_MAX_REQUESTS (4<<10)
+#endif // BGFX_CONFIG_VT_MAX_REQUESTS
+
+#ifndef BGFX_CONFIG_ATLAS_MAX_PAGES
+#	define BGFX_CONFIG_ATLAS_MAX_PAGES 16
+#endif // BGFX_CONFIG_ATLAS_MAX_PAGES
+
+#ifndef BGFX_CONFIG_ATLAS_MAX_REGIONS
+#	define BGFX_CONFIG_ATLAS_MAX_REGIONS (16<<10)
+#endif // BGFX_CONFIG_ATLAS_MAX_REGIONS
+
+#ifndef BGFX_CONFIG_ATLAS_MAX_FREE_RECTS
+#	define BGFX_CONFIG_ATLAS_MAX_FREE_RECTS 256
+#endif // BGFX_CONFIG_ATLAS_MAX_FREE_RECTS
+
+#ifndef BGFX_CONFIG_ASSET_IO_THREADS
+#	define BGFX_CONFIG_ASSET_IO_THREADS 2
+#endif // BGFX_CONFIG_ASSET_IO_THREADS
+
+#ifndef BGFX_CONFIG_ASSET_MAX_IO_THREADS
+#	define BGFX_CONFIG_ASSET_MAX_IO_THREADS 8
+#endif // BGFX_CONFIG_ASSET_MAX_IO_THREADS
+
+#ifndef BGFX_CONFIG_ASSET_MAX_REQUESTS
+#	define BGFX_CONFIG_ASSET_MAX_REQUESTS 1024
+#endif // BGFX_CONFIG_ASSET_MAX_REQUESTS
+
+#ifndef BGFX_CONFIG_ASSET_MAX_PATH
+#	define BGFX_CONFIG_ASSET_MAX_PATH 256
+#endif // BGFX_CONFIG_ASSET_MAX_PATH
+
+#ifndef BGFX_CONFIG_ASSET_MAX_CREATE_SIZE
+#	define BGFX_CONFIG_ASSET_MAX_CREATE_SIZE (32<<20)
+#endif // BGFX_CONFIG_ASSET_MAX_CREATE_SIZE
+
+#ifndef BGFX_CONFIG_PROFILER
+#	define BGFX_CONFIG_PROFILER 0
+#endif // BGFX_CONFIG_PROFILER
+
+#ifndef BGFX_CONFIG_PROFILER_RING_SIZE
+#	define BGFX_CONFIG_PROFILER_RING_SIZE (64<<10)
+#endif // BGFX_CONFIG_PROFILER_RING_SIZE
+
+#ifndef BGFX_CONFIG_PROFILER_MAX_THREADS
+#	define BGFX_CONFIG_PROFILER_MAX_THREADS 64
+#endif // BGFX_CONFIG_PROFILER_MAX_THREADS
+
+#ifndef BGFX_CONFIG_MESHLET_MAX_VERTICES
+#	define BGFX_CONFIG_MESHLET_MAX_VERTICES 64
+#endif // BGFX_CONFIG_MESHLET_MAX_VERTICES
+
+#ifndef BGFX_CONFIG_MESHLET_MAX_TRIANGLES
+#	define BGFX_CONFIG_MESHLET_MAX_TRIANGLES 124
+#endif // BGFX_CONFIG_MESHLET_MAX_TRIANGLES
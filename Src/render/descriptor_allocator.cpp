@@ -0,0 +1,106 @@
+#include <bx/allocator.h>
+
+#include "descriptor_allocator.h"
+
+namespace TinyRender
+{
+
+DescriptorAllocator::DescriptorAllocator()
+    : m_allocator(NULL), m_pending(NULL), m_numPending(0), m_maxPending(0), m_numStatic(0), m_numTransient(0),
+      m_numFrames(0), m_frame(0), m_transientOffset(0)
+{
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    destroy();
+}
+
+bool DescriptorAllocator::create(uint32_t _numStatic, uint32_t _maxAllocs, uint32_t _numTransient,
+                                 uint32_t _numFrames, bx::AllocatorI *_allocator)
+{
+    BX_ASSERT(0 < _numFrames, "Descriptor allocator needs at least one frame slot.");
+
+    m_allocator = _allocator;
+    if (!m_tlsf.create(_numStatic, _maxAllocs, 1, _allocator))
+    {
+        return false;
+    }
+
+    m_numStatic = _numStatic;
+    m_numTransient = _numTransient;
+    m_numFrames = _numFrames;
+    m_frame = 0;
+    m_transientOffset = 0;
+    m_numPending = 0;
+    return true;
+}
+
+void DescriptorAllocator::destroy()
+{
+    m_tlsf.destroy();
+
+    if (NULL != m_pending)
+    {
+        bx::free(m_allocator, m_pending);
+        m_pending = NULL;
+    }
+    m_numPending = 0;
+    m_maxPending = 0;
+}
+
+TlsfAllocation DescriptorAllocator::alloc(uint32_t _num)
+{
+    return m_tlsf.alloc(_num);
+}
+
+void DescriptorAllocator::free(TlsfAllocation _allocation)
+{
+    if (m_numPending == m_maxPending)
+    {
+        m_maxPending = bx::max<uint32_t>(64, m_maxPending * 2);
+        m_pending = (PendingFree *)bx::realloc(m_allocator, m_pending, m_maxPending * sizeof(PendingFree));
+    }
+
+    PendingFree &pending = m_pending[m_numPending++];
+    pending.m_allocation = _allocation;
+    pending.m_frame = m_frame;
+}
+
+uint32_t DescriptorAllocator::allocTransient(uint32_t _num)
+{
+    if (m_transientOffset + _num > m_numTransient)
+    {
+        return UINT32_MAX;
+    }
+
+    const uint32_t index = m_numStatic + m_frame * m_numTransient + m_transientOffset;
+    m_transientOffset += _num;
+    return index;
+}
+
+void DescriptorAllocator::beginFrame(uint32_t _frame)
+{
+    BX_ASSERT(_frame < m_numFrames, "Invalid frame slot %d.", _frame);
+
+    m_frame = _frame;
+    m_transientOffset = 0;
+
+    // Ranges freed last time this slot was recorded are no longer used by GPU.
+    uint32_t num = 0;
+    for (uint32_t ii = 0; ii < m_numPending; ++ii)
+    {
+        const PendingFree &pending = m_pending[ii];
+        if (pending.m_frame == _frame)
+        {
+            m_tlsf.free(pending.m_allocation);
+        }
+        else
+        {
+            m_pending[num++] = pending;
+        }
+    }
+    m_numPending = num;
+}
+
+} // namespace TinyRender
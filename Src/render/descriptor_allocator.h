@@ -0,0 +1,69 @@
+#pragma once
+
+#include "tlsf.h"
+
+namespace TinyRender
+{
+
+/// Hands out descriptor indices of one bindless descriptor heap, heap itself is owned by backend.
+///
+/// Front of heap, `[0, _numStatic)`, holds descriptors of resources and is allocated in ranges by
+/// TLSF. GPU may still read a freed range, it is reused only once frame slot it was freed in comes
+/// around again. Back of heap is split in one linear range of `_numTransient` descriptors per frame
+/// slot, for descriptors written every frame. Slot range is reset when slot starts recording again.
+///
+struct DescriptorAllocator
+{
+    DescriptorAllocator();
+    ~DescriptorAllocator();
+
+    /// @param[in] _numStatic Descriptors in front part of heap.
+    /// @param[in] _maxAllocs Maximum number of live ranges in front part.
+    /// @param[in] _numTransient Descriptors per frame slot.
+    /// @param[in] _numFrames Frame slots, frames GPU and CPU can have in flight together.
+    /// @param[in] _allocator Allocator for bookkeeping.
+    ///
+    bool create(uint32_t _numStatic, uint32_t _maxAllocs, uint32_t _numTransient, uint32_t _numFrames,
+                bx::AllocatorI *_allocator);
+
+    void destroy();
+
+    /// Allocate `_num` consecutive descriptors. Check result with `TlsfAllocator::isValid`, index of
+    /// first descriptor is `m_offset`.
+    TlsfAllocation alloc(uint32_t _num);
+
+    /// Free range. It becomes available once GPU is done with frame slot being recorded.
+    void free(TlsfAllocation _allocation);
+
+    /// Allocate `_num` consecutive descriptors valid only for frame slot being recorded. Returns index
+    /// of first one, `UINT32_MAX` when slot range is exhausted.
+    uint32_t allocTransient(uint32_t _num);
+
+    /// Start recording frame slot `_frame`. GPU must be done with previous frame recorded in it.
+    void beginFrame(uint32_t _frame);
+
+    /// Heap size needed for static and all transient descriptors.
+    uint32_t getNumDescriptors() const
+    {
+        return m_numStatic + m_numTransient * m_numFrames;
+    }
+
+    struct PendingFree
+    {
+        TlsfAllocation m_allocation;
+        uint32_t m_frame;
+    };
+
+    TlsfAllocator m_tlsf;
+    bx::AllocatorI *m_allocator;
+    PendingFree *m_pending; //!< Ranges freed while GPU may still use them.
+    uint32_t m_numPending;
+    uint32_t m_maxPending;
+    uint32_t m_numStatic;
+    uint32_t m_numTransient;
+    uint32_t m_numFrames;
+    uint32_t m_frame;           //!< Frame slot being recorded.
+    uint32_t m_transientOffset; //!< Descriptors used in slot range this frame.
+};
+
+} // namespace TinyRender
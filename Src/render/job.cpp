@@ -0,0 +1,122 @@
+#include <bx/cpu.h>
+#include <bx/uint32_t.h>
+
+#include "job.h"
+
+namespace TinyRender
+{
+
+JobPool::JobPool()
+    : m_fn(NULL), m_userData(NULL), m_num(0), m_batch(1), m_next(0), m_numActive(0), m_numThreads(0), m_quit(false)
+{
+}
+
+JobPool::~JobPool()
+{
+    destroy();
+}
+
+bool JobPool::create(uint32_t _numThreads)
+{
+    m_quit = false;
+    m_numThreads = 0;
+
+    const uint32_t numThreads = bx::uint32_min(_numThreads, BGFX_CONFIG_MAX_WORKER_THREADS);
+    for (uint32_t ii = 0; ii < numThreads; ++ii)
+    {
+        if (!m_thread[ii].init(workerFunc, this, 0, "TinyRender worker"))
+        {
+            destroy();
+            return false;
+        }
+        ++m_numThreads;
+    }
+
+    return true;
+}
+
+void JobPool::destroy()
+{
+    if (0 == m_numThreads)
+    {
+        return;
+    }
+
+    m_quit = true;
+    m_start.post(m_numThreads);
+    for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+    {
+        m_thread[ii].shutdown();
+    }
+    m_numThreads = 0;
+}
+
+void JobPool::parallelFor(JobFn _fn, void *_userData, uint32_t _num, uint32_t _batch)
+{
+    const uint32_t batch = bx::uint32_max(_batch, 1);
+    const uint32_t numBatches = (_num + batch - 1) / batch;
+    if (0 == m_numThreads || 1 >= numBatches)
+    {
+        if (0 != _num)
+        {
+            _fn(_userData, 0, _num);
+        }
+        return;
+    }
+
+    m_fn = _fn;
+    m_userData = _userData;
+    m_num = _num;
+    m_batch = batch;
+    m_next = 0;
+
+    // Calling thread takes one batch, wake only as many workers as there are batches left.
+    const uint32_t numWake = bx::uint32_min(m_numThreads, numBatches - 1);
+    m_numActive = int32_t(numWake);
+    bx::memoryBarrier();
+    m_start.post(numWake);
+
+    run();
+
+    m_done.wait();
+}
+
+int32_t JobPool::workerFunc(bx::Thread *_self, void *_userData)
+{
+    BX_UNUSED(_self);
+    JobPool *pool = (JobPool *)_userData;
+
+    for (;;)
+    {
+        pool->m_start.wait();
+        if (pool->m_quit)
+        {
+            break;
+        }
+
+        pool->run();
+
+        if (0 == bx::atomicSubAndFetch<int32_t>(&pool->m_numActive, 1))
+        {
+            pool->m_done.post();
+        }
+    }
+
+    return 0;
+}
+
+void JobPool::run()
+{
+    for (;;)
+    {
+        const uint32_t begin = bx::atomicFetchAndAdd<uint32_t>(&m_next, m_batch);
+        if (begin >= m_num)
+        {
+            break;
+        }
+
+        m_fn(m_userData, begin, bx::uint32_min(begin + m_batch, m_num));
+    }
+}
+
+} // namespace TinyRender
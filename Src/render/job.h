@@ -0,0 +1,60 @@
+#pragma once
+
+#include <bx/semaphore.h>
+#include <bx/thread.h>
+
+#include "defines.h"
+
+namespace TinyRender
+{
+
+/// Job body, runs items `[_begin, _end)`. Called from workers and from thread calling
+/// `JobPool::parallelFor`, concurrently.
+typedef void (*JobFn)(void *_userData, uint32_t _begin, uint32_t _end);
+
+/// Fixed set of worker threads running data parallel loops.
+///
+/// Workers sleep on semaphore between loops. Items are handed out in batches through atomic
+/// counter, so uneven items balance themselves. Calling thread works on loop too and returns once
+/// all items are done.
+///
+struct JobPool
+{
+    JobPool();
+    ~JobPool();
+
+    /// @param[in] _numThreads Worker threads, clamped to `BGFX_CONFIG_MAX_WORKER_THREADS`. With 0
+    ///   all loops run on calling thread.
+    ///
+    bool create(uint32_t _numThreads);
+
+    void destroy();
+
+    /// Run `_fn` over items `[0, _num)`, `_batch` items per call. Only one thread may run loop at a
+    /// time, `_fn` must not start another one.
+    void parallelFor(JobFn _fn, void *_userData, uint32_t _num, uint32_t _batch = 1);
+
+    /// Threads working on loop, calling thread included.
+    uint32_t getNumThreads() const
+    {
+        return m_numThreads + 1;
+    }
+
+    static int32_t workerFunc(bx::Thread *_self, void *_userData);
+
+    void run();
+
+    bx::Thread m_thread[BGFX_CONFIG_MAX_WORKER_THREADS];
+    bx::Semaphore m_start;
+    bx::Semaphore m_done;
+    JobFn m_fn;
+    void *m_userData;
+    uint32_t m_num;
+    uint32_t m_batch;
+    volatile uint32_t m_next;     //!< First item not handed out yet.
+    volatile int32_t m_numActive; //!< Workers woken for current loop and not done yet.
+    uint32_t m_numThreads;
+    bool m_quit;
+};
+
+} // namespace TinyRender
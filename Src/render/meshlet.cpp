@@ -0,0 +1,521 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+
+#include "meshlet.h"
+
+namespace TinyRender
+{
+
+static inline uint32_t readIndex(const void *_indices, bool _index32, uint32_t _idx)
+{
+    return _index32 ? ((const uint32_t *)_indices)[_idx] : ((const uint16_t *)_indices)[_idx];
+}
+
+static inline void writeIndex(void *_indices, bool _index32, uint32_t _idx, uint32_t _value)
+{
+    if (_index32)
+    {
+        ((uint32_t *)_indices)[_idx] = _value;
+    }
+    else
+    {
+        ((uint16_t *)_indices)[_idx] = uint16_t(_value);
+    }
+}
+
+struct MeshletBuilder
+{
+    bx::Vec3 getPos(uint32_t _vertex) const
+    {
+        return bx::load<bx::Vec3>(m_vertices + _vertex * m_stride);
+    }
+
+    uint32_t getIndex(uint32_t _triangle, uint32_t _corner) const
+    {
+        return readIndex(m_indices, m_index32, _triangle * 3 + _corner);
+    }
+
+    uint32_t countNewVertices(uint32_t _triangle) const
+    {
+        uint32_t num = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            num += UINT8_MAX == m_used[getIndex(_triangle, corner)];
+        }
+        return num;
+    }
+
+    /// Find best unemitted triangle sharing vertices with current cluster. `_hasNeighbors` is set when
+    /// any unemitted triangle is adjacent, even if it doesn't fit into cluster limits.
+    uint32_t findNeighbor(bool &_hasNeighbors) const
+    {
+        _hasNeighbors = false;
+
+        uint32_t best = UINT32_MAX;
+        uint32_t bestExtra = UINT32_MAX;
+        uint32_t bestLive = UINT32_MAX;
+
+        for (uint32_t ii = 0; ii < m_numClusterVertices; ++ii)
+        {
+            const uint32_t vertex = m_clusterVertices[ii];
+            if (0 == m_live[vertex])
+            {
+                continue;
+            }
+
+            for (uint32_t jj = m_adjOffset[vertex], end = m_adjOffset[vertex + 1]; jj < end; ++jj)
+            {
+                const uint32_t triangle = m_adjTriangles[jj];
+                if (m_emitted[triangle])
+                {
+                    continue;
+                }
+
+                _hasNeighbors = true;
+
+                const uint32_t extra = countNewVertices(triangle);
+                if (m_numClusterVertices + extra > m_maxVertices)
+                {
+                    continue;
+                }
+
+                // Prefer triangles adding fewer vertices, then triangles whose vertices have fewer
+                // remaining triangles, so clusters don't leave isolated islands behind.
+                const uint32_t live = m_live[getIndex(triangle, 0)] + m_live[getIndex(triangle, 1)] +
+                                      m_live[getIndex(triangle, 2)];
+                if (extra < bestExtra || (extra == bestExtra && live < bestLive))
+                {
+                    best = triangle;
+                    bestExtra = extra;
+                    bestLive = live;
+                }
+            }
+        }
+
+        return best;
+    }
+
+    void addTriangle(uint32_t _triangle)
+    {
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t vertex = getIndex(_triangle, corner);
+            if (UINT8_MAX == m_used[vertex])
+            {
+                m_used[vertex] = uint8_t(m_numClusterVertices);
+                m_clusterVertices[m_numClusterVertices++] = vertex;
+            }
+
+            --m_live[vertex];
+            writeIndex(m_dstIndices, m_index32, m_numDstIndices++, vertex);
+        }
+
+        m_emitted[_triangle] = 1;
+        ++m_numClusterTriangles;
+    }
+
+    void computeBounds(MeshletCluster &_cluster) const
+    {
+        // Ritter's bounding sphere, seeded with the most distant pair of axis extremes.
+        uint32_t pmin[3] = {0, 0, 0};
+        uint32_t pmax[3] = {0, 0, 0};
+        for (uint32_t ii = 1; ii < m_numClusterVertices; ++ii)
+        {
+            const float *pos = (const float *)(m_vertices + m_clusterVertices[ii] * m_stride);
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                const float *pa = (const float *)(m_vertices + m_clusterVertices[pmin[axis]] * m_stride);
+                const float *pb = (const float *)(m_vertices + m_clusterVertices[pmax[axis]] * m_stride);
+                pmin[axis] = pos[axis] < pa[axis] ? ii : pmin[axis];
+                pmax[axis] = pos[axis] > pb[axis] ? ii : pmax[axis];
+            }
+        }
+
+        float maxDist = -1.0f;
+        bx::Vec3 center(bx::InitZero);
+        float radius = 0.0f;
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            const bx::Vec3 pa = getPos(m_clusterVertices[pmin[axis]]);
+            const bx::Vec3 pb = getPos(m_clusterVertices[pmax[axis]]);
+            const float dist = bx::length(bx::sub(pb, pa));
+            if (dist > maxDist)
+            {
+                maxDist = dist;
+                center = bx::mul(bx::add(pa, pb), 0.5f);
+                radius = dist * 0.5f;
+            }
+        }
+
+        for (uint32_t ii = 0; ii < m_numClusterVertices; ++ii)
+        {
+            const bx::Vec3 pos = getPos(m_clusterVertices[ii]);
+            const float dist = bx::length(bx::sub(pos, center));
+            if (dist > radius)
+            {
+                const float newRadius = (radius + dist) * 0.5f;
+                center = bx::mad(bx::sub(pos, center), (newRadius - radius) / dist, center);
+                radius = newRadius;
+            }
+        }
+
+        bx::store(_cluster.m_center, center);
+        _cluster.m_radius = radius;
+
+        // Normal cone, axis is average of unit triangle normals.
+        bx::Vec3 axis(bx::InitZero);
+        const uint32_t firstTriangle = _cluster.m_firstIndex / 3;
+        for (uint32_t ii = 0; ii < m_numClusterTriangles; ++ii)
+        {
+            const bx::Vec3 normal = triangleNormal(firstTriangle + ii);
+            axis = bx::add(axis, normal);
+        }
+
+        const float axisLength = bx::length(axis);
+        if (0.0f == axisLength)
+        {
+            _cluster.m_coneAxis[0] = 0;
+            _cluster.m_coneAxis[1] = 0;
+            _cluster.m_coneAxis[2] = 0;
+            _cluster.m_coneCutoff = 127;
+            return;
+        }
+
+        axis = bx::mul(axis, 1.0f / axisLength);
+
+        float minDot = 1.0f;
+        for (uint32_t ii = 0; ii < m_numClusterTriangles; ++ii)
+        {
+            const bx::Vec3 normal = triangleNormal(firstTriangle + ii);
+            if (0.0f != bx::dot(normal, normal))
+            {
+                minDot = bx::min(minDot, bx::dot(axis, normal));
+            }
+        }
+
+        // Cutoff is sine of the cone half-angle; cones wider than ~84 degrees never cull.
+        const float cutoff = minDot <= 0.1f ? 1.0f : bx::sqrt(1.0f - minDot * minDot);
+
+        const float axisf[3] = {axis.x, axis.y, axis.z};
+        float error = 0.0f;
+        for (uint32_t ii = 0; ii < 3; ++ii)
+        {
+            const int32_t quantized = int32_t(bx::round(bx::clamp(axisf[ii], -1.0f, 1.0f) * 127.0f));
+            _cluster.m_coneAxis[ii] = int8_t(quantized);
+            error += bx::abs(float(quantized) / 127.0f - axisf[ii]);
+        }
+
+        // Widen cutoff by axis quantization error so the test stays conservative.
+        const int32_t cutoff8 = int32_t(127.0f * (cutoff + error) + 1.0f);
+        _cluster.m_coneCutoff = int8_t(bx::min(cutoff8, 127));
+    }
+
+    bx::Vec3 triangleNormal(uint32_t _triangle) const
+    {
+        const uint32_t i0 = readIndex(m_dstIndices, m_index32, _triangle * 3 + 0);
+        const uint32_t i1 = readIndex(m_dstIndices, m_index32, _triangle * 3 + 1);
+        const uint32_t i2 = readIndex(m_dstIndices, m_index32, _triangle * 3 + 2);
+
+        const bx::Vec3 p0 = getPos(i0);
+        const bx::Vec3 normal = bx::cross(bx::sub(getPos(i1), p0), bx::sub(getPos(i2), p0));
+        const float len = bx::length(normal);
+
+        return 0.0f == len ? bx::Vec3(bx::InitZero) : bx::mul(normal, 1.0f / len);
+    }
+
+    void finishCluster(MeshletCluster *_clusters)
+    {
+        if (0 == m_numClusterTriangles)
+        {
+            return;
+        }
+
+        MeshletCluster &cluster = _clusters[m_numClusters++];
+        bx::memSet(&cluster, 0, sizeof(MeshletCluster));
+        cluster.m_firstIndex = m_numDstIndices - m_numClusterTriangles * 3;
+        cluster.m_numTriangles = uint16_t(m_numClusterTriangles);
+        cluster.m_numVertices = uint8_t(m_numClusterVertices);
+        computeBounds(cluster);
+
+        for (uint32_t ii = 0; ii < m_numClusterVertices; ++ii)
+        {
+            m_used[m_clusterVertices[ii]] = UINT8_MAX;
+        }
+
+        m_numClusterVertices = 0;
+        m_numClusterTriangles = 0;
+    }
+
+    const uint8_t *m_vertices;
+    uint32_t m_stride;
+    const void *m_indices;
+    void *m_dstIndices;
+    bool m_index32;
+
+    uint32_t *m_adjOffset;
+    uint32_t *m_adjTriangles;
+    uint32_t *m_live;
+    uint8_t *m_emitted;
+    uint8_t *m_used;
+
+    uint32_t m_maxVertices;
+    uint32_t m_maxTriangles;
+
+    uint32_t m_clusterVertices[UINT8_MAX];
+    uint32_t m_numClusterVertices;
+    uint32_t m_numClusterTriangles;
+    uint32_t m_numDstIndices;
+    uint32_t m_numClusters;
+};
+
+uint32_t meshletBuildBound(uint32_t _numIndices, uint32_t _maxVertices, uint32_t _maxTriangles)
+{
+    BX_ASSERT(_maxVertices >= 3 && _maxTriangles >= 1, "Invalid cluster limits.");
+
+    const uint32_t numTriangles = _numIndices / 3;
+    const uint32_t byTriangles = (numTriangles + _maxTriangles - 1) / _maxTriangles;
+    const uint32_t byVertices = (_numIndices + _maxVertices - 3) / (_maxVertices - 2);
+
+    return bx::max(byTriangles, byVertices);
+}
+
+uint32_t meshletBuild(MeshletCluster *_clusters, void *_dstIndices, const void *_indices, uint32_t _numIndices,
+                      bool _index32, const void *_vertices, uint32_t _numVertices, const VertexLayout &_layout,
+                      uint32_t _maxVertices, uint32_t _maxTriangles, bx::AllocatorI *_allocator)
+{
+    BX_ASSERT(0 == _numIndices % 3, "Index count must be multiple of 3.");
+    BX_ASSERT(_maxVertices >= 3 && _maxVertices <= UINT8_MAX, "_maxVertices must be in [3, 255] range.");
+    BX_ASSERT(_maxTriangles >= 1 && _maxTriangles <= UINT16_MAX, "_maxTriangles must be in [1, 65535] range.");
+    BX_ASSERT(_layout.has(Attrib::Position), "Vertex layout must have position.");
+
+    uint8_t num;
+    AttribType::Enum type;
+    bool normalized;
+    bool asInt;
+    _layout.decode(Attrib::Position, num, type, normalized, asInt);
+    BX_ASSERT(AttribType::Float == type && 3 <= num, "Position must be 3 x AttribType::Float.");
+    BX_UNUSED(num, type, normalized, asInt);
+
+    const uint32_t numTriangles = _numIndices / 3;
+
+    const uint32_t size = 0 + (_numVertices + 1) * sizeof(uint32_t) // adjacency offsets
+                          + _numIndices * sizeof(uint32_t)          // adjacency triangles
+                          + _numVertices * sizeof(uint32_t)         // live triangle count
+                          + numTriangles                            // emitted flag
+                          + _numVertices                            // cluster local index
+        ;
+    uint8_t *data = (uint8_t *)bx::alloc(_allocator, size);
+
+    MeshletBuilder builder;
+    builder.m_vertices = (const uint8_t *)_vertices + _layout.getOffset(Attrib::Position);
+    builder.m_stride = _layout.getStride();
+    builder.m_indices = _indices;
+    builder.m_dstIndices = _dstIndices;
+    builder.m_index32 = _index32;
+    builder.m_adjOffset = (uint32_t *)data;
+    builder.m_adjTriangles = builder.m_adjOffset + _numVertices + 1;
+    builder.m_live = builder.m_adjTriangles + _numIndices;
+    builder.m_emitted = (uint8_t *)(builder.m_live + _numVertices);
+    builder.m_used = builder.m_emitted + numTriangles;
+    builder.m_maxVertices = _maxVertices;
+    builder.m_maxTriangles = _maxTriangles;
+    builder.m_numClusterVertices = 0;
+    builder.m_numClusterTriangles = 0;
+    builder.m_numDstIndices = 0;
+    builder.m_numClusters = 0;
+
+    bx::memSet(builder.m_live, 0, _numVertices * sizeof(uint32_t));
+    bx::memSet(builder.m_emitted, 0, numTriangles);
+    bx::memSet(builder.m_used, UINT8_MAX, _numVertices);
+
+    // Vertex -> triangle adjacency.
+    for (uint32_t ii = 0; ii < _numIndices; ++ii)
+    {
+        const uint32_t vertex = readIndex(_indices, _index32, ii);
+        BX_ASSERT(vertex < _numVertices, "Index %d out of range (%d vertices).", vertex, _numVertices);
+        ++builder.m_live[vertex];
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t ii = 0; ii < _numVertices; ++ii)
+    {
+        builder.m_adjOffset[ii] = offset;
+        offset += builder.m_live[ii];
+    }
+    builder.m_adjOffset[_numVertices] = offset;
+
+    for (uint32_t ii = 0; ii < _numIndices; ++ii)
+    {
+        const uint32_t vertex = readIndex(_indices, _index32, ii);
+        builder.m_adjTriangles[builder.m_adjOffset[vertex]++] = ii / 3;
+    }
+
+    for (uint32_t ii = 0; ii < _numVertices; ++ii)
+    {
+        builder.m_adjOffset[ii] -= builder.m_live[ii];
+    }
+
+    uint32_t cursor = 0;
+    for (;;)
+    {
+        bool hasNeighbors;
+        uint32_t triangle = builder.findNeighbor(hasNeighbors);
+
+        if (UINT32_MAX == triangle)
+        {
+            if (hasNeighbors)
+            {
+                // Neighbors exist but don't fit, start a new cluster.
+                builder.finishCluster(_clusters);
+                continue;
+            }
+
+            while (cursor < numTriangles && builder.m_emitted[cursor])
+            {
+                ++cursor;
+            }
+
+            if (cursor == numTriangles)
+            {
+                break;
+            }
+
+            // Disconnected piece, keep filling current cluster if it fits.
+            triangle = cursor;
+            if (builder.m_numClusterVertices + builder.countNewVertices(triangle) > _maxVertices)
+            {
+                builder.finishCluster(_clusters);
+            }
+        }
+
+        builder.addTriangle(triangle);
+
+        if (builder.m_numClusterTriangles == _maxTriangles)
+        {
+            builder.finishCluster(_clusters);
+        }
+    }
+
+    builder.finishCluster(_clusters);
+
+    BX_ASSERT(builder.m_numDstIndices == _numIndices, "Not all triangles were clustered (%d of %d).",
+              builder.m_numDstIndices, _numIndices);
+    BX_ASSERT(builder.m_numClusters <= meshletBuildBound(_numIndices, _maxVertices, _maxTriangles),
+              "Cluster count exceeds bound.");
+
+    bx::free(_allocator, data);
+
+    return builder.m_numClusters;
+}
+
+uint32_t meshletCull(IndexRange *_ranges, const MeshletCluster *_clusters, uint32_t _numClusters, const float *_mtx,
+                     const float *_viewProj, const float *_eye, MeshletCullStats *_stats)
+{
+    // Frustum planes from view-projection columns (row-vector convention, see bx::mul).
+    const float *vp = _viewProj;
+    float planes[6][4];
+    for (uint32_t ii = 0; ii < 4; ++ii)
+    {
+        const float col0 = vp[ii * 4 + 0];
+        const float col1 = vp[ii * 4 + 1];
+        const float col2 = vp[ii * 4 + 2];
+        const float col3 = vp[ii * 4 + 3];
+        planes[0][ii] = col3 + col0; // left
+        planes[1][ii] = col3 - col0; // right
+        planes[2][ii] = col3 + col1; // bottom
+        planes[3][ii] = col3 - col1; // top
+        planes[4][ii] = col3 + col2; // near, conservative for both depth ranges
+        planes[5][ii] = col3 - col2; // far
+    }
+
+    for (uint32_t ii = 0; ii < BX_COUNTOF(planes); ++ii)
+    {
+        const float invLen = 1.0f / bx::length(bx::load<bx::Vec3>(planes[ii]));
+        planes[ii][0] *= invLen;
+        planes[ii][1] *= invLen;
+        planes[ii][2] *= invLen;
+        planes[ii][3] *= invLen;
+    }
+
+    float scale = 1.0f;
+    if (NULL != _mtx)
+    {
+        scale = bx::length(bx::load<bx::Vec3>(_mtx));
+    }
+
+    const bx::Vec3 eye = bx::load<bx::Vec3>(_eye);
+
+    MeshletCullStats stats = {};
+    uint32_t numRanges = 0;
+
+    for (uint32_t ii = 0; ii < _numClusters; ++ii)
+    {
+        const MeshletCluster &cluster = _clusters[ii];
+
+        bx::Vec3 center = bx::load<bx::Vec3>(cluster.m_center);
+        if (NULL != _mtx)
+        {
+            center = bx::mul(center, _mtx);
+        }
+        const float radius = cluster.m_radius * scale;
+
+        bool visible = true;
+        for (uint32_t jj = 0; jj < BX_COUNTOF(planes) && visible; ++jj)
+        {
+            const float dist = planes[jj][0] * center.x + planes[jj][1] * center.y + planes[jj][2] * center.z +
+                               planes[jj][3];
+            visible = dist >= -radius;
+        }
+
+        if (!visible)
+        {
+            ++stats.m_numFrustum;
+            continue;
+        }
+
+        if (cluster.m_coneCutoff < 127)
+        {
+            bx::Vec3 axis = {cluster.m_coneAxis[0] / 127.0f, cluster.m_coneAxis[1] / 127.0f,
+                             cluster.m_coneAxis[2] / 127.0f};
+            if (NULL != _mtx)
+            {
+                axis = bx::mul(bx::mulXyz0(axis, _mtx), 1.0f / scale);
+            }
+
+            const bx::Vec3 dir = bx::sub(center, eye);
+            const float cutoff = cluster.m_coneCutoff / 127.0f;
+            if (bx::dot(dir, axis) >= cutoff * bx::length(dir) + radius)
+            {
+                ++stats.m_numBackface;
+                continue;
+            }
+        }
+
+        ++stats.m_numVisible;
+        stats.m_numTriangles += cluster.m_numTriangles;
+
+        const uint32_t numIndices = cluster.m_numTriangles * 3;
+        if (0 != numRanges)
+        {
+            IndexRange &last = _ranges[numRanges - 1];
+            if (last.m_firstIndex + last.m_numIndices == cluster.m_firstIndex)
+            {
+                last.m_numIndices += numIndices;
+                continue;
+            }
+        }
+
+        IndexRange &range = _ranges[numRanges++];
+        range.m_firstIndex = cluster.m_firstIndex;
+        range.m_numIndices = numIndices;
+    }
+
+    if (NULL != _stats)
+    {
+        *_stats = stats;
+    }
+
+    return numRanges;
+}
+
+} // namespace TinyRender
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "tiny_render.h"
+
+namespace bx
+{
+struct AllocatorI;
+}
+
+namespace TinyRender
+{
+
+/// Packed per-cluster data emitted by `meshletBuild`. 32 bytes per cluster.
+///
+/// Triangles of a cluster are stored contiguously in the clustered index buffer
+/// starting at `m_firstIndex`. Cone axis and cutoff are snorm8 quantized and
+/// conservatively widened, so culling with them never rejects a visible cluster.
+///
+struct MeshletCluster
+{
+    float m_center[3];     //!< Bounding sphere center (object space).
+    float m_radius;        //!< Bounding sphere radius.
+    int8_t m_coneAxis[3];  //!< Normal cone axis.
+    int8_t m_coneCutoff;   //!< Normal cone cutoff, 127 when cone culling is not possible.
+    uint32_t m_firstIndex; //!< First index in clustered index buffer.
+    uint16_t m_numTriangles;
+    uint8_t m_numVertices;
+    uint8_t m_reserved;
+    uint32_t m_reserved1;
+};
+
+/// Contiguous range in the clustered index buffer.
+struct IndexRange
+{
+    uint32_t m_firstIndex;
+    uint32_t m_numIndices;
+};
+
+/// Per-call cull statistics.
+struct MeshletCullStats
+{
+    uint32_t m_numVisible;   //!< Clusters passing all tests.
+    uint32_t m_numFrustum;   //!< Clusters rejected by frustum test.
+    uint32_t m_numBackface;  //!< Clusters rejected by normal cone test.
+    uint32_t m_numTriangles; //!< Triangles in visible clusters.
+};
+
+/// Returns maximum number of clusters `meshletBuild` can emit for given index count.
+uint32_t meshletBuildBound(uint32_t _numIndices, uint32_t _maxVertices = BGFX_CONFIG_MESHLET_MAX_VERTICES,
+                           uint32_t _maxTriangles = BGFX_CONFIG_MESHLET_MAX_TRIANGLES);
+
+/// Split triangle list into clusters.
+///
+/// @param[out] _clusters Cluster stream, must hold `meshletBuildBound` elements.
+/// @param[out] _dstIndices Clustered index buffer, same size and format as `_indices`. Triangles are
+///   reordered, vertices are not, so it can be used with the original vertex buffer.
+/// @param[in] _indices Source triangle list.
+/// @param[in] _numIndices Number of indices.
+/// @param[in] _index32 Set to `true` if indices are 32-bit.
+/// @param[in] _vertices Vertex data. Position must be 3 x `AttribType::Float`.
+/// @param[in] _numVertices Number of vertices.
+/// @param[in] _layout Vertex layout.
+/// @param[in] _maxVertices Maximum number of unique vertices per cluster (<= 255).
+/// @param[in] _maxTriangles Maximum number of triangles per cluster.
+/// @param[in] _allocator Allocator used for temporary adjacency data.
+///
+/// @returns Number of clusters written.
+///
+uint32_t meshletBuild(MeshletCluster *_clusters, void *_dstIndices, const void *_indices, uint32_t _numIndices,
+                      bool _index32, const void *_vertices, uint32_t _numVertices, const VertexLayout &_layout,
+                      uint32_t _maxVertices, uint32_t _maxTriangles, bx::AllocatorI *_allocator);
+
+/// Cull clusters against view frustum and normal cone, and emit compacted index ranges.
+/// Adjacent visible clusters are merged into a single range.
+///
+/// @param[out] _ranges Output ranges, must hold `_numClusters` elements.
+/// @param[in] _clusters Cluster stream from `meshletBuild`.
+/// @param[in] _numClusters Number of clusters.
+/// @param[in] _mtx Model matrix, can be NULL for identity. Scale is assumed to be uniform.
+/// @param[in] _viewProj View-projection matrix (`bx::mtxMul(viewProj, view, proj)`).
+/// @param[in] _eye Camera position in world space.
+/// @param[out] _stats Optional statistics.
+///
+/// @returns Number of ranges written.
+///
+uint32_t meshletCull(IndexRange *_ranges, const MeshletCluster *_clusters, uint32_t _numClusters, const float *_mtx,
+                     const float *_viewProj, const float *_eye, MeshletCullStats *_stats = NULL);
+
+} // namespace TinyRender
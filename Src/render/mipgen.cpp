@@ -0,0 +1,655 @@
+#include <bx/allocator.h>
+#include <bx/math.h>
+#include <bx/simd_t.h>
+#include <bx/uint32_t.h>
+
+#include "job.h"
+#include "mipgen.h"
+
+namespace TinyRender
+{
+
+using bx::simd128_t;
+
+static const float kKaiserWidth = 3.0f; //!< Filter radius in destination pixels.
+static const float kKaiserAlpha = 4.0f;
+static const uint32_t kMaxMips = 16;
+
+/// Pixel encodings mip generator filters.
+struct MipFormat
+{
+    enum Enum
+    {
+        Unorm8, //!< 4 x 8-bit unorm, channel order doesn't matter.
+        Srgb8,  //!< 4 x 8-bit unorm, sRGB color and linear alpha.
+        Half4,  //!< 4 x 16-bit float.
+        Float4, //!< 4 x 32-bit float.
+        Float1, //!< 1 x 32-bit float.
+
+        Count
+    };
+};
+
+static MipFormat::Enum getMipFormat(TextureFormat::Enum _format)
+{
+    switch (_format)
+    {
+    case TextureFormat::BGRA8:
+    case TextureFormat::RGBA8:
+        return MipFormat::Unorm8;
+    case TextureFormat::SRGBA8:
+        return MipFormat::Srgb8;
+    case TextureFormat::RGBA16F:
+        return MipFormat::Half4;
+    case TextureFormat::RGBA32F:
+        return MipFormat::Float4;
+    case TextureFormat::R32F:
+        return MipFormat::Float1;
+    default:
+        return MipFormat::Count;
+    }
+}
+
+static uint32_t getNumChannels(MipFormat::Enum _format)
+{
+    return MipFormat::Float1 == _format ? 1 : 4;
+}
+
+/// sRGB transfer tables. Linear values are quantized to 16 bits, enough to round trip all 8-bit
+/// sRGB values and to keep dark shades apart.
+struct SrgbTable
+{
+    SrgbTable()
+    {
+        for (uint32_t ii = 0; ii < 256; ++ii)
+        {
+            const float srgb = float(ii) / 255.0f;
+            const float linear = srgb <= 0.04045f ? srgb / 12.92f : bx::pow((srgb + 0.055f) / 1.055f, 2.4f);
+            m_toLinear[ii] = linear;
+            m_toLinear16[ii] = uint16_t(linear * 65535.0f + 0.5f);
+        }
+
+        for (uint32_t ii = 0; ii < 65536; ++ii)
+        {
+            const float linear = float(ii) / 65535.0f;
+            const float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * bx::pow(linear, 1.0f / 2.4f) - 0.055f;
+            m_fromLinear16[ii] = uint8_t(srgb * 255.0f + 0.5f);
+        }
+    }
+
+    float m_toLinear[256];
+    uint16_t m_toLinear16[256];
+    uint8_t m_fromLinear16[65536];
+};
+
+static const SrgbTable &getSrgbTable()
+{
+    // Built by first caller, construction of function statics is thread safe.
+    static const SrgbTable s_table;
+    return s_table;
+}
+
+/// Source and destination of one side and mip.
+struct MipLevel
+{
+    const uint8_t *m_src;
+    uint8_t *m_dst;
+    uint32_t m_srcWidth;
+    uint32_t m_srcHeight;
+    uint32_t m_srcPitch;
+    uint32_t m_dstWidth;
+    uint32_t m_dstHeight;
+    uint32_t m_dstPitch;
+};
+
+/// Separable filter taps along one axis, `m_numTaps` weights per destination pixel starting at
+/// source pixel `m_first`. Taps outside source are clamped to edge.
+struct MipKernel
+{
+    int32_t *m_first;
+    float *m_weight;
+    uint32_t m_numTaps;
+};
+
+struct MipGen
+{
+    uint8_t *m_data;
+    bx::AllocatorI *m_allocator;
+    MipFormat::Enum m_format;
+    MipFilter::Enum m_filter;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_bytesPerPixel;
+    uint32_t m_sideSize;
+    uint32_t m_mipOffset[kMaxMips];
+    uint32_t m_numMips;
+    uint32_t m_numSides;
+    uint32_t m_mip;      //!< Mip being generated.
+    uint32_t m_numBands; //!< Row bands of mip being generated.
+    MipKernel m_kernelX;
+    MipKernel m_kernelY;
+};
+
+static MipLevel getLevel(const MipGen &_gen, uint32_t _side, uint32_t _mip)
+{
+    uint8_t *side = _gen.m_data + _side * _gen.m_sideSize;
+
+    MipLevel level;
+    level.m_src = side + _gen.m_mipOffset[_mip - 1];
+    level.m_dst = side + _gen.m_mipOffset[_mip];
+    level.m_srcWidth = bx::uint32_max(1, _gen.m_width >> (_mip - 1));
+    level.m_srcHeight = bx::uint32_max(1, _gen.m_height >> (_mip - 1));
+    level.m_srcPitch = level.m_srcWidth * _gen.m_bytesPerPixel;
+    level.m_dstWidth = bx::uint32_max(1, _gen.m_width >> _mip);
+    level.m_dstHeight = bx::uint32_max(1, _gen.m_height >> _mip);
+    level.m_dstPitch = level.m_dstWidth * _gen.m_bytesPerPixel;
+    return level;
+}
+
+static float besselI0(float _x)
+{
+    const float halfX = _x * 0.5f;
+
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (uint32_t kk = 1; term > sum * 1e-7f; ++kk)
+    {
+        const float tt = halfX / float(kk);
+        term *= tt * tt;
+        sum += term;
+    }
+    return sum;
+}
+
+/// Kaiser windowed sinc, `_x` in destination pixels.
+static float kaiserSinc(float _x)
+{
+    const float tt = _x / kKaiserWidth;
+    if (bx::abs(tt) >= 1.0f)
+    {
+        return 0.0f;
+    }
+
+    const float window = besselI0(kKaiserAlpha * bx::sqrt(1.0f - tt * tt)) / besselI0(kKaiserAlpha);
+    const float px = bx::kPi * _x;
+    const float sinc = bx::abs(px) < 1e-6f ? 1.0f : bx::sin(px) / px;
+    return window * sinc;
+}
+
+static void kernelCreate(MipKernel &_kernel, uint32_t _src, uint32_t _dst, bx::AllocatorI *_allocator)
+{
+    const float scale = float(_src) / float(_dst);
+    const uint32_t numTaps = uint32_t(bx::ceil(2.0f * kKaiserWidth * scale)) + 2;
+
+    _kernel.m_numTaps = numTaps;
+    _kernel.m_first = (int32_t *)bx::alloc(_allocator, _dst * sizeof(int32_t));
+    _kernel.m_weight = (float *)bx::alloc(_allocator, _dst * numTaps * sizeof(float));
+
+    for (uint32_t ii = 0; ii < _dst; ++ii)
+    {
+        const float center = (float(ii) + 0.5f) * scale;
+        const int32_t first = int32_t(bx::floor(center - kKaiserWidth * scale));
+        float *weight = &_kernel.m_weight[ii * numTaps];
+
+        float sum = 0.0f;
+        for (uint32_t tap = 0; tap < numTaps; ++tap)
+        {
+            weight[tap] = kaiserSinc((float(first + int32_t(tap)) + 0.5f - center) / scale);
+            sum += weight[tap];
+        }
+
+        const float invSum = 1.0f / sum;
+        for (uint32_t tap = 0; tap < numTaps; ++tap)
+        {
+            weight[tap] *= invSum;
+        }
+
+        _kernel.m_first[ii] = first;
+    }
+}
+
+static void kernelDestroy(MipKernel &_kernel, bx::AllocatorI *_allocator)
+{
+    bx::free(_allocator, _kernel.m_first);
+    bx::free(_allocator, _kernel.m_weight);
+}
+
+static int32_t clampTap(int32_t _tap, uint32_t _size)
+{
+    return bx::clamp<int32_t>(_tap, 0, int32_t(_size) - 1);
+}
+
+static void decodeRow(float *_dst, const uint8_t *_src, uint32_t _width, MipFormat::Enum _format)
+{
+    switch (_format)
+    {
+    case MipFormat::Unorm8:
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ++ii)
+        {
+            _dst[ii] = float(_src[ii]) * (1.0f / 255.0f);
+        }
+        break;
+
+    case MipFormat::Srgb8: {
+        const SrgbTable &table = getSrgbTable();
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ii += 4)
+        {
+            _dst[ii + 0] = table.m_toLinear[_src[ii + 0]];
+            _dst[ii + 1] = table.m_toLinear[_src[ii + 1]];
+            _dst[ii + 2] = table.m_toLinear[_src[ii + 2]];
+            _dst[ii + 3] = float(_src[ii + 3]) * (1.0f / 255.0f);
+        }
+    }
+    break;
+
+    case MipFormat::Half4: {
+        const uint16_t *src = (const uint16_t *)_src;
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ++ii)
+        {
+            _dst[ii] = bx::halfToFloat(src[ii]);
+        }
+    }
+    break;
+
+    default:
+        bx::memCopy(_dst, _src, _width * getNumChannels(_format) * sizeof(float));
+        break;
+    }
+}
+
+static uint8_t toUnorm8(float _value)
+{
+    return uint8_t(bx::clamp(_value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static void encodeRow(uint8_t *_dst, const float *_src, uint32_t _width, MipFormat::Enum _format)
+{
+    switch (_format)
+    {
+    case MipFormat::Unorm8:
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ++ii)
+        {
+            _dst[ii] = toUnorm8(_src[ii]);
+        }
+        break;
+
+    case MipFormat::Srgb8: {
+        const SrgbTable &table = getSrgbTable();
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ii += 4)
+        {
+            for (uint32_t ch = 0; ch < 3; ++ch)
+            {
+                const uint32_t linear = uint32_t(bx::clamp(_src[ii + ch], 0.0f, 1.0f) * 65535.0f + 0.5f);
+                _dst[ii + ch] = table.m_fromLinear16[linear];
+            }
+            _dst[ii + 3] = toUnorm8(_src[ii + 3]);
+        }
+    }
+    break;
+
+    case MipFormat::Half4: {
+        uint16_t *dst = (uint16_t *)_dst;
+        for (uint32_t ii = 0, num = _width * 4; ii < num; ++ii)
+        {
+            dst[ii] = bx::halfFromFloat(_src[ii]);
+        }
+    }
+    break;
+
+    default:
+        bx::memCopy(_dst, _src, _width * getNumChannels(_format) * sizeof(float));
+        break;
+    }
+}
+
+/// Per channel rounded average of 4 pixels, two channels per 16-bit lane so sums can't carry over.
+static uint32_t average4(uint32_t _a, uint32_t _b, uint32_t _c, uint32_t _d)
+{
+    const uint32_t mask = 0x00ff00ff;
+    const uint32_t lo = (_a & mask) + (_b & mask) + (_c & mask) + (_d & mask) + 0x00020002;
+    const uint32_t hi = ((_a >> 8) & mask) + ((_b >> 8) & mask) + ((_c >> 8) & mask) + ((_d >> 8) & mask) + 0x00020002;
+    return ((lo >> 2) & mask) | (((hi >> 2) & mask) << 8);
+}
+
+static void boxUnorm8(const MipLevel &_level, uint32_t _y0, uint32_t _y1)
+{
+    const uint32_t step = _level.m_srcWidth > 1 ? 1 : 0;
+
+    for (uint32_t yy = _y0; yy < _y1; ++yy)
+    {
+        const uint32_t srcY = yy * 2;
+        const uint32_t *row0 = (const uint32_t *)(_level.m_src + srcY * _level.m_srcPitch);
+        const uint32_t *row1 =
+            (const uint32_t *)(_level.m_src + bx::uint32_min(srcY + 1, _level.m_srcHeight - 1) * _level.m_srcPitch);
+        uint32_t *dst = (uint32_t *)(_level.m_dst + yy * _level.m_dstPitch);
+
+        for (uint32_t xx = 0; xx < _level.m_dstWidth; ++xx)
+        {
+            const uint32_t x0 = xx * 2;
+            const uint32_t x1 = x0 + step;
+            dst[xx] = average4(row0[x0], row0[x1], row1[x0], row1[x1]);
+        }
+    }
+}
+
+static void boxSrgb8(const MipLevel &_level, uint32_t _y0, uint32_t _y1)
+{
+    const SrgbTable &table = getSrgbTable();
+    const uint32_t step = _level.m_srcWidth > 1 ? 4 : 0;
+
+    for (uint32_t yy = _y0; yy < _y1; ++yy)
+    {
+        const uint32_t srcY = yy * 2;
+        const uint8_t *row0 = _level.m_src + srcY * _level.m_srcPitch;
+        const uint8_t *row1 = _level.m_src + bx::uint32_min(srcY + 1, _level.m_srcHeight - 1) * _level.m_srcPitch;
+        uint8_t *dst = _level.m_dst + yy * _level.m_dstPitch;
+
+        for (uint32_t xx = 0; xx < _level.m_dstWidth; ++xx, dst += 4)
+        {
+            const uint8_t *a = &row0[xx * 8];
+            const uint8_t *b = a + step;
+            const uint8_t *c = &row1[xx * 8];
+            const uint8_t *d = c + step;
+
+            for (uint32_t ch = 0; ch < 3; ++ch)
+            {
+                const uint32_t sum = table.m_toLinear16[a[ch]] + table.m_toLinear16[b[ch]] +
+                                     table.m_toLinear16[c[ch]] + table.m_toLinear16[d[ch]];
+                dst[ch] = table.m_fromLinear16[(sum + 2) >> 2];
+            }
+            dst[3] = uint8_t((a[3] + b[3] + c[3] + d[3] + 2) >> 2);
+        }
+    }
+}
+
+/// Box filter of float formats, rows are decoded to float, averaged and encoded back.
+static void boxFloat(const MipLevel &_level, MipFormat::Enum _format, uint32_t _y0, uint32_t _y1,
+                     bx::AllocatorI *_allocator)
+{
+    const uint32_t numChannels = getNumChannels(_format);
+    const uint32_t srcFloats = (_level.m_srcWidth * numChannels + 3) & ~3;
+    const uint32_t dstFloats = (_level.m_dstWidth * numChannels + 3) & ~3;
+
+    float *scratch = (float *)bx::alloc(_allocator, (srcFloats * 2 + dstFloats) * sizeof(float), 16);
+    float *src0 = scratch;
+    float *src1 = src0 + srcFloats;
+    float *dst = src1 + srcFloats;
+
+    const simd128_t quarter = bx::simd_splat<simd128_t>(0.25f);
+    const uint32_t step = _level.m_srcWidth > 1 ? numChannels : 0;
+
+    for (uint32_t yy = _y0; yy < _y1; ++yy)
+    {
+        const uint32_t srcY = yy * 2;
+        decodeRow(src0, _level.m_src + srcY * _level.m_srcPitch, _level.m_srcWidth, _format);
+        decodeRow(src1, _level.m_src + bx::uint32_min(srcY + 1, _level.m_srcHeight - 1) * _level.m_srcPitch,
+                  _level.m_srcWidth, _format);
+
+        if (4 == numChannels)
+        {
+            for (uint32_t xx = 0; xx < _level.m_dstWidth; ++xx)
+            {
+                const uint32_t x0 = xx * 8;
+                const uint32_t x1 = x0 + step;
+                const simd128_t sum0 =
+                    bx::simd_add(bx::simd_ld<simd128_t>(&src0[x0]), bx::simd_ld<simd128_t>(&src0[x1]));
+                const simd128_t sum1 =
+                    bx::simd_add(bx::simd_ld<simd128_t>(&src1[x0]), bx::simd_ld<simd128_t>(&src1[x1]));
+                bx::simd_st(&dst[xx * 4], bx::simd_mul(bx::simd_add(sum0, sum1), quarter));
+            }
+        }
+        else
+        {
+            for (uint32_t xx = 0; xx < _level.m_dstWidth; ++xx)
+            {
+                const uint32_t x0 = xx * 2;
+                const uint32_t x1 = x0 + step;
+                dst[xx] = (src0[x0] + src0[x1] + src1[x0] + src1[x1]) * 0.25f;
+            }
+        }
+
+        encodeRow(_level.m_dst + yy * _level.m_dstPitch, dst, _level.m_dstWidth, _format);
+    }
+
+    bx::free(_allocator, scratch, 16);
+}
+
+/// Separable filter of destination rows `[_y0, _y1)`. Source rows band needs are filtered
+/// horizontally first, then combined vertically.
+static void kaiserRows(const MipLevel &_level, const MipKernel &_kernelX, const MipKernel &_kernelY,
+                       MipFormat::Enum _format, uint32_t _y0, uint32_t _y1, bx::AllocatorI *_allocator)
+{
+    const uint32_t numChannels = getNumChannels(_format);
+    const uint32_t srcFloats = (_level.m_srcWidth * numChannels + 3) & ~3;
+    const uint32_t dstFloats = (_level.m_dstWidth * numChannels + 3) & ~3;
+
+    const int32_t lo = clampTap(_kernelY.m_first[_y0], _level.m_srcHeight);
+    const int32_t hi = clampTap(_kernelY.m_first[_y1 - 1] + int32_t(_kernelY.m_numTaps) - 1, _level.m_srcHeight);
+    const uint32_t numRows = uint32_t(hi - lo + 1);
+
+    float *scratch =
+        (float *)bx::alloc(_allocator, (numRows * dstFloats + srcFloats + dstFloats) * sizeof(float), 16);
+    float *rows = scratch;
+    float *src = rows + numRows * dstFloats;
+    float *dst = src + srcFloats;
+
+    for (uint32_t row = 0; row < numRows; ++row)
+    {
+        decodeRow(src, _level.m_src + (uint32_t(lo) + row) * _level.m_srcPitch, _level.m_srcWidth, _format);
+
+        float *out = &rows[row * dstFloats];
+        bx::memSet(out, 0, dstFloats * sizeof(float));
+
+        for (uint32_t xx = 0; xx < _level.m_dstWidth; ++xx)
+        {
+            const float *weight = &_kernelX.m_weight[xx * _kernelX.m_numTaps];
+            const int32_t first = _kernelX.m_first[xx];
+
+            if (4 == numChannels)
+            {
+                simd128_t acc = bx::simd_zero<simd128_t>();
+                for (uint32_t tap = 0; tap < _kernelX.m_numTaps; ++tap)
+                {
+                    const int32_t sx = clampTap(first + int32_t(tap), _level.m_srcWidth);
+                    acc = bx::simd_madd(bx::simd_ld<simd128_t>(&src[sx * 4]), bx::simd_splat<simd128_t>(weight[tap]),
+                                        acc);
+                }
+                bx::simd_st(&out[xx * 4], acc);
+            }
+            else
+            {
+                float acc = 0.0f;
+                for (uint32_t tap = 0; tap < _kernelX.m_numTaps; ++tap)
+                {
+                    acc += src[clampTap(first + int32_t(tap), _level.m_srcWidth)] * weight[tap];
+                }
+                out[xx] = acc;
+            }
+        }
+    }
+
+    // Rows are padded to 4 floats, vertical pass runs 4 floats at a time whatever the format.
+    for (uint32_t yy = _y0; yy < _y1; ++yy)
+    {
+        const float *weight = &_kernelY.m_weight[yy * _kernelY.m_numTaps];
+        const int32_t first = _kernelY.m_first[yy];
+
+        bx::memSet(dst, 0, dstFloats * sizeof(float));
+        for (uint32_t tap = 0; tap < _kernelY.m_numTaps; ++tap)
+        {
+            if (0.0f == weight[tap])
+            {
+                continue;
+            }
+
+            const float *row = &rows[(clampTap(first + int32_t(tap), _level.m_srcHeight) - lo) * dstFloats];
+            const simd128_t ww = bx::simd_splat<simd128_t>(weight[tap]);
+            for (uint32_t ii = 0; ii < dstFloats; ii += 4)
+            {
+                const simd128_t acc = bx::simd_ld<simd128_t>(&dst[ii]);
+                bx::simd_st(&dst[ii], bx::simd_madd(bx::simd_ld<simd128_t>(&row[ii]), ww, acc));
+            }
+        }
+
+        encodeRow(_level.m_dst + yy * _level.m_dstPitch, dst, _level.m_dstWidth, _format);
+    }
+
+    bx::free(_allocator, scratch, 16);
+}
+
+static void filterRows(const MipGen &_gen, const MipLevel &_level, const MipKernel &_kernelX,
+                       const MipKernel &_kernelY, uint32_t _y0, uint32_t _y1)
+{
+    if (MipFilter::Kaiser == _gen.m_filter)
+    {
+        kaiserRows(_level, _kernelX, _kernelY, _gen.m_format, _y0, _y1, _gen.m_allocator);
+        return;
+    }
+
+    switch (_gen.m_format)
+    {
+    case MipFormat::Unorm8:
+        boxUnorm8(_level, _y0, _y1);
+        break;
+    case MipFormat::Srgb8:
+        boxSrgb8(_level, _y0, _y1);
+        break;
+    default:
+        boxFloat(_level, _gen.m_format, _y0, _y1, _gen.m_allocator);
+        break;
+    }
+}
+
+static void mipBandJob(void *_userData, uint32_t _begin, uint32_t _end)
+{
+    const MipGen &gen = *(const MipGen *)_userData;
+
+    for (uint32_t item = _begin; item < _end; ++item)
+    {
+        const uint32_t side = item / gen.m_numBands;
+        const uint32_t band = item % gen.m_numBands;
+
+        const MipLevel level = getLevel(gen, side, gen.m_mip);
+        const uint32_t y0 = band * BGFX_CONFIG_MIPGEN_BAND_ROWS;
+        const uint32_t y1 = bx::uint32_min(y0 + BGFX_CONFIG_MIPGEN_BAND_ROWS, level.m_dstHeight);
+        filterRows(gen, level, gen.m_kernelX, gen.m_kernelY, y0, y1);
+    }
+}
+
+/// Remaining mips of one side, too small to split in bands.
+static void mipTailJob(void *_userData, uint32_t _begin, uint32_t _end)
+{
+    const MipGen &gen = *(const MipGen *)_userData;
+
+    for (uint32_t side = _begin; side < _end; ++side)
+    {
+        for (uint32_t mip = gen.m_mip; mip < gen.m_numMips; ++mip)
+        {
+            const MipLevel level = getLevel(gen, side, mip);
+
+            MipKernel kernelX = {};
+            MipKernel kernelY = {};
+            if (MipFilter::Kaiser == gen.m_filter)
+            {
+                kernelCreate(kernelX, level.m_srcWidth, level.m_dstWidth, gen.m_allocator);
+                kernelCreate(kernelY, level.m_srcHeight, level.m_dstHeight, gen.m_allocator);
+            }
+
+            filterRows(gen, level, kernelX, kernelY, 0, level.m_dstHeight);
+
+            if (MipFilter::Kaiser == gen.m_filter)
+            {
+                kernelDestroy(kernelX, gen.m_allocator);
+                kernelDestroy(kernelY, gen.m_allocator);
+            }
+        }
+    }
+}
+
+static void runJobs(JobPool *_pool, JobFn _fn, void *_userData, uint32_t _num)
+{
+    if (NULL != _pool)
+    {
+        _pool->parallelFor(_fn, _userData, _num);
+    }
+    else
+    {
+        _fn(_userData, 0, _num);
+    }
+}
+
+bool mipIsSupported(TextureFormat::Enum _format)
+{
+    return MipFormat::Count != getMipFormat(_format);
+}
+
+bool mipGenerate(void *_data, const TextureInfo &_info, MipFilter::Enum _filter, JobPool *_pool,
+                 bx::AllocatorI *_allocator)
+{
+    const MipFormat::Enum format = getMipFormat(_info.format);
+    if (MipFormat::Count == format || MipFilter::Count <= _filter)
+    {
+        BX_TRACE("WARNING: Can't generate mips of format %d.", _info.format);
+        return false;
+    }
+
+    BX_ASSERT(_info.numMips <= kMaxMips, "Too many mips %d.", _info.numMips);
+
+    if (MipFormat::Srgb8 == format)
+    {
+        // Build tables before jobs need them.
+        getSrgbTable();
+    }
+
+    MipGen gen;
+    gen.m_data = (uint8_t *)_data;
+    gen.m_allocator = _allocator;
+    gen.m_format = format;
+    gen.m_filter = _filter;
+    gen.m_width = _info.width;
+    gen.m_height = _info.height;
+    gen.m_bytesPerPixel = _info.bitsPerPixel / 8;
+    gen.m_numMips = _info.numMips;
+    gen.m_numSides = _info.cubeMap ? 6 : 1;
+    gen.m_sideSize = _info.storageSize / gen.m_numSides;
+
+    uint32_t offset = 0;
+    for (uint32_t mip = 0; mip < gen.m_numMips; ++mip)
+    {
+        gen.m_mipOffset[mip] = offset;
+        offset += bx::uint32_max(1, gen.m_width >> mip) * bx::uint32_max(1, gen.m_height >> mip) * gen.m_bytesPerPixel;
+    }
+
+    for (uint32_t mip = 1; mip < gen.m_numMips; ++mip)
+    {
+        gen.m_mip = mip;
+
+        const uint32_t dstHeight = bx::uint32_max(1, gen.m_height >> mip);
+        if (dstHeight <= BGFX_CONFIG_MIPGEN_BAND_ROWS)
+        {
+            runJobs(_pool, mipTailJob, &gen, gen.m_numSides);
+            break;
+        }
+
+        gen.m_numBands = (dstHeight + BGFX_CONFIG_MIPGEN_BAND_ROWS - 1) / BGFX_CONFIG_MIPGEN_BAND_ROWS;
+
+        if (MipFilter::Kaiser == _filter)
+        {
+            kernelCreate(gen.m_kernelX, bx::uint32_max(1, gen.m_width >> (mip - 1)),
+                         bx::uint32_max(1, gen.m_width >> mip), _allocator);
+            kernelCreate(gen.m_kernelY, bx::uint32_max(1, gen.m_height >> (mip - 1)), dstHeight, _allocator);
+        }
+
+        runJobs(_pool, mipBandJob, &gen, gen.m_numSides * gen.m_numBands);
+
+        if (MipFilter::Kaiser == _filter)
+        {
+            kernelDestroy(gen.m_kernelX, _allocator);
+            kernelDestroy(gen.m_kernelY, _allocator);
+        }
+    }
+
+    return true;
+}
+
+} // namespace TinyRender
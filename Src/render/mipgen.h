@@ -0,0 +1,49 @@
+#pragma once
+
+#include "tiny_render.h"
+
+namespace bx
+{
+struct AllocatorI;
+}
+
+namespace TinyRender
+{
+
+struct JobPool;
+
+/// Mip generator downsample filters.
+struct MipFilter
+{
+    enum Enum
+    {
+        Box,    //!< 2x2 average. Odd last row and column of source mip are dropped.
+        Kaiser, //!< Kaiser windowed sinc, 3 destination pixels wide. Sharper, several times slower.
+
+        Count
+    };
+};
+
+/// Returns true if `mipGenerate` can filter `_format`. Supported are `BGRA8`, `RGBA8`, `SRGBA8`,
+/// `RGBA16F`, `RGBA32F` and `R32F`.
+bool mipIsSupported(TextureFormat::Enum _format);
+
+/// Generate mips from mip 0 of every side, each mip is filtered from previous one.
+///
+/// `SRGBA8` color is filtered in linear space and encoded back to sRGB, alpha and other formats are
+/// filtered as they are. Unorm results are clamped, float ones are not.
+///
+/// @param[in,out] _data Whole texture laid out as described in `calcTextureSize`, mip 0 of each side
+///   filled. All other mips are overwritten.
+/// @param[in] _info Texture description from `calcTextureSize`.
+/// @param[in] _filter Downsample filter.
+/// @param[in] _pool Job pool, rows of a mip are split in bands filtered in parallel. Small mips of
+///   each side are done in one job per side. NULL runs everything on calling thread.
+/// @param[in] _allocator Allocator for filter scratch memory.
+///
+/// @returns False when format isn't supported.
+///
+bool mipGenerate(void *_data, const TextureInfo &_info, MipFilter::Enum _filter, JobPool *_pool,
+                 bx::AllocatorI *_allocator);
+
+} // namespace TinyRender
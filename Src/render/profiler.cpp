@@ -0,0 +1,176 @@
+#include <bx/cpu.h>
+#include <bx/file.h>
+#include <bx/timer.h>
+
+#include "entry.h"
+#include "profiler.h"
+#include "tiny_render_p.h"
+
+namespace TinyRender
+{
+
+#if BGFX_CONFIG_PROFILER
+
+static_assert(bx::isPowerOf2(BGFX_CONFIG_PROFILER_RING_SIZE), "BGFX_CONFIG_PROFILER_RING_SIZE must be power of 2.");
+
+struct ProfilerEvent
+{
+    const char *m_name;
+    uint64_t m_begin;
+    uint64_t m_end;
+};
+
+/// Ring of one thread. Only owning thread writes events and `m_write`, export only reads them.
+struct ProfilerThread
+{
+    ProfilerEvent *m_events;
+    volatile uint32_t m_write; //!< Number of events ever written.
+    volatile uint32_t m_start; //!< First event to export, moved by `profilerReset`.
+    uint32_t m_tid;
+};
+
+static ProfilerThread *s_threads[BGFX_CONFIG_PROFILER_MAX_THREADS];
+static volatile uint32_t s_numThreads;
+
+static thread_local ProfilerThread *t_thread;
+static thread_local bool t_dropped;
+
+// Clock origins, used to convert TSC to microseconds at export.
+static const uint64_t s_tscOrigin = profilerTicks();
+static const int64_t s_hpOrigin = bx::getHPCounter();
+
+static ProfilerThread *registerThread()
+{
+    const uint32_t idx = bx::atomicFetchAndAdd<uint32_t>(&s_numThreads, 1);
+    if (BGFX_CONFIG_PROFILER_MAX_THREADS <= idx)
+    {
+        BX_TRACE("WARNING: Profiler thread limit reached (BGFX_CONFIG_PROFILER_MAX_THREADS, max: %d).",
+                 BGFX_CONFIG_PROFILER_MAX_THREADS);
+        t_dropped = true;
+        return NULL;
+    }
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Command);
+    ProfilerThread *thread = BX_NEW(allocator, ProfilerThread);
+    thread->m_events =
+        (ProfilerEvent *)bx::alloc(allocator, BGFX_CONFIG_PROFILER_RING_SIZE * sizeof(ProfilerEvent));
+    thread->m_write = 0;
+    thread->m_start = 0;
+    thread->m_tid = idx;
+
+    bx::writeBarrier();
+    s_threads[idx] = thread;
+    return thread;
+}
+
+void profilerRecord(const char *_name, uint64_t _begin, uint64_t _end)
+{
+    ProfilerThread *thread = t_thread;
+    if (BX_UNLIKELY(NULL == thread))
+    {
+        if (t_dropped)
+        {
+            return;
+        }
+
+        thread = t_thread = registerThread();
+        if (NULL == thread)
+        {
+            return;
+        }
+    }
+
+    const uint32_t write = thread->m_write;
+    ProfilerEvent &event = thread->m_events[write & (BGFX_CONFIG_PROFILER_RING_SIZE - 1)];
+    event.m_name = _name;
+    event.m_begin = _begin;
+    event.m_end = _end;
+
+    // Publish event before count.
+    bx::writeBarrier();
+    thread->m_write = write + 1;
+}
+
+void profilerReset()
+{
+    const uint32_t numThreads = bx::min<uint32_t>(uint32_t(s_numThreads), BGFX_CONFIG_PROFILER_MAX_THREADS);
+    for (uint32_t ii = 0; ii < numThreads; ++ii)
+    {
+        ProfilerThread *thread = s_threads[ii];
+        if (NULL != thread)
+        {
+            thread->m_start = thread->m_write;
+        }
+    }
+}
+
+bool profilerExport(const char *_filePath)
+{
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _filePath))
+    {
+        return false;
+    }
+
+    const uint64_t tsc = profilerTicks();
+    const int64_t hp = bx::getHPCounter();
+    const double seconds = double(hp - s_hpOrigin) / double(bx::getHPFrequency());
+    const double usPerTick = 1e6 * seconds / double(tsc - s_tscOrigin);
+
+    bx::Error err;
+    bx::write(writer, &err, "{\"traceEvents\":[\n");
+    bx::write(writer, &err, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"TinyRender\"}}");
+
+    const uint32_t numThreads = bx::min<uint32_t>(uint32_t(s_numThreads), BGFX_CONFIG_PROFILER_MAX_THREADS);
+    for (uint32_t ii = 0; ii < numThreads; ++ii)
+    {
+        const ProfilerThread *thread = s_threads[ii];
+        if (NULL == thread)
+        {
+            continue;
+        }
+
+        bx::write(writer, &err,
+                  ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                  thread->m_tid, thread->m_tid);
+
+        const uint32_t end = thread->m_write;
+        bx::readBarrier();
+
+        // Ring keeps only the last BGFX_CONFIG_PROFILER_RING_SIZE events.
+        uint32_t start = thread->m_start;
+        if (end - start > BGFX_CONFIG_PROFILER_RING_SIZE)
+        {
+            start = end - BGFX_CONFIG_PROFILER_RING_SIZE;
+        }
+
+        for (uint32_t jj = start; jj != end; ++jj)
+        {
+            const ProfilerEvent &event = thread->m_events[jj & (BGFX_CONFIG_PROFILER_RING_SIZE - 1)];
+            bx::write(writer, &err, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      event.m_name, thread->m_tid, double(event.m_begin - s_tscOrigin) * usPerTick,
+                      double(event.m_end - event.m_begin) * usPerTick);
+        }
+    }
+
+    bx::write(writer, &err, "\n]}\n");
+    bx::close(writer);
+
+    return err.isOk();
+}
+
+#else
+
+void profilerReset()
+{
+}
+
+bool profilerExport(const char *_filePath)
+{
+    BX_UNUSED(_filePath);
+    return false;
+}
+
+#endif // BGFX_CONFIG_PROFILER
+
+} // namespace TinyRender
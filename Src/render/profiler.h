@@ -0,0 +1,62 @@
+#pragma once
+
+#include <bx/bx.h>
+
+#include "defines.h"
+
+#if BGFX_CONFIG_PROFILER
+#if BX_COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif // BX_COMPILER_MSVC
+#endif // BGFX_CONFIG_PROFILER
+
+namespace TinyRender
+{
+
+/// Write all recorded scopes to Chrome/Perfetto JSON trace through `entry::getFileWriter`.
+/// Returns `false` when profiler is compiled out or file can't be opened.
+///
+/// Scopes are recorded into per-thread rings, threads keep recording while exporting, so
+/// events written during export may be missing or, if a ring wraps, cut.
+///
+bool profilerExport(const char *_filePath);
+
+/// Drop everything recorded so far.
+void profilerReset();
+
+#if BGFX_CONFIG_PROFILER
+
+/// Profiler clock. TSC is invariant on every x86-64 CPU we run on, and reading it is much
+/// cheaper than `bx::getHPCounter`. It's converted to time at export.
+inline uint64_t profilerTicks()
+{
+    return __rdtsc();
+}
+
+/// Append scope to calling thread ring. `_name` must have static storage duration.
+void profilerRecord(const char *_name, uint64_t _begin, uint64_t _end);
+
+struct ProfilerScope
+{
+    ProfilerScope(const char *_name) : m_name(_name), m_begin(profilerTicks()) {}
+
+    ~ProfilerScope()
+    {
+        profilerRecord(m_name, m_begin, profilerTicks());
+    }
+
+    const char *m_name;
+    uint64_t m_begin;
+};
+
+#define BGFX_PROFILER_SCOPE(_name) TinyRender::ProfilerScope BX_CONCATENATE(profilerScope, __LINE__)(_name)
+
+#else
+
+#define BGFX_PROFILER_SCOPE(_name) BX_NOOP()
+
+#endif // BGFX_CONFIG_PROFILER
+
+} // namespace TinyRender
@@ -4,6 +4,8 @@
 
 #include "rhi_d3d12.h"
 
+#include <bx/allocator.h>
+
 #include "d3dx12.h"
 #include <D3Dcompiler.h>
 #include <DirectXMath.h>
@@ -23,13 +25,115 @@ const UINT FrameCount = 2;
 // Define the interface ID for ID3D12Resource
 static const GUID IID_ID3D12Resource = {0x696442be, 0xa72e, 0x4059, {0xbc, 0x79, 0x5b, 0x5c, 0x98, 0x04, 0x0f, 0xad}};
 
+static const DXGI_FORMAT s_textureFormat[] = {
+    DXGI_FORMAT_B8G8R8A8_UNORM,      // BGRA8
+    DXGI_FORMAT_R8G8B8A8_UNORM,      // RGBA8
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, // SRGBA8
+    DXGI_FORMAT_R16G16B16A16_FLOAT,  // RGBA16F
+    DXGI_FORMAT_R32G32B32A32_FLOAT,  // RGBA32F
+    DXGI_FORMAT_R32_FLOAT,           // R32F
+    DXGI_FORMAT_BC1_UNORM,           // BC1
+    DXGI_FORMAT_BC3_UNORM,           // BC3
+    DXGI_FORMAT_BC4_UNORM,           // BC4
+    DXGI_FORMAT_BC5_UNORM,           // BC5
+    DXGI_FORMAT_BC7_UNORM,           // BC7
+    DXGI_FORMAT_UNKNOWN,             // UnknownDepth
+    DXGI_FORMAT_D24_UNORM_S8_UINT,   // D24S8
+    DXGI_FORMAT_D32_FLOAT,           // D32F
+};
+static_assert(BX_COUNTOF(s_textureFormat) == TextureFormat::Count);
+
+/// Indexed by `BGFX_STATE_DEPTH_TEST_*` value, 0 is depth test disabled.
+static const D3D12_COMPARISON_FUNC s_cmpFunc[] = {
+    D3D12_COMPARISON_FUNC(0),
+    D3D12_COMPARISON_FUNC_LESS,
+    D3D12_COMPARISON_FUNC_LESS_EQUAL,
+    D3D12_COMPARISON_FUNC_EQUAL,
+    D3D12_COMPARISON_FUNC_GREATER_EQUAL,
+    D3D12_COMPARISON_FUNC_GREATER,
+    D3D12_COMPARISON_FUNC_NOT_EQUAL,
+    D3D12_COMPARISON_FUNC_NEVER,
+    D3D12_COMPARISON_FUNC_ALWAYS,
+};
+
+/// Indexed by `BGFX_STATE_BLEND_*` factor, RGB and alpha variant.
+static const D3D12_BLEND s_blendFactor[][2] = {
+    {D3D12_BLEND(0), D3D12_BLEND(0)},                             // ignored
+    {D3D12_BLEND_ZERO, D3D12_BLEND_ZERO},                         // ZERO
+    {D3D12_BLEND_ONE, D3D12_BLEND_ONE},                           // ONE
+    {D3D12_BLEND_SRC_COLOR, D3D12_BLEND_SRC_ALPHA},               // SRC_COLOR
+    {D3D12_BLEND_INV_SRC_COLOR, D3D12_BLEND_INV_SRC_ALPHA},       // INV_SRC_COLOR
+    {D3D12_BLEND_SRC_ALPHA, D3D12_BLEND_SRC_ALPHA},               // SRC_ALPHA
+    {D3D12_BLEND_INV_SRC_ALPHA, D3D12_BLEND_INV_SRC_ALPHA},       // INV_SRC_ALPHA
+    {D3D12_BLEND_DEST_ALPHA, D3D12_BLEND_DEST_ALPHA},             // DST_ALPHA
+    {D3D12_BLEND_INV_DEST_ALPHA, D3D12_BLEND_INV_DEST_ALPHA},     // INV_DST_ALPHA
+    {D3D12_BLEND_DEST_COLOR, D3D12_BLEND_DEST_ALPHA},             // DST_COLOR
+    {D3D12_BLEND_INV_DEST_COLOR, D3D12_BLEND_INV_DEST_ALPHA},     // INV_DST_COLOR
+    {D3D12_BLEND_SRC_ALPHA_SAT, D3D12_BLEND_ONE},                 // SRC_ALPHA_SAT
+    {D3D12_BLEND_BLEND_FACTOR, D3D12_BLEND_BLEND_FACTOR},         // FACTOR
+    {D3D12_BLEND_INV_BLEND_FACTOR, D3D12_BLEND_INV_BLEND_FACTOR}, // INV_FACTOR
+};
+
+static const D3D12_BLEND_OP s_blendEquation[] = {
+    D3D12_BLEND_OP_ADD,
+    D3D12_BLEND_OP_SUBTRACT,
+    D3D12_BLEND_OP_REV_SUBTRACT,
+    D3D12_BLEND_OP_MIN,
+    D3D12_BLEND_OP_MAX,
+};
+
+/// Indexed by `BGFX_STATE_PT_*` value.
+static const D3D_PRIMITIVE_TOPOLOGY s_primTopology[] = {
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP,
+    D3D_PRIMITIVE_TOPOLOGY_LINELIST,
+    D3D_PRIMITIVE_TOPOLOGY_LINESTRIP,
+    D3D_PRIMITIVE_TOPOLOGY_POINTLIST,
+};
+
+static const D3D12_PRIMITIVE_TOPOLOGY_TYPE s_primTopologyType[] = {
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_POINT,
+};
+
+static bool isStrip(uint64_t _state)
+{
+    const uint64_t pt = _state & BGFX_STATE_PT_MASK;
+    return BGFX_STATE_PT_TRISTRIP == pt || BGFX_STATE_PT_LINESTRIP == pt;
+}
+
+/// Indexed by `BGFX_STATE_CULL_*` value, front face is picked by `BGFX_STATE_FRONT_CCW`.
+static const D3D12_CULL_MODE s_cullMode[] = {
+    D3D12_CULL_MODE_NONE,
+    D3D12_CULL_MODE_FRONT,
+    D3D12_CULL_MODE_BACK,
+};
+
+void setResourceBarrier(ID3D12GraphicsCommandList *_commandList, const ID3D12Resource *_resource,
+                        D3D12_RESOURCE_STATES _stateBefore, D3D12_RESOURCE_STATES _stateAfter);
+
+/// Create 2D texture with single mip. Render targets get optimized clear value matching default
+/// clear of samples, views clearing to it take fast clear path.
+ID3D12Resource *createTexture(ID3D12Device *_device, uint16_t _width, uint16_t _height, DXGI_FORMAT _format,
+                              D3D12_RESOURCE_FLAGS _flags,
+                              D3D12_RESOURCE_STATES _state = D3D12_RESOURCE_STATE_COMMON);
+
 struct RendererContextD3D12 : public RendererContextI
 {
     ~RendererContextD3D12() {}
 
-    void init(const InitParams &_init)
+    RendererType::Enum getRendererType() const
+    {
+        return RendererType::Direct3D12;
+    }
+
+    bool init(const InitParams &_init)
     {
         m_hwnd = static_cast<HWND>(_init.hwnd);
+
         int Width = _init.width;
         int Height = _init.height;
 
@@ -42,10 +146,37 @@ struct RendererContextD3D12 : public RendererContextI
         
         // 创建设备
         Microsoft::WRL::ComPtr<IDXGIFactory4> factory;
-        CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+        if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))))
+        {
+            BX_TRACE("Failed to create DXGI factory.");
+            return false;
+        }
+
+        // First hardware adapter that supports D3D12, WARP software rasterizer when there is none.
         Microsoft::WRL::ComPtr<IDXGIAdapter1> adapter;
-        factory->EnumAdapters1(0, &adapter);
-        D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device));
+        for (UINT ii = 0; DXGI_ERROR_NOT_FOUND != factory->EnumAdapters1(ii, &adapter); ++ii)
+        {
+            DXGI_ADAPTER_DESC1 desc;
+            adapter->GetDesc1(&desc);
+            if (0 == (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) &&
+                SUCCEEDED(D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
+            {
+                break;
+            }
+        }
+
+        if (NULL == m_device.Get())
+        {
+            Microsoft::WRL::ComPtr<IDXGIAdapter> warp;
+            if (FAILED(factory->EnumWarpAdapter(IID_PPV_ARGS(&warp))) ||
+                FAILED(D3D12CreateDevice(warp.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
+            {
+                BX_TRACE("No Direct3D 12 device available.");
+                return false;
+            }
+
+            BX_TRACE("No Direct3D 12 hardware adapter, using WARP.");
+        }
 
         // 创建命令队列
         D3D12_COMMAND_QUEUE_DESC queueDesc = {};
@@ -53,47 +184,139 @@ struct RendererContextD3D12 : public RendererContextI
         queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
         m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue));
 
-        // 创建交换链
-        DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-        swapChainDesc.BufferCount = FrameCount;
-        swapChainDesc.Width = Width;
-        swapChainDesc.Height = Height;
-        swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-        swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-        swapChainDesc.SampleDesc.Count = 1;
-
-        Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain;
-        factory->CreateSwapChainForHwnd(m_commandQueue.Get(), m_hwnd, &swapChainDesc, nullptr, nullptr, &swapChain);
-        swapChain.As(&m_swapChain);
-        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
-
-        // 创建RTV描述符堆
+        // 创建交换链, 没有窗口时后台缓冲区是离屏纹理
+        if (NULL != m_hwnd)
+        {
+            DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+            swapChainDesc.BufferCount = FrameCount;
+            swapChainDesc.Width = Width;
+            swapChainDesc.Height = Height;
+            swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+            swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+            swapChainDesc.SampleDesc.Count = 1;
+
+            Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain;
+            if (FAILED(factory->CreateSwapChainForHwnd(m_commandQueue.Get(), m_hwnd, &swapChainDesc, nullptr,
+                                                       nullptr, &swapChain)))
+            {
+                BX_TRACE("Failed to create swap chain.");
+                return false;
+            }
+            swapChain.As(&m_swapChain);
+            m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+        }
+        else
+        {
+            m_frameIndex = 0;
+        }
+        m_width = uint16_t(Width);
+        m_height = uint16_t(Height);
+
+        // 创建RTV描述符堆, 后台缓冲区在前, 帧缓冲区在后
         D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-        rtvHeapDesc.NumDescriptors = FrameCount;
+        rtvHeapDesc.NumDescriptors = FrameCount + BGFX_CONFIG_MAX_FRAME_BUFFERS;
         rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
         rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
         m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap));
         m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
+        // 创建DSV描述符堆, 帧缓冲区在前, 后台缓冲区深度在最后
+        D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc = {};
+        dsvHeapDesc.NumDescriptors = BGFX_CONFIG_MAX_FRAME_BUFFERS + 1;
+        dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+        dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        m_device->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&m_dsvHeap));
+        m_dsvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+
+        // 创建着色器可见的 CBV/SRV/UAV 描述符堆, 所有绘制共用 (bindless). 前部静态分配, 后部每帧线性分配
+        m_descriptorAlloc.create(BGFX_CONFIG_MAX_DESCRIPTORS, BGFX_CONFIG_MAX_DESCRIPTOR_ALLOCS,
+                                 BGFX_CONFIG_MAX_TRANSIENT_DESCRIPTORS, FrameCount, getAllocator(MemoryCategory::Command));
+        D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+        srvHeapDesc.NumDescriptors = m_descriptorAlloc.getNumDescriptors();
+        srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+        if (FAILED(m_device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap))))
+        {
+            BX_TRACE("Failed to create descriptor heap.");
+            return false;
+        }
+        m_srvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
         // 创建渲染目标视图
         CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
         for (UINT i = 0; i < FrameCount; i++)
         {
-            m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_renderTargets[i]));
+            if (NULL != m_swapChain.Get())
+            {
+                m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_renderTargets[i]));
+            }
+            else
+            {
+                m_renderTargets[i].Attach(d3d12::createTexture(m_device.Get(), m_width, m_height,
+                                                               DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                               D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET));
+            }
             m_device->CreateRenderTargetView(m_renderTargets[i].Get(), nullptr, rtvHandle);
             rtvHandle.Offset(1, m_rtvDescriptorSize);
         }
+        m_backBufferState = D3D12_RESOURCE_STATE_PRESENT;
+
+        // 创建后台缓冲区深度, GPU 按顺序执行帧, 所有后台缓冲区共用一个
+        m_backBufferDsvFormat = DXGI_FORMAT_UNKNOWN;
+        if (0 != _init.maxDepth)
+        {
+            m_backBufferDsvFormat = s_textureFormat[TextureFormat::D24S8];
+            m_backBufferDepth.Attach(d3d12::createTexture(m_device.Get(), m_width, m_height, m_backBufferDsvFormat,
+                                                          D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL |
+                                                              D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE,
+                                                          D3D12_RESOURCE_STATE_DEPTH_WRITE));
+            m_backBufferDsv = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_dsvHeap->GetCPUDescriptorHandleForHeapStart(),
+                                                            BGFX_CONFIG_MAX_FRAME_BUFFERS, m_dsvDescriptorSize);
+            m_device->CreateDepthStencilView(m_backBufferDepth.Get(), nullptr, m_backBufferDsv);
+        }
 
-        // 创建命令分配器
-        m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocator));
+        // 创建命令分配器, 每帧一个, GPU 用完才能重置
+        for (UINT i = 0; i < FrameCount; i++)
+        {
+            m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocator[i]));
+            m_frameFence[i] = 0;
+        }
 
-        // 创建命令列表
-        m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList));
+        // 创建命令列表, 保持打开状态, 帧之间创建资源的上传也录制在里面
+        m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocator[0].Get(), nullptr,
+                                    IID_PPV_ARGS(&m_commandList));
+        invalidateBindings();
+        m_backBufferUsed = false;
+
+        // 创建共享根签名, 所有 PSO 共用, 绘制之间不切换. 着色器用根常量里的下标直接索引描述符堆.
+        // 资源绑定层级 1 和 2 限制表大小, 着色器只能看到堆的前部.
+        D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+        m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+        const uint32_t numDescriptors = m_descriptorAlloc.getNumDescriptors();
+        const uint32_t numSrvs =
+            D3D12_RESOURCE_BINDING_TIER_1 == options.ResourceBindingTier ? 128 : numDescriptors;
+        const uint32_t numUavs = D3D12_RESOURCE_BINDING_TIER_3 == options.ResourceBindingTier ? numDescriptors
+                                 : D3D12_RESOURCE_BINDING_TIER_2 == options.ResourceBindingTier ? 64
+                                                                                                 : 8;
+
+        CD3DX12_DESCRIPTOR_RANGE ranges[2];
+        ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, numSrvs, 0, 0, 0);
+        ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, numUavs, 0, 1, 0);
+
+        CD3DX12_ROOT_PARAMETER rootParams[RootParam::Count];
+        rootParams[RootParam::Constants].InitAsConstants(BGFX_CONFIG_MAX_ROOT_CONSTANTS, 0);
+        rootParams[RootParam::DescriptorTable].InitAsDescriptorTable(BX_COUNTOF(ranges), ranges);
+        rootParams[RootParam::Model].InitAsConstants(16, 1);
+
+        CD3DX12_STATIC_SAMPLER_DESC samplers[2];
+        samplers[0].Init(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
+        samplers[1].Init(1, D3D12_FILTER_MIN_MAG_MIP_POINT, D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+                         D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP);
 
-        // 创建根签名
         CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
-        rootSignatureDesc.Init(0, nullptr, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+        rootSignatureDesc.Init(BX_COUNTOF(rootParams), rootParams, BX_COUNTOF(samplers), samplers,
+                               D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
         Microsoft::WRL::ComPtr<ID3DBlob> signature;
         Microsoft::WRL::ComPtr<ID3DBlob> error;
         D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
@@ -104,9 +327,112 @@ struct RendererContextD3D12 : public RendererContextI
         m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
         m_fenceValue = 1;
         m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+        // 创建临时顶点/索引缓冲区
+        m_transientVb.create(BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE, FrameCount);
+        m_transientIb.create(BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE, FrameCount);
+        m_transientFrame = 0;
+        m_frameStats.reset();
+
+        // 创建上传缓冲区
+        m_upload.create(BGFX_CONFIG_UPLOAD_BUFFER_SIZE, FrameCount);
+        m_uploadOffset = 0;
+
+        return true;
+    }
+
+    void Shutdown()
+    {
+        // Init may have failed half way.
+        if (NULL != m_fence.Get())
+        {
+            if (NULL != m_commandList.Get())
+            {
+                m_commandList->Close();
+                ID3D12CommandList *commandLists[] = {m_commandList.Get()};
+                m_commandQueue->ExecuteCommandLists(BX_COUNTOF(commandLists), commandLists);
+            }
+
+            m_commandQueue->Signal(m_fence.Get(), m_fenceValue);
+            waitForFence(m_fenceValue);
+            m_fenceValue++;
+
+            processReadbacks();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_vertexBuffers); ++ii)
+        {
+            m_vertexBuffers[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_indexBuffers); ++ii)
+        {
+            m_indexBuffers[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_frameBuffers); ++ii)
+        {
+            m_frameBuffers[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_textures); ++ii)
+        {
+            m_textures[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_pso); ++ii)
+        {
+            m_pso[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_program); ++ii)
+        {
+            m_program[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_shaders); ++ii)
+        {
+            m_shaders[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_readbacks); ++ii)
+        {
+            ReadbackD3D12 &readback = m_readbacks[ii];
+            if (NULL != readback.m_buffer)
+            {
+                trackFree(MemoryCategory::Staging, readback.m_capacity);
+                readback.m_buffer->Release();
+                readback.m_buffer = NULL;
+            }
+        }
+
+        m_bufferPool.destroy();
+        m_descriptorAlloc.destroy();
+        for (uint32_t ii = 0; ii < FrameCount; ++ii)
+        {
+            m_release[ii].destroy();
+            trackFree(MemoryCategory::Staging, m_stagingSize[ii], m_numStaging[ii]);
+        }
+
+        m_transientVb.destroy();
+        m_transientIb.destroy();
+        m_upload.destroy();
+    }
+
+    /// Queue resource for release once GPU is done with frame being recorded.
+    void release(ID3D12Resource *_ptr)
+    {
+        m_release[m_transientFrame].push(_ptr);
     }
 
-    void Shutdown() {}
+    void waitForFence(UINT64 _fence)
+    {
+        if (m_fence->GetCompletedValue() < _fence)
+        {
+            m_fence->SetEventOnCompletion(_fence, m_fenceEvent);
+            WaitForSingleObject(m_fenceEvent, INFINITE);
+        }
+    }
 
     void createIndexBuffer(IndexBufferHandle _handle, const void *_data, uint32_t _size, uint16_t _flags)
     {
@@ -128,29 +454,56 @@ struct RendererContextD3D12 : public RendererContextI
         m_vertexBuffers[_handle.idx].create(_size, _data, _layoutHandle, _flags);
     }
 
-    void destroyVertexBuffer(VertexBufferHandle _handle) {}
+    void destroyVertexBuffer(VertexBufferHandle _handle)
+    {
+        m_vertexBuffers[_handle.idx].destroy();
+    }
+
+    void destroyIndexBuffer(IndexBufferHandle _handle)
+    {
+        m_indexBuffers[_handle.idx].destroy();
+    }
+
+    void updateVertexBuffer(VertexBufferHandle _handle, uint32_t _offset, uint32_t _size, const void *_data)
+    {
+        m_vertexBuffers[_handle.idx].updateDynamic(_offset, _size, _data);
+    }
+
+    void updateIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, const void *_data)
+    {
+        m_indexBuffers[_handle.idx].updateDynamic(_offset, _size, _data);
+    }
+
+    /// Allocate `_size` bytes of staging memory for copies recorded this frame. Texture copies need
+    /// `_align` of `D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT`.
+    uint8_t *allocUpload(uint32_t _size, ID3D12Resource *&_resource, uint64_t &_offset, uint32_t _align = 16);
 
-    void destroyIndexBuffer(IndexBufferHandle _handle) {}
+    bool createShader(ShaderHandle _handle, const void *_data, uint32_t _size, ShaderType _type)
+    {
+        return m_shaders[_handle.idx].create(_data, _size, _type);
+    }
 
-    void createShader(ShaderHandle _handle, const void *_data, uint32_t _size, ShaderType _type)
+    void destroyShader(ShaderHandle _handle)
     {
-        m_shaders[_handle.idx].create(_data, _size, _type);
+        m_shaders[_handle.idx].destroy();
     }
 
+    uint8_t *compileShader(const void *_data, uint32_t _size, ShaderType _type, uint32_t &_outSize);
+
     void createProgram(ProgramHandle _handle, ShaderHandle _vsh, ShaderHandle _fsh)
     {
-        m_program[_handle.idx].create(&m_shaders[_vsh.idx], &m_shaders[_fsh.idx]);
+        m_program[_handle.idx].create(&m_shaders[_vsh.idx], isValid(_fsh) ? &m_shaders[_fsh.idx] : NULL);
     }
 
-    void createPSO(PSOHandle _handle, ProgramHandle _program, const VertexLayout &_layout, uint16_t _flags)
+    void createPSO(PSOHandle _handle, ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags)
     {
         m_pso[_handle.idx].create(&m_program[_program.idx], &_layout, _flags);
     }
 
-    void beginFrame(const View &_view)
+    void beginView(const View &_view)
     {
-        m_commandAllocator->Reset();
-        m_commandList->Reset(m_commandAllocator.Get(), nullptr);
+        BGFX_PROFILER_SCOPE("RendererContextD3D12::beginView");
+        const int64_t start = bx::getHPCounter();
 
         D3D12_VIEWPORT viewport = {static_cast<float>(_view.m_rect.m_x),
                                    static_cast<float>(_view.m_rect.m_y),
@@ -158,156 +511,546 @@ struct RendererContextD3D12 : public RendererContextI
                                    static_cast<float>(_view.m_rect.m_height),
                                    0.0f,
                                    1.0f};
-        D3D12_RECT scissorRect = {0, 0, static_cast<LONG>(_view.m_rect.m_width),
-                                  static_cast<LONG>(_view.m_rect.m_height)};
+        D3D12_RECT scissorRect = {static_cast<LONG>(_view.m_rect.m_x), static_cast<LONG>(_view.m_rect.m_y),
+                                  static_cast<LONG>(_view.m_rect.m_x + _view.m_rect.m_width),
+                                  static_cast<LONG>(_view.m_rect.m_y + _view.m_rect.m_height)};
         m_commandList->RSSetViewports(1, &viewport);
         m_commandList->RSSetScissorRects(1, &scissorRect);
 
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-        m_commandList->ResourceBarrier(1, &barrier);
+        FrameBufferHandle fbh = _view.m_fbh;
+        if (isValid(fbh) && NULL == m_frameBuffers[fbh.idx].m_texture)
+        {
+            BX_TRACE("View renders into invalid frame buffer %d, using backbuffer.", fbh.idx);
+            fbh.idx = kInvalidHandle;
+        }
+
+        // 只清除 view 请求的部分, 没有 clear 标志的 view 完全跳过清除.
+        const Clear &clear = _view.m_clear;
+        const bool clearColor = 0 != (clear.m_flags & BGFX_CLEAR_COLOR);
+        D3D12_CLEAR_FLAGS clearDepthStencil = D3D12_CLEAR_FLAGS(0);
 
-        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_frameIndex,
-                                                m_rtvDescriptorSize);
-        m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+        if (isValid(fbh))
+        {
+            FrameBufferD3D12 &fb = m_frameBuffers[fbh.idx];
+            fb.setState(m_commandList.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+            const bool depth = NULL != fb.m_depth;
+            m_commandList->OMSetRenderTargets(1, &fb.m_rtv, FALSE, depth ? &fb.m_dsv : nullptr);
+
+            if (depth)
+            {
+                if (0 != (clear.m_flags & BGFX_CLEAR_DEPTH))
+                {
+                    clearDepthStencil |= D3D12_CLEAR_FLAG_DEPTH;
+                }
+                if (0 != (clear.m_flags & BGFX_CLEAR_STENCIL) && TextureFormat::D24S8 == fb.m_depthFormat)
+                {
+                    clearDepthStencil |= D3D12_CLEAR_FLAG_STENCIL;
+                }
+            }
+
+            // 覆盖整个目标时不传矩形, 清除值和优化清除值一致时驱动走快速清除.
+            const bool full = 0 == _view.m_rect.m_x && 0 == _view.m_rect.m_y && fb.m_width <= _view.m_rect.m_width &&
+                              fb.m_height <= _view.m_rect.m_height;
+            const UINT numRects = full ? 0 : 1;
+            const D3D12_RECT *rects = full ? nullptr : &scissorRect;
+
+            if (clearColor)
+            {
+                m_commandList->ClearRenderTargetView(fb.m_rtv, clear.m_color, numRects, rects);
+            }
+            if (0 != clearDepthStencil)
+            {
+                m_commandList->ClearDepthStencilView(fb.m_dsv, clearDepthStencil, clear.m_depth, clear.m_stencil,
+                                                     numRects, rects);
+            }
+
+            m_rtvFormat = s_textureFormat[fb.m_format];
+            m_dsvFormat = depth ? s_textureFormat[fb.m_depthFormat] : DXGI_FORMAT_UNKNOWN;
+        }
+        else
+        {
+            setBackBufferState(D3D12_RESOURCE_STATE_RENDER_TARGET);
+            m_backBufferUsed = true;
+
+            CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_frameIndex,
+                                                    m_rtvDescriptorSize);
+            const bool depth = NULL != m_backBufferDepth.Get();
+            m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, depth ? &m_backBufferDsv : nullptr);
+
+            if (depth)
+            {
+                if (0 != (clear.m_flags & BGFX_CLEAR_DEPTH))
+                {
+                    clearDepthStencil |= D3D12_CLEAR_FLAG_DEPTH;
+                }
+                if (0 != (clear.m_flags & BGFX_CLEAR_STENCIL))
+                {
+                    clearDepthStencil |= D3D12_CLEAR_FLAG_STENCIL;
+                }
+            }
+
+            const bool full = 0 == _view.m_rect.m_x && 0 == _view.m_rect.m_y && m_width <= _view.m_rect.m_width &&
+                              m_height <= _view.m_rect.m_height;
+            const UINT numRects = full ? 0 : 1;
+            const D3D12_RECT *rects = full ? nullptr : &scissorRect;
+
+            if (clearColor)
+            {
+                m_commandList->ClearRenderTargetView(rtvHandle, clear.m_color, numRects, rects);
+            }
+            if (0 != clearDepthStencil)
+            {
+                m_commandList->ClearDepthStencilView(m_backBufferDsv, clearDepthStencil, clear.m_depth,
+                                                     clear.m_stencil, numRects, rects);
+            }
 
-        const float clearColor[] = {0.0f, 0.2f, 0.4f, 1.0f};
-        m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+            m_rtvFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+            m_dsvFormat = m_backBufferDsvFormat;
+        }
 
         // m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+
+        m_frameStats.cpuTimeBackend += bx::getHPCounter() - start;
     }
 
-    void endFrame()
+    void endFrame(FrameStats &_stats)
     {
-        // Indicate that the back buffer will now be used to present.
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_renderTargets[m_frameIndex].Get(),
-            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-        m_commandList->ResourceBarrier(1, &barrier);
-        
+        BGFX_PROFILER_SCOPE("RendererContextD3D12::endFrame");
+        int64_t now = bx::getHPCounter();
+
+        // Indicate that the back buffer will now be used to present. Frames where no view rendered
+        // into backbuffer leave it alone and aren't presented.
+        const bool present = m_backBufferUsed;
+        m_backBufferUsed = false;
+        setBackBufferState(D3D12_RESOURCE_STATE_PRESENT);
+
         m_commandList->Close();
 
         ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
         m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-        m_swapChain->Present(1, 0);
-        
-        const UINT64 fence = m_fenceValue;
-        m_commandQueue->Signal(m_fence.Get(), fence);
-        m_fenceValue++;
-        if (m_fence->GetCompletedValue() < fence)
+        m_frameStats.cpuTimeBackend += bx::getHPCounter() - now;
+
+        now = bx::getHPCounter();
+        if (present && NULL != m_swapChain.Get())
         {
-            m_fence->SetEventOnCompletion(fence, m_fenceEvent);
-            WaitForSingleObject(m_fenceEvent, INFINITE);
+            m_swapChain->Present(1, 0);
         }
-        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
-    }
+        m_frameStats.cpuTimePresent = bx::getHPCounter() - now;
 
-    void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso,
-                  uint16_t _state, const void *_mtx)
-    {
-        // 设置顶点缓冲区
-        m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        VertexLayoutHandle layoutHandle = m_vertexBuffers[_vbh.idx].m_layoutHandle;
-        VertexLayout &layout = m_vertexLayouts[layoutHandle.idx];
+        m_frameFence[m_transientFrame] = m_fenceValue;
+        m_commandQueue->Signal(m_fence.Get(), m_fenceValue);
+        m_fenceValue++;
 
-        D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
-        vertexBufferView.BufferLocation = m_vertexBuffers[_vbh.idx].m_gpuVA;
-        vertexBufferView.SizeInBytes = m_vertexBuffers[_vbh.idx].m_size;
-        vertexBufferView.StrideInBytes = layout.getStride();
-        m_commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+        // Advance to next frame slot. Only wait for the frame that used it FrameCount frames ago,
+        // so CPU records next frame while GPU renders this one.
+        m_transientFrame = (m_transientFrame + 1) % FrameCount;
+        m_uploadOffset = 0;
 
-        // 设置索引缓冲区
-        D3D12_INDEX_BUFFER_VIEW indexBufferView;
-        indexBufferView.BufferLocation = m_indexBuffers[_ibh.idx].m_gpuVA;
-        indexBufferView.SizeInBytes = m_indexBuffers[_ibh.idx].m_size;
-        indexBufferView.Format = m_indexBuffers[_ibh.idx].m_srvd.Format;
-        m_commandList->IASetIndexBuffer(&indexBufferView);
+        now = bx::getHPCounter();
+        waitForFence(m_frameFence[m_transientFrame]);
+        m_frameStats.cpuTimeFenceWait = bx::getHPCounter() - now;
 
-        // 设置程序
-        m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+        now = bx::getHPCounter();
 
-        // 设置PSO
-        m_commandList->SetPipelineState(m_pso[_pso.idx].m_pso);
+        // Resources and descriptors retired while recording this slot last time can go.
+        m_release[m_transientFrame].flush();
+        m_descriptorAlloc.beginFrame(m_transientFrame);
+        trackFree(MemoryCategory::Staging, m_stagingSize[m_transientFrame], m_numStaging[m_transientFrame]);
+        m_stagingSize[m_transientFrame] = 0;
+        m_numStaging[m_transientFrame] = 0;
 
-        // 设置常量缓冲区
-        // m_commandList->SetGraphicsRootConstantBufferView(0, m_constantBuffer.GetGPUVirtualAddress());
+        m_commandAllocator[m_transientFrame]->Reset();
+        m_commandList->Reset(m_commandAllocator[m_transientFrame].Get(), nullptr);
+        invalidateBindings();
 
-        // 绘制
-        m_commandList->DrawIndexedInstanced(m_indexBuffers[_ibh.idx].m_srvd.Format == DXGI_FORMAT_R16_UINT ? 36 : 36, 1,
-                                            0, 0, 0);
+        if (NULL != m_swapChain.Get())
+        {
+            if (present)
+            {
+                m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+            }
+        }
+        else
+        {
+            m_frameIndex = m_transientFrame;
+        }
 
+        processReadbacks();
+        m_frameStats.cpuTimeBackend += bx::getHPCounter() - now;
 
+        _stats = m_frameStats;
+        m_frameStats.reset();
     }
 
-    HWND m_hwnd;
-    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
-    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
-    Microsoft::WRL::ComPtr<IDXGISwapChain3> m_swapChain;
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
-    Microsoft::WRL::ComPtr<ID3D12Resource> m_renderTargets[FrameCount];
-    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_commandAllocator;
-    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
-    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
-    Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+    void setBackBufferState(D3D12_RESOURCE_STATES _state)
+    {
+        if (m_backBufferState != _state)
+        {
+            setResourceBarrier(m_commandList.Get(), m_renderTargets[m_frameIndex].Get(), m_backBufferState, _state);
+            m_backBufferState = _state;
+        }
+    }
 
-    // CommandQueueD3D12 m_cmd;
-    UINT64 m_fenceValue;
-    HANDLE m_fenceEvent;
-    UINT m_frameIndex;
-    UINT m_rtvDescriptorSize;
+    void createTexture(TextureHandle _handle, const TextureInfo &_info, const void *_data)
+    {
+        m_textures[_handle.idx].create(_info, _data);
+    }
 
-    VertexLayout m_vertexLayouts[BGFX_CONFIG_MAX_VERTEX_LAYOUTS];
+    void updateTexture(TextureHandle _handle, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y,
+                       uint16_t _width, uint16_t _height, const void *_data, uint32_t _pitch)
+    {
+        m_textures[_handle.idx].update(m_commandList.Get(), _side, _mip, _x, _y, _width, _height, _data, _pitch);
+    }
 
-    BufferD3D12 m_indexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
-    VertexBufferD3D12 m_vertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+    void destroyTexture(TextureHandle _handle)
+    {
+        m_textures[_handle.idx].destroy();
+    }
 
-    ShaderD3D12 m_shaders[BGFX_CONFIG_MAX_SHADERS];
-    ProgramD3D12 m_program[BGFX_CONFIG_MAX_PROGRAMS];
-    PSOD3D12 m_pso[BGFX_CONFIG_MAX_PSOS];
-};
+    void createFrameBuffer(FrameBufferHandle _handle, uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                           TextureFormat::Enum _depthFormat)
+    {
+        CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), FrameCount + _handle.idx,
+                                          m_rtvDescriptorSize);
+        CD3DX12_CPU_DESCRIPTOR_HANDLE dsv(m_dsvHeap->GetCPUDescriptorHandleForHeapStart(), _handle.idx,
+                                          m_dsvDescriptorSize);
+        m_frameBuffers[_handle.idx].create(_width, _height, _format, _depthFormat, rtv, dsv);
+    }
 
-static RendererContextD3D12 *s_renderD3D12;
+    void destroyFrameBuffer(FrameBufferHandle _handle)
+    {
+        m_frameBuffers[_handle.idx].destroy();
+    }
 
-RendererContextI *rendererCreate(const InitParams &_init)
-{
-    BX_ASSERT(s_renderD3D12 == nullptr, "Renderer already initialized");
+    bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData);
 
-    s_renderD3D12 = new RendererContextD3D12();
-    s_renderD3D12->init(_init);
-    return s_renderD3D12;
-}
+    /// Call callbacks of readbacks GPU finished.
+    void processReadbacks();
 
-void rendererDestroy()
-{
-    s_renderD3D12->Shutdown();
-    delete s_renderD3D12;
-    s_renderD3D12 = nullptr;
-}
+    void resetTransientBuffers(TransientBuffer &_vb, TransientBuffer &_ib)
+    {
+        _vb.data = &m_transientVb.m_data[m_transientFrame * m_transientVb.m_size];
+        _vb.size = m_transientVb.m_size;
+        _vb.offset = 0;
 
-void setResourceBarrier(ID3D12GraphicsCommandList *_commandList, const ID3D12Resource *_resource,
-                        D3D12_RESOURCE_STATES _stateBefore, D3D12_RESOURCE_STATES _stateAfter)
-{
-    D3D12_RESOURCE_BARRIER barrier;
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    barrier.Transition.pResource = const_cast<ID3D12Resource *>(_resource);
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    barrier.Transition.StateBefore = _stateBefore;
-    barrier.Transition.StateAfter = _stateAfter;
-    _commandList->ResourceBarrier(1, &barrier);
-}
+        _ib.data = &m_transientIb.m_data[m_transientFrame * m_transientIb.m_size];
+        _ib.size = m_transientIb.m_size;
+        _ib.offset = 0;
+    }
 
-struct HeapProperty
-{
-    enum Enum
+    /// Forget what is bound, command list state doesn't survive `Reset`.
+    void invalidateBindings()
     {
-        Default,
-        Texture,
-        Upload,
-        ReadBack,
+        bx::memSet(&m_bindVb, 0, sizeof(m_bindVb));
+        bx::memSet(&m_bindIb, 0, sizeof(m_bindIb));
+        m_bindPso = NULL;
+        m_bindRootSignature = NULL;
+        m_bindTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    }
 
-        Count
-    };
+    /// CPU handle of descriptor `_index` of shader visible heap, for writing descriptor.
+    D3D12_CPU_DESCRIPTOR_HANDLE getCpuHandle(uint32_t _index) const
+    {
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_srvHeap->GetCPUDescriptorHandleForHeapStart(), _index,
+                                             m_srvDescriptorSize);
+    }
+
+    /// GPU handle of descriptor `_index` of shader visible heap.
+    D3D12_GPU_DESCRIPTOR_HANDLE getGpuHandle(uint32_t _index) const
+    {
+        return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_srvHeap->GetGPUDescriptorHandleForHeapStart(), _index,
+                                             m_srvDescriptorSize);
+    }
+
+    void setVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW &_view)
+    {
+        if (0 != bx::memCmp(&m_bindVb, &_view, sizeof(_view)))
+        {
+            m_bindVb = _view;
+            m_commandList->IASetVertexBuffers(0, 1, &_view);
+            ++m_frameStats.numVertexBufferBinds;
+        }
+    }
+
+    void setIndexBuffer(const D3D12_INDEX_BUFFER_VIEW &_view)
+    {
+        if (0 != bx::memCmp(&m_bindIb, &_view, sizeof(_view)))
+        {
+            m_bindIb = _view;
+            m_commandList->IASetIndexBuffer(&_view);
+            ++m_frameStats.numIndexBufferBinds;
+        }
+    }
+
+    /// `_index32` picks primitive restart value of indexed strips. Returns false when PSO failed to
+    /// compile, draw must be skipped then.
+    bool setPipeline(PSOHandle _pso, uint64_t _state, bool _index32)
+    {
+        uint64_t state = _state & ~BGFX_STATE_RESERVED_MASK;
+        if (_index32 && isStrip(state))
+        {
+            state |= PSOD3D12::kStateIndex32;
+        }
+
+        ID3D12PipelineState *pso = m_pso[_pso.idx].get(m_rtvFormat, m_dsvFormat, state);
+        if (NULL == pso)
+        {
+            return false;
+        }
+
+        const uint32_t pt = uint32_t((_state & BGFX_STATE_PT_MASK) >> BGFX_STATE_PT_SHIFT);
+        const D3D_PRIMITIVE_TOPOLOGY topology = s_primTopology[pt];
+        if (m_bindTopology != topology)
+        {
+            m_bindTopology = topology;
+            m_commandList->IASetPrimitiveTopology(m_bindTopology);
+        }
+
+        // Heap and root signature never change, they are set once per command list.
+        if (m_bindRootSignature != m_rootSignature.Get())
+        {
+            ID3D12DescriptorHeap *heaps[] = {m_srvHeap.Get()};
+            m_commandList->SetDescriptorHeaps(BX_COUNTOF(heaps), heaps);
+
+            m_bindRootSignature = m_rootSignature.Get();
+            m_commandList->SetGraphicsRootSignature(m_bindRootSignature);
+            m_commandList->SetGraphicsRootDescriptorTable(RootParam::DescriptorTable,
+                                                          m_srvHeap->GetGPUDescriptorHandleForHeapStart());
+            ++m_frameStats.numRootSignatureBinds;
+        }
+
+        if (m_bindPso != pso)
+        {
+            m_bindPso = pso;
+            m_commandList->SetPipelineState(pso);
+            ++m_frameStats.numPsoBinds;
+        }
+
+        return true;
+    }
+
+    /// Set model matrix root constants of draw, after `setPipeline` bound root signature.
+    void setModel(const void *_mtx)
+    {
+        static const float s_identity[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+        };
+        m_commandList->SetGraphicsRoot32BitConstants(RootParam::Model, 16, NULL != _mtx ? _mtx : s_identity, 0);
+    }
+
+    void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex, uint32_t _numIndices,
+                  ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        const VertexBufferD3D12 &vb = m_vertexBuffers[_vbh.idx];
+        const uint16_t stride = m_vertexLayouts[vb.m_layoutHandle.idx].getStride();
+
+        // 上传动态缓冲区的脏区域
+        m_vertexBuffers[_vbh.idx].flush(m_commandList.Get());
+
+        // 设置顶点缓冲区
+        D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+        vertexBufferView.BufferLocation = vb.m_gpuVA;
+        vertexBufferView.SizeInBytes = vb.m_size;
+        vertexBufferView.StrideInBytes = stride;
+        setVertexBuffer(vertexBufferView);
+
+        // 无索引缓冲区时按顶点绘制
+        if (!isValid(_ibh))
+        {
+            if (!setPipeline(_pso, _state, false))
+            {
+                return;
+            }
+
+            setModel(_mtx);
+
+            const uint32_t numVertices =
+                bx::uint32_min(_numIndices, bx::uint32_satsub(vb.m_size / stride, _firstIndex));
+            m_commandList->DrawInstanced(numVertices, 1, _firstIndex, 0);
+
+            ++m_frameStats.numDraw;
+            m_frameStats.numPrims += getNumPrims(_state, numVertices);
+            return;
+        }
+
+        const BufferD3D12 &ib = m_indexBuffers[_ibh.idx];
+        m_indexBuffers[_ibh.idx].flush(m_commandList.Get());
+
+        // 设置索引缓冲区
+        D3D12_INDEX_BUFFER_VIEW indexBufferView;
+        indexBufferView.BufferLocation = ib.m_gpuVA;
+        indexBufferView.SizeInBytes = ib.m_size;
+        indexBufferView.Format = ib.m_srvd.Format;
+        setIndexBuffer(indexBufferView);
+
+        // 设置根签名和PSO
+        if (!setPipeline(_pso, _state, DXGI_FORMAT_R32_UINT == ib.m_srvd.Format))
+        {
+            return;
+        }
+
+        setModel(_mtx);
+
+        // 绘制
+        const uint32_t indexSize = DXGI_FORMAT_R16_UINT == ib.m_srvd.Format ? 2 : 4;
+        const uint32_t numIndices = bx::uint32_min(_numIndices, bx::uint32_satsub(ib.m_size / indexSize, _firstIndex));
+        m_commandList->DrawIndexedInstanced(numIndices, 1, _firstIndex, 0, 0);
+
+        ++m_frameStats.numDraw;
+        m_frameStats.numPrims += getNumPrims(_state, numIndices);
+    }
+
+    void drawTransient(const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib, ProgramHandle _program,
+                       PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+        vertexBufferView.BufferLocation = m_transientVb.getGpuVA(m_transientFrame, _tvb->offset);
+        vertexBufferView.SizeInBytes = _tvb->size;
+        vertexBufferView.StrideInBytes = _tvb->stride;
+        setVertexBuffer(vertexBufferView);
+
+        if (!setPipeline(_pso, _state, NULL != _tib && !_tib->isIndex16))
+        {
+            return;
+        }
+
+        setModel(_mtx);
+
+        uint32_t numVertices = _tvb->size / _tvb->stride;
+
+        if (NULL == _tib)
+        {
+            m_commandList->DrawInstanced(numVertices, 1, 0, 0);
+        }
+        else
+        {
+            const uint32_t indexSize = _tib->isIndex16 ? 2 : 4;
+
+            D3D12_INDEX_BUFFER_VIEW indexBufferView;
+            indexBufferView.BufferLocation = m_transientIb.getGpuVA(m_transientFrame, _tib->offset);
+            indexBufferView.SizeInBytes = _tib->size;
+            indexBufferView.Format = _tib->isIndex16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            setIndexBuffer(indexBufferView);
+
+            numVertices = _tib->size / indexSize;
+            m_commandList->DrawIndexedInstanced(numVertices, 1, 0, 0, 0);
+        }
+
+        ++m_frameStats.numDraw;
+        m_frameStats.numPrims += getNumPrims(_state, numVertices);
+    }
+
+    HWND m_hwnd;
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
+    Microsoft::WRL::ComPtr<IDXGISwapChain3> m_swapChain;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_renderTargets[FrameCount];
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_dsvHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_backBufferDepth; //!< NULL when `InitParams::maxDepth` is 0.
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_commandAllocator[FrameCount];
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvHeap; //!< Shader visible, indexed by `m_descriptorAlloc`.
+
+    // CommandQueueD3D12 m_cmd;
+    UINT64 m_fenceValue;                //!< Value next submitted frame signals.
+    UINT64 m_frameFence[FrameCount];    //!< Value signaled by last frame recorded in slot.
+    HANDLE m_fenceEvent;
+    UINT m_frameIndex;
+    UINT m_rtvDescriptorSize;
+    UINT m_dsvDescriptorSize;
+    UINT m_srvDescriptorSize;
+    uint16_t m_width;
+    uint16_t m_height;
+    D3D12_RESOURCE_STATES m_backBufferState;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_backBufferDsv;
+    DXGI_FORMAT m_backBufferDsvFormat;
+
+    TransientBufferD3D12 m_transientVb;
+    TransientBufferD3D12 m_transientIb;
+    uint32_t m_transientFrame; //!< Frame slot being recorded, indexes all per frame resources.
+
+    TransientBufferD3D12 m_upload;
+    uint32_t m_uploadOffset;
+    uint64_t m_stagingSize[FrameCount]; //!< One-off staging bytes retired with frame slot.
+    uint32_t m_numStaging[FrameCount];
+    ReleaseQueueD3D12 m_release[FrameCount];
+    BufferPoolD3D12 m_bufferPool;
+    DescriptorAllocator m_descriptorAlloc;
+
+    bool m_backBufferUsed; //!< Some view of frame being recorded renders into backbuffer.
+    DXGI_FORMAT m_rtvFormat;
+    DXGI_FORMAT m_dsvFormat;
+    FrameBufferD3D12 m_frameBuffers[BGFX_CONFIG_MAX_FRAME_BUFFERS];
+    TextureD3D12 m_textures[BGFX_CONFIG_MAX_TEXTURES];
+    ReadbackD3D12 m_readbacks[BGFX_CONFIG_MAX_READBACKS];
+
+    FrameStats m_frameStats;
+    D3D12_VERTEX_BUFFER_VIEW m_bindVb;
+    D3D12_INDEX_BUFFER_VIEW m_bindIb;
+    ID3D12PipelineState *m_bindPso;
+    ID3D12RootSignature *m_bindRootSignature;
+    D3D_PRIMITIVE_TOPOLOGY m_bindTopology;
+
+    VertexLayout m_vertexLayouts[BGFX_CONFIG_MAX_VERTEX_LAYOUTS];
+
+    BufferD3D12 m_indexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
+    VertexBufferD3D12 m_vertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+
+    ShaderD3D12 m_shaders[BGFX_CONFIG_MAX_SHADERS];
+    ProgramD3D12 m_program[BGFX_CONFIG_MAX_PROGRAMS];
+    PSOD3D12 m_pso[BGFX_CONFIG_MAX_PSOS];
+};
+
+static RendererContextD3D12 *s_renderD3D12;
+
+void rendererDestroy()
+{
+    s_renderD3D12->Shutdown();
+    bx::deleteObject(getAllocator(MemoryCategory::Command), s_renderD3D12);
+    s_renderD3D12 = nullptr;
+}
+
+RendererContextI *rendererCreate(const InitParams &_init)
+{
+    BX_ASSERT(s_renderD3D12 == nullptr, "Renderer already initialized");
+
+    s_renderD3D12 = BX_NEW(getAllocator(MemoryCategory::Command), RendererContextD3D12)();
+    if (!s_renderD3D12->init(_init))
+    {
+        rendererDestroy();
+    }
+
+    return s_renderD3D12;
+}
+
+void setResourceBarrier(ID3D12GraphicsCommandList *_commandList, const ID3D12Resource *_resource,
+                        D3D12_RESOURCE_STATES _stateBefore, D3D12_RESOURCE_STATES _stateAfter)
+{
+    D3D12_RESOURCE_BARRIER barrier;
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    barrier.Transition.pResource = const_cast<ID3D12Resource *>(_resource);
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = _stateBefore;
+    barrier.Transition.StateAfter = _stateAfter;
+    _commandList->ResourceBarrier(1, &barrier);
+}
+
+struct HeapProperty
+{
+    enum Enum
+    {
+        Default,
+        Texture,
+        Upload,
+        ReadBack,
+
+        Count
+    };
 
     D3D12_HEAP_PROPERTIES m_properties;
     D3D12_RESOURCE_STATES m_state;
@@ -369,154 +1112,865 @@ ID3D12Resource *createCommittedResource(ID3D12Device *_device, HeapProperty::Enu
     resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
     resourceDesc.Flags = _flags;
 
-    return createCommittedResource(_device, _heapProperty, &resourceDesc, NULL);
+    return createCommittedResource(_device, _heapProperty, &resourceDesc, NULL);
+}
+
+ID3D12Resource *createTexture(ID3D12Device *_device, uint16_t _width, uint16_t _height, DXGI_FORMAT _format,
+                              D3D12_RESOURCE_FLAGS _flags, D3D12_RESOURCE_STATES _state)
+{
+    D3D12_RESOURCE_DESC resourceDesc = {};
+    resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    resourceDesc.Alignment = 0;
+    resourceDesc.Width = _width;
+    resourceDesc.Height = _height;
+    resourceDesc.DepthOrArraySize = 1;
+    resourceDesc.MipLevels = 1;
+    resourceDesc.Format = _format;
+    resourceDesc.SampleDesc.Count = 1;
+    resourceDesc.SampleDesc.Quality = 0;
+    resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    resourceDesc.Flags = _flags;
+
+    D3D12_CLEAR_VALUE clearValue = {};
+    clearValue.Format = _format;
+    if (0 != (_flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+    {
+        clearValue.DepthStencil.Depth = 1.0f;
+        clearValue.DepthStencil.Stencil = 0;
+    }
+    else
+    {
+        clearValue.Color[0] = 0.0f;
+        clearValue.Color[1] = 0.2f;
+        clearValue.Color[2] = 0.4f;
+        clearValue.Color[3] = 1.0f;
+    }
+
+    const bool target = 0 != (_flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+                                        D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL));
+
+    ID3D12Resource *resource = NULL;
+    DX_CHECK(_device->CreateCommittedResource(&s_heapProperties[HeapProperty::Texture].m_properties,
+                                              D3D12_HEAP_FLAG_NONE, &resourceDesc, _state,
+                                              target ? &clearValue : NULL, IID_ID3D12Resource, (void **)&resource));
+    BX_WARN(NULL != resource, "CreateCommittedResource failed (%dx%d). Out of memory?", _width, _height);
+
+    return resource;
+}
+
+bool RendererContextD3D12::readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData)
+{
+    FrameBufferD3D12 *fb = isValid(_handle) ? &m_frameBuffers[_handle.idx] : NULL;
+    if (NULL != fb && NULL == fb->m_texture)
+    {
+        BX_TRACE("Reading invalid frame buffer %d.", _handle.idx);
+        return false;
+    }
+
+    ReadbackD3D12 *readback = NULL;
+    for (uint32_t ii = 0; ii < BX_COUNTOF(m_readbacks) && NULL == readback; ++ii)
+    {
+        readback = NULL == m_readbacks[ii].m_fn ? &m_readbacks[ii] : NULL;
+    }
+
+    if (NULL == readback)
+    {
+        BX_TRACE("Too many readbacks in flight (BGFX_CONFIG_MAX_READBACKS, max: %d).", BGFX_CONFIG_MAX_READBACKS);
+        return false;
+    }
+
+    ID3D12Resource *texture = NULL != fb ? fb->m_texture : m_renderTargets[m_frameIndex].Get();
+    const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    uint64_t total;
+    m_device->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, NULL, NULL, &total);
+
+    // Slot keeps its buffer, readbacks of the same frame buffer every frame don't allocate.
+    if (readback->m_capacity < total)
+    {
+        if (NULL != readback->m_buffer)
+        {
+            trackFree(MemoryCategory::Staging, readback->m_capacity);
+            release(readback->m_buffer);
+        }
+
+        readback->m_buffer = createCommittedResource(m_device.Get(), HeapProperty::ReadBack, total);
+        readback->m_capacity = total;
+        trackAlloc(MemoryCategory::Staging, total);
+    }
+
+    // 复制到回读缓冲区
+    D3D12_RESOURCE_STATES state;
+    if (NULL != fb)
+    {
+        state = fb->setState(m_commandList.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE);
+    }
+    else
+    {
+        state = m_backBufferState;
+        setBackBufferState(D3D12_RESOURCE_STATE_COPY_SOURCE);
+    }
+
+    CD3DX12_TEXTURE_COPY_LOCATION dst(readback->m_buffer, footprint);
+    CD3DX12_TEXTURE_COPY_LOCATION src(texture, 0);
+    m_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, NULL);
+
+    if (NULL != fb)
+    {
+        fb->setState(m_commandList.Get(), state);
+    }
+    else
+    {
+        setBackBufferState(state);
+    }
+
+    readback->m_fence = m_fenceValue;
+    readback->m_fn = _fn;
+    readback->m_userData = _userData;
+    readback->m_handle = _handle;
+    readback->m_pitch = footprint.Footprint.RowPitch;
+    readback->m_width = uint16_t(desc.Width);
+    readback->m_height = uint16_t(desc.Height);
+    readback->m_format = NULL != fb ? fb->m_format : TextureFormat::RGBA8;
+
+    return true;
+}
+
+void RendererContextD3D12::processReadbacks()
+{
+    const UINT64 completed = m_fence->GetCompletedValue();
+
+    for (uint32_t ii = 0; ii < BX_COUNTOF(m_readbacks); ++ii)
+    {
+        ReadbackD3D12 &readback = m_readbacks[ii];
+        if (NULL != readback.m_fn && readback.m_fence <= completed)
+        {
+            const D3D12_RANGE readRange = {0, SIZE_T(readback.m_pitch) * readback.m_height};
+            const D3D12_RANGE writeRange = {0, 0};
+
+            void *data;
+            DX_CHECK(readback.m_buffer->Map(0, &readRange, &data));
+
+            const ReadbackFn fn = readback.m_fn;
+            readback.m_fn = NULL;
+            fn(readback.m_handle, data, readback.m_pitch, readback.m_width, readback.m_height, readback.m_format,
+               readback.m_userData);
+
+            readback.m_buffer->Unmap(0, &writeRange);
+        }
+    }
+}
+
+uint8_t *RendererContextD3D12::allocUpload(uint32_t _size, ID3D12Resource *&_resource, uint64_t &_offset,
+                                           uint32_t _align)
+{
+    m_frameStats.uploadedBytes += _size;
+
+    const uint32_t offset = bx::alignUp(m_uploadOffset, _align);
+    if (offset + _size <= m_upload.m_size)
+    {
+        m_uploadOffset = offset + _size;
+        _resource = m_upload.m_ptr;
+        _offset = uint64_t(m_transientFrame) * m_upload.m_size + offset;
+        return &m_upload.m_data[_offset];
+    }
+
+    // Too big for what is left of upload buffer, use one-off staging buffer retired with this frame.
+    ID3D12Resource *staging = createCommittedResource(m_device.Get(), HeapProperty::Upload, _size);
+    release(staging);
+    trackAlloc(MemoryCategory::Staging, _size);
+    m_stagingSize[m_transientFrame] += _size;
+    ++m_numStaging[m_transientFrame];
+
+    uint8_t *data;
+    D3D12_RANGE readRange = {0, 0};
+    DX_CHECK(staging->Map(0, &readRange, (void **)&data));
+
+    _resource = staging;
+    _offset = 0;
+    return data;
+}
+
+void ReleaseQueueD3D12::push(ID3D12Resource *_ptr)
+{
+    if (m_num == m_max)
+    {
+        m_max = bx::max<uint32_t>(64, m_max * 2);
+        m_ptr = (ID3D12Resource **)bx::realloc(getAllocator(MemoryCategory::Command), m_ptr, m_max * sizeof(ID3D12Resource *));
+    }
+
+    m_ptr[m_num++] = _ptr;
+}
+
+void ReleaseQueueD3D12::flush()
+{
+    for (uint32_t ii = 0; ii < m_num; ++ii)
+    {
+        m_ptr[ii]->Release();
+    }
+
+    m_num = 0;
+}
+
+void ReleaseQueueD3D12::destroy()
+{
+    flush();
+    bx::free(getAllocator(MemoryCategory::Command), m_ptr);
+    m_ptr = NULL;
+    m_max = 0;
+}
+
+uint16_t BufferPoolD3D12::alloc(uint32_t _size, TlsfAllocation &_allocation)
+{
+    // Big buffers gain nothing from sharing a page, keep them committed.
+    if (_size > BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE / 4)
+    {
+        return UINT16_MAX;
+    }
+
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        Page &page = m_pages[ii];
+        if (page.m_tlsf.m_numAllocs < BGFX_CONFIG_BUFFER_POOL_MAX_ALLOCS)
+        {
+            _allocation = page.m_tlsf.alloc(_size);
+            if (TlsfAllocator::isValid(_allocation))
+            {
+                return ii;
+            }
+        }
+    }
+
+    if (BGFX_CONFIG_BUFFER_POOL_MAX_PAGES == m_numPages)
+    {
+        BX_TRACE("WARNING: Buffer pool is full (BGFX_CONFIG_BUFFER_POOL_MAX_PAGES, max: %d).",
+                 BGFX_CONFIG_BUFFER_POOL_MAX_PAGES);
+        return UINT16_MAX;
+    }
+
+    // 创建新的缓冲区页
+    Page &page = m_pages[m_numPages];
+    page.m_ptr = createCommittedResource(s_renderD3D12->m_device.Get(), HeapProperty::Default,
+                                         BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE);
+    page.m_gpuVA = page.m_ptr->GetGPUVirtualAddress();
+    page.m_state = s_heapProperties[HeapProperty::Default].m_state;
+    page.m_tlsf.create(BGFX_CONFIG_BUFFER_POOL_PAGE_SIZE, BGFX_CONFIG_BUFFER_POOL_MAX_ALLOCS,
+                       D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, getAllocator(MemoryCategory::Command));
+
+    _allocation = page.m_tlsf.alloc(_size);
+    return m_numPages++;
+}
+
+void BufferPoolD3D12::free(uint16_t _page, TlsfAllocation _allocation)
+{
+    // Range can be handed out again right away. New owner's upload transitions the page to copy
+    // destination, and that barrier waits for earlier reads on the queue.
+    m_pages[_page].m_tlsf.free(_allocation);
+}
+
+void BufferPoolD3D12::destroy()
+{
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        m_pages[ii].m_ptr->Release();
+        m_pages[ii].m_tlsf.destroy();
+    }
+
+    m_numPages = 0;
+}
+
+void BufferPoolD3D12::getStats(TlsfStats &_stats) const
+{
+    bx::memSet(&_stats, 0, sizeof(TlsfStats));
+
+    for (uint16_t ii = 0; ii < m_numPages; ++ii)
+    {
+        TlsfStats stats;
+        m_pages[ii].m_tlsf.getStats(stats);
+
+        _stats.m_totalSize += stats.m_totalSize;
+        _stats.m_usedSize += stats.m_usedSize;
+        _stats.m_freeSize += stats.m_freeSize;
+        _stats.m_largestFree = bx::max(_stats.m_largestFree, stats.m_largestFree);
+        _stats.m_numAllocs += stats.m_numAllocs;
+        _stats.m_numFreeBlocks += stats.m_numFreeBlocks;
+    }
+
+    _stats.m_fragmentation =
+        0 == _stats.m_freeSize ? 0.0f : 1.0f - float(_stats.m_largestFree) / float(_stats.m_freeSize);
+}
+
+void DirtyRanges::add(uint32_t _begin, uint32_t _end)
+{
+    uint32_t first = 0;
+    while (first < m_num && m_end[first] + MergeGap < _begin)
+    {
+        ++first;
+    }
+
+    uint32_t last = first;
+    while (last < m_num && m_begin[last] <= _end + MergeGap)
+    {
+        _begin = bx::min(_begin, m_begin[last]);
+        _end = bx::max(_end, m_end[last]);
+        ++last;
+    }
+
+    // Ranges [first, last) are replaced by the merged one.
+    const uint32_t numMerged = last - first;
+    if (0 == numMerged)
+    {
+        bx::memMove(&m_begin[first + 1], &m_begin[first], (m_num - first) * sizeof(uint32_t));
+        bx::memMove(&m_end[first + 1], &m_end[first], (m_num - first) * sizeof(uint32_t));
+        ++m_num;
+    }
+    else if (1 < numMerged)
+    {
+        bx::memMove(&m_begin[first + 1], &m_begin[last], (m_num - last) * sizeof(uint32_t));
+        bx::memMove(&m_end[first + 1], &m_end[last], (m_num - last) * sizeof(uint32_t));
+        m_num -= numMerged - 1;
+    }
+
+    m_begin[first] = _begin;
+    m_end[first] = _end;
+
+    if (MaxRanges < m_num)
+    {
+        uint32_t closest = 0;
+        for (uint32_t ii = 1; ii < m_num - 1; ++ii)
+        {
+            if (m_begin[ii + 1] - m_end[ii] < m_begin[closest + 1] - m_end[closest])
+            {
+                closest = ii;
+            }
+        }
+
+        m_end[closest] = m_end[closest + 1];
+        bx::memMove(&m_begin[closest + 1], &m_begin[closest + 2], (m_num - closest - 2) * sizeof(uint32_t));
+        bx::memMove(&m_end[closest + 1], &m_end[closest + 2], (m_num - closest - 2) * sizeof(uint32_t));
+        --m_num;
+    }
+}
+
+struct UavFormat
+{
+    DXGI_FORMAT format[3];
+    uint32_t stride;
+};
+
+static const UavFormat s_uavFormat[] = {
+    //  BGFX_BUFFER_COMPUTE_TYPE_INT,  BGFX_BUFFER_COMPUTE_TYPE_UINT,  BGFX_BUFFER_COMPUTE_TYPE_FLOAT
+    {{DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN}, 0},             // ignored
+    {{DXGI_FORMAT_R8_SINT, DXGI_FORMAT_R8_UINT, DXGI_FORMAT_UNKNOWN}, 1},             // BGFX_BUFFER_COMPUTE_FORMAT_8X1
+    {{DXGI_FORMAT_R8G8_SINT, DXGI_FORMAT_R8G8_UINT, DXGI_FORMAT_UNKNOWN}, 2},         // BGFX_BUFFER_COMPUTE_FORMAT_8X2
+    {{DXGI_FORMAT_R8G8B8A8_SINT, DXGI_FORMAT_R8G8B8A8_UINT, DXGI_FORMAT_UNKNOWN}, 4}, // BGFX_BUFFER_COMPUTE_FORMAT_8X4
+    {{DXGI_FORMAT_R16_SINT, DXGI_FORMAT_R16_UINT, DXGI_FORMAT_R16_FLOAT}, 2},         // BGFX_BUFFER_COMPUTE_FORMAT_16X1
+    {{DXGI_FORMAT_R16G16_SINT, DXGI_FORMAT_R16G16_UINT, DXGI_FORMAT_R16G16_FLOAT},
+     4}, // BGFX_BUFFER_COMPUTE_FORMAT_16X2
+    {{DXGI_FORMAT_R16G16B16A16_SINT, DXGI_FORMAT_R16G16B16A16_UINT, DXGI_FORMAT_R16G16B16A16_FLOAT},
+     8},                                                                      // BGFX_BUFFER_COMPUTE_FORMAT_16X4
+    {{DXGI_FORMAT_R32_SINT, DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32_FLOAT}, 4}, // BGFX_BUFFER_COMPUTE_FORMAT_32X1
+    {{DXGI_FORMAT_R32G32_SINT, DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32_FLOAT},
+     8}, // BGFX_BUFFER_COMPUTE_FORMAT_32X2
+    {{DXGI_FORMAT_R32G32B32A32_SINT, DXGI_FORMAT_R32G32B32A32_UINT, DXGI_FORMAT_R32G32B32A32_FLOAT},
+     16}, // BGFX_BUFFER_COMPUTE_FORMAT_32X4
+};
+
+void BufferD3D12::create(uint32_t _size, const void *_data, uint16_t _flags, bool _vertex, uint32_t _stride)
+{
+    m_size = _size;
+    m_flags = _flags;
+    m_category = _vertex ? MemoryCategory::VertexBuffer : MemoryCategory::IndexBuffer;
+
+    const bool needUav = 0 != (_flags & (BGFX_BUFFER_COMPUTE_WRITE | BGFX_BUFFER_DRAW_INDIRECT));
+    const bool drawIndirect = 0 != (_flags & BGFX_BUFFER_DRAW_INDIRECT);
+    m_dynamic = NULL == _data || needUav;
+
+    DXGI_FORMAT format;
+    uint32_t stride;
+
+    uint32_t flags = needUav ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE;
+
+    if (drawIndirect)
+    {
+        format = _vertex ? DXGI_FORMAT_R32G32B32A32_UINT : DXGI_FORMAT_R32_UINT;
+        stride = _vertex ? 16 : 4;
+    }
+    else
+    {
+        uint32_t uavFormat = (_flags & BGFX_BUFFER_COMPUTE_FORMAT_MASK) >> BGFX_BUFFER_COMPUTE_FORMAT_SHIFT;
+        if (0 == uavFormat)
+        {
+            if (_vertex)
+            {
+                format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+                stride = 16;
+            }
+            else
+            {
+                if (0 == (_flags & BGFX_BUFFER_INDEX32))
+                {
+                    format = DXGI_FORMAT_R16_UINT;
+                    stride = 2;
+                }
+                else
+                {
+                    format = DXGI_FORMAT_R32_UINT;
+                    stride = 4;
+                }
+            }
+        }
+        else
+        {
+            const uint32_t uavType =
+                bx::uint32_satsub((_flags & BGFX_BUFFER_COMPUTE_TYPE_MASK) >> BGFX_BUFFER_COMPUTE_TYPE_SHIFT, 1);
+            format = s_uavFormat[uavFormat].format[uavType];
+            stride = s_uavFormat[uavFormat].stride;
+        }
+    }
+
+    stride = 0 == _stride ? stride : _stride;
+    m_stride = stride;
+
+    m_srvd.Format = format;
+    m_srvd.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    m_srvd.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    m_srvd.Buffer.FirstElement = 0;
+    m_srvd.Buffer.NumElements = m_size / stride;
+    m_srvd.Buffer.StructureByteStride = 0;
+    m_srvd.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+
+    m_uavd.Format = format;
+    m_uavd.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    m_uavd.Buffer.FirstElement = 0;
+    m_uavd.Buffer.NumElements = m_size / stride;
+    m_uavd.Buffer.StructureByteStride = 0;
+    m_uavd.Buffer.CounterOffsetInBytes = 0;
+    m_uavd.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
+
+    ID3D12Device *device = s_renderD3D12->m_device.Get();
+    ID3D12GraphicsCommandList *commandList = s_renderD3D12->m_commandList.Get();
+
+    m_page = m_dynamic ? UINT16_MAX : s_renderD3D12->m_bufferPool.alloc(_size, m_allocation);
+    if (UINT16_MAX != m_page)
+    {
+        const BufferPoolD3D12::Page &page = s_renderD3D12->m_bufferPool.m_pages[m_page];
+        m_ptr = page.m_ptr;
+        m_offset = m_allocation.m_offset;
+        m_gpuVA = page.m_gpuVA + m_offset;
+        m_srvd.Buffer.FirstElement = m_offset / stride;
+        m_uavd.Buffer.FirstElement = m_offset / stride;
+        trackAlloc(m_category, page.m_tlsf.getSize(m_allocation));
+    }
+    else
+    {
+        m_ptr = createCommittedResource(device, HeapProperty::Default, _size, D3D12_RESOURCE_FLAGS(flags));
+        m_offset = 0;
+        m_gpuVA = m_ptr->GetGPUVirtualAddress();
+        trackAlloc(m_category, _size);
+    }
+
+    setState(commandList, drawIndirect ? D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT : D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    if (NULL == _data)
+    {
+        m_shadow = (uint8_t *)bx::alloc(getAllocator(m_category), _size);
+        bx::memSet(m_shadow, 0, _size);
+    }
+
+    if (!m_dynamic)
+    {
+        update(commandList, 0, _size, _data);
+    }
+}
+
+void BufferD3D12::update(ID3D12GraphicsCommandList *_commandList, uint32_t _offset, uint32_t _size, const void *_data,
+                         bool _discard)
+{
+    BGFX_PROFILER_SCOPE("BufferD3D12::update");
+    ID3D12Resource *staging;
+    uint64_t stagingOffset;
+    uint8_t *data = s_renderD3D12->allocUpload(_size, staging, stagingOffset);
+    bx::memCopy(data, _data, _size);
+
+    D3D12_RESOURCE_STATES state = setState(_commandList, D3D12_RESOURCE_STATE_COPY_DEST);
+    _commandList->CopyBufferRegion(m_ptr, m_offset + _offset, staging, stagingOffset, _size);
+    setState(_commandList, state);
+}
+
+void BufferD3D12::updateDynamic(uint32_t _offset, uint32_t _size, const void *_data)
+{
+    BX_ASSERT(NULL != m_shadow, "Updating buffer that wasn't created as dynamic.");
+
+    const uint32_t end = _offset + _size;
+    if (end > m_size)
+    {
+        BX_ASSERT(0 != (m_flags & BGFX_BUFFER_ALLOW_RESIZE), "Update out of bounds (%d > %d).", end, m_size);
+        resize(end);
+    }
+
+    bx::memCopy(&m_shadow[_offset], _data, _size);
+    m_dirty.add(_offset, end);
+}
+
+void BufferD3D12::resize(uint32_t _size)
+{
+    // Grow geometrically so buffers appended to every frame don't resize every frame.
+    const uint32_t size = bx::alignUp(bx::max(_size, m_size + m_size / 2), 256);
+
+    m_shadow = (uint8_t *)bx::realloc(getAllocator(m_category), m_shadow, size);
+    bx::memSet(&m_shadow[m_size], 0, size - m_size);
+
+    if (NULL == m_resizeSrc)
+    {
+        m_resizeSrc = m_ptr;
+        m_resizeSrcState = m_state;
+        m_resizeSrcSize = m_size;
+    }
+    else
+    {
+        // Buffer from previous resize was never flushed, it holds nothing worth copying.
+        s_renderD3D12->release(m_ptr);
+    }
+
+    const bool needUav = 0 != (m_flags & (BGFX_BUFFER_COMPUTE_WRITE | BGFX_BUFFER_DRAW_INDIRECT));
+    m_ptr = createCommittedResource(s_renderD3D12->m_device.Get(), HeapProperty::Default, size,
+                                    needUav ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE);
+    m_gpuVA = m_ptr->GetGPUVirtualAddress();
+    m_state = s_heapProperties[HeapProperty::Default].m_state;
+    trackFree(m_category, m_size);
+    trackAlloc(m_category, size);
+    m_size = size;
+
+    m_srvd.Buffer.NumElements = m_size / m_stride;
+    m_uavd.Buffer.NumElements = m_size / m_stride;
+}
+
+void BufferD3D12::flush(ID3D12GraphicsCommandList *_commandList)
+{
+    if (NULL == m_resizeSrc && m_dirty.isEmpty())
+    {
+        return;
+    }
+
+    BGFX_PROFILER_SCOPE("BufferD3D12::flush");
+
+    setState(_commandList, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    if (NULL != m_resizeSrc)
+    {
+        // Copy old contents on GPU instead of uploading whole shadow again.
+        setResourceBarrier(_commandList, m_resizeSrc, m_resizeSrcState, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        _commandList->CopyBufferRegion(m_ptr, 0, m_resizeSrc, 0, m_resizeSrcSize);
+        s_renderD3D12->release(m_resizeSrc);
+        m_resizeSrc = NULL;
+    }
+
+    for (uint32_t ii = 0; ii < m_dirty.m_num; ++ii)
+    {
+        const uint32_t offset = m_dirty.m_begin[ii];
+        const uint32_t size = m_dirty.m_end[ii] - offset;
+
+        ID3D12Resource *staging;
+        uint64_t stagingOffset;
+        uint8_t *data = s_renderD3D12->allocUpload(size, staging, stagingOffset);
+        bx::memCopy(data, &m_shadow[offset], size);
+        _commandList->CopyBufferRegion(m_ptr, m_offset + offset, staging, stagingOffset, size);
+    }
+
+    m_dirty.reset();
+
+    const bool drawIndirect = 0 != (m_flags & BGFX_BUFFER_DRAW_INDIRECT);
+    setState(_commandList, drawIndirect ? D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT : D3D12_RESOURCE_STATE_GENERIC_READ);
+}
+
+void BufferD3D12::destroy()
+{
+    if (UINT16_MAX != m_page)
+    {
+        trackFree(m_category, s_renderD3D12->m_bufferPool.m_pages[m_page].m_tlsf.getSize(m_allocation));
+        s_renderD3D12->m_bufferPool.free(m_page, m_allocation);
+        m_page = UINT16_MAX;
+        m_offset = 0;
+        m_ptr = nullptr;
+        m_state = D3D12_RESOURCE_STATE_COMMON;
+    }
+    else if (m_ptr)
+    {
+        trackFree(m_category, m_size);
+        s_renderD3D12->release(m_ptr);
+        m_ptr = nullptr;
+        m_dynamic = false;
+        m_state = D3D12_RESOURCE_STATE_COMMON;
+    }
+
+    if (NULL != m_resizeSrc)
+    {
+        s_renderD3D12->release(m_resizeSrc);
+        m_resizeSrc = NULL;
+    }
+
+    if (NULL != m_shadow)
+    {
+        bx::free(getAllocator(m_category), m_shadow);
+        m_shadow = NULL;
+    }
+
+    m_dirty.reset();
+}
+
+D3D12_RESOURCE_STATES BufferD3D12::setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state)
+{
+    D3D12_RESOURCE_STATES &state =
+        UINT16_MAX == m_page ? m_state : s_renderD3D12->m_bufferPool.m_pages[m_page].m_state;
+
+    if (state != _state)
+    {
+        setResourceBarrier(_commandList, m_ptr, state, _state);
+
+        bx::swap(state, _state);
+    }
+
+    return _state;
 }
 
-struct UavFormat
+void VertexBufferD3D12::create(uint32_t _size, const void *_data, VertexLayoutHandle _layoutHandle, uint16_t _flags)
 {
-    DXGI_FORMAT format[3];
-    uint32_t stride;
-};
-
-static const UavFormat s_uavFormat[] = {
-    //  BGFX_BUFFER_COMPUTE_TYPE_INT,  BGFX_BUFFER_COMPUTE_TYPE_UINT,  BGFX_BUFFER_COMPUTE_TYPE_FLOAT
-    {{DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN}, 0},             // ignored
-    {{DXGI_FORMAT_R8_SINT, DXGI_FORMAT_R8_UINT, DXGI_FORMAT_UNKNOWN}, 1},             // BGFX_BUFFER_COMPUTE_FORMAT_8X1
-    {{DXGI_FORMAT_R8G8_SINT, DXGI_FORMAT_R8G8_UINT, DXGI_FORMAT_UNKNOWN}, 2},         // BGFX_BUFFER_COMPUTE_FORMAT_8X2
-    {{DXGI_FORMAT_R8G8B8A8_SINT, DXGI_FORMAT_R8G8B8A8_UINT, DXGI_FORMAT_UNKNOWN}, 4}, // BGFX_BUFFER_COMPUTE_FORMAT_8X4
-    {{DXGI_FORMAT_R16_SINT, DXGI_FORMAT_R16_UINT, DXGI_FORMAT_R16_FLOAT}, 2},         // BGFX_BUFFER_COMPUTE_FORMAT_16X1
-    {{DXGI_FORMAT_R16G16_SINT, DXGI_FORMAT_R16G16_UINT, DXGI_FORMAT_R16G16_FLOAT},
-     4}, // BGFX_BUFFER_COMPUTE_FORMAT_16X2
-    {{DXGI_FORMAT_R16G16B16A16_SINT, DXGI_FORMAT_R16G16B16A16_UINT, DXGI_FORMAT_R16G16B16A16_FLOAT},
-     8},                                                                      // BGFX_BUFFER_COMPUTE_FORMAT_16X4
-    {{DXGI_FORMAT_R32_SINT, DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32_FLOAT}, 4}, // BGFX_BUFFER_COMPUTE_FORMAT_32X1
-    {{DXGI_FORMAT_R32G32_SINT, DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32_FLOAT},
-     8}, // BGFX_BUFFER_COMPUTE_FORMAT_32X2
-    {{DXGI_FORMAT_R32G32B32A32_SINT, DXGI_FORMAT_R32G32B32A32_UINT, DXGI_FORMAT_R32G32B32A32_FLOAT},
-     16}, // BGFX_BUFFER_COMPUTE_FORMAT_32X4
-};
+    m_layoutHandle = _layoutHandle;
+    BufferD3D12::create(_size, _data, _flags, true, 0);
+}
 
-void BufferD3D12::create(uint32_t _size, const void *_data, uint16_t _flags, bool _vertex, uint32_t _stride)
+void TransientBufferD3D12::create(uint32_t _size, uint32_t _numFrames)
 {
     m_size = _size;
-    m_flags = _flags;
+    m_numFrames = _numFrames;
+    trackAlloc(MemoryCategory::UploadRing, uint64_t(_size) * _numFrames);
+    m_ptr = createCommittedResource(s_renderD3D12->m_device.Get(), HeapProperty::Upload, uint64_t(_size) * _numFrames);
+    m_gpuVA = m_ptr->GetGPUVirtualAddress();
 
-    const bool needUav = 0 != (_flags & (BGFX_BUFFER_COMPUTE_WRITE | BGFX_BUFFER_DRAW_INDIRECT));
-    const bool drawIndirect = 0 != (_flags & BGFX_BUFFER_DRAW_INDIRECT);
-    m_dynamic = NULL == _data || needUav;
+    D3D12_RANGE readRange = {0, 0};
+    DX_CHECK(m_ptr->Map(0, &readRange, (void **)&m_data));
+}
 
-    DXGI_FORMAT format;
-    uint32_t stride;
+void TransientBufferD3D12::destroy()
+{
+    if (NULL != m_ptr)
+    {
+        m_ptr->Unmap(0, NULL);
+        m_ptr->Release();
+        m_ptr = NULL;
+        m_data = NULL;
+        trackFree(MemoryCategory::UploadRing, uint64_t(m_size) * m_numFrames);
+    }
+}
 
-    uint32_t flags = needUav ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE;
+void TextureD3D12::create(const TextureInfo &_info, const void *_data)
+{
+    BGFX_PROFILER_SCOPE("TextureD3D12::create");
+    ID3D12Device *device = s_renderD3D12->m_device.Get();
+    ID3D12GraphicsCommandList *commandList = s_renderD3D12->m_commandList.Get();
 
-    if (drawIndirect)
+    m_info = _info;
+
+    const uint16_t numSides = _info.cubeMap ? 6 : 1;
+    const DXGI_FORMAT format = s_textureFormat[_info.format];
+    const D3D12_RESOURCE_DESC desc =
+        CD3DX12_RESOURCE_DESC::Tex2D(format, _info.width, _info.height, numSides, _info.numMips);
+
+    m_ptr = createCommittedResource(device, HeapProperty::Texture, &desc, NULL);
+    m_state = s_heapProperties[HeapProperty::Texture].m_state;
+    trackAlloc(MemoryCategory::Texture, _info.storageSize);
+
+    // 在着色器可见描述符堆中创建 SRV
+    m_srv = s_renderD3D12->m_descriptorAlloc.alloc(1);
+    if (TlsfAllocator::isValid(m_srv))
     {
-        format = _vertex ? DXGI_FORMAT_R32G32B32A32_UINT : DXGI_FORMAT_R32_UINT;
-        stride = _vertex ? 16 : 4;
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvd = {};
+        srvd.Format = format;
+        srvd.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        if (_info.cubeMap)
+        {
+            srvd.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+            srvd.TextureCube.MipLevels = _info.numMips;
+        }
+        else
+        {
+            srvd.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvd.Texture2D.MipLevels = _info.numMips;
+        }
+        device->CreateShaderResourceView(m_ptr, &srvd, s_renderD3D12->getCpuHandle(m_srv.m_offset));
     }
     else
     {
-        uint32_t uavFormat = (_flags & BGFX_BUFFER_COMPUTE_FORMAT_MASK) >> BGFX_BUFFER_COMPUTE_FORMAT_SHIFT;
-        if (0 == uavFormat)
+        BX_TRACE("WARNING: Descriptor heap exhausted (BGFX_CONFIG_MAX_DESCRIPTORS, max: %d).",
+                 BGFX_CONFIG_MAX_DESCRIPTORS);
+    }
+
+    if (NULL != _data)
+    {
+        // Subresource `side * numMips + mip` matches data layout, one upload holds them all and
+        // each gets one copy.
+        const uint32_t numSubresources = numSides * _info.numMips;
+        BX_ASSERT(numSubresources <= MaxSubresources, "Too many subresources %d.", numSubresources);
+
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprints[MaxSubresources];
+        UINT numRows[MaxSubresources];
+        UINT64 total;
+        device->GetCopyableFootprints(&desc, 0, numSubresources, 0, footprints, numRows, NULL, &total);
+
+        ID3D12Resource *staging;
+        uint64_t stagingOffset;
+        uint8_t *data = s_renderD3D12->allocUpload(uint32_t(total), staging, stagingOffset,
+                                                   D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        setState(commandList, D3D12_RESOURCE_STATE_COPY_DEST);
+
+        const uint8_t *src = (const uint8_t *)_data;
+        for (uint32_t ii = 0; ii < numSubresources; ++ii)
         {
-            if (_vertex)
-            {
-                format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-                stride = 16;
-            }
-            else
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = footprints[ii];
+            const uint32_t pitch = calcPitch(_info.format, uint16_t(footprint.Footprint.Width));
+
+            uint8_t *dst = &data[footprint.Offset];
+            for (uint32_t yy = 0; yy < numRows[ii]; ++yy)
             {
-                if (0 == (_flags & BGFX_BUFFER_INDEX32))
-                {
-                    format = DXGI_FORMAT_R16_UINT;
-                    stride = 2;
-                }
-                else
-                {
-                    format = DXGI_FORMAT_R32_UINT;
-                    stride = 4;
-                }
+                bx::memCopy(dst, src, pitch);
+                dst += footprint.Footprint.RowPitch;
+                src += pitch;
             }
+
+            footprint.Offset += stagingOffset;
+            CD3DX12_TEXTURE_COPY_LOCATION dstLocation(m_ptr, ii);
+            CD3DX12_TEXTURE_COPY_LOCATION srcLocation(staging, footprint);
+            commandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, NULL);
         }
-        else
+        BX_ASSERT(src == (const uint8_t *)_data + _info.storageSize, "Texture data size mismatch.");
+    }
+
+    setState(commandList, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+}
+
+void TextureD3D12::destroy()
+{
+    if (NULL != m_ptr)
+    {
+        trackFree(MemoryCategory::Texture, m_info.storageSize);
+        s_renderD3D12->release(m_ptr);
+        m_ptr = NULL;
+
+        if (TlsfAllocator::isValid(m_srv))
         {
-            const uint32_t uavType =
-                bx::uint32_satsub((_flags & BGFX_BUFFER_COMPUTE_TYPE_MASK) >> BGFX_BUFFER_COMPUTE_TYPE_SHIFT, 1);
-            format = s_uavFormat[uavFormat].format[uavType];
-            stride = s_uavFormat[uavFormat].stride;
+            s_renderD3D12->m_descriptorAlloc.free(m_srv);
         }
     }
+}
 
-    stride = 0 == _stride ? stride : _stride;
+void TextureD3D12::update(ID3D12GraphicsCommandList *_commandList, uint8_t _side, uint8_t _mip, uint16_t _x,
+                          uint16_t _y, uint16_t _width, uint16_t _height, const void *_data, uint32_t _pitch)
+{
+    BGFX_PROFILER_SCOPE("TextureD3D12::update");
+    const uint32_t rowSize = calcPitch(m_info.format, _width);
+    const uint32_t rowPitch = bx::alignUp(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    const uint32_t numRows = calcNumRows(m_info.format, _height);
+
+    ID3D12Resource *staging;
+    uint64_t stagingOffset;
+    uint8_t *data = s_renderD3D12->allocUpload(rowPitch * numRows, staging, stagingOffset,
+                                               D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+    const uint8_t *src = (const uint8_t *)_data;
+    for (uint32_t yy = 0; yy < numRows; ++yy)
+    {
+        bx::memCopy(&data[yy * rowPitch], &src[yy * _pitch], rowSize);
+    }
 
-    m_srvd.Format = format;
-    m_srvd.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-    m_srvd.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    m_srvd.Buffer.FirstElement = 0;
-    m_srvd.Buffer.NumElements = m_size / stride;
-    m_srvd.Buffer.StructureByteStride = 0;
-    m_srvd.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+    // Footprint of compressed format covers whole blocks, edge blocks of mip past its size too.
+    const uint32_t blockSize = getBlockSize(m_info.format);
 
-    m_uavd.Format = format;
-    m_uavd.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-    m_uavd.Buffer.FirstElement = 0;
-    m_uavd.Buffer.NumElements = m_size / stride;
-    m_uavd.Buffer.StructureByteStride = 0;
-    m_uavd.Buffer.CounterOffsetInBytes = 0;
-    m_uavd.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    footprint.Offset = stagingOffset;
+    footprint.Footprint.Format = s_textureFormat[m_info.format];
+    footprint.Footprint.Width = bx::alignUp(uint32_t(_width), blockSize);
+    footprint.Footprint.Height = bx::alignUp(uint32_t(_height), blockSize);
+    footprint.Footprint.Depth = 1;
+    footprint.Footprint.RowPitch = rowPitch;
 
-    ID3D12Device *device = s_renderD3D12->m_device.Get();
-    ID3D12GraphicsCommandList *commandList = s_renderD3D12->m_commandList.Get();
+    const D3D12_RESOURCE_STATES state = setState(_commandList, D3D12_RESOURCE_STATE_COPY_DEST);
 
-    m_ptr = createCommittedResource(device, HeapProperty::Default, _size, D3D12_RESOURCE_FLAGS(flags));
-    m_gpuVA = m_ptr->GetGPUVirtualAddress();
-    setState(commandList, drawIndirect ? D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT : D3D12_RESOURCE_STATE_GENERIC_READ);
+    CD3DX12_TEXTURE_COPY_LOCATION dstLocation(m_ptr, _side * m_info.numMips + _mip);
+    CD3DX12_TEXTURE_COPY_LOCATION srcLocation(staging, footprint);
+    _commandList->CopyTextureRegion(&dstLocation, _x, _y, 0, &srcLocation, NULL);
 
-    if (!m_dynamic)
+    setState(_commandList, state);
+}
+
+D3D12_RESOURCE_STATES TextureD3D12::setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state)
+{
+    if (m_state != _state)
     {
-        update(commandList, 0, _size, _data);
+        setResourceBarrier(_commandList, m_ptr, m_state, _state);
+
+        bx::swap(m_state, _state);
     }
+
+    return _state;
 }
 
-void BufferD3D12::update(ID3D12GraphicsCommandList *_commandList, uint32_t _offset, uint32_t _size, const void *_data,
-                         bool _discard)
+void FrameBufferD3D12::create(uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                              TextureFormat::Enum _depthFormat, D3D12_CPU_DESCRIPTOR_HANDLE _rtv,
+                              D3D12_CPU_DESCRIPTOR_HANDLE _dsv)
 {
-    ID3D12Resource *staging = createCommittedResource(s_renderD3D12->m_device.Get(), HeapProperty::Upload, _size);
-    uint8_t *data;
+    ID3D12Device *device = s_renderD3D12->m_device.Get();
 
-    D3D12_RANGE readRange = {0, 0};
-    DX_CHECK(staging->Map(0, &readRange, (void **)&data));
-    bx::memCopy(data, _data, _size);
-    D3D12_RANGE writeRange = {0, _size};
-    staging->Unmap(0, &writeRange);
+    m_width = _width;
+    m_height = _height;
+    m_format = _format;
+    m_depthFormat = _depthFormat;
+    m_rtv = _rtv;
+    m_dsv = _dsv;
 
-    D3D12_RESOURCE_STATES state = setState(_commandList, D3D12_RESOURCE_STATE_COPY_DEST);
-    _commandList->CopyBufferRegion(m_ptr, _offset, staging, 0, _size);
-    setState(_commandList, state);
+    m_texture = createTexture(device, _width, _height, s_textureFormat[_format],
+                              D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    m_state = D3D12_RESOURCE_STATE_COMMON;
+    device->CreateRenderTargetView(m_texture, NULL, m_rtv);
+    m_size = uint32_t(_width) * _height * getBitsPerPixel(_format) / 8;
+
+    if (TextureFormat::Count != _depthFormat)
+    {
+        m_depth = createTexture(device, _width, _height, s_textureFormat[_depthFormat],
+                                D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL | D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE,
+                                D3D12_RESOURCE_STATE_DEPTH_WRITE);
+        device->CreateDepthStencilView(m_depth, NULL, m_dsv);
+        m_size += uint32_t(_width) * _height * getBitsPerPixel(_depthFormat) / 8;
+    }
 
-    // TODO: 释放资源
-    //  s_renderD3D12->m_cmd.release(staging);
+    trackAlloc(MemoryCategory::Texture, m_size);
 }
 
-void BufferD3D12::destroy()
+void FrameBufferD3D12::destroy()
 {
-    if (m_ptr)
+    if (NULL != m_texture)
     {
-        // TODO: 释放资源
-        //  s_renderD3D12->m_cmd.release(m_ptr);
-        m_ptr->Release();
-        m_ptr = nullptr;
-        m_dynamic = false;
-        m_state = D3D12_RESOURCE_STATE_COMMON;
+        trackFree(MemoryCategory::Texture, m_size);
+        s_renderD3D12->release(m_texture);
+        m_texture = NULL;
+        m_size = 0;
+    }
+
+    if (NULL != m_depth)
+    {
+        s_renderD3D12->release(m_depth);
+        m_depth = NULL;
     }
 }
 
-D3D12_RESOURCE_STATES BufferD3D12::setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state)
+D3D12_RESOURCE_STATES FrameBufferD3D12::setState(ID3D12GraphicsCommandList *_commandList,
+                                                 D3D12_RESOURCE_STATES _state)
 {
     if (m_state != _state)
     {
-        setResourceBarrier(_commandList, m_ptr, m_state, _state);
+        setResourceBarrier(_commandList, m_texture, m_state, _state);
 
         bx::swap(m_state, _state);
     }
@@ -524,43 +1978,94 @@ D3D12_RESOURCE_STATES BufferD3D12::setState(ID3D12GraphicsCommandList *_commandL
     return _state;
 }
 
-void VertexBufferD3D12::create(uint32_t _size, const void *_data, VertexLayoutHandle _layoutHandle, uint16_t _flags)
-{
-    m_layoutHandle = _layoutHandle;
-    BufferD3D12::create(_size, _data, _flags, true, 0);
-}
-
-void ShaderD3D12::create(const void *_data, uint32_t _size, ShaderType _type)
+/// D3DCompile doesn't touch device, so it runs on loader threads too. Returns NULL when source doesn't compile.
+static ID3DBlob *compileHlsl(const void *_data, uint32_t _size, ShaderType _type)
 {
-    BX_ASSERT(NULL != _data, "Invalid memory.");
-
-    m_code = _data;
-    m_size = _size;
-    m_type = _type;
+    BGFX_PROFILER_SCOPE("compileHlsl");
 
-    // compile shader
     Microsoft::WRL::ComPtr<ID3DBlob> error;
+    ID3DBlob *code = NULL;
 
-    const char *entry = _type == ShaderType::ShaderType_Vertex ? "main" : "main";
     const char *target = _type == ShaderType::ShaderType_Vertex ? "vs_5_0" : "ps_5_0";
-
-    DX_CHECK(D3DCompile(_data, _size, nullptr, nullptr, nullptr, entry, target, 0, 0, &m_shader, &error));
+    const HRESULT hr = D3DCompile(_data, _size, nullptr, nullptr, nullptr, "main", target, 0, 0, &code, &error);
 
     if (error)
     {
         OutputDebugStringA(reinterpret_cast<const char *>(error->GetBufferPointer()));
     }
+
+    if (FAILED(hr))
+    {
+        BX_TRACE("WARNING: Shader doesn't compile (0x%08x).", uint32_t(hr));
+        if (NULL != code)
+        {
+            code->Release();
+        }
+        return NULL;
+    }
+
+    return code;
+}
+
+uint8_t *RendererContextD3D12::compileShader(const void *_data, uint32_t _size, ShaderType _type,
+                                             uint32_t &_outSize)
+{
+    ID3DBlob *blob = compileHlsl(_data, _size, _type);
+    if (NULL == blob)
+    {
+        return NULL;
+    }
+
+    _outSize = uint32_t(blob->GetBufferSize());
+    uint8_t *code = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Staging), _outSize);
+    bx::memCopy(code, blob->GetBufferPointer(), _outSize);
+    blob->Release();
+
+    return code;
+}
+
+bool ShaderD3D12::create(const void *_data, uint32_t _size, ShaderType _type)
+{
+    BGFX_PROFILER_SCOPE("ShaderD3D12::create");
+    BX_ASSERT(NULL != _data, "Invalid memory.");
+
+    if (_size >= 4 && 0 == bx::memCmp(_data, "DXBC", 4))
+    {
+        if (FAILED(D3DCreateBlob(_size, &m_shader)))
+        {
+            return false;
+        }
+        bx::memCopy(m_shader->GetBufferPointer(), _data, _size);
+    }
+    else
+    {
+        m_shader = compileHlsl(_data, _size, _type);
+        if (NULL == m_shader)
+        {
+            return false;
+        }
+    }
+
+    // Caller's memory is gone after create, keep pointing at own copy.
+    m_code = m_shader->GetBufferPointer();
+    m_size = uint32_t(m_shader->GetBufferSize());
+    m_type = _type;
+    trackAlloc(MemoryCategory::Shader, m_size);
+
+    return true;
 }
 
 void ProgramD3D12::create(const ShaderD3D12 *_vsh, const ShaderD3D12 *_fsh)
 {
     BX_ASSERT(NULL != _vsh->m_code, "Vertex shader doesn't exist.");
-    m_vsh = _vsh;
+    m_vsCode = _vsh->m_shader;
+    m_vsCode->AddRef();
 
     if (NULL != _fsh)
     {
         BX_ASSERT(NULL != _fsh->m_code, "Fragment shader doesn't exist.");
-        m_fsh = _fsh;
+        m_fsCode = _fsh->m_shader;
+        m_fsCode->AddRef();
     }
 }
 
@@ -736,40 +2241,174 @@ uint32_t setInputLayout(D3D12_INPUT_ELEMENT_DESC *_vertexElements, const VertexL
     return setInputLayout(_vertexElements, BX_COUNTOF(layouts), layouts, _program, _numInstanceData);
 }
 
-void PSOD3D12::create(const ProgramD3D12 *_program, const VertexLayout *_layout, uint16_t _flags)
+void PSOD3D12::create(const ProgramD3D12 *_program, const VertexLayout *_layout, uint64_t _flags)
 {
-    BX_ASSERT(NULL != _program->m_vsh->m_code, "Vertex shader doesn't exist.");
+    BX_ASSERT(NULL != _program->m_vsCode, "Vertex shader doesn't exist.");
     BX_ASSERT(NULL != _layout, "Layout doesn't exist.");
 
+    m_program = _program;
+    m_layout = *_layout;
+    m_flags = _flags & kStateMask;
+    m_pso = compile(DXGI_FORMAT_R8G8B8A8_UNORM, s_renderD3D12->m_backBufferDsvFormat, m_flags, m_size);
+}
+
+ID3D12PipelineState *PSOD3D12::get(DXGI_FORMAT _rtvFormat, DXGI_FORMAT _dsvFormat, uint64_t _state)
+{
+    const uint64_t state = _state & (kStateMask | kStateIndex32);
+
+    if (DXGI_FORMAT_R8G8B8A8_UNORM == _rtvFormat && s_renderD3D12->m_backBufferDsvFormat == _dsvFormat &&
+        m_flags == state)
+    {
+        return m_pso;
+    }
+
+    for (uint16_t ii = 0; ii < m_numVariants; ++ii)
+    {
+        const Variant &variant = m_variants[ii];
+        if (variant.m_rtvFormat == _rtvFormat && variant.m_dsvFormat == _dsvFormat && variant.m_state == state)
+        {
+            return variant.m_pso;
+        }
+    }
+
+    m_variants = (Variant *)bx::realloc(getAllocator(MemoryCategory::PSO), m_variants,
+                                        (m_numVariants + 1) * sizeof(Variant));
+
+    Variant &variant = m_variants[m_numVariants++];
+    variant.m_rtvFormat = _rtvFormat;
+    variant.m_dsvFormat = _dsvFormat;
+    variant.m_state = state;
+    variant.m_pso = compile(_rtvFormat, _dsvFormat, state, variant.m_size);
+    return variant.m_pso;
+}
+
+void PSOD3D12::destroy()
+{
+    if (NULL != m_pso)
+    {
+        trackFree(MemoryCategory::PSO, m_size);
+        m_pso->Release();
+    }
+
+    for (uint16_t ii = 0; ii < m_numVariants; ++ii)
+    {
+        if (NULL != m_variants[ii].m_pso)
+        {
+            trackFree(MemoryCategory::PSO, m_variants[ii].m_size);
+            m_variants[ii].m_pso->Release();
+        }
+    }
+
+    bx::free(getAllocator(MemoryCategory::PSO), m_variants);
+    m_variants = NULL;
+    m_numVariants = 0;
+    m_pso = NULL;
+    m_size = 0;
+}
+
+ID3D12PipelineState *PSOD3D12::compile(DXGI_FORMAT _rtvFormat, DXGI_FORMAT _dsvFormat, uint64_t _state,
+                                       uint32_t &_outSize)
+{
+    const ProgramD3D12 *program = m_program;
+
     // Input layout
     D3D12_INPUT_ELEMENT_DESC vertexElements[Attrib::Count + 1 + BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
-    uint32_t countOfVertexElements = setInputLayout(vertexElements, *_layout, *_program, 0);
+    uint32_t countOfVertexElements = setInputLayout(vertexElements, m_layout, *program, 0);
 
     // Describe and create the graphics pipeline state object (PSO)
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = {vertexElements, countOfVertexElements};
     psoDesc.pRootSignature = s_renderD3D12->m_rootSignature.Get();
-    psoDesc.VS = {_program->m_vsh->m_shader->GetBufferPointer(), _program->m_vsh->m_shader->GetBufferSize()};
-    psoDesc.PS = {_program->m_fsh->m_shader->GetBufferPointer(), _program->m_fsh->m_shader->GetBufferSize()};
+    psoDesc.VS = {program->m_vsCode->GetBufferPointer(), program->m_vsCode->GetBufferSize()};
+
+    const uint32_t cull = uint32_t((_state & BGFX_STATE_CULL_MASK) >> BGFX_STATE_CULL_SHIFT);
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.RasterizerState.CullMode = s_cullMode[cull];
+    psoDesc.RasterizerState.FrontCounterClockwise = 0 != (_state & BGFX_STATE_FRONT_CCW);
+    psoDesc.RasterizerState.MultisampleEnable = 0 != (_state & BGFX_STATE_MSAA);
+
+    // Blend function and equation pack RGB in low nibbles and alpha in high ones.
+    const uint32_t blend = uint32_t((_state & BGFX_STATE_BLEND_MASK) >> BGFX_STATE_BLEND_SHIFT);
+    const uint32_t equation = uint32_t((_state & BGFX_STATE_BLEND_EQUATION_MASK) >> BGFX_STATE_BLEND_EQUATION_SHIFT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.BlendState.AlphaToCoverageEnable = 0 != (_state & BGFX_STATE_BLEND_ALPHA_TO_COVERAGE);
+
+    D3D12_RENDER_TARGET_BLEND_DESC &rtBlend = psoDesc.BlendState.RenderTarget[0];
+    rtBlend.BlendEnable = 0 != blend;
+    if (0 != blend)
+    {
+        rtBlend.SrcBlend = s_blendFactor[blend & 0xf][0];
+        rtBlend.DestBlend = s_blendFactor[(blend >> 4) & 0xf][0];
+        rtBlend.BlendOp = s_blendEquation[equation & 0x7];
+        rtBlend.SrcBlendAlpha = s_blendFactor[(blend >> 8) & 0xf][1];
+        rtBlend.DestBlendAlpha = s_blendFactor[(blend >> 12) & 0xf][1];
+        rtBlend.BlendOpAlpha = s_blendEquation[(equation >> 3) & 0x7];
+    }
+
+    // `BGFX_STATE_WRITE_*` color bits match `D3D12_COLOR_WRITE_ENABLE_*`. Without color writes
+    // there is nothing to shade, depth-only PSO runs without pixel shader, as does program without one.
+    const uint8_t writeMask = uint8_t(_state & (BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A));
+    psoDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = writeMask;
+    if (0 != writeMask && NULL != program->m_fsCode)
+    {
+        psoDesc.PS = {program->m_fsCode->GetBufferPointer(), program->m_fsCode->GetBufferSize()};
+    }
+
+    // Depth state is ignored when target has no depth buffer.
+    const uint32_t depthTest = uint32_t((_state & BGFX_STATE_DEPTH_TEST_MASK) >> BGFX_STATE_DEPTH_TEST_SHIFT);
+    const bool depthWrite = 0 != (_state & BGFX_STATE_WRITE_Z);
+    psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState.DepthEnable = DXGI_FORMAT_UNKNOWN != _dsvFormat && (0 != depthTest || depthWrite);
+    psoDesc.DepthStencilState.DepthWriteMask = depthWrite ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
+    psoDesc.DepthStencilState.DepthFunc = 0 != depthTest ? s_cmpFunc[depthTest] : D3D12_COMPARISON_FUNC_ALWAYS;
     psoDesc.DepthStencilState.StencilEnable = FALSE;
     psoDesc.SampleMask = UINT_MAX;
-    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    // Strips restart at all ones index, index size is part of variant state.
+    const uint32_t pt = uint32_t((_state & BGFX_STATE_PT_MASK) >> BGFX_STATE_PT_SHIFT);
+    psoDesc.PrimitiveTopologyType = s_primTopologyType[pt];
+    psoDesc.IBStripCutValue = !isStrip(_state)                  ? D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED
+                              : 0 != (_state & kStateIndex32) ? D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF
+                                                              : D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF;
     psoDesc.NumRenderTargets = 1;
-    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+    psoDesc.RTVFormats[0] = _rtvFormat;
+    psoDesc.DSVFormat = _dsvFormat;
     psoDesc.SampleDesc.Count = 1;
 
-    HRESULT hr = s_renderD3D12->m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso));
-    if (FAILED(hr)) {
-        char errorMsg[1024];
-        FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM, nullptr, hr, 0, errorMsg, sizeof(errorMsg), nullptr);
-        OutputDebugStringA("Failed to create graphics pipeline state: ");
-        OutputDebugStringA(errorMsg);
-        OutputDebugStringA("\n");
+    ID3D12PipelineState *pso = NULL;
+    _outSize = 0;
+    HRESULT hr = s_renderD3D12->m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+    if (SUCCEEDED(hr))
+    {
+        // Driver doesn't report PSO size, bytecode it was built from is a close enough estimate.
+        _outSize = uint32_t(psoDesc.VS.BytecodeLength + psoDesc.PS.BytecodeLength);
+        trackAlloc(MemoryCategory::PSO, _outSize);
+    }
+    else
+    {
+        BX_TRACE("WARNING: Graphics pipeline state can't be created (0x%08x).", uint32_t(hr));
     }
-    DX_CHECK(hr);
+
+    return pso;
+}
+
+} // namespace d3d12
+} // namespace TinyRender
+
+#else
+
+namespace TinyRender
+{
+namespace d3d12
+{
+
+RendererContextI *rendererCreate(const InitParams &_init)
+{
+    BX_UNUSED(_init);
+    return NULL;
+}
+
+void rendererDestroy()
+{
 }
 
 } // namespace d3d12
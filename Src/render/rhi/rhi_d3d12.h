@@ -50,17 +50,108 @@ extern "C++"
 #define DX_CHECK_REFCOUNT(_ptr, _expected)
 #endif // BGFX_CONFIG_DEBUG
 
+#include "descriptor_allocator.h"
 #include "rhi.h"
+#include "tlsf.h"
 
 namespace TinyRender
 {
 namespace d3d12
 {
 
+/// Parameters of root signature shared by all PSOs.
+struct RootParam
+{
+    enum Enum
+    {
+        Constants,       //!< `BGFX_CONFIG_MAX_ROOT_CONSTANTS` 32-bit values at `b0`, descriptor indices of draw.
+        DescriptorTable, //!< Whole CBV/SRV/UAV heap, SRVs at `t0, space0`, UAVs at `u0, space1`.
+        Model,           //!< 16 32-bit values at `b1`, model matrix of draw, identity when draw has none.
+
+        Count
+    };
+};
+
+/// Resources released once GPU is done with the frame that used them.
+struct ReleaseQueueD3D12
+{
+    ReleaseQueueD3D12() : m_ptr(NULL), m_num(0), m_max(0) {}
+
+    void push(ID3D12Resource *_ptr);
+
+    /// Release everything queued. Call only after GPU finished all submitted work.
+    void flush();
+
+    void destroy();
+
+    ID3D12Resource **m_ptr;
+    uint32_t m_num;
+    uint32_t m_max;
+};
+
+/// Sorted, disjoint byte ranges written since last upload. Ranges closer than `MergeGap` are
+/// merged, and when more than `MaxRanges` remain the two closest ones are merged, so a frame of
+/// small scattered updates still uploads with a handful of copies.
+struct DirtyRanges
+{
+    enum
+    {
+        MaxRanges = 8,
+        MergeGap = 1024,
+    };
+
+    DirtyRanges() : m_num(0) {}
+
+    void reset()
+    {
+        m_num = 0;
+    }
+
+    bool isEmpty() const
+    {
+        return 0 == m_num;
+    }
+
+    void add(uint32_t _begin, uint32_t _end);
+
+    uint32_t m_num;
+    uint32_t m_begin[MaxRanges + 1];
+    uint32_t m_end[MaxRanges + 1];
+};
+
+/// Static buffers are suballocated from large committed buffers (pages) instead of getting one
+/// committed resource each. All buffers in a page share its resource state.
+struct BufferPoolD3D12
+{
+    struct Page
+    {
+        ID3D12Resource *m_ptr;
+        D3D12_GPU_VIRTUAL_ADDRESS m_gpuVA;
+        D3D12_RESOURCE_STATES m_state;
+        TlsfAllocator m_tlsf;
+    };
+
+    BufferPoolD3D12() : m_numPages(0) {}
+
+    /// Returns page index, or `UINT16_MAX` when buffer is too big for pool or pool is full.
+    uint16_t alloc(uint32_t _size, TlsfAllocation &_allocation);
+
+    void free(uint16_t _page, TlsfAllocation _allocation);
+
+    void destroy();
+
+    /// Statistics of all pages combined.
+    void getStats(TlsfStats &_stats) const;
+
+    Page m_pages[BGFX_CONFIG_BUFFER_POOL_MAX_PAGES];
+    uint16_t m_numPages;
+};
+
 struct BufferD3D12
 {
     BufferD3D12()
-        : m_ptr(NULL), m_state(D3D12_RESOURCE_STATE_COMMON), m_size(0), m_flags(BGFX_BUFFER_NONE), m_dynamic(false)
+        : m_ptr(NULL), m_resizeSrc(NULL), m_shadow(NULL), m_state(D3D12_RESOURCE_STATE_COMMON), m_size(0),
+          m_stride(0), m_offset(0), m_page(UINT16_MAX), m_flags(BGFX_BUFFER_NONE), m_dynamic(false)
     {
     }
 
@@ -69,6 +160,15 @@ struct BufferD3D12
     void update(ID3D12GraphicsCommandList *_commandList, uint32_t _offset, uint32_t _size, const void *_data,
                 bool _discard = false);
 
+    /// Write into CPU shadow of dynamic buffer and mark range dirty. GPU copy happens in `flush`.
+    void updateDynamic(uint32_t _offset, uint32_t _size, const void *_data);
+
+    /// Record pending resize copy and dirty range uploads. No-op when buffer is clean.
+    void flush(ID3D12GraphicsCommandList *_commandList);
+
+    /// Grow dynamic buffer to at least `_size` bytes. Old GPU buffer is kept until next `flush`.
+    void resize(uint32_t _size);
+
     void destroy();
 
     D3D12_RESOURCE_STATES setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state);
@@ -77,8 +177,18 @@ struct BufferD3D12
     D3D12_UNORDERED_ACCESS_VIEW_DESC m_uavd;
     ID3D12Resource *m_ptr;
     D3D12_GPU_VIRTUAL_ADDRESS m_gpuVA;
+    ID3D12Resource *m_resizeSrc;              //!< Buffer before resize, its contents are copied on GPU in `flush`.
+    D3D12_RESOURCE_STATES m_resizeSrcState;
+    uint32_t m_resizeSrcSize;
+    uint8_t *m_shadow;                        //!< CPU copy of dynamic buffer contents.
+    DirtyRanges m_dirty;
     D3D12_RESOURCE_STATES m_state;
     uint32_t m_size;
+    uint32_t m_stride;
+    uint32_t m_offset;           //!< Offset inside `m_ptr`, non-zero only for pooled buffers.
+    TlsfAllocation m_allocation; //!< Pool allocation, valid when `m_page` is not `UINT16_MAX`.
+    uint16_t m_page;             //!< Pool page, `UINT16_MAX` when buffer is committed resource.
+    MemoryCategory::Enum m_category;
     uint16_t m_flags;
     bool m_dynamic;
 };
@@ -90,11 +200,34 @@ struct VertexBufferD3D12 : public BufferD3D12
     VertexLayoutHandle m_layoutHandle;
 };
 
+/// Upload heap buffer split into one region per frame in flight. Persistently mapped, CPU writes
+/// straight into it and GPU reads from it, no staging copy.
+struct TransientBufferD3D12
+{
+    TransientBufferD3D12() : m_ptr(NULL), m_data(NULL), m_size(0), m_numFrames(0) {}
+
+    void create(uint32_t _size, uint32_t _numFrames);
+
+    void destroy();
+
+    D3D12_GPU_VIRTUAL_ADDRESS getGpuVA(uint32_t _frame, uint32_t _offset) const
+    {
+        return m_gpuVA + _frame * m_size + _offset;
+    }
+
+    ID3D12Resource *m_ptr;
+    D3D12_GPU_VIRTUAL_ADDRESS m_gpuVA;
+    uint8_t *m_data;
+    uint32_t m_size; //!< Size of one frame region.
+    uint32_t m_numFrames;
+};
+
 struct ShaderD3D12
 {
-    ShaderD3D12() : m_code(NULL), m_size(0) {}
+    ShaderD3D12() : m_code(NULL), m_size(0), m_shader(NULL) {}
 
-    void create(const void* _data, uint32_t _size, ShaderType _type);
+    /// Compiles HLSL source, DXBC bytecode is used as it is. Returns `false` when source doesn't compile.
+    bool create(const void *_data, uint32_t _size, ShaderType _type);
 
     void destroy()
     {
@@ -103,6 +236,13 @@ struct ShaderD3D12
             m_code = NULL;
             m_size = 0;
         }
+
+        if (NULL != m_shader)
+        {
+            trackFree(MemoryCategory::Shader, m_shader->GetBufferSize());
+            m_shader->Release();
+            m_shader = NULL;
+        }
     }
 
     const void *m_code;
@@ -113,34 +253,145 @@ struct ShaderD3D12
     
 };
 
+/// Program keeps its own reference to shader bytecode. Shaders can be destroyed right after program
+/// is created, PSO variants are still compiled from it on first use.
 struct ProgramD3D12
 {
-    ProgramD3D12() : m_vsh(NULL), m_fsh(NULL) {}
+    ProgramD3D12() : m_vsCode(NULL), m_fsCode(NULL) {}
 
     void create(const ShaderD3D12 *_vsh, const ShaderD3D12 *_fsh);
 
     void destroy()
     {
-        m_vsh = NULL;
-        m_fsh = NULL;
+        if (NULL != m_vsCode)
+        {
+            m_vsCode->Release();
+            m_vsCode = NULL;
+        }
+
+        if (NULL != m_fsCode)
+        {
+            m_fsCode->Release();
+            m_fsCode = NULL;
+        }
     }
 
-    const ShaderD3D12 *m_vsh;
-    const ShaderD3D12 *m_fsh;
+    ID3DBlob *m_vsCode;
+    ID3DBlob *m_fsCode; //!< NULL for program without fragment shader.
 };
 
+/// PSO bakes in render target formats and render state. `m_pso` is compiled for backbuffer and
+/// state PSO was created with, variants for other frame buffer formats and draw states are compiled
+/// on first use.
 struct PSOD3D12
 {
-    PSOD3D12() : m_pso(NULL) {}
+    /// `BGFX_STATE_*` bits baked into PSO.
+    static const uint64_t kStateMask = BGFX_STATE_WRITE_MASK | BGFX_STATE_DEPTH_TEST_MASK | BGFX_STATE_BLEND_MASK |
+                                       BGFX_STATE_BLEND_EQUATION_MASK | BGFX_STATE_CULL_MASK | BGFX_STATE_FRONT_CCW |
+                                       BGFX_STATE_BLEND_ALPHA_TO_COVERAGE | BGFX_STATE_MSAA | BGFX_STATE_PT_MASK;
 
-    void create(const ProgramD3D12 *_program, const VertexLayout *_layout, uint16_t _flags);
-    void destroy()
+    /// Internal state bit, strip PSO restarts at 32-bit index cut value.
+    static const uint64_t kStateIndex32 = UINT64_C(1) << BGFX_STATE_RESERVED_SHIFT;
+
+    struct Variant
     {
-        m_pso = NULL;
-    }
+        DXGI_FORMAT m_rtvFormat;
+        DXGI_FORMAT m_dsvFormat;
+        uint64_t m_state;
+        ID3D12PipelineState *m_pso; //!< NULL when compile failed, kept so it isn't retried every draw.
+        uint32_t m_size;            //!< Size tracked for `m_pso`.
+    };
+
+    PSOD3D12() : m_pso(NULL), m_program(NULL), m_variants(NULL), m_numVariants(0), m_size(0) {}
+
+    void create(const ProgramD3D12 *_program, const VertexLayout *_layout, uint64_t _flags);
+
+    /// Returns PSO matching render target formats and state, NULL when it fails to compile.
+    ID3D12PipelineState *get(DXGI_FORMAT _rtvFormat, DXGI_FORMAT _dsvFormat, uint64_t _state);
+
+    void destroy();
+
+    /// `_outSize` is estimated size tracked in `MemoryCategory::PSO`, 0 when compile fails.
+    ID3D12PipelineState *compile(DXGI_FORMAT _rtvFormat, DXGI_FORMAT _dsvFormat, uint64_t _state, uint32_t &_outSize);
 
     ID3D12PipelineState *m_pso;
-    
+    const ProgramD3D12 *m_program;
+    VertexLayout m_layout;
+    uint64_t m_flags; //!< State `m_pso` is compiled with.
+    Variant *m_variants;
+    uint16_t m_numVariants;
+    uint32_t m_size; //!< Size tracked for `m_pso`, variants track their own, depth-only ones have no PS.
+};
+
+/// Sampled texture with SRV in bindless heap. Uploads are recorded into frame command list, all
+/// subresources of texture share one upload allocation.
+struct TextureD3D12
+{
+    enum
+    {
+        MaxSubresources = 6 * 16, //!< Cube map sides times mips of 65535 pixels texture.
+    };
+
+    TextureD3D12() : m_ptr(NULL), m_state(D3D12_RESOURCE_STATE_COMMON) {}
+
+    void create(const TextureInfo &_info, const void *_data);
+
+    /// Texture goes through release queue and its descriptor is freed with frame, GPU may still
+    /// sample it.
+    void destroy();
+
+    void update(ID3D12GraphicsCommandList *_commandList, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y,
+                uint16_t _width, uint16_t _height, const void *_data, uint32_t _pitch);
+
+    D3D12_RESOURCE_STATES setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state);
+
+    ID3D12Resource *m_ptr;
+    D3D12_RESOURCE_STATES m_state;
+    TlsfAllocation m_srv; //!< Descriptor in shader visible heap, shaders index heap with `m_srv.m_offset`.
+    TextureInfo m_info;
+};
+
+/// Offscreen render target, color texture with optional depth texture.
+struct FrameBufferD3D12
+{
+    FrameBufferD3D12() : m_texture(NULL), m_depth(NULL), m_state(D3D12_RESOURCE_STATE_COMMON), m_size(0) {}
+
+    void create(uint16_t _width, uint16_t _height, TextureFormat::Enum _format, TextureFormat::Enum _depthFormat,
+                D3D12_CPU_DESCRIPTOR_HANDLE _rtv, D3D12_CPU_DESCRIPTOR_HANDLE _dsv);
+
+    /// Textures go through release queue, GPU may still be rendering into them.
+    void destroy();
+
+    D3D12_RESOURCE_STATES setState(ID3D12GraphicsCommandList *_commandList, D3D12_RESOURCE_STATES _state);
+
+    ID3D12Resource *m_texture;
+    ID3D12Resource *m_depth;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_rtv;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_dsv;
+    D3D12_RESOURCE_STATES m_state; //!< Color texture state, depth stays in depth write.
+    uint32_t m_size;               //!< Estimated size for memory accounting.
+    uint16_t m_width;
+    uint16_t m_height;
+    TextureFormat::Enum m_format;
+    TextureFormat::Enum m_depthFormat;
+};
+
+/// Copy of render target into readback heap buffer. Done when frame fence reaches `m_fence`,
+/// callback is called from `endFrame` after that. Buffer is kept for next readback that fits.
+struct ReadbackD3D12
+{
+    ReadbackD3D12() : m_buffer(NULL), m_capacity(0), m_fn(NULL) {}
+
+    ID3D12Resource *m_buffer;
+    uint64_t m_capacity;
+    uint64_t m_fence;
+    ReadbackFn m_fn; //!< NULL when slot is free.
+    void *m_userData;
+    FrameBufferHandle m_handle;
+    uint32_t m_pitch;
+    uint16_t m_width;
+    uint16_t m_height;
+    TextureFormat::Enum m_format;
 };
 
 } // namespace d3d12
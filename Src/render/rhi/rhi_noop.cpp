@@ -0,0 +1,541 @@
+#include "tiny_render_p.h"
+
+#if BGFX_CONFIG_RENDERER_NOOP
+
+namespace TinyRender
+{
+namespace noop
+{
+
+/// Binding slot value used for transient vertex and index buffers.
+static const uint16_t kTransient = UINT16_MAX - 1;
+
+/// Buffer bookkeeping, no memory is allocated for contents. Size is tracked in memory stats so
+/// frontend memory numbers look the same as with a real backend.
+struct BufferNoop
+{
+    void create(MemoryCategory::Enum _category, uint32_t _size, VertexLayoutHandle _layoutHandle, uint16_t _flags)
+    {
+        m_size = _size;
+        m_flags = _flags;
+        m_layoutHandle = _layoutHandle;
+        m_category = _category;
+        m_valid = true;
+        trackAlloc(m_category, m_size);
+    }
+
+    void destroy()
+    {
+        if (m_valid)
+        {
+            trackFree(m_category, m_size);
+            m_valid = false;
+        }
+    }
+
+    void update(uint32_t _offset, uint32_t _size)
+    {
+        const uint32_t end = _offset + _size;
+        if (end > m_size)
+        {
+            BX_ASSERT(0 != (m_flags & BGFX_BUFFER_ALLOW_RESIZE), "Update out of buffer bounds.");
+            trackAlloc(m_category, end - m_size, 0);
+            m_size = end;
+        }
+    }
+
+    uint32_t m_size;
+    uint16_t m_flags;
+    VertexLayoutHandle m_layoutHandle;
+    MemoryCategory::Enum m_category;
+    bool m_valid;
+};
+
+struct FrameBufferNoop
+{
+    uint32_t getSize() const
+    {
+        const uint32_t depthBpp = TextureFormat::Count != m_depthFormat ? getBitsPerPixel(m_depthFormat) : 0;
+        return uint32_t(m_width) * m_height * (getBitsPerPixel(m_format) + depthBpp) / 8;
+    }
+
+    uint16_t m_width;
+    uint16_t m_height;
+    TextureFormat::Enum m_format;
+    TextureFormat::Enum m_depthFormat;
+    bool m_valid;
+};
+
+/// Texture bookkeeping. Upload sizes are computed the same way D3D12 backend copies data, so size
+/// and layout bugs show up without GPU.
+struct TextureNoop
+{
+    TextureInfo m_info;
+    bool m_valid;
+};
+
+/// Readback waiting for `endFrame`, completes with zeroed pixels.
+struct ReadbackNoop
+{
+    ReadbackFn m_fn; //!< NULL when slot is free.
+    void *m_userData;
+    FrameBufferHandle m_handle;
+    uint16_t m_width;
+    uint16_t m_height;
+    TextureFormat::Enum m_format;
+};
+
+struct RendererContextNoop : public RendererContextI
+{
+    void init(const InitParams &_init)
+    {
+        m_width = uint16_t(_init.width);
+        m_height = uint16_t(_init.height);
+
+        // Transient data is written by user, it needs real memory. One frame is enough, nothing
+        // reads it after `endFrame`.
+        bx::AllocatorI *allocator = getAllocator(MemoryCategory::UploadRing);
+        m_transientVb = (uint8_t *)bx::alloc(allocator, BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE);
+        m_transientIb = (uint8_t *)bx::alloc(allocator, BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
+
+        m_frameStats.reset();
+        invalidateBindings();
+    }
+
+    void shutdown()
+    {
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_vertexBuffers); ++ii)
+        {
+            m_vertexBuffers[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_indexBuffers); ++ii)
+        {
+            m_indexBuffers[ii].destroy();
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_shaders); ++ii)
+        {
+            if (0 != m_shaders[ii])
+            {
+                trackFree(MemoryCategory::Shader, m_shaders[ii]);
+            }
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_frameBuffers); ++ii)
+        {
+            if (m_frameBuffers[ii].m_valid)
+            {
+                trackFree(MemoryCategory::Texture, m_frameBuffers[ii].getSize());
+            }
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_textures); ++ii)
+        {
+            if (m_textures[ii].m_valid)
+            {
+                trackFree(MemoryCategory::Texture, m_textures[ii].m_info.storageSize);
+            }
+        }
+
+        // Same as a real backend, readbacks in flight complete before shutdown.
+        flushReadbacks();
+
+        bx::AllocatorI *allocator = getAllocator(MemoryCategory::UploadRing);
+        bx::free(allocator, m_transientVb);
+        bx::free(allocator, m_transientIb);
+    }
+
+    RendererType::Enum getRendererType() const
+    {
+        return RendererType::Noop;
+    }
+
+    void createIndexBuffer(IndexBufferHandle _handle, const void *_data, uint32_t _size, uint16_t _flags)
+    {
+        m_indexBuffers[_handle.idx].create(MemoryCategory::IndexBuffer, _size, BGFX_INVALID_HANDLE, _flags);
+        if (NULL != _data)
+        {
+            m_frameStats.uploadedBytes += _size;
+        }
+    }
+
+    void destroyIndexBuffer(IndexBufferHandle _handle)
+    {
+        BX_ASSERT(m_indexBuffers[_handle.idx].m_valid, "Destroying invalid index buffer %d.", _handle.idx);
+        m_indexBuffers[_handle.idx].destroy();
+    }
+
+    void createVertexLayout(VertexLayoutHandle _handle, const VertexLayout &_layout)
+    {
+        bx::memCopy(&m_vertexLayouts[_handle.idx], &_layout, sizeof(VertexLayout));
+    }
+
+    void destroyVertexLayout(VertexLayoutHandle _handle)
+    {
+        BX_UNUSED(_handle);
+    }
+
+    void createVertexBuffer(VertexBufferHandle _handle, const void *_data, uint32_t _size,
+                            VertexLayoutHandle _layoutHandle, uint16_t _flags)
+    {
+        m_vertexBuffers[_handle.idx].create(MemoryCategory::VertexBuffer, _size, _layoutHandle, _flags);
+        if (NULL != _data)
+        {
+            m_frameStats.uploadedBytes += _size;
+        }
+    }
+
+    void destroyVertexBuffer(VertexBufferHandle _handle)
+    {
+        BX_ASSERT(m_vertexBuffers[_handle.idx].m_valid, "Destroying invalid vertex buffer %d.", _handle.idx);
+        m_vertexBuffers[_handle.idx].destroy();
+    }
+
+    void updateVertexBuffer(VertexBufferHandle _handle, uint32_t _offset, uint32_t _size, const void *_data)
+    {
+        BX_UNUSED(_data);
+        m_vertexBuffers[_handle.idx].update(_offset, _size);
+        m_frameStats.uploadedBytes += _size;
+    }
+
+    void updateIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, const void *_data)
+    {
+        BX_UNUSED(_data);
+        m_indexBuffers[_handle.idx].update(_offset, _size);
+        m_frameStats.uploadedBytes += _size;
+    }
+
+    bool createShader(ShaderHandle _handle, const void *_data, uint32_t _size, ShaderType _type)
+    {
+        BX_UNUSED(_data, _type);
+        m_shaders[_handle.idx] = _size;
+        trackAlloc(MemoryCategory::Shader, _size);
+        return true;
+    }
+
+    void destroyShader(ShaderHandle _handle)
+    {
+        trackFree(MemoryCategory::Shader, m_shaders[_handle.idx]);
+        m_shaders[_handle.idx] = 0;
+    }
+
+    /// Nothing to compile, source is its own bytecode.
+    uint8_t *compileShader(const void *_data, uint32_t _size, ShaderType _type, uint32_t &_outSize)
+    {
+        BX_UNUSED(_type);
+        uint8_t *code = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Staging), _size);
+        bx::memCopy(code, _data, _size);
+        _outSize = _size;
+        return code;
+    }
+
+    void createProgram(ProgramHandle _handle, ShaderHandle _vsh, ShaderHandle _fsh)
+    {
+        BX_UNUSED(_handle, _vsh, _fsh);
+    }
+
+    void createPSO(PSOHandle _handle, ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags)
+    {
+        BX_UNUSED(_program, _layout, _flags);
+        m_psos[_handle.idx] = true;
+    }
+
+    void beginView(const View &_view)
+    {
+        BX_UNUSED(_view);
+    }
+
+    void endFrame(FrameStats &_stats)
+    {
+        flushReadbacks();
+        invalidateBindings();
+
+        _stats = m_frameStats;
+        m_frameStats.reset();
+    }
+
+    void createTexture(TextureHandle _handle, const TextureInfo &_info, const void *_data)
+    {
+        TextureNoop &texture = m_textures[_handle.idx];
+        BX_ASSERT(!texture.m_valid, "Creating texture %d twice.", _handle.idx);
+        texture.m_info = _info;
+        texture.m_valid = true;
+        trackAlloc(MemoryCategory::Texture, _info.storageSize);
+
+        if (NULL != _data)
+        {
+            // Walk subresources like a copy would, layout must add up to storage size.
+            const uint8_t numSides = _info.cubeMap ? 6 : 1;
+            uint32_t size = 0;
+            for (uint8_t side = 0; side < numSides; ++side)
+            {
+                for (uint8_t mip = 0; mip < _info.numMips; ++mip)
+                {
+                    const uint16_t width = bx::max<uint16_t>(1, _info.width >> mip);
+                    const uint16_t height = bx::max<uint16_t>(1, _info.height >> mip);
+                    size += calcPitch(_info.format, width) * calcNumRows(_info.format, height);
+                }
+            }
+            BX_ASSERT(size == _info.storageSize, "Texture layout size %d doesn't match storage size %d.", size,
+                      _info.storageSize);
+
+            m_frameStats.uploadedBytes += size;
+        }
+    }
+
+    void updateTexture(TextureHandle _handle, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y,
+                       uint16_t _width, uint16_t _height, const void *_data, uint32_t _pitch)
+    {
+        BX_UNUSED(_data, _side, _x, _y, _pitch);
+
+        const TextureNoop &texture = m_textures[_handle.idx];
+        BX_ASSERT(texture.m_valid, "Updating invalid texture %d.", _handle.idx);
+        BX_ASSERT(_side < (texture.m_info.cubeMap ? 6 : 1) && _mip < texture.m_info.numMips, "Invalid side %d mip %d.",
+                  _side, _mip);
+        BX_ASSERT(_x + _width <= bx::max(1, texture.m_info.width >> _mip) &&
+                      _y + _height <= bx::max(1, texture.m_info.height >> _mip),
+                  "Texture update out of bounds.");
+
+        const uint32_t rowSize = calcPitch(texture.m_info.format, _width);
+        BX_ASSERT(_pitch >= rowSize, "Pitch %d is smaller than row %d.", _pitch, rowSize);
+
+        m_frameStats.uploadedBytes += rowSize * calcNumRows(texture.m_info.format, _height);
+    }
+
+    void destroyTexture(TextureHandle _handle)
+    {
+        TextureNoop &texture = m_textures[_handle.idx];
+        BX_ASSERT(texture.m_valid, "Destroying invalid texture %d.", _handle.idx);
+        if (texture.m_valid)
+        {
+            trackFree(MemoryCategory::Texture, texture.m_info.storageSize);
+            texture.m_valid = false;
+        }
+    }
+
+    void createFrameBuffer(FrameBufferHandle _handle, uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                           TextureFormat::Enum _depthFormat)
+    {
+        FrameBufferNoop &fb = m_frameBuffers[_handle.idx];
+        fb.m_width = _width;
+        fb.m_height = _height;
+        fb.m_format = _format;
+        fb.m_depthFormat = _depthFormat;
+        fb.m_valid = true;
+        trackAlloc(MemoryCategory::Texture, fb.getSize());
+    }
+
+    void destroyFrameBuffer(FrameBufferHandle _handle)
+    {
+        FrameBufferNoop &fb = m_frameBuffers[_handle.idx];
+        BX_ASSERT(fb.m_valid, "Destroying invalid frame buffer %d.", _handle.idx);
+        if (fb.m_valid)
+        {
+            trackFree(MemoryCategory::Texture, fb.getSize());
+            fb.m_valid = false;
+        }
+    }
+
+    bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData)
+    {
+        if (isValid(_handle) && !m_frameBuffers[_handle.idx].m_valid)
+        {
+            BX_TRACE("Reading invalid frame buffer %d.", _handle.idx);
+            return false;
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_readbacks); ++ii)
+        {
+            ReadbackNoop &readback = m_readbacks[ii];
+            if (NULL == readback.m_fn)
+            {
+                const FrameBufferNoop *fb = isValid(_handle) ? &m_frameBuffers[_handle.idx] : NULL;
+                readback.m_fn = _fn;
+                readback.m_userData = _userData;
+                readback.m_handle = _handle;
+                readback.m_width = NULL != fb ? fb->m_width : m_width;
+                readback.m_height = NULL != fb ? fb->m_height : m_height;
+                readback.m_format = NULL != fb ? fb->m_format : TextureFormat::RGBA8;
+                return true;
+            }
+        }
+
+        BX_TRACE("Too many readbacks in flight (BGFX_CONFIG_MAX_READBACKS, max: %d).", BGFX_CONFIG_MAX_READBACKS);
+        return false;
+    }
+
+    void flushReadbacks()
+    {
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_readbacks); ++ii)
+        {
+            ReadbackNoop &readback = m_readbacks[ii];
+            if (NULL != readback.m_fn)
+            {
+                const uint32_t pitch = uint32_t(readback.m_width) * getBitsPerPixel(readback.m_format) / 8;
+                const uint32_t size = pitch * readback.m_height;
+
+                bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+                void *data = bx::alloc(allocator, size);
+                bx::memSet(data, 0, size);
+
+                const ReadbackFn fn = readback.m_fn;
+                readback.m_fn = NULL;
+                fn(readback.m_handle, data, pitch, readback.m_width, readback.m_height, readback.m_format,
+                   readback.m_userData);
+
+                bx::free(allocator, data);
+            }
+        }
+    }
+
+    void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex, uint32_t _numIndices,
+                  ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        BX_UNUSED(_program, _mtx);
+
+        const bool indexed = isValid(_ibh);
+        if (!isValid(_vbh) || !isValid(_pso) || !m_vertexBuffers[_vbh.idx].m_valid ||
+            (indexed && !m_indexBuffers[_ibh.idx].m_valid) || !m_psos[_pso.idx])
+        {
+            BX_TRACE("Draw with invalid handle, vb %d, ib %d, pso %d.", _vbh.idx, _ibh.idx, _pso.idx);
+            return;
+        }
+
+        const BufferNoop &vb = m_vertexBuffers[_vbh.idx];
+
+        // Non-indexed draw keeps index buffer bound, same as D3D12 backend.
+        bind(_vbh.idx, indexed ? _ibh.idx : m_bindIb, _pso.idx);
+
+        uint32_t count;
+        if (indexed)
+        {
+            const BufferNoop &ib = m_indexBuffers[_ibh.idx];
+            const uint32_t indexSize = 0 != (ib.m_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
+            count = ib.m_size / indexSize;
+        }
+        else
+        {
+            count = vb.m_size / m_vertexLayouts[vb.m_layoutHandle.idx].getStride();
+        }
+        const uint32_t numIndices = bx::uint32_min(_numIndices, bx::uint32_satsub(count, _firstIndex));
+
+        ++m_frameStats.numDraw;
+        m_frameStats.numPrims += getNumPrims(_state, numIndices);
+    }
+
+    void drawTransient(const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib, ProgramHandle _program,
+                       PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        BX_UNUSED(_program, _mtx);
+
+        if (!isValid(_pso) || !m_psos[_pso.idx])
+        {
+            BX_TRACE("Draw with invalid pso %d.", _pso.idx);
+            return;
+        }
+
+        // Every transient draw binds a view at its own offset, same as D3D12 backend.
+        m_bindVb = kInvalidHandle;
+        if (NULL != _tib)
+        {
+            m_bindIb = kInvalidHandle;
+        }
+        bind(kTransient, NULL != _tib ? kTransient : m_bindIb, _pso.idx);
+
+        const uint32_t numVertices = _tvb->size / _tvb->stride;
+        const uint32_t numIndices = NULL != _tib ? _tib->size / (_tib->isIndex16 ? 2 : 4) : numVertices;
+
+        ++m_frameStats.numDraw;
+        m_frameStats.numPrims += getNumPrims(_state, numIndices);
+    }
+
+    void resetTransientBuffers(TransientBuffer &_vb, TransientBuffer &_ib)
+    {
+        _vb.data = m_transientVb;
+        _vb.size = BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE;
+        _vb.offset = 0;
+
+        _ib.data = m_transientIb;
+        _ib.size = BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE;
+        _ib.offset = 0;
+    }
+
+    void invalidateBindings()
+    {
+        m_bindVb = kInvalidHandle;
+        m_bindIb = kInvalidHandle;
+        m_bindPso = kInvalidHandle;
+    }
+
+    /// Count state changes the way D3D12 backend does after redundant bind filtering.
+    void bind(uint16_t _vb, uint16_t _ib, uint16_t _pso)
+    {
+        if (_vb != m_bindVb)
+        {
+            m_bindVb = _vb;
+            ++m_frameStats.numVertexBufferBinds;
+        }
+
+        if (_ib != m_bindIb)
+        {
+            m_bindIb = _ib;
+            ++m_frameStats.numIndexBufferBinds;
+        }
+
+        if (_pso != m_bindPso)
+        {
+            if (kInvalidHandle == m_bindPso)
+            {
+                ++m_frameStats.numRootSignatureBinds;
+            }
+
+            m_bindPso = _pso;
+            ++m_frameStats.numPsoBinds;
+        }
+    }
+
+    BufferNoop m_vertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+    BufferNoop m_indexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
+    VertexLayout m_vertexLayouts[BGFX_CONFIG_MAX_VERTEX_LAYOUTS];
+    uint32_t m_shaders[BGFX_CONFIG_MAX_SHADERS]; //!< Bytecode size, 0 when not created.
+    bool m_psos[BGFX_CONFIG_MAX_PSOS];
+    FrameBufferNoop m_frameBuffers[BGFX_CONFIG_MAX_FRAME_BUFFERS];
+    TextureNoop m_textures[BGFX_CONFIG_MAX_TEXTURES];
+    ReadbackNoop m_readbacks[BGFX_CONFIG_MAX_READBACKS];
+
+    uint16_t m_width;  //!< Backbuffer size.
+    uint16_t m_height;
+
+    uint8_t *m_transientVb;
+    uint8_t *m_transientIb;
+
+    uint16_t m_bindVb;
+    uint16_t m_bindIb;
+    uint16_t m_bindPso;
+
+    FrameStats m_frameStats;
+};
+
+static RendererContextNoop *s_renderNoop;
+
+RendererContextI *rendererCreate(const InitParams &_init)
+{
+    BX_ASSERT(NULL == s_renderNoop, "Renderer already initialized");
+
+    s_renderNoop = BX_NEW(getAllocator(MemoryCategory::Command), RendererContextNoop)();
+    s_renderNoop->init(_init);
+    return s_renderNoop;
+}
+
+void rendererDestroy()
+{
+    s_renderNoop->shutdown();
+    bx::deleteObject(getAllocator(MemoryCategory::Command), s_renderNoop);
+    s_renderNoop = NULL;
+}
+
+} // namespace noop
+} // namespace TinyRender
+
+#endif // BGFX_CONFIG_RENDERER_NOOP
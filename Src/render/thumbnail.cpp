@@ -0,0 +1,247 @@
+#include <bx/file.h>
+
+#include "entry.h"
+#include "thumbnail.h"
+#include "tiny_render_p.h"
+
+namespace TinyRender
+{
+
+static const uint32_t kTgaHeaderSize = 18;
+
+/// Worst case is every row made of raw packets, 128 pixels each.
+static uint32_t tgaMaxSize(uint16_t _width, uint16_t _height)
+{
+    return kTgaHeaderSize + _height * (_width * 4 + (_width + 127) / 128);
+}
+
+static uint32_t loadPixel(const uint8_t *_src, bool _swizzle)
+{
+    uint32_t pixel;
+    bx::memCopy(&pixel, _src, 4);
+
+    // TGA stores BGRA.
+    return _swizzle ? (pixel & 0xff00ff00) | ((pixel & 0xff) << 16) | ((pixel >> 16) & 0xff) : pixel;
+}
+
+/// Encode 32bpp image as RLE compressed, top-left origin TGA. Packets don't cross rows.
+static uint32_t encodeTga(uint8_t *_dst, const uint8_t *_src, uint32_t _pitch, uint16_t _width, uint16_t _height,
+                          bool _swizzle)
+{
+    uint8_t *dst = _dst;
+
+    bx::memSet(dst, 0, kTgaHeaderSize);
+    dst[2] = 10; // RLE true color
+    dst[12] = uint8_t(_width);
+    dst[13] = uint8_t(_width >> 8);
+    dst[14] = uint8_t(_height);
+    dst[15] = uint8_t(_height >> 8);
+    dst[16] = 32;
+    dst[17] = 0x28; // Top-left origin, 8 alpha bits.
+    dst += kTgaHeaderSize;
+
+    for (uint32_t yy = 0; yy < _height; ++yy)
+    {
+        const uint8_t *row = _src + yy * _pitch;
+
+        uint32_t xx = 0;
+        while (xx < _width)
+        {
+            const uint32_t pixel = loadPixel(&row[xx * 4], _swizzle);
+
+            uint32_t run = 1;
+            while (xx + run < _width && run < 128 && pixel == loadPixel(&row[(xx + run) * 4], _swizzle))
+            {
+                ++run;
+            }
+
+            if (run > 1)
+            {
+                *dst++ = uint8_t(0x80 | (run - 1));
+                bx::memCopy(dst, &pixel, 4);
+                dst += 4;
+                xx += run;
+                continue;
+            }
+
+            // Raw packet ends where next run starts.
+            uint32_t raw = 1;
+            while (xx + raw < _width && raw < 128 &&
+                   !(xx + raw + 1 < _width &&
+                     loadPixel(&row[(xx + raw) * 4], _swizzle) == loadPixel(&row[(xx + raw + 1) * 4], _swizzle)))
+            {
+                ++raw;
+            }
+
+            *dst++ = uint8_t(raw - 1);
+            for (uint32_t ii = 0; ii < raw; ++ii)
+            {
+                const uint32_t rawPixel = loadPixel(&row[(xx + ii) * 4], _swizzle);
+                bx::memCopy(dst, &rawPixel, 4);
+                dst += 4;
+            }
+            xx += raw;
+        }
+    }
+
+    return uint32_t(dst - _dst);
+}
+
+ThumbnailBatch::ThumbnailBatch()
+    : m_encoded(NULL), m_encodedSize(0), m_numPending(0), m_numWritten(0), m_numBytes(0), m_width(0), m_height(0),
+      m_numTargets(0), m_format(TextureFormat::BGRA8)
+{
+    bx::memSet(m_pending, 0, sizeof(m_pending));
+}
+
+ThumbnailBatch::~ThumbnailBatch()
+{
+    destroy();
+}
+
+bool ThumbnailBatch::create(uint16_t _width, uint16_t _height, uint16_t _numTargets, TextureFormat::Enum _format)
+{
+    BX_ASSERT(0 == m_numTargets, "Thumbnail batch already created.");
+    BX_ASSERT(TextureFormat::RGBA8 == _format || TextureFormat::BGRA8 == _format,
+              "Thumbnails must be RGBA8 or BGRA8.");
+
+    m_width = _width;
+    m_height = _height;
+    m_format = _format;
+
+    const uint16_t maxTargets = uint16_t(bx::min(BGFX_CONFIG_MAX_VIEWS, BGFX_CONFIG_MAX_READBACKS / 2));
+    const uint16_t numTargets = bx::clamp<uint16_t>(_numTargets, 1, maxTargets);
+
+    for (uint16_t ii = 0; ii < numTargets; ++ii)
+    {
+        m_fbh[ii] = createFrameBuffer(_width, _height, _format, TextureFormat::D32F);
+        if (!isValid(m_fbh[ii]))
+        {
+            break;
+        }
+
+        setViewFrameBuffer(ViewId(ii), m_fbh[ii]);
+        setViewRect(ViewId(ii), 0, 0, _width, _height);
+        setViewClear(ViewId(ii), BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x003366ff, 1.0f, 0);
+        ++m_numTargets;
+    }
+
+    m_encodedSize = tgaMaxSize(_width, _height);
+    m_encoded = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Command), m_encodedSize);
+
+    return 0 != m_numTargets;
+}
+
+void ThumbnailBatch::destroy()
+{
+    for (uint16_t ii = 0; ii < m_numTargets; ++ii)
+    {
+        TinyRender::destroy(m_fbh[ii]);
+    }
+    m_numTargets = 0;
+
+    if (NULL != m_encoded)
+    {
+        bx::free(getAllocator(MemoryCategory::Command), m_encoded);
+        m_encoded = NULL;
+    }
+}
+
+uint32_t ThumbnailBatch::render(const ThumbnailJob *_jobs, uint32_t _num)
+{
+    BX_ASSERT(0 != m_numTargets, "Thumbnail batch is not created.");
+
+    m_numWritten = 0;
+    m_numBytes = 0;
+
+    // One frame renders one job into every target, each target is its own view. Frames are
+    // pipelined, readbacks of a frame complete while next one is recorded. Targets are reused
+    // right away, GPU executes copy of previous frame before rendering over it.
+    uint32_t pos = 0;
+    for (uint32_t first = 0; first < _num; first += m_numTargets)
+    {
+        const uint32_t num = bx::min<uint32_t>(m_numTargets, _num - first);
+
+        // Readbacks complete in submission order, at most two frames after they were issued.
+        while (m_numPending + num > BGFX_CONFIG_MAX_READBACKS)
+        {
+            endFrame();
+        }
+
+        for (uint32_t ii = 0; ii < num; ++ii)
+        {
+            const ThumbnailJob &job = _jobs[first + ii];
+            const ViewId view = ViewId(ii);
+
+            setViewTransform(view, job.m_view, job.m_proj);
+            drawMesh(view, job.m_vbh, job.m_ibh, job.m_program, job.m_state);
+
+            while (NULL != m_pending[pos].m_job)
+            {
+                pos = (pos + 1) % BGFX_CONFIG_MAX_READBACKS;
+            }
+
+            Pending &pending = m_pending[pos];
+            pending.m_batch = this;
+            pending.m_job = &job;
+            if (readFrameBuffer(m_fbh[ii], readbackCallback, &pending))
+            {
+                ++m_numPending;
+            }
+            else
+            {
+                pending.m_job = NULL;
+            }
+        }
+
+        endFrame();
+    }
+
+    while (0 != m_numPending)
+    {
+        endFrame();
+    }
+
+    return m_numWritten;
+}
+
+void ThumbnailBatch::readbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                      uint16_t _height, TextureFormat::Enum _format, void *_userData)
+{
+    BX_UNUSED(_handle, _width, _height);
+
+    Pending *pending = (Pending *)_userData;
+    ThumbnailBatch *batch = pending->m_batch;
+
+    if (NULL != _data)
+    {
+        batch->write(*pending->m_job, _data, _pitch, _format);
+    }
+
+    pending->m_job = NULL;
+    --batch->m_numPending;
+}
+
+void ThumbnailBatch::write(const ThumbnailJob &_job, const void *_data, uint32_t _pitch, TextureFormat::Enum _format)
+{
+    const uint32_t size = encodeTga(m_encoded, (const uint8_t *)_data, _pitch, m_width, m_height,
+                                    TextureFormat::RGBA8 == _format);
+
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _job.m_filePath))
+    {
+        return;
+    }
+
+    bx::Error err;
+    bx::write(writer, m_encoded, int32_t(size), &err);
+    bx::close(writer);
+
+    if (err.isOk())
+    {
+        ++m_numWritten;
+        m_numBytes += size;
+    }
+}
+
+} // namespace TinyRender
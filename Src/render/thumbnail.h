@@ -0,0 +1,82 @@
+#pragma once
+
+#include "tiny_render.h"
+
+namespace TinyRender
+{
+
+struct ThumbnailJob
+{
+    VertexBufferHandle m_vbh;
+    IndexBufferHandle m_ibh;
+    ProgramHandle m_program;
+    uint64_t m_state; //!< `BGFX_STATE_*` render state, PSO is derived from program, layout and state.
+    float m_view[16];
+    float m_proj[16];
+    const char *m_filePath; //!< Output TGA file, written through `entry::getFileWriter`.
+};
+
+/// Headless batch thumbnail renderer. Jobs are rendered into a pool of small frame buffers, every
+/// pool target owns one view and whole pool is rendered in a single frame. Images are read back
+/// asynchronously and written out as RLE compressed TGA.
+///
+/// Batch owns views `[0, getNumTargets())` while it exists, and changes their transform, rect, clear
+/// and frame buffer.
+///
+struct ThumbnailBatch
+{
+    ThumbnailBatch();
+    ~ThumbnailBatch();
+
+    /// Create pool of `_numTargets` frame buffers. Pool is clamped to `BGFX_CONFIG_MAX_VIEWS`, to
+    /// half of `BGFX_CONFIG_MAX_READBACKS`, so two frames worth of readbacks can be in flight, and to
+    /// frame buffer handles left.
+    ///
+    /// @param[in] _format `TextureFormat::RGBA8` or `TextureFormat::BGRA8`.
+    ///
+    bool create(uint16_t _width, uint16_t _height, uint16_t _numTargets,
+                TextureFormat::Enum _format = TextureFormat::BGRA8);
+
+    void destroy();
+
+    /// Render all jobs and wait until their images are written. Returns number of images written,
+    /// jobs whose file can't be opened are skipped.
+    uint32_t render(const ThumbnailJob *_jobs, uint32_t _num);
+
+    uint16_t getNumTargets() const
+    {
+        return m_numTargets;
+    }
+
+    /// Bytes written to files by last `render`.
+    uint64_t getNumBytesWritten() const
+    {
+        return m_numBytes;
+    }
+
+  private:
+    struct Pending
+    {
+        ThumbnailBatch *m_batch;
+        const ThumbnailJob *m_job;
+    };
+
+    static void readbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                 uint16_t _height, TextureFormat::Enum _format, void *_userData);
+
+    void write(const ThumbnailJob &_job, const void *_data, uint32_t _pitch, TextureFormat::Enum _format);
+
+    FrameBufferHandle m_fbh[BGFX_CONFIG_MAX_VIEWS];
+    Pending m_pending[BGFX_CONFIG_MAX_READBACKS];
+    uint8_t *m_encoded; //!< Scratch for encoded image, sized for worst case.
+    uint32_t m_encodedSize;
+    uint32_t m_numPending;
+    uint32_t m_numWritten;
+    uint64_t m_numBytes;
+    uint16_t m_width;
+    uint16_t m_height;
+    uint16_t m_numTargets;
+    TextureFormat::Enum m_format;
+};
+
+} // namespace TinyRender
@@ -1,13 +1,247 @@
 #include <bx/platform.h>
+#include <bx/sort.h>
 
+#include "capture.h"
+#include "entry.h"
 #include "tiny_render_p.h"
 
 namespace TinyRender
 {
 
+    struct MemoryCounter
+    {
+        volatile int64_t m_current;
+        volatile int64_t m_peak;
+        volatile int32_t m_numAllocs;
+        int64_t m_budget;
+        MemoryBudgetFn m_budgetFn;
+        void *m_userData;
+    };
+
+    static MemoryCounter s_memory[MemoryCategory::Count];
+
+    void trackAlloc(MemoryCategory::Enum _category, uint64_t _size, uint32_t _num)
+    {
+        MemoryCounter &counter = s_memory[_category];
+        bx::atomicFetchAndAdd<int32_t>(&counter.m_numAllocs, int32_t(_num));
+        const int64_t current = bx::atomicAddAndFetch<int64_t>(&counter.m_current, int64_t(_size));
+
+        for (int64_t peak = counter.m_peak; current > peak; peak = counter.m_peak)
+        {
+            if (peak == bx::atomicCompareAndSwap<int64_t>(&counter.m_peak, peak, current))
+            {
+                break;
+            }
+        }
+
+        const int64_t budget = counter.m_budget;
+        if (0 != budget && NULL != counter.m_budgetFn && current > budget && current - int64_t(_size) <= budget)
+        {
+            counter.m_budgetFn(_category, current, budget, counter.m_userData);
+        }
+    }
+
+    void trackFree(MemoryCategory::Enum _category, uint64_t _size, uint32_t _num)
+    {
+        MemoryCounter &counter = s_memory[_category];
+        bx::atomicFetchAndAdd<int32_t>(&counter.m_numAllocs, -int32_t(_num));
+        bx::atomicFetchAndAdd<int64_t>(&counter.m_current, -int64_t(_size));
+    }
+
+    /// Stores allocation size in a header in front of user pointer, header is padded to alignment.
+    struct TrackingAllocator : public bx::AllocatorI
+    {
+        struct Header
+        {
+            uint64_t m_size;
+            uint64_t m_align;
+        };
+
+        virtual ~TrackingAllocator() {}
+
+        virtual void *realloc(void *_ptr, size_t _size, size_t _align, const char *_filePath, uint32_t _line) override
+        {
+            bx::AllocatorI *allocator = entry::getAllocator();
+
+            if (0 == _size)
+            {
+                if (NULL != _ptr)
+                {
+                    const Header *header = (const Header *)_ptr - 1;
+                    const size_t align = size_t(header->m_align);
+                    trackFree(m_category, header->m_size);
+                    allocator->realloc((uint8_t *)_ptr - align, 0, align, _filePath, _line);
+                }
+
+                return NULL;
+            }
+
+            const size_t align = bx::max<size_t>(_align, sizeof(Header));
+            uint8_t *base = (uint8_t *)allocator->realloc(NULL, _size + align, align, _filePath, _line);
+            if (NULL == base)
+            {
+                return NULL;
+            }
+
+            uint8_t *ptr = base + align;
+            Header *header = (Header *)ptr - 1;
+            header->m_size = _size;
+            header->m_align = align;
+            trackAlloc(m_category, _size);
+
+            if (NULL != _ptr)
+            {
+                const Header *oldHeader = (const Header *)_ptr - 1;
+                bx::memCopy(ptr, _ptr, size_t(bx::min<uint64_t>(oldHeader->m_size, _size)));
+                realloc(_ptr, 0, _align, _filePath, _line);
+            }
+
+            return ptr;
+        }
+
+        MemoryCategory::Enum m_category;
+    };
+
+    static TrackingAllocator s_allocators[MemoryCategory::Count];
+
+    bx::AllocatorI *getAllocator(MemoryCategory::Enum _category)
+    {
+        TrackingAllocator &allocator = s_allocators[_category];
+        allocator.m_category = _category;
+        return &allocator;
+    }
+
+    static Context* s_ctx = nullptr;
+    static Stats s_stats;
+    static CaptureWriter s_capture;
+
+    const Stats *getStats()
+    {
+        Stats &stats = NULL != s_ctx ? s_ctx->m_stats : s_stats;
+        stats.memoryCurrent = 0;
+
+        for (uint32_t ii = 0; ii < MemoryCategory::Count; ++ii)
+        {
+            const MemoryCounter &counter = s_memory[ii];
+            Stats::Memory &memory = stats.memory[ii];
+            memory.current = counter.m_current;
+            memory.peak = counter.m_peak;
+            memory.numAllocs = uint32_t(counter.m_numAllocs);
+            stats.memoryCurrent += memory.current;
+        }
+
+        return &stats;
+    }
+
+    void setMemoryBudget(MemoryCategory::Enum _category, int64_t _budget, MemoryBudgetFn _fn, void *_userData)
+    {
+        BX_ASSERT(_category < MemoryCategory::Count, "Invalid memory category.");
+
+        MemoryCounter &counter = s_memory[_category];
+        counter.m_budgetFn = _fn;
+        counter.m_userData = _userData;
+        counter.m_budget = _budget;
+    }
+
+    struct TextureFormatInfo
+    {
+        uint8_t bitsPerPixel;
+        uint8_t blockSize;
+        bool depth;
+    };
+
+    static const TextureFormatInfo s_textureFormatInfo[] =
+    {
+        {  32, 1, false }, // BGRA8
+        {  32, 1, false }, // RGBA8
+        {  32, 1, false }, // SRGBA8
+        {  64, 1, false }, // RGBA16F
+        { 128, 1, false }, // RGBA32F
+        {  32, 1, false }, // R32F
+        {   4, 4, false }, // BC1
+        {   8, 4, false }, // BC3
+        {   4, 4, false }, // BC4
+        {   8, 4, false }, // BC5
+        {   8, 4, false }, // BC7
+        {   0, 1, true  }, // UnknownDepth
+        {  32, 1, true  }, // D24S8
+        {  32, 1, true  }, // D32F
+    };
+    static_assert(BX_COUNTOF(s_textureFormatInfo) == TextureFormat::Count, "Texture format info mismatch.");
+
+    uint32_t getBitsPerPixel(TextureFormat::Enum _format)
+    {
+        return s_textureFormatInfo[_format].bitsPerPixel;
+    }
+
+    bool isDepth(TextureFormat::Enum _format)
+    {
+        return s_textureFormatInfo[_format].depth;
+    }
+
+    uint32_t getBlockSize(TextureFormat::Enum _format)
+    {
+        return s_textureFormatInfo[_format].blockSize;
+    }
+
+    bool isCompressed(TextureFormat::Enum _format)
+    {
+        return 1 < s_textureFormatInfo[_format].blockSize;
+    }
+
+    uint32_t calcPitch(TextureFormat::Enum _format, uint16_t _width)
+    {
+        const TextureFormatInfo &info = s_textureFormatInfo[_format];
+        const uint32_t numBlocks = (uint32_t(_width) + info.blockSize - 1) / info.blockSize;
+        return numBlocks * info.bitsPerPixel * info.blockSize * info.blockSize / 8;
+    }
+
+    uint32_t calcNumRows(TextureFormat::Enum _format, uint16_t _height)
+    {
+        const uint32_t blockSize = s_textureFormatInfo[_format].blockSize;
+        return (uint32_t(_height) + blockSize - 1) / blockSize;
+    }
+
+    uint8_t calcNumMips(bool _hasMips, uint16_t _width, uint16_t _height)
+    {
+        if (!_hasMips)
+        {
+            return 1;
+        }
+
+        const uint32_t max = bx::uint32_max(bx::uint32_max(_width, _height), 1);
+        return uint8_t(32 - bx::uint32_cntlz(max));
+    }
+
+    void calcTextureSize(TextureInfo &_info, uint16_t _width, uint16_t _height, bool _cubeMap, bool _hasMips,
+                         TextureFormat::Enum _format)
+    {
+        BX_ASSERT(_format < TextureFormat::Count && !isDepth(_format), "Invalid texture format %d.", _format);
+
+        const uint16_t width = bx::max<uint16_t>(1, _width);
+        const uint16_t height = bx::max<uint16_t>(1, _height);
+        const uint8_t numMips = calcNumMips(_hasMips, width, height);
+
+        uint32_t size = 0;
+        for (uint8_t mip = 0; mip < numMips; ++mip)
+        {
+            const uint16_t mipWidth = bx::max<uint16_t>(1, width >> mip);
+            const uint16_t mipHeight = bx::max<uint16_t>(1, height >> mip);
+            size += calcPitch(_format, mipWidth) * calcNumRows(_format, mipHeight);
+        }
+
+        _info.format = _format;
+        _info.storageSize = size * (_cubeMap ? 6 : 1);
+        _info.width = width;
+        _info.height = height;
+        _info.numMips = numMips;
+        _info.bitsPerPixel = uint8_t(getBitsPerPixel(_format));
+        _info.cubeMap = _cubeMap;
+    }
+
     RendererType::Enum getRendererType()
     {
-        return RendererType::Direct3D12;
+        return NULL != s_ctx ? s_ctx->m_renderCtx->getRendererType() : RendererType::Noop;
     }
 
     void dump(const VertexLayout& _layout)
@@ -51,12 +285,54 @@ namespace TinyRender
 	///
 	void RendererDestroy(RendererContextI* _renderCtx);
 
-    static Context* s_ctx = nullptr;
+    bool init(const struct InitParams &params)
+    {
+        s_ctx = BX_NEW(getAllocator(MemoryCategory::Command), Context)();
+        if (!s_ctx->init(params))
+        {
+            bx::deleteObject(getAllocator(MemoryCategory::Command), s_ctx);
+            s_ctx = NULL;
+            return false;
+        }
+
+        if (s_capture.isActive())
+        {
+            s_capture.writeHeader(params);
+        }
+
+        return true;
+    }
 
-    void init(const struct InitParams &params) 
+    void shutdown()
     {
-        s_ctx = new Context();
-        s_ctx->init(params);
+        if (NULL == s_ctx)
+        {
+            return;
+        }
+
+        s_ctx->shutdown();
+        bx::deleteObject(getAllocator(MemoryCategory::Command), s_ctx);
+        s_ctx = NULL;
+
+        s_capture.end();
+    }
+
+    bool captureBegin(const char *_filePath)
+    {
+        BX_ASSERT(NULL != _filePath, "_filePath can't be NULL");
+
+        if (NULL != s_ctx)
+        {
+            BX_TRACE("Capture must begin before init.");
+            return false;
+        }
+
+        return s_capture.begin(_filePath);
+    }
+
+    void captureEnd()
+    {
+        s_capture.end();
     }
 
     VertexBufferHandle createVertexBuffer(const void* _data, uint32_t _size, const VertexLayout& _layout, uint16_t _flags)
@@ -64,21 +340,97 @@ namespace TinyRender
         BX_ASSERT(NULL != _data, "_data can't be NULL");
         BX_ASSERT(isValid(_layout), "Invalid VertexLayout.");
 
-        return s_ctx->createVertexBuffer(_data, _size, _layout, _flags);
+        const VertexBufferHandle handle = s_ctx->createVertexBuffer(_data, _size, _layout, _flags);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateVertexBuffer);
+            s_capture.write(handle.idx);
+            s_capture.write(_layout);
+            s_capture.write(_flags);
+            s_capture.writeData(_data, _size);
+        }
+
+        return handle;
     }
 
     IndexBufferHandle createIndexBuffer(const void* _data, uint32_t _size, uint16_t _flags)
     {
         BX_ASSERT(NULL != _data, "_data can't be NULL");
 
-        return s_ctx->createIndexBuffer(_data, _size, _flags);
+        const IndexBufferHandle handle = s_ctx->createIndexBuffer(_data, _size, _flags);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateIndexBuffer);
+            s_capture.write(handle.idx);
+            s_capture.write(_flags);
+            s_capture.writeData(_data, _size);
+        }
+
+        return handle;
     }
 
     ShaderHandle createShader(const void* _data, uint32_t _size, ShaderType _type)
     {
         BX_ASSERT(NULL != _data, "_data can't be NULL");
 
-        return s_ctx->createShader(_data, _size, _type);
+        const ShaderHandle handle = s_ctx->createShader(_data, _size, _type);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateShader);
+            s_capture.write(handle.idx);
+            s_capture.write(uint8_t(_type));
+            s_capture.writeData(_data, _size);
+        }
+
+        return handle;
+    }
+
+    uint8_t *compileShader(const void *_data, uint32_t _size, ShaderType _type, uint32_t &_outSize)
+    {
+        BX_ASSERT(NULL != s_ctx, "Renderer is not initialized.");
+        return s_ctx->m_renderCtx->compileShader(_data, _size, _type, _outSize);
+    }
+
+    void destroy(VertexBufferHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid vertex buffer handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyVertexBuffer);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    void destroy(IndexBufferHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid index buffer handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyIndexBuffer);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    void destroy(ShaderHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid shader handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyShader);
+            s_capture.write(_handle.idx);
+        }
     }
 
     ProgramHandle createProgram(ShaderHandle _vsh, ShaderHandle _fsh)
@@ -86,55 +438,746 @@ namespace TinyRender
         BX_ASSERT(isValid(_vsh), "_vsh can't be NULL");
         BX_ASSERT(isValid(_fsh), "_fsh can't be NULL");
 
-        return s_ctx->createProgram(_vsh, _fsh);
+        const ProgramHandle handle = s_ctx->createProgram(_vsh, _fsh);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateProgram);
+            s_capture.write(handle.idx);
+            s_capture.write(_vsh.idx);
+            s_capture.write(_fsh.idx);
+        }
+
+        return handle;
     }
 
-    PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint16_t _flags)
+    PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags)
     {
         BX_ASSERT(isValid(_program), "_program can't be NULL");
         BX_ASSERT(isValid(_layout), "_layout can't be NULL");
 
-        return s_ctx->createPSO(_program, _layout, _flags);
+        const PSOHandle handle = s_ctx->createPSO(_program, _layout, _flags);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreatePSO);
+            s_capture.write(handle.idx);
+            s_capture.write(_program.idx);
+            s_capture.write(_layout);
+            s_capture.write(_flags);
+        }
+
+        return handle;
     }
 
     void setViewTransform(ViewId _id, const void* _view, const void* _proj)
     {
         s_ctx->setViewTransform(_id, _view, _proj);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::SetViewTransform);
+            s_capture.write(_id);
+            s_capture.writeMtx(_view);
+            s_capture.writeMtx(_proj);
+        }
     }
 
     void setViewRect(ViewId _id, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height)
     {
         s_ctx->setViewRect(_id, _x, _y, _width, _height);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::SetViewRect);
+            s_capture.write(_id);
+            s_capture.write(_x);
+            s_capture.write(_y);
+            s_capture.write(_width);
+            s_capture.write(_height);
+        }
+    }
+
+    void setViewClear(ViewId _id, uint16_t _flags, uint32_t _rgba, float _depth, uint8_t _stencil)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+
+        s_ctx->setViewClear(_id, _flags, _rgba, _depth, _stencil);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::SetViewClear);
+            s_capture.write(_id);
+            s_capture.write(_flags);
+            s_capture.write(_rgba);
+            s_capture.write(_depth);
+            s_capture.write(_stencil);
+        }
+    }
+
+    void setViewMode(ViewId _id, ViewMode::Enum _mode)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+        BX_ASSERT(_mode < ViewMode::Count, "Invalid view mode %d.", _mode);
+
+        s_ctx->setViewMode(_id, _mode);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::SetViewMode);
+            s_capture.write(_id);
+            s_capture.write(uint8_t(_mode));
+        }
     }
 
-    void beginFrame(ViewId _id)
+    void touch(ViewId _id)
     {
-        s_ctx->beginFrame(_id);
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+
+        s_ctx->touch(_id);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::Touch);
+            s_capture.write(_id);
+        }
     }
 
     void endFrame()
     {
         s_ctx->endFrame();
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::EndFrame);
+        }
     }
     
-    void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso, uint16_t _state, const void* _mtx)
+    void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program,
+                  PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        drawMesh(_id, _vbh, _ibh, 0, UINT32_MAX, _program, _pso, _state, _mtx);
+    }
+
+    void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+                  uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+
+        s_ctx->drawMesh(_id, _vbh, _ibh, _firstIndex, _numIndices, _program, _pso, _state, _mtx);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DrawMesh);
+            s_capture.write(_id);
+            s_capture.write(_vbh.idx);
+            s_capture.write(_ibh.idx);
+            s_capture.write(_firstIndex);
+            s_capture.write(_numIndices);
+            s_capture.write(_program.idx);
+            s_capture.write(_pso.idx);
+            s_capture.write(_state);
+            s_capture.writeMtx(_mtx);
+        }
+    }
+
+    void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program,
+                  uint64_t _state, const void *_mtx)
+    {
+        const PSOHandle pso = BGFX_INVALID_HANDLE;
+        drawMesh(_id, _vbh, _ibh, 0, UINT32_MAX, _program, pso, _state, _mtx);
+    }
+
+    void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+                  uint32_t _numIndices, ProgramHandle _program, uint64_t _state, const void *_mtx)
+    {
+        const PSOHandle pso = BGFX_INVALID_HANDLE;
+        drawMesh(_id, _vbh, _ibh, _firstIndex, _numIndices, _program, pso, _state, _mtx);
+    }
+
+    uint32_t getAvailTransientVertexBuffer(uint32_t _num, const VertexLayout &_layout)
+    {
+        BX_ASSERT(isValid(_layout), "Invalid VertexLayout.");
+
+        return s_ctx->getAvailTransientVertexBuffer(_num, _layout);
+    }
+
+    uint32_t getAvailTransientIndexBuffer(uint32_t _num, bool _index32)
+    {
+        return s_ctx->getAvailTransientIndexBuffer(_num, _index32);
+    }
+
+    bool allocTransientVertexBuffer(TransientVertexBuffer *_tvb, uint32_t _num, const VertexLayout &_layout)
+    {
+        BX_ASSERT(NULL != _tvb, "_tvb can't be NULL");
+        BX_ASSERT(0 < _num, "Requesting 0 vertices.");
+        BX_ASSERT(isValid(_layout), "Invalid VertexLayout.");
+
+        return s_ctx->allocTransientVertexBuffer(_tvb, _num, _layout);
+    }
+
+    bool allocTransientIndexBuffer(TransientIndexBuffer *_tib, uint32_t _num, bool _index32)
+    {
+        BX_ASSERT(NULL != _tib, "_tib can't be NULL");
+        BX_ASSERT(0 < _num, "Requesting 0 indices.");
+
+        return s_ctx->allocTransientIndexBuffer(_tib, _num, _index32);
+    }
+
+    void drawMesh(ViewId _id, const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+                  ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+        BX_ASSERT(NULL != _tvb && NULL != _tvb->data, "Invalid transient vertex buffer.");
+
+        s_ctx->drawMesh(_id, _tvb, _tib, _program, _pso, _state, _mtx);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            // Full layout, replayed draw may derive its PSO from it.
+            s_capture.cmd(CaptureCmd::DrawMeshTransient);
+            s_capture.write(_id);
+            s_capture.write(_tvb->layout);
+            s_capture.writeData(_tvb->data, _tvb->size);
+            s_capture.write(uint8_t(NULL != _tib));
+            s_capture.write(uint8_t(NULL != _tib && _tib->isIndex16));
+            s_capture.writeData(NULL != _tib ? _tib->data : NULL, NULL != _tib ? _tib->size : 0);
+            s_capture.write(_program.idx);
+            s_capture.write(_pso.idx);
+            s_capture.write(_state);
+            s_capture.writeMtx(_mtx);
+        }
+    }
+
+    void drawMesh(ViewId _id, const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+                  ProgramHandle _program, uint64_t _state, const void *_mtx)
+    {
+        const PSOHandle pso = BGFX_INVALID_HANDLE;
+        drawMesh(_id, _tvb, _tib, _program, pso, _state, _mtx);
+    }
+
+    DynamicVertexBufferHandle createDynamicVertexBuffer(uint32_t _num, const VertexLayout &_layout, uint16_t _flags)
+    {
+        BX_ASSERT(isValid(_layout), "Invalid VertexLayout.");
+
+        const DynamicVertexBufferHandle handle = s_ctx->createDynamicVertexBuffer(_num, _layout, _flags);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateDynamicVertexBuffer);
+            s_capture.write(handle.idx);
+            s_capture.write(_num);
+            s_capture.write(_layout);
+            s_capture.write(_flags);
+        }
+
+        return handle;
+    }
+
+    DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint16_t _flags)
+    {
+        const DynamicIndexBufferHandle handle = s_ctx->createDynamicIndexBuffer(_num, _flags);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateDynamicIndexBuffer);
+            s_capture.write(handle.idx);
+            s_capture.write(_num);
+            s_capture.write(_flags);
+        }
+
+        return handle;
+    }
+
+    void update(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const void *_data, uint32_t _size)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid dynamic vertex buffer handle.");
+        BX_ASSERT(NULL != _data, "_data can't be NULL");
+
+        s_ctx->update(_handle, _startVertex, _data, _size);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::UpdateDynamicVertexBuffer);
+            s_capture.write(_handle.idx);
+            s_capture.write(_startVertex);
+            s_capture.writeData(_data, _size);
+        }
+    }
+
+    void update(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const void *_data, uint32_t _size)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid dynamic index buffer handle.");
+        BX_ASSERT(NULL != _data, "_data can't be NULL");
+
+        s_ctx->update(_handle, _startIndex, _data, _size);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::UpdateDynamicIndexBuffer);
+            s_capture.write(_handle.idx);
+            s_capture.write(_startIndex);
+            s_capture.writeData(_data, _size);
+        }
+    }
+
+    void destroy(DynamicVertexBufferHandle _handle)
     {
-        s_ctx->drawMesh(_vbh, _ibh, _program, _pso, _state, _mtx);
+        BX_ASSERT(isValid(_handle), "Invalid dynamic vertex buffer handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyDynamicVertexBuffer);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    void destroy(DynamicIndexBufferHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid dynamic index buffer handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyDynamicIndexBuffer);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, DynamicIndexBufferHandle _dibh,
+                  uint32_t _firstIndex, uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso,
+                  uint64_t _state, const void *_mtx)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+        BX_ASSERT(isValid(_dvbh), "Invalid dynamic vertex buffer handle.");
+        BX_ASSERT(isValid(_dibh), "Invalid dynamic index buffer handle.");
+
+        s_ctx->drawMesh(_id, _dvbh, _dibh, _firstIndex, _numIndices, _program, _pso, _state, _mtx);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DrawMeshDynamic);
+            s_capture.write(_id);
+            s_capture.write(_dvbh.idx);
+            s_capture.write(_dibh.idx);
+            s_capture.write(_firstIndex);
+            s_capture.write(_numIndices);
+            s_capture.write(_program.idx);
+            s_capture.write(_pso.idx);
+            s_capture.write(_state);
+            s_capture.writeMtx(_mtx);
+        }
+    }
+
+    void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+                  uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+        BX_ASSERT(isValid(_dvbh), "Invalid dynamic vertex buffer handle.");
+
+        s_ctx->drawMesh(_id, _dvbh, _ibh, _firstIndex, _numIndices, _program, _pso, _state, _mtx);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DrawMeshDynamicVb);
+            s_capture.write(_id);
+            s_capture.write(_dvbh.idx);
+            s_capture.write(_ibh.idx);
+            s_capture.write(_firstIndex);
+            s_capture.write(_numIndices);
+            s_capture.write(_program.idx);
+            s_capture.write(_pso.idx);
+            s_capture.write(_state);
+            s_capture.writeMtx(_mtx);
+        }
+    }
+
+    void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, DynamicIndexBufferHandle _dibh,
+                  uint32_t _firstIndex, uint32_t _numIndices, ProgramHandle _program, uint64_t _state,
+                  const void *_mtx)
+    {
+        const PSOHandle pso = BGFX_INVALID_HANDLE;
+        drawMesh(_id, _dvbh, _dibh, _firstIndex, _numIndices, _program, pso, _state, _mtx);
+    }
+
+    void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+                  uint32_t _numIndices, ProgramHandle _program, uint64_t _state, const void *_mtx)
+    {
+        const PSOHandle pso = BGFX_INVALID_HANDLE;
+        drawMesh(_id, _dvbh, _ibh, _firstIndex, _numIndices, _program, pso, _state, _mtx);
+    }
+
+    TextureHandle createTexture2D(uint16_t _width, uint16_t _height, bool _hasMips, TextureFormat::Enum _format,
+                                  const void *_data, uint32_t _size)
+    {
+        BX_ASSERT(0 < _width && 0 < _height, "Invalid texture size %dx%d.", _width, _height);
+        BX_ASSERT(_format < TextureFormat::Count && !isDepth(_format), "Invalid texture format %d.", _format);
+
+        const TextureHandle handle = s_ctx->createTexture(_width, _height, false, _hasMips, _format, _data, _size);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateTexture);
+            s_capture.write(handle.idx);
+            s_capture.write(_width);
+            s_capture.write(_height);
+            s_capture.write(uint8_t(false));
+            s_capture.write(uint8_t(_hasMips));
+            s_capture.write(uint8_t(_format));
+            s_capture.writeData(_data, NULL != _data ? _size : 0);
+        }
+
+        return handle;
+    }
+
+    TextureHandle createTextureCube(uint16_t _edge, bool _hasMips, TextureFormat::Enum _format, const void *_data,
+                                    uint32_t _size)
+    {
+        BX_ASSERT(0 < _edge, "Invalid cube map size %d.", _edge);
+        BX_ASSERT(_format < TextureFormat::Count && !isDepth(_format), "Invalid texture format %d.", _format);
+
+        const TextureHandle handle = s_ctx->createTexture(_edge, _edge, true, _hasMips, _format, _data, _size);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateTexture);
+            s_capture.write(handle.idx);
+            s_capture.write(_edge);
+            s_capture.write(_edge);
+            s_capture.write(uint8_t(true));
+            s_capture.write(uint8_t(_hasMips));
+            s_capture.write(uint8_t(_format));
+            s_capture.writeData(_data, NULL != _data ? _size : 0);
+        }
+
+        return handle;
+    }
+
+    void updateTexture2D(TextureHandle _handle, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _width,
+                         uint16_t _height, const void *_data, uint32_t _pitch)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid texture handle.");
+        BX_ASSERT(NULL != _data, "_data can't be NULL");
+
+        s_ctx->updateTexture2D(_handle, _mip, _x, _y, _width, _height, _data, _pitch);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            const TextureFormat::Enum format = s_ctx->m_textureInfo[_handle.idx].format;
+            const uint32_t rowSize = calcPitch(format, _width);
+            const uint32_t pitch = UINT32_MAX == _pitch ? rowSize : _pitch;
+
+            s_capture.cmd(CaptureCmd::UpdateTexture2D);
+            s_capture.write(_handle.idx);
+            s_capture.write(_mip);
+            s_capture.write(_x);
+            s_capture.write(_y);
+            s_capture.write(_width);
+            s_capture.write(_height);
+            s_capture.writeRows(_data, rowSize, calcNumRows(format, _height), pitch);
+        }
+    }
+
+    void destroy(TextureHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid texture handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyTexture);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    FrameBufferHandle createFrameBuffer(uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                                        TextureFormat::Enum _depthFormat)
+    {
+        BX_ASSERT(0 < _width && 0 < _height, "Invalid frame buffer size %dx%d.", _width, _height);
+        BX_ASSERT(_format < TextureFormat::Count && !isDepth(_format), "Invalid color format %d.", _format);
+        BX_ASSERT(TextureFormat::Count == _depthFormat || isDepth(_depthFormat), "Invalid depth format %d.",
+                  _depthFormat);
+
+        const FrameBufferHandle handle = s_ctx->createFrameBuffer(_width, _height, _format, _depthFormat);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::CreateFrameBuffer);
+            s_capture.write(handle.idx);
+            s_capture.write(_width);
+            s_capture.write(_height);
+            s_capture.write(uint8_t(_format));
+            s_capture.write(uint8_t(_depthFormat));
+        }
+
+        return handle;
+    }
+
+    void destroy(FrameBufferHandle _handle)
+    {
+        BX_ASSERT(isValid(_handle), "Invalid frame buffer handle.");
+
+        s_ctx->destroy(_handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::DestroyFrameBuffer);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    void setViewFrameBuffer(ViewId _id, FrameBufferHandle _handle)
+    {
+        BX_ASSERT(_id < BGFX_CONFIG_MAX_VIEWS, "Invalid view id %d.", _id);
+
+        s_ctx->setViewFrameBuffer(_id, _handle);
+
+        if (BX_UNLIKELY(s_capture.isActive()))
+        {
+            s_capture.cmd(CaptureCmd::SetViewFrameBuffer);
+            s_capture.write(_id);
+            s_capture.write(_handle.idx);
+        }
+    }
+
+    bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData)
+    {
+        BX_ASSERT(NULL != _fn, "_fn can't be NULL");
+
+        // Not captured, replay has no one to hand pixels to.
+        return s_ctx->readFrameBuffer(_handle, _fn, _userData);
     }
 
     bool Context::init(const InitParams &_init)
     {
         m_renderCtx = RendererCreate(_init);
+        if (NULL == m_renderCtx)
+        {
+            return false;
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(m_view); ++ii)
+        {
+            m_view[ii].reset();
+        }
+
+        m_renderCtx->resetTransientBuffers(m_transientVb, m_transientIb);
+
+        if (!m_jobPool.create(BGFX_CONFIG_WORKER_THREADS))
+        {
+            BX_TRACE("WARNING: Failed to create worker threads, CPU jobs run on API thread.");
+        }
+
+        m_numDraws = 0;
+        m_numKeys = 0;
+        m_numMatrices = 0;
+        m_numQueuedReadbacks = 0;
+        m_numFreeVertexBuffers = 0;
+        m_numFreeIndexBuffers = 0;
+        m_numFreeShaders = 0;
+        m_numFreeDynamicVertexBuffers = 0;
+        m_numFreeDynamicIndexBuffers = 0;
+        m_numFreeFrameBuffers = 0;
+        m_numFreeTextures = 0;
+
+        m_frameTime = bx::getHPCounter();
+        m_cpuTimeSubmit = 0;
+        m_cpuTimeSort = 0;
 
         return true;
     }
 
     void Context::shutdown()
     {
+        // Draws and readbacks of unfinished frame are dropped, readbacks in flight complete in
+        // backend shutdown.
+        m_numDraws = 0;
+        m_numKeys = 0;
+        m_numQueuedReadbacks = 0;
+        freeDeferred();
+
+        m_jobPool.destroy();
+
         RendererDestroy(m_renderCtx);
         m_renderCtx = nullptr;
     }
 
+    void Context::submit()
+    {
+        BGFX_PROFILER_SCOPE("Context::submit");
+
+        int64_t start = bx::getHPCounter();
+        bx::radixSort(m_sortKeys, m_tempKeys, m_sortValues, m_tempValues, m_numKeys);
+
+        int64_t now = bx::getHPCounter();
+        m_cpuTimeSort += now - start;
+        start = now;
+
+        ViewId view = UINT16_MAX;
+        for (uint32_t ii = 0; ii < m_numKeys; ++ii)
+        {
+            const ViewId id = SortKey::decodeView(m_sortKeys[ii]);
+            if (id != view)
+            {
+                view = id;
+                m_renderCtx->beginView(m_view[id]);
+            }
+
+            const RenderDraw &draw = m_draws[m_sortValues[ii]];
+            if (!isValid(draw.m_pso))
+            {
+                continue;
+            }
+
+            const void *mtx = UINT32_MAX != draw.m_mtx ? m_matrixCache[draw.m_mtx].un.val : NULL;
+
+            // Pre-pass lays down depth without color, shading pass then only touches visible pixels.
+            uint64_t state = draw.m_state;
+            switch (SortKey::decodePass(m_sortKeys[ii]))
+            {
+            case SortKey::PassDepth:
+                state &= ~(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+                break;
+
+            case SortKey::PassOpaque:
+                state &= ~(BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_MASK);
+                state |= BGFX_STATE_DEPTH_TEST_EQUAL;
+                break;
+
+            default:
+                break;
+            }
+
+            if (draw.m_transient)
+            {
+                TransientVertexBuffer tvb;
+                tvb.data = &m_transientVb.data[draw.m_tvbOffset];
+                tvb.size = draw.m_tvbSize;
+                tvb.offset = draw.m_tvbOffset;
+                tvb.stride = draw.m_tvbStride;
+
+                TransientIndexBuffer tib;
+                tib.data = &m_transientIb.data[draw.m_tibOffset];
+                tib.size = draw.m_tibSize;
+                tib.offset = draw.m_tibOffset;
+                tib.isIndex16 = draw.m_tibIndex16;
+
+                m_renderCtx->drawTransient(&tvb, draw.m_tibValid ? &tib : NULL, draw.m_program, draw.m_pso, state,
+                                           mtx);
+            }
+            else
+            {
+                m_renderCtx->drawMesh(draw.m_vbh, draw.m_ibh, draw.m_firstIndex, draw.m_numIndices, draw.m_program,
+                                      draw.m_pso, state, mtx);
+            }
+        }
+
+        // Readbacks go after all views, so they see everything rendered this frame.
+        for (uint32_t ii = 0; ii < m_numQueuedReadbacks; ++ii)
+        {
+            ReadbackRequest &request = m_readbacks[m_readbackQueue[ii]];
+            if (!m_renderCtx->readFrameBuffer(request.m_handle, readbackCallback, &request))
+            {
+                readbackCallback(request.m_handle, NULL, 0, 0, 0, TextureFormat::Count, &request);
+            }
+        }
+
+        m_numDraws = 0;
+        m_numKeys = 0;
+        m_numMatrices = 0;
+        m_numQueuedReadbacks = 0;
+
+        m_cpuTimeSubmit += bx::getHPCounter() - start;
+    }
+
+    void Context::freeDeferred()
+    {
+        for (uint32_t ii = 0; ii < m_numFreeVertexBuffers; ++ii)
+        {
+            const VertexBufferHandle handle = m_freeVertexBuffers[ii];
+            m_renderCtx->destroyVertexBuffer(handle);
+            m_vertexBufferHandle.free(handle.idx);
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeIndexBuffers; ++ii)
+        {
+            const IndexBufferHandle handle = m_freeIndexBuffers[ii];
+            m_renderCtx->destroyIndexBuffer(handle);
+            m_indexBufferHandle.free(handle.idx);
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeShaders; ++ii)
+        {
+            const ShaderHandle handle = m_freeShaders[ii];
+            m_renderCtx->destroyShader(handle);
+            m_shaderHandle.free(handle.idx);
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeDynamicVertexBuffers; ++ii)
+        {
+            const DynamicVertexBufferHandle handle = m_freeDynamicVertexBuffers[ii];
+            DynamicVertexBuffer &dvb = m_dynamicVertexBuffers[handle.idx];
+            m_renderCtx->destroyVertexBuffer(dvb.m_handle);
+            m_vertexBufferHandle.free(dvb.m_handle.idx);
+            m_dynamicVertexBufferHandle.free(handle.idx);
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeDynamicIndexBuffers; ++ii)
+        {
+            const DynamicIndexBufferHandle handle = m_freeDynamicIndexBuffers[ii];
+            DynamicIndexBuffer &dib = m_dynamicIndexBuffers[handle.idx];
+            m_renderCtx->destroyIndexBuffer(dib.m_handle);
+            m_indexBufferHandle.free(dib.m_handle.idx);
+            m_dynamicIndexBufferHandle.free(handle.idx);
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeFrameBuffers; ++ii)
+        {
+            const FrameBufferHandle handle = m_freeFrameBuffers[ii];
+            m_renderCtx->destroyFrameBuffer(handle);
+            m_frameBufferHandle.free(handle.idx);
+
+            for (uint32_t jj = 0; jj < BX_COUNTOF(m_view); ++jj)
+            {
+                if (m_view[jj].m_fbh.idx == handle.idx)
+                {
+                    m_view[jj].m_fbh.idx = kInvalidHandle;
+                }
+            }
+        }
+
+        for (uint32_t ii = 0; ii < m_numFreeTextures; ++ii)
+        {
+            const TextureHandle handle = m_freeTextures[ii];
+            m_renderCtx->destroyTexture(handle);
+            m_textureHandle.free(handle.idx);
+        }
+
+        m_numFreeVertexBuffers = 0;
+        m_numFreeIndexBuffers = 0;
+        m_numFreeShaders = 0;
+        m_numFreeDynamicVertexBuffers = 0;
+        m_numFreeDynamicIndexBuffers = 0;
+        m_numFreeFrameBuffers = 0;
+        m_numFreeTextures = 0;
+    }
+
+    void Context::readbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                   uint16_t _height, TextureFormat::Enum _format, void *_userData)
+    {
+        // Free request slot first, so callback can't see it taken.
+        ReadbackRequest *request = (ReadbackRequest *)_userData;
+        const ReadbackFn fn = request->m_fn;
+        void *userData = request->m_userData;
+        request->m_fn = NULL;
+
+        fn(_handle, _data, _pitch, _width, _height, _format, userData);
+    }
+
 
 	typedef RendererContextI* (*RendererCreateFn)(const InitParams& _init);
 	typedef void (*RendererDestroyFn)();
@@ -146,23 +1189,112 @@ namespace TinyRender
 		extern void rendererDestroy();                              \
 	}
 
+	BGFX_RENDERER_CONTEXT(noop);
 	BGFX_RENDERER_CONTEXT(d3d12);
 
 #undef BGFX_RENDERER_CONTEXT
 
+	struct RendererCreator
+	{
+		RendererCreateFn  createFn;
+		RendererDestroyFn destroyFn;
+		const char* name;
+		bool supported;
+	};
+
+	static RendererCreator s_rendererCreator[] =
+	{
+		{ noop::rendererCreate,  noop::rendererDestroy,  "Noop",        true                              }, // Noop
+		{ NULL,                  NULL,                   "AGC",         false                             }, // Agc
+		{ NULL,                  NULL,                   "Direct3D 11", false                             }, // Direct3D11
+		{ d3d12::rendererCreate, d3d12::rendererDestroy, "Direct3D 12", !!BGFX_CONFIG_RENDERER_DIRECT3D12 }, // Direct3D12
+		{ NULL,                  NULL,                   "GNM",         false                             }, // Gnm
+		{ NULL,                  NULL,                   "Metal",       false                             }, // Metal
+		{ NULL,                  NULL,                   "NVN",         false                             }, // Nvn
+		{ NULL,                  NULL,                   "OpenGL ES",   false                             }, // OpenGLES
+		{ NULL,                  NULL,                   "OpenGL",      false                             }, // OpenGL
+		{ NULL,                  NULL,                   "Vulkan",      false                             }, // Vulkan
+	};
+	static_assert(BX_COUNTOF(s_rendererCreator) == RendererType::Count, "Renderer creator table mismatch.");
+
+	// Fastest first. D3D12 falls back to WARP software rasterizer by itself when there is no GPU,
+	// Noop always succeeds.
+	static const RendererType::Enum s_rendererFallback[] =
+	{
+		RendererType::Direct3D12,
+		RendererType::Noop,
+	};
+
+	uint8_t getSupportedRenderers(uint8_t _max, RendererType::Enum* _enum)
+	{
+		_enum = _max == 0 ? NULL : _enum;
+
+		uint8_t num = 0;
+		for (uint32_t ii = 0; ii < BX_COUNTOF(s_rendererFallback); ++ii)
+		{
+			const RendererType::Enum type = s_rendererFallback[ii];
+			if (s_rendererCreator[type].supported)
+			{
+				if (NULL == _enum)
+				{
+					num++;
+				}
+				else
+				{
+					if (num < _max)
+					{
+						_enum[num++] = type;
+					}
+					else
+					{
+						break;
+					}
+				}
+			}
+		}
+
+		return num;
+	}
+
+	const char* getRendererName(RendererType::Enum _type)
+	{
+		BX_ASSERT(_type < RendererType::Count, "Invalid renderer type %d.", _type);
+		return s_rendererCreator[_type].name;
+	}
+
     RendererContextI* RendererCreate(const InitParams& _init)
     {
-        #if BGFX_CONFIG_RENDERER_DIRECT3D12
-            return d3d12::rendererCreate(_init);
-        #endif
-        return nullptr;
+        if (_init.type < RendererType::Count && s_rendererCreator[_init.type].supported)
+        {
+            RendererContextI* renderCtx = s_rendererCreator[_init.type].createFn(_init);
+            if (NULL != renderCtx)
+            {
+                return renderCtx;
+            }
+
+            BX_TRACE("Renderer %s is not available, falling back.", getRendererName(_init.type));
+        }
+
+        for (uint32_t ii = 0; ii < BX_COUNTOF(s_rendererFallback); ++ii)
+        {
+            const RendererType::Enum type = s_rendererFallback[ii];
+            if (type != _init.type && s_rendererCreator[type].supported)
+            {
+                RendererContextI* renderCtx = s_rendererCreator[type].createFn(_init);
+                if (NULL != renderCtx)
+                {
+                    BX_TRACE("Using renderer %s.", getRendererName(type));
+                    return renderCtx;
+                }
+            }
+        }
+
+        return NULL;
     }
 
     void RendererDestroy(RendererContextI* _renderCtx)
     {
-        #if BGFX_CONFIG_RENDERER_DIRECT3D12
-            d3d12::rendererDestroy();
-        #endif
+        s_rendererCreator[_renderCtx->getRendererType()].destroyFn();
     }
 
 } // namespace TinyRender
\ No newline at end of file
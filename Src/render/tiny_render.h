@@ -49,8 +49,21 @@ struct RendererType
     };
 };
 
+/// Returns current renderer backend type.
 RendererType::Enum getRendererType();
 
+/// Returns renderers compiled into this build, in fallback order.
+///
+/// @param[in] _max Maximum number of elements in `_enum` array.
+/// @param[out] _enum Array where supported renderers will be written.
+///
+/// @returns Number of supported renderers.
+///
+uint8_t getSupportedRenderers(uint8_t _max = 0, RendererType::Enum *_enum = NULL);
+
+/// Returns name of renderer.
+const char *getRendererName(RendererType::Enum _type);
+
 /// Vertex attribute enum.
 ///
 /// @attention C99's equivalent binding is `bgfx_attrib_t`.
@@ -102,6 +115,36 @@ struct AttribType
     };
 };
 
+/// Texture format enum.
+///
+/// @attention C99's equivalent binding is `bgfx_texture_format_t`.
+///
+struct TextureFormat
+{
+    /// Texture formats:
+    enum Enum
+    {
+        BGRA8,   //!< 8-bit BGRA unorm.
+        RGBA8,   //!< 8-bit RGBA unorm.
+        SRGBA8,  //!< 8-bit RGBA unorm, sRGB encoded color and linear alpha.
+        RGBA16F, //!< 16-bit RGBA float.
+        RGBA32F, //!< 32-bit RGBA float.
+        R32F,    //!< 32-bit red float.
+        BC1,     //!< DXT1 RGB, 1-bit alpha, 4x4 blocks.
+        BC3,     //!< DXT5 RGBA, 4x4 blocks.
+        BC4,     //!< Single channel, 4x4 blocks.
+        BC5,     //!< Two channels, 4x4 blocks, normal maps.
+        BC7,     //!< RGBA, 4x4 blocks.
+
+        UnknownDepth, // Depth formats below.
+
+        D24S8, //!< 24-bit depth, 8-bit stencil.
+        D32F,  //!< 32-bit float depth.
+
+        Count
+    };
+};
+
 static const uint16_t kInvalidHandle = UINT16_MAX;
 
 BGFX_HANDLE(DynamicIndexBufferHandle)
@@ -159,13 +202,119 @@ struct VertexLayout
     uint16_t m_attributes[Attrib::Count]; //!< Used attributes.
 };
 
+/// Transient vertex buffer. Lives only for the frame it was allocated in.
+///
+struct TransientVertexBuffer
+{
+    uint8_t *data;   //!< Pointer to data, write vertices here directly.
+    uint32_t size;   //!< Data size.
+    uint32_t offset; //!< Byte offset inside frame transient vertex buffer.
+    uint16_t stride; //!< Vertex stride.
+    VertexLayout layout; //!< Vertex layout, PSO is derived from it when buffer is drawn.
+};
+
+/// Transient index buffer. Lives only for the frame it was allocated in.
+///
+struct TransientIndexBuffer
+{
+    uint8_t *data;   //!< Pointer to data, write indices here directly.
+    uint32_t size;   //!< Data size.
+    uint32_t offset; //!< Byte offset inside frame transient index buffer.
+    bool isIndex16;  //!< Indices are 16-bit.
+};
+
+/// Texture size and layout, see `calcTextureSize`.
+///
+struct TextureInfo
+{
+    TextureFormat::Enum format; //!< Texture format.
+    uint32_t storageSize;       //!< Total bytes of all sides and mips, tightly packed.
+    uint16_t width;             //!< Width of mip 0.
+    uint16_t height;            //!< Height of mip 0.
+    uint8_t numMips;            //!< Number of mips.
+    uint8_t bitsPerPixel;       //!< Format bits per pixel.
+    bool cubeMap;               //!< Texture is cube map, it has 6 sides.
+};
+
+/// Memory accounting category.
+struct MemoryCategory
+{
+    enum Enum
+    {
+        VertexBuffer, //!< Vertex buffers, including CPU shadow of dynamic ones.
+        IndexBuffer,  //!< Index buffers, including CPU shadow of dynamic ones.
+        Shader,       //!< Compiled shader bytecode.
+        PSO,          //!< Pipeline state objects, estimated from their bytecode size.
+        Texture,      //!< Textures and frame buffer attachments.
+        Staging,      //!< One-off staging buffers for uploads that don't fit upload ring, readback buffers.
+        UploadRing,   //!< Upload ring and transient vertex/index buffers.
+        Command,      //!< CPU-side renderer state and command recording memory.
+
+        Count
+    };
+};
+
+/// Renderer statistics. Frame counters and timings describe the last finished frame, they are
+/// updated in `endFrame`. Memory counters are current at the time of `getStats` call.
+///
+/// CPU times are in ticks of `cpuTimerFreq`.
+struct Stats
+{
+    struct Memory
+    {
+        int64_t current;    //!< Bytes in use.
+        int64_t peak;       //!< Highest `current` since init.
+        uint32_t numAllocs; //!< Live allocations.
+    };
+
+    int64_t cpuTimeFrame;     //!< Time between last two `endFrame` calls.
+    int64_t cpuTimeSubmit;    //!< Time spent in draw calls, including backend translation of them.
+    int64_t cpuTimeSort;      //!< Time spent sorting draws.
+    int64_t cpuTimeBackend;   //!< Backend frame setup and command list submission.
+    int64_t cpuTimePresent;   //!< Time spent in swap chain present.
+    int64_t cpuTimeFenceWait; //!< Time spent waiting for GPU.
+    int64_t cpuTimerFreq;     //!< CPU timer frequency.
+
+    uint32_t numDraw;               //!< Draw calls.
+    uint32_t numPrims;              //!< Primitives drawn, triangles, lines and points together.
+    uint32_t numPsoBinds;           //!< PSO changes, redundant binds are filtered.
+    uint32_t numRootSignatureBinds; //!< Root signature changes.
+    uint32_t numVertexBufferBinds;  //!< Vertex buffer changes.
+    uint32_t numIndexBufferBinds;   //!< Index buffer changes.
+    uint64_t uploadedBytes;         //!< Bytes copied through upload buffers plus transient buffer bytes.
+
+    Memory memory[MemoryCategory::Count]; //!< Per category memory usage.
+    int64_t memoryCurrent;                //!< Sum of `current` over all categories.
+};
+
+/// Called when memory in category grows over its budget. Can be called from any thread that
+/// allocates renderer memory.
+typedef void (*MemoryBudgetFn)(MemoryCategory::Enum _category, int64_t _current, int64_t _budget, void *_userData);
+
+/// Called when frame buffer readback finished, see `readFrameBuffer`. `_data` is valid only
+/// during the call.
+///
+/// @param[in] _handle Frame buffer that was read, invalid handle for backbuffer.
+/// @param[in] _data Rows of pixels, `_pitch` bytes apart.
+/// @param[in] _pitch Row pitch in bytes, can be larger than `_width` pixels.
+///
+typedef void (*ReadbackFn)(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                           uint16_t _height, TextureFormat::Enum _format, void *_userData);
+
 struct InitParams
 {
     int width;
     int height;
     int samples;
-    int maxDepth;
+    int maxDepth; //!< When not 0 backbuffer gets `TextureFormat::D24S8` depth-stencil buffer.
+
+    /// Window to render to. When NULL renderers run headless, backbuffer is an offscreen texture of
+    /// `width` x `height` and nothing is presented.
     void *hwnd;
+
+    /// Renderer to try first. When it's not available, or left at `RendererType::Count`, renderers
+    /// are tried in `getSupportedRenderers` order, Noop always succeeds.
+    RendererType::Enum type = RendererType::Count;
 };
 
 enum ShaderType
@@ -183,6 +332,7 @@ enum ShaderType
 			Sequential,      //!< Sort in the same order in which submit calls were called.
 			DepthAscending,  //!< Sort draw call depth in ascending order.
 			DepthDescending, //!< Sort draw call depth in descending order.
+			DepthPrePass,    //!< Draws writing depth are rendered depth-only front to back, then shaded.
 
 			Count
 		};
@@ -191,27 +341,268 @@ enum ShaderType
 /// View id.
 typedef uint16_t ViewId;
 
-void init(const InitParams &params);
+/// Initialize renderer.
+///
+/// @returns `false` when no renderer could be created.
+///
+bool init(const InitParams &params);
+
+/// Shut renderer down. Resources that weren't destroyed are destroyed with it, draws of unfinished
+/// frame are dropped and capture in progress is ended. `init` can be called again afterwards.
+void shutdown();
 
 VertexBufferHandle createVertexBuffer(const void *_data, uint32_t _size, const VertexLayout &_layout,
                                       uint16_t _flags = BGFX_BUFFER_NONE);
 
 IndexBufferHandle createIndexBuffer(const void *_data, uint32_t _size, uint16_t _flags = BGFX_BUFFER_NONE);
 
+/// Create shader from HLSL source or from compiled bytecode, DXBC on D3D12.
+///
+/// @returns Invalid handle when source doesn't compile.
+///
 ShaderHandle createShader(const void *_data, uint32_t _size, ShaderType _type);
 
+/// Destroy vertex buffer after current frame is submitted.
+void destroy(VertexBufferHandle _handle);
+
+/// Destroy index buffer after current frame is submitted.
+void destroy(IndexBufferHandle _handle);
+
+/// Destroy shader after current frame is submitted. Programs created from it keep working, shader
+/// can be destroyed right after `createProgram`.
+void destroy(ShaderHandle _handle);
+
 ProgramHandle createProgram(ShaderHandle _vsh, ShaderHandle _fsh);
 
-PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint16_t _flags);
+/// Create pipeline state. Draws without PSO get one derived from their program, vertex layout and
+/// state instead, explicit PSO is needed only to share it between layouts or to create it upfront.
+///
+/// @param[in] _flags `BGFX_STATE_*` render state, used by draws that pass `BGFX_STATE_NONE` as
+///   `_state`. Depth test and write need depth buffer in view render target.
+///
+PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags);
 
 void setViewTransform(ViewId _id, const void *_view, const void *_proj);
 
 void setViewRect(ViewId _id, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height);
 
-void beginFrame(ViewId _id);
+/// Set view clear, done when view starts executing. Views without clear flags skip clear and keep
+/// previous contents of their render target.
+///
+/// @param[in] _flags `BGFX_CLEAR_*` flags.
+/// @param[in] _rgba Clear color, packed as `0xRRGGBBAA`.
+///
+void setViewClear(ViewId _id, uint16_t _flags, uint32_t _rgba = 0x000000ff, float _depth = 1.0f,
+                  uint8_t _stencil = 0);
+
+/// Set order of draws inside view. Depth modes sort by view space depth of `_mtx` translation.
+///
+/// `ViewMode::DepthPrePass` renders draws with `BGFX_STATE_WRITE_Z` twice. First depth-only, front
+/// to back, then with their shading in default order, testing depth for equal without writing it,
+/// so every pixel is shaded once. Draws that don't write depth go last, in default order.
+///
+void setViewMode(ViewId _id, ViewMode::Enum _mode = ViewMode::Default);
 
+/// Execute view this frame even if nothing is drawn into it.
+void touch(ViewId _id);
+
+/// Submit frame. Draws are recorded per view and executed here, views with draws, or touched,
+/// run in view id order, each with its rect, transform and frame buffer as they are at this point.
 void endFrame();
 
-void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso, uint16_t _state, const void* _mtx);
+/// Draw mesh into view.
+///
+/// @param[in] _pso Pipeline state. When invalid, PSO is derived from `_program`, vertex layout of
+///   `_vbh` and `_state`, and cached, so draws with the same triple share it.
+/// @param[in] _state `BGFX_STATE_*` render state, `BGFX_STATE_NONE` uses state PSO was created with.
+///   `BGFX_STATE_PT_*` selects primitive topology. Render targets are single sampled for now, so
+///   `BGFX_STATE_MSAA` only turns on line antialiasing.
+/// @param[in] _mtx Model matrix, 16 floats, or NULL for identity. D3D12 passes it to shaders as root
+///   constants at `b1`.
+///
+void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso,
+              uint64_t _state, const void *_mtx);
+
+/// Draw `_numIndices` indices starting at `_firstIndex`. Pass `UINT32_MAX` to draw till the end of buffer.
+/// With invalid `_ibh` draw is not indexed, and `_firstIndex` and `_numIndices` select vertices.
+void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx);
+
+/// Draw mesh with PSO derived from `_program`, vertex layout and `_state`.
+void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program,
+              uint64_t _state = BGFX_STATE_DEFAULT, const void *_mtx = NULL);
+
+/// Draw index range with PSO derived from `_program`, vertex layout and `_state`.
+void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, uint64_t _state = BGFX_STATE_DEFAULT,
+              const void *_mtx = NULL);
+
+/// Returns number of vertices that can be allocated from transient vertex buffer, up to `_num`.
+uint32_t getAvailTransientVertexBuffer(uint32_t _num, const VertexLayout &_layout);
+
+/// Returns number of indices that can be allocated from transient index buffer, up to `_num`.
+uint32_t getAvailTransientIndexBuffer(uint32_t _num, bool _index32 = false);
+
+/// Allocate transient vertex buffer for current frame. Memory is written in place and recycled
+/// automatically after `endFrame`. Safe to call from multiple threads.
+///
+/// @returns `false` when transient vertex buffer is exhausted for this frame.
+///
+bool allocTransientVertexBuffer(TransientVertexBuffer *_tvb, uint32_t _num, const VertexLayout &_layout);
+
+/// Allocate transient index buffer for current frame. Memory is written in place and recycled
+/// automatically after `endFrame`. Safe to call from multiple threads.
+///
+/// @returns `false` when transient index buffer is exhausted for this frame.
+///
+bool allocTransientIndexBuffer(TransientIndexBuffer *_tib, uint32_t _num, bool _index32 = false);
+
+/// Returns renderer statistics. Pointer stays valid until shutdown.
+const Stats *getStats();
+
+/// Set memory budget for category. `_fn` is called each time category usage goes from within
+/// budget to over it. Pass 0 as `_budget` to disable.
+void setMemoryBudget(MemoryCategory::Enum _category, int64_t _budget, MemoryBudgetFn _fn, void *_userData = NULL);
+
+/// Start recording every API call and its data into capture file `_filePath`. Must be called
+/// before `init`, so capture holds everything needed to replay it on a fresh renderer. Transient
+/// geometry is recorded when drawn. See `Tools/Replay`.
+///
+/// @returns `false` when renderer is already initialized or file can't be opened.
+///
+bool captureBegin(const char *_filePath);
+
+/// Stop recording and close capture file.
+void captureEnd();
+
+/// Draw transient geometry. `_tib` can be NULL for non-indexed draw. Invalid `_pso` is derived
+/// from layout transient vertex buffer was allocated with.
+void drawMesh(ViewId _id, const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+              ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx);
+
+/// Draw transient geometry with PSO derived from `_program`, vertex layout and `_state`.
+void drawMesh(ViewId _id, const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+              ProgramHandle _program, uint64_t _state = BGFX_STATE_DEFAULT, const void *_mtx = NULL);
+
+/// Create empty dynamic vertex buffer with room for `_num` vertices.
+///
+/// @param[in] _flags `BGFX_BUFFER_ALLOW_RESIZE` lets `update` grow the buffer past `_num`.
+///
+DynamicVertexBufferHandle createDynamicVertexBuffer(uint32_t _num, const VertexLayout &_layout,
+                                                    uint16_t _flags = BGFX_BUFFER_NONE);
+
+/// Create empty dynamic index buffer with room for `_num` indices.
+///
+/// @param[in] _flags `BGFX_BUFFER_INDEX32` for 32-bit indices, `BGFX_BUFFER_ALLOW_RESIZE` lets `update` grow
+///   the buffer past `_num`.
+///
+DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint16_t _flags = BGFX_BUFFER_NONE);
+
+/// Update part of dynamic vertex buffer. Data is copied, updates are tracked per byte range and
+/// uploaded together when the buffer is drawn next, so many small updates per frame are cheap.
+///
+/// @param[in] _startVertex First vertex to update.
+/// @param[in] _data Vertex data.
+/// @param[in] _size Data size in bytes.
+///
+void update(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const void *_data, uint32_t _size);
+
+/// Update part of dynamic index buffer. See dynamic vertex buffer `update`.
+void update(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const void *_data, uint32_t _size);
+
+/// Destroy dynamic vertex buffer. It stays alive until current frame is submitted, so draws
+/// already recorded still use it.
+void destroy(DynamicVertexBufferHandle _handle);
+
+/// Destroy dynamic index buffer, see dynamic vertex buffer `destroy`.
+void destroy(DynamicIndexBufferHandle _handle);
+
+/// Draw from dynamic vertex and index buffers. Pass `UINT32_MAX` as `_numIndices` to draw till the end of buffer.
+void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, DynamicIndexBufferHandle _dibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx);
+
+/// Draw from dynamic vertex buffer with static index buffer.
+void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx);
+
+/// Draw from dynamic vertex and index buffers with PSO derived from `_program`, vertex layout and `_state`.
+void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, DynamicIndexBufferHandle _dibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, uint64_t _state = BGFX_STATE_DEFAULT,
+              const void *_mtx = NULL);
+
+/// Draw from dynamic vertex buffer with static index buffer and PSO derived from `_program`, vertex
+/// layout and `_state`.
+void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+              uint32_t _numIndices, ProgramHandle _program, uint64_t _state = BGFX_STATE_DEFAULT,
+              const void *_mtx = NULL);
+
+/// Calculate texture size and number of mips. Texture data is sides in `+x, -x, +y, -y, +z, -z`
+/// order, each side its mips from largest, each mip rows of pixels without padding. Block compressed
+/// mips are rows of 4x4 blocks, partial blocks at edges of small mips are whole.
+///
+/// @param[out] _info Texture info.
+/// @param[in] _hasMips Full mip chain down to 1x1, otherwise single mip.
+///
+void calcTextureSize(TextureInfo &_info, uint16_t _width, uint16_t _height, bool _cubeMap, bool _hasMips,
+                     TextureFormat::Enum _format);
+
+/// Create 2D texture.
+///
+/// @param[in] _hasMips Texture has full mip chain.
+/// @param[in] _format Color format, depth formats are for frame buffers only. Block compressed
+///   textures need width and height multiple of 4, and all mips in data, see `bcEncodeTexture`.
+/// @param[in] _data Contents of all mips, laid out as described in `calcTextureSize`. NULL leaves
+///   texture uninitialized, fill it with `updateTexture2D`. With `_hasMips` it can also hold just
+///   mip 0, the rest of chain is then generated with box filter, see `mipGenerate`.
+/// @param[in] _size Data size, must match `TextureInfo::storageSize`, or size of mip 0 when mips are
+///   generated.
+///
+/// @returns Invalid handle when handles are exhausted or `_size` doesn't match.
+///
+TextureHandle createTexture2D(uint16_t _width, uint16_t _height, bool _hasMips, TextureFormat::Enum _format,
+                              const void *_data = NULL, uint32_t _size = 0);
+
+/// Create cube map texture `_edge` x `_edge` pixels per side. See `createTexture2D`.
+TextureHandle createTextureCube(uint16_t _edge, bool _hasMips, TextureFormat::Enum _format, const void *_data = NULL,
+                                uint32_t _size = 0);
+
+/// Update rectangle of 2D texture mip. Data is copied and uploaded with this frame, before any
+/// draw of it.
+///
+/// @param[in] _pitch Bytes between rows of `_data`, `UINT32_MAX` for rows without padding. Rows of
+///   4x4 blocks for block compressed formats, rectangle must then be aligned to blocks.
+///
+void updateTexture2D(TextureHandle _handle, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _width,
+                     uint16_t _height, const void *_data, uint32_t _pitch = UINT32_MAX);
+
+/// Destroy texture after current frame is submitted.
+void destroy(TextureHandle _handle);
+
+/// Create offscreen frame buffer.
+///
+/// @param[in] _format Color format.
+/// @param[in] _depthFormat Depth format, `TextureFormat::Count` for no depth.
+///
+FrameBufferHandle createFrameBuffer(uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                                    TextureFormat::Enum _depthFormat = TextureFormat::Count);
+
+/// Destroy frame buffer after current frame is submitted, then views rendering into it go back to
+/// backbuffer. Readbacks already issued still complete.
+void destroy(FrameBufferHandle _handle);
+
+/// Set view render target. Pass invalid handle to render into backbuffer. View rect is not
+/// changed, set it to frame buffer size with `setViewRect`.
+void setViewFrameBuffer(ViewId _id, FrameBufferHandle _handle);
+
+/// Copy frame buffer color to CPU memory without waiting for GPU. Contents are captured at the end
+/// of this frame, after all views executed. `_fn` is called from a later `endFrame`, once GPU got
+/// there, readbacks from several frames can be in flight. `_data` is NULL when frame buffer was
+/// destroyed in the same frame. Don't call renderer API from `_fn`.
+///
+/// @param[in] _handle Frame buffer, invalid handle for backbuffer.
+///
+/// @returns `false` when `BGFX_CONFIG_MAX_READBACKS` readbacks are already queued or in flight.
+///
+bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData = NULL);
 
 } // namespace TinyRender
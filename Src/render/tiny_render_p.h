@@ -2,14 +2,22 @@
 
 #include <bx/platform.h>
 
+#include <bx/allocator.h>
+#include <bx/cpu.h>
 #include <bx/handlealloc.h>
+#include <bx/hash.h>
 #include <bx/math.h>
 #include <bx/float4x4_t.h>
 #include <bx/string.h>
+#include <bx/timer.h>
 
+#include "job.h"
+#include "mipgen.h"
+#include "profiler.h"
 #include "tiny_render.h"
 
 #define BGFX_CONFIG_RENDERER_DIRECT3D12 1
+#define BGFX_CONFIG_RENDERER_NOOP 1
 
 #define BGFX_CONFIG_DEBUG BX_CONFIG_DEBUG
 
@@ -68,12 +76,34 @@ struct Rect
     uint16_t m_height;
 };
 
+struct Clear
+{
+    void set(uint16_t _flags, uint32_t _rgba, float _depth, uint8_t _stencil)
+    {
+        m_flags = _flags;
+        m_color[0] = float((_rgba >> 24) & 0xff) / 255.0f;
+        m_color[1] = float((_rgba >> 16) & 0xff) / 255.0f;
+        m_color[2] = float((_rgba >> 8) & 0xff) / 255.0f;
+        m_color[3] = float((_rgba >> 0) & 0xff) / 255.0f;
+        m_depth = _depth;
+        m_stencil = _stencil;
+    }
+
+    float m_color[4];
+    float m_depth;
+    uint16_t m_flags; //!< `BGFX_CLEAR_*`
+    uint8_t m_stencil;
+};
+
 BX_ALIGN_DECL_CACHE_LINE(struct) View
 {
     void reset()
     {
         setRect(0, 0, 1, 1);
         setTransform(NULL, NULL);
+        m_clear.set(BGFX_CLEAR_NONE, 0x000000ff, 1.0f, 0);
+        m_fbh.idx = kInvalidHandle;
+        m_mode = ViewMode::Default;
     }
 
     void setRect(uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height)
@@ -109,12 +139,183 @@ BX_ALIGN_DECL_CACHE_LINE(struct) View
     Rect m_rect;
     Matrix4 m_view;
     Matrix4 m_proj;
+    Clear m_clear;
+    FrameBufferHandle m_fbh; //!< Render target, invalid for backbuffer.
+    ViewMode::Enum m_mode;
+};
+
+/// Draw sort key. View id is in the top bits, so views execute in order, then pass, bits below
+/// depend on view mode. Keys are radix sorted, which is stable, draws with equal keys keep
+/// submission order.
+struct SortKey
+{
+    static const uint32_t kViewShift = 56;
+    static const uint32_t kPassShift = 54;
+    static const uint32_t kPayloadShift = 22;
+
+    /// Passes of a view, executed in this order. Only `ViewMode::DepthPrePass` views use first two.
+    enum Pass
+    {
+        PassDepth,   //!< Depth-only pre-pass, front to back.
+        PassOpaque,  //!< Shading of draws that went through pre-pass.
+        PassDefault, //!< All other draws.
+    };
+
+    static uint64_t encode(ViewId _id, const View &_view, Pass _pass, PSOHandle _pso, const float *_mtx)
+    {
+        uint64_t payload = 0;
+
+        switch (_pass)
+        {
+        case PassDepth:
+            payload = depthBits(_view, _mtx);
+            break;
+
+        case PassOpaque:
+            payload = _pso.idx;
+            break;
+
+        default:
+            switch (_view.m_mode)
+            {
+            case ViewMode::Default:
+            case ViewMode::DepthPrePass:
+                payload = _pso.idx;
+                break;
+
+            case ViewMode::DepthAscending:
+                payload = depthBits(_view, _mtx);
+                break;
+
+            case ViewMode::DepthDescending:
+                payload = ~depthBits(_view, _mtx);
+                break;
+
+            default:
+                break;
+            }
+            break;
+        }
+
+        return (uint64_t(_id) << kViewShift) | (uint64_t(_pass) << kPassShift) | (payload << kPayloadShift);
+    }
+
+    static ViewId decodeView(uint64_t _key)
+    {
+        return ViewId(_key >> kViewShift);
+    }
+
+    static Pass decodePass(uint64_t _key)
+    {
+        return Pass((_key >> kPassShift) & 3);
+    }
+
+    /// View space depth of draw origin, with float bits flipped so they sort as unsigned integers.
+    static uint32_t depthBits(const View &_view, const float *_mtx)
+    {
+        const float *view = _view.m_view.un.val;
+        const float x = NULL != _mtx ? _mtx[12] : 0.0f;
+        const float y = NULL != _mtx ? _mtx[13] : 0.0f;
+        const float z = NULL != _mtx ? _mtx[14] : 0.0f;
+        const float depth = x * view[2] + y * view[6] + z * view[10] + view[14];
+
+        uint32_t bits = bx::floatToBits(depth);
+        bits ^= 0 != (bits & UINT32_C(0x80000000)) ? UINT32_MAX : UINT32_C(0x80000000);
+        return bits;
+    }
+};
+
+static_assert(BGFX_CONFIG_MAX_VIEWS <= 256, "View id must fit into sort key view bits.");
+
+/// Draw recorded into frame, executed at `endFrame`. Touched views get draw with invalid PSO.
+struct RenderDraw
+{
+    VertexBufferHandle m_vbh;
+    IndexBufferHandle m_ibh;
+    ProgramHandle m_program;
+    PSOHandle m_pso;
+    uint64_t m_state;
+    bool m_transient;
+    bool m_tibValid;
+    uint32_t m_firstIndex;
+    uint32_t m_numIndices;
+    uint32_t m_mtx; //!< Matrix cache index, `UINT32_MAX` for none.
+
+    // Transient draws only, buffers are regions of frame transient buffers.
+    uint32_t m_tvbOffset;
+    uint32_t m_tvbSize;
+    uint32_t m_tibOffset;
+    uint32_t m_tibSize;
+    uint16_t m_tvbStride;
+    bool m_tibIndex16;
+};
+
+/// Readback requested this frame or in flight. Context keeps as many slots as backend, so backend
+/// never runs out of them when queued readbacks are submitted.
+struct ReadbackRequest
+{
+    FrameBufferHandle m_handle;
+    ReadbackFn m_fn; //!< NULL when slot is free.
+    void *m_userData;
+};
+
+/// Frame region of backend transient buffer. Allocation is a lock-free bump of `offset`.
+struct TransientBuffer
+{
+    uint8_t *data;
+    uint32_t size;
+    volatile uint32_t offset;
 };
 
+/// Returns number of primitives `_numIndices` indices, or vertices, make with `BGFX_STATE_PT_*`
+/// topology of `_state`.
+inline uint32_t getNumPrims(uint64_t _state, uint32_t _numIndices)
+{
+    struct PrimInfo
+    {
+        uint32_t m_min;
+        uint32_t m_div;
+        uint32_t m_sub;
+    };
+
+    static const PrimInfo s_primInfo[] = {
+        {3, 3, 0}, // TriList
+        {3, 1, 2}, // TriStrip
+        {2, 2, 0}, // Lines
+        {2, 1, 1}, // LineStrip
+        {1, 1, 0}, // Points
+    };
+
+    const uint32_t pt = uint32_t((_state & BGFX_STATE_PT_MASK) >> BGFX_STATE_PT_SHIFT);
+    BX_ASSERT(pt < BX_COUNTOF(s_primInfo), "Invalid primitive type %d.", pt);
+    const PrimInfo &info = s_primInfo[pt];
+    return _numIndices < info.m_min ? 0 : (_numIndices - info.m_sub) / info.m_div;
+}
+
+/// Work and time backend spent on a frame, reported by `RendererContextI::endFrame`.
+struct FrameStats
+{
+    void reset()
+    {
+        bx::memSet(this, 0, sizeof(FrameStats));
+    }
+
+    int64_t cpuTimeBackend;
+    int64_t cpuTimePresent;
+    int64_t cpuTimeFenceWait;
+    uint32_t numDraw;
+    uint32_t numPrims;
+    uint32_t numPsoBinds;
+    uint32_t numRootSignatureBinds;
+    uint32_t numVertexBufferBinds;
+    uint32_t numIndexBufferBinds;
+    uint64_t uploadedBytes;
+};
 
 struct BX_NO_VTABLE RendererContextI
 {
     virtual ~RendererContextI() = 0;
+    virtual RendererType::Enum getRendererType() const = 0;
     virtual void createIndexBuffer(IndexBufferHandle _handle, const void *_data, uint32_t _size, uint16_t _flags) = 0;
     virtual void destroyIndexBuffer(IndexBufferHandle _handle) = 0;
     virtual void createVertexLayout(VertexLayoutHandle _handle, const VertexLayout &_layout) = 0;
@@ -122,12 +323,38 @@ struct BX_NO_VTABLE RendererContextI
     virtual void createVertexBuffer(VertexBufferHandle _handle, const void *_data, uint32_t _size,
                                     VertexLayoutHandle _layoutHandle, uint16_t _flags) = 0;
     virtual void destroyVertexBuffer(VertexBufferHandle _handle) = 0;
-    virtual void createShader(ShaderHandle _handle, const void *_data, uint32_t _size, ShaderType _type) = 0;
+    /// Update buffer created with NULL data. Buffers created with `BGFX_BUFFER_ALLOW_RESIZE` grow to fit.
+    virtual void updateVertexBuffer(VertexBufferHandle _handle, uint32_t _offset, uint32_t _size,
+                                    const void *_data) = 0;
+    virtual void updateIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size,
+                                   const void *_data) = 0;
+    virtual bool createShader(ShaderHandle _handle, const void *_data, uint32_t _size, ShaderType _type) = 0;
+    virtual void destroyShader(ShaderHandle _handle) = 0;
+    /// Called from any thread, must not touch renderer state.
+    virtual uint8_t *compileShader(const void *_data, uint32_t _size, ShaderType _type, uint32_t &_outSize) = 0;
     virtual void createProgram(ProgramHandle _handle, ShaderHandle _vsh, ShaderHandle _fsh) = 0;
-    virtual void createPSO(PSOHandle _handle, ProgramHandle _program, const VertexLayout &_layout, uint16_t _flags) = 0;
-    virtual void beginFrame(const View &_view) = 0;
-    virtual void endFrame() = 0;
-    virtual void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso, uint16_t _state, const void* _mtx) = 0;
+    virtual void createPSO(PSOHandle _handle, ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags) = 0;
+    /// Bind view render target, clear it and set viewport. Called at `endFrame` for every executed
+    /// view, in order, before its draws.
+    virtual void beginView(const View &_view) = 0;
+    virtual void endFrame(FrameStats &_stats) = 0;
+    virtual void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex, uint32_t _numIndices,
+                          ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx) = 0;
+    virtual void drawTransient(const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+                               ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx) = 0;
+    /// Point transient buffers to region of the frame being recorded.
+    virtual void resetTransientBuffers(TransientBuffer &_vb, TransientBuffer &_ib) = 0;
+    /// Create texture, `_data` is NULL or `_info.storageSize` bytes of all sides and mips.
+    virtual void createTexture(TextureHandle _handle, const TextureInfo &_info, const void *_data) = 0;
+    /// Upload rectangle of mip, rect is validated by frontend. `_data` is valid only during the call.
+    virtual void updateTexture(TextureHandle _handle, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y,
+                               uint16_t _width, uint16_t _height, const void *_data, uint32_t _pitch) = 0;
+    virtual void destroyTexture(TextureHandle _handle) = 0;
+    virtual void createFrameBuffer(FrameBufferHandle _handle, uint16_t _width, uint16_t _height,
+                                   TextureFormat::Enum _format, TextureFormat::Enum _depthFormat) = 0;
+    virtual void destroyFrameBuffer(FrameBufferHandle _handle) = 0;
+    /// Record copy of frame buffer color, `_fn` is called from `endFrame` once GPU finished it.
+    virtual bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData) = 0;
 };
 
 inline RendererContextI::~RendererContextI() {}
@@ -138,24 +365,85 @@ inline RendererContextI::~RendererContextI() {}
 #define BGFX_API_FUNC(_func) _func
 #endif // BGFX_CONFIG_DEBUG
 
+/// Allocator accounting CPU memory to `_category`. Forwards to `entry::getAllocator`.
+bx::AllocatorI *getAllocator(MemoryCategory::Enum _category);
+
+/// Account memory that isn't allocated through `getAllocator`, like GPU resources.
+void trackAlloc(MemoryCategory::Enum _category, uint64_t _size, uint32_t _num = 1);
+
+void trackFree(MemoryCategory::Enum _category, uint64_t _size, uint32_t _num = 1);
+
+/// Compile shader source to bytecode `createShader` takes as it is. Safe on any thread between `init`
+/// and `shutdown`, so loaders can compile off API thread.
+///
+/// @returns Bytecode allocated from `getAllocator(MemoryCategory::Staging)`, NULL when source doesn't compile.
+///
+uint8_t *compileShader(const void *_data, uint32_t _size, ShaderType _type, uint32_t &_outSize);
+
 /// Dump vertex layout info into debug output.
 void dump(const VertexLayout &_layout);
 
 const char *getAttribName(Attrib::Enum _attr);
 
+uint32_t getBitsPerPixel(TextureFormat::Enum _format);
+
+bool isDepth(TextureFormat::Enum _format);
+
+/// Width and height of compression block, 1 for uncompressed formats.
+uint32_t getBlockSize(TextureFormat::Enum _format);
+
+bool isCompressed(TextureFormat::Enum _format);
+
+/// Bytes in row of `_width` pixels, without padding. Row of blocks for compressed formats.
+uint32_t calcPitch(TextureFormat::Enum _format, uint16_t _width);
 
+/// Rows in `_height` pixels, rows of blocks for compressed formats.
+uint32_t calcNumRows(TextureFormat::Enum _format, uint16_t _height);
 
+/// Number of mips, full chain ends at 1x1.
+uint8_t calcNumMips(bool _hasMips, uint16_t _width, uint16_t _height);
 
+/// Frontend view of dynamic buffer, backing buffer lives in backend.
+struct DynamicBuffer
+{
+    uint32_t m_size;   //!< Current size in bytes.
+    uint16_t m_stride; //!< Vertex or index stride.
+    uint16_t m_flags;
+};
+
+struct DynamicVertexBuffer : DynamicBuffer
+{
+    VertexBufferHandle m_handle; //!< Backing vertex buffer.
+};
+
+struct DynamicIndexBuffer : DynamicBuffer
+{
+    IndexBufferHandle m_handle; //!< Backing index buffer.
+};
+
+/// What PSO was created for. Derived PSOs are looked up by it.
+struct PSOKey
+{
+    uint64_t m_state;
+    ProgramHandle m_program;
+    VertexLayoutHandle m_layoutHandle;
+};
 
 struct Context
 {
     bool init(const InitParams &_init);
     void shutdown();
 
+    /// API thread only, it creates backend layouts. Transient vertex buffers resolve their layout when drawn.
     VertexLayoutHandle findOrCreateVertexLayout(const VertexLayout &_layout)
     {
+        VertexLayoutHandle layoutHandle = {m_layoutHashMap.find(_layout.m_hash)};
+        if (isValid(layoutHandle))
+        {
+            return layoutHandle;
+        }
 
-        VertexLayoutHandle layoutHandle = {m_layoutHandle.alloc()};
+        layoutHandle = {m_layoutHandle.alloc()};
         if (!isValid(layoutHandle))
         {
             BX_TRACE("WARNING: Failed to allocate vertex layout handle (BGFX_CONFIG_MAX_VERTEX_LAYOUTS, max: %d).",
@@ -163,6 +451,8 @@ struct Context
             return BGFX_INVALID_HANDLE;
         }
 
+        m_layoutHashMap.insert(_layout.m_hash, layoutHandle.idx);
+        m_vertexLayouts[layoutHandle.idx] = _layout;
         m_renderCtx->createVertexLayout(layoutHandle, _layout);
 
         return layoutHandle;
@@ -182,6 +472,7 @@ struct Context
                 m_vertexBufferHandle.free(handle.idx);
                 return BGFX_INVALID_HANDLE;
             }
+            m_vertexBufferLayout[handle.idx] = layoutHandle;
             m_renderCtx->createVertexBuffer(handle, _data, _size, layoutHandle, _flags);
         }
         return handle;
@@ -198,17 +489,156 @@ struct Context
         return handle;
     }
 
+    BGFX_API_FUNC(DynamicVertexBufferHandle createDynamicVertexBuffer(uint32_t _num, const VertexLayout &_layout,
+                                                                      uint16_t _flags))
+    {
+        const uint64_t size = uint64_t(_num) * _layout.getStride();
+        if (size > UINT32_MAX)
+        {
+            BX_TRACE("WARNING: Dynamic vertex buffer of %u vertices is too large.", _num);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        DynamicVertexBufferHandle handle = {m_dynamicVertexBufferHandle.alloc()};
+        BX_WARN(isValid(handle), "Failed to allocate dynamic vertex buffer handle.");
+        if (!isValid(handle))
+        {
+            return handle;
+        }
+
+        VertexBufferHandle vbh = createVertexBuffer(NULL, uint32_t(size), _layout, _flags);
+        if (!isValid(vbh))
+        {
+            m_dynamicVertexBufferHandle.free(handle.idx);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        DynamicVertexBuffer &dvb = m_dynamicVertexBuffers[handle.idx];
+        dvb.m_handle = vbh;
+        dvb.m_size = uint32_t(size);
+        dvb.m_stride = _layout.getStride();
+        dvb.m_flags = _flags;
+        return handle;
+    }
+
+    BGFX_API_FUNC(DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint16_t _flags))
+    {
+        const uint64_t size = uint64_t(_num) * (0 != (_flags & BGFX_BUFFER_INDEX32) ? 4 : 2);
+        if (size > UINT32_MAX)
+        {
+            BX_TRACE("WARNING: Dynamic index buffer of %u indices is too large.", _num);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        DynamicIndexBufferHandle handle = {m_dynamicIndexBufferHandle.alloc()};
+        BX_WARN(isValid(handle), "Failed to allocate dynamic index buffer handle.");
+        if (!isValid(handle))
+        {
+            return handle;
+        }
+
+        IndexBufferHandle ibh = createIndexBuffer(NULL, uint32_t(size), _flags);
+        if (!isValid(ibh))
+        {
+            m_dynamicIndexBufferHandle.free(handle.idx);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        DynamicIndexBuffer &dib = m_dynamicIndexBuffers[handle.idx];
+        dib.m_handle = ibh;
+        dib.m_size = uint32_t(size);
+        dib.m_stride = 0 != (_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
+        dib.m_flags = _flags;
+        return handle;
+    }
+
+    /// Validates update range, grows the buffer when allowed. Returns `false` if update must be dropped.
+    static bool checkDynamicUpdate(DynamicBuffer &_db, uint64_t _offset, uint32_t _size)
+    {
+        const uint64_t end = _offset + _size;
+        if (end <= _db.m_size)
+        {
+            return true;
+        }
+
+        if (end > UINT32_MAX)
+        {
+            BX_TRACE("WARNING: Dynamic buffer update past 4GB, size %u.", _size);
+            return false;
+        }
+
+        if (0 == (_db.m_flags & BGFX_BUFFER_ALLOW_RESIZE))
+        {
+            BX_TRACE("WARNING: Dynamic buffer update out of bounds (%u > %u) and BGFX_BUFFER_ALLOW_RESIZE is not set.",
+                     uint32_t(end), _db.m_size);
+            return false;
+        }
+
+        _db.m_size = uint32_t(end);
+        return true;
+    }
+
+    BGFX_API_FUNC(void update(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const void *_data,
+                              uint32_t _size))
+    {
+        DynamicVertexBuffer &dvb = m_dynamicVertexBuffers[_handle.idx];
+        const uint64_t offset = uint64_t(_startVertex) * dvb.m_stride;
+        if (checkDynamicUpdate(dvb, offset, _size))
+        {
+            m_renderCtx->updateVertexBuffer(dvb.m_handle, uint32_t(offset), _size, _data);
+        }
+    }
+
+    BGFX_API_FUNC(void update(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const void *_data,
+                              uint32_t _size))
+    {
+        DynamicIndexBuffer &dib = m_dynamicIndexBuffers[_handle.idx];
+        const uint64_t offset = uint64_t(_startIndex) * dib.m_stride;
+        if (checkDynamicUpdate(dib, offset, _size))
+        {
+            m_renderCtx->updateIndexBuffer(dib.m_handle, uint32_t(offset), _size, _data);
+        }
+    }
+
+    // Draws recorded this frame may still use destroyed resources, destruction waits for `endFrame`.
+
+    BGFX_API_FUNC(void destroy(DynamicVertexBufferHandle _handle))
+    {
+        m_freeDynamicVertexBuffers[m_numFreeDynamicVertexBuffers++] = _handle;
+    }
+
+    BGFX_API_FUNC(void destroy(DynamicIndexBufferHandle _handle))
+    {
+        m_freeDynamicIndexBuffers[m_numFreeDynamicIndexBuffers++] = _handle;
+    }
+
     BGFX_API_FUNC(ShaderHandle createShader(const void *_data, uint32_t _size, ShaderType _type))
     {
         ShaderHandle handle = {m_shaderHandle.alloc()};
         BX_WARN(isValid(handle), "Failed to allocate shader handle.");
-        if (isValid(handle))
+        if (isValid(handle) && !m_renderCtx->createShader(handle, _data, _size, _type))
         {
-            m_renderCtx->createShader(handle, _data, _size, _type);
+            m_shaderHandle.free(handle.idx);
+            return BGFX_INVALID_HANDLE;
         }
         return handle;
     }
 
+    BGFX_API_FUNC(void destroy(VertexBufferHandle _handle))
+    {
+        m_freeVertexBuffers[m_numFreeVertexBuffers++] = _handle;
+    }
+
+    BGFX_API_FUNC(void destroy(IndexBufferHandle _handle))
+    {
+        m_freeIndexBuffers[m_numFreeIndexBuffers++] = _handle;
+    }
+
+    BGFX_API_FUNC(void destroy(ShaderHandle _handle))
+    {
+        m_freeShaders[m_numFreeShaders++] = _handle;
+    }
+
     BGFX_API_FUNC(ProgramHandle createProgram(ShaderHandle _vsh, ShaderHandle _fsh))
     {
         ProgramHandle handle = {m_programHandle.alloc()};
@@ -220,17 +650,79 @@ struct Context
         return handle;
     }
 
-    BGFX_API_FUNC(PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint16_t _flags))
+    BGFX_API_FUNC(PSOHandle createPSO(ProgramHandle _program, const VertexLayout &_layout, uint64_t _flags))
     {
         PSOHandle handle = {m_psoHandle.alloc()};
         BX_WARN(isValid(handle), "Failed to allocate pso handle.");
         if (isValid(handle))
-        {   
+        {
             m_renderCtx->createPSO(handle, _program, _layout, _flags);
+
+            PSOKey &key = m_psoKey[handle.idx];
+            key.m_state = _flags;
+            key.m_program = _program;
+            key.m_layoutHandle = BGFX_INVALID_HANDLE;
         }
         return handle;
     }
 
+    /// Returns PSO for program, vertex layout and render state, PSO is created on first use and
+    /// shared by every draw with the same triple.
+    PSOHandle findOrCreatePSO(ProgramHandle _program, VertexLayoutHandle _layoutHandle, uint64_t _state)
+    {
+        // Colliding triples are rehashed with next seed.
+        for (uint32_t seed = 0; seed < 4; ++seed)
+        {
+            bx::HashMurmur2A murmur;
+            murmur.begin(seed);
+            murmur.add(_state);
+            murmur.add(_program.idx);
+            murmur.add(_layoutHandle.idx);
+            const uint32_t hash = murmur.end();
+
+            PSOHandle handle = {m_psoHashMap.find(hash)};
+            if (isValid(handle))
+            {
+                const PSOKey &key = m_psoKey[handle.idx];
+                if (key.m_state == _state && key.m_program.idx == _program.idx &&
+                    key.m_layoutHandle.idx == _layoutHandle.idx)
+                {
+                    return handle;
+                }
+                continue;
+            }
+
+            handle = createPSO(_program, m_vertexLayouts[_layoutHandle.idx], _state);
+            if (isValid(handle))
+            {
+                m_psoKey[handle.idx].m_layoutHandle = _layoutHandle;
+                m_psoHashMap.insert(hash, handle.idx);
+            }
+            return handle;
+        }
+
+        BX_TRACE("WARNING: Too many PSO hash collisions, state 0x%016llx.", (unsigned long long)_state);
+        return BGFX_INVALID_HANDLE;
+    }
+
+    /// Resolves invalid `_pso` of draw to derived PSO. Returns `false` when draw has no PSO.
+    bool resolvePSO(PSOHandle &_pso, ProgramHandle _program, VertexLayoutHandle _layoutHandle, uint64_t _state)
+    {
+        if (isValid(_pso))
+        {
+            return true;
+        }
+
+        if (!isValid(_program) || !isValid(_layoutHandle))
+        {
+            BX_TRACE("WARNING: Draw without PSO needs valid program and vertex layout.");
+            return false;
+        }
+
+        _pso = findOrCreatePSO(_program, _layoutHandle, _state);
+        return isValid(_pso);
+    }
+
     BGFX_API_FUNC(void setViewTransform(ViewId _id, const void *_view, const void *_proj))
     {
         m_view[_id].setTransform(_view, _proj);
@@ -241,37 +733,512 @@ struct Context
         m_view[_id].setRect(_x, _y, _width, _height);
     }
 
-    BGFX_API_FUNC(void beginFrame(ViewId _id))
+    BGFX_API_FUNC(void setViewClear(ViewId _id, uint16_t _flags, uint32_t _rgba, float _depth, uint8_t _stencil))
+    {
+        m_view[_id].m_clear.set(_flags, _rgba, _depth, _stencil);
+    }
+
+    BGFX_API_FUNC(void setViewMode(ViewId _id, ViewMode::Enum _mode))
     {
-        m_renderCtx->beginFrame(m_view[_id]);
+        m_view[_id].m_mode = _mode;
     }
 
+    BGFX_API_FUNC(void touch(ViewId _id))
+    {
+        const PSOHandle invalid = BGFX_INVALID_HANDLE;
+        addDraw(_id, invalid, BGFX_STATE_NONE, NULL);
+    }
+
+    /// Append draw to current frame. `BGFX_STATE_NONE` state is resolved to PSO state. Returns NULL
+    /// when frame is full.
+    RenderDraw *addDraw(ViewId _id, PSOHandle _pso, uint64_t _state, const void *_mtx)
+    {
+        if (BX_UNLIKELY(m_numDraws >= BGFX_CONFIG_MAX_DRAW_CALLS))
+        {
+            BX_TRACE("WARNING: Too many draws in frame (BGFX_CONFIG_MAX_DRAW_CALLS, max: %d).",
+                     BGFX_CONFIG_MAX_DRAW_CALLS);
+            return NULL;
+        }
+
+        const uint64_t state = BGFX_STATE_NONE == _state && isValid(_pso) ? m_psoKey[_pso.idx].m_state : _state;
+
+        const uint32_t idx = m_numDraws++;
+        const View &view = m_view[_id];
+        if (ViewMode::DepthPrePass == view.m_mode && 0 != (state & BGFX_STATE_WRITE_Z))
+        {
+            m_sortKeys[m_numKeys] = SortKey::encode(_id, view, SortKey::PassDepth, _pso, (const float *)_mtx);
+            m_sortValues[m_numKeys++] = idx;
+            m_sortKeys[m_numKeys] = SortKey::encode(_id, view, SortKey::PassOpaque, _pso, (const float *)_mtx);
+            m_sortValues[m_numKeys++] = idx;
+        }
+        else
+        {
+            m_sortKeys[m_numKeys] = SortKey::encode(_id, view, SortKey::PassDefault, _pso, (const float *)_mtx);
+            m_sortValues[m_numKeys++] = idx;
+        }
+
+        RenderDraw &draw = m_draws[idx];
+        draw.m_pso = _pso;
+        draw.m_state = state;
+        draw.m_transient = false;
+        draw.m_mtx = UINT32_MAX;
+        if (NULL != _mtx)
+        {
+            draw.m_mtx = m_numMatrices++;
+            bx::memCopy(m_matrixCache[draw.m_mtx].un.val, _mtx, sizeof(Matrix4));
+        }
+
+        return &draw;
+    }
+
+    /// Sort recorded draws and execute views in order, then issue queued readbacks.
+    void submit();
+
+    /// Destroy resources whose destruction waited for frame submission.
+    void freeDeferred();
+
+    static void readbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                 uint16_t _height, TextureFormat::Enum _format, void *_userData);
+
     BGFX_API_FUNC(void endFrame())
     {
-        m_renderCtx->endFrame();
+        const uint64_t transientBytes = m_transientVb.offset + m_transientIb.offset;
+
+        submit();
+        freeDeferred();
+
+        FrameStats frameStats;
+        m_renderCtx->endFrame(frameStats);
+        m_renderCtx->resetTransientBuffers(m_transientVb, m_transientIb);
+
+        const int64_t now = bx::getHPCounter();
+
+        m_stats.cpuTimeFrame = now - m_frameTime;
+        m_stats.cpuTimeSubmit = m_cpuTimeSubmit;
+        m_stats.cpuTimeSort = m_cpuTimeSort;
+        m_stats.cpuTimeBackend = frameStats.cpuTimeBackend;
+        m_stats.cpuTimePresent = frameStats.cpuTimePresent;
+        m_stats.cpuTimeFenceWait = frameStats.cpuTimeFenceWait;
+        m_stats.cpuTimerFreq = bx::getHPFrequency();
+        m_stats.numDraw = frameStats.numDraw;
+        m_stats.numPrims = frameStats.numPrims;
+        m_stats.numPsoBinds = frameStats.numPsoBinds;
+        m_stats.numRootSignatureBinds = frameStats.numRootSignatureBinds;
+        m_stats.numVertexBufferBinds = frameStats.numVertexBufferBinds;
+        m_stats.numIndexBufferBinds = frameStats.numIndexBufferBinds;
+        m_stats.uploadedBytes = frameStats.uploadedBytes + transientBytes;
+
+        m_frameTime = now;
+        m_cpuTimeSubmit = 0;
+        m_cpuTimeSort = 0;
+    }
+
+    static uint32_t allocTransient(TransientBuffer &_tb, uint32_t _size)
+    {
+        // Sizes near UINT32_MAX would wrap when aligned.
+        if (_size > _tb.size)
+        {
+            return UINT32_MAX;
+        }
+
+        const uint32_t size = bx::alignUp(_size, 16);
+
+        for (;;)
+        {
+            const uint32_t offset = _tb.offset;
+            const uint32_t end = offset + size;
+            if (end > _tb.size || end < offset)
+            {
+                return UINT32_MAX;
+            }
+
+            if (offset == bx::atomicCompareAndSwap<uint32_t>(&_tb.offset, offset, end))
+            {
+                return offset;
+            }
+        }
+    }
+
+    static uint32_t getAvailTransient(const TransientBuffer &_tb, uint32_t _num, uint32_t _stride)
+    {
+        const uint32_t offset = bx::alignUp(_tb.offset, 16);
+        const uint32_t avail = bx::uint32_satsub(_tb.size, offset) / _stride;
+        return bx::uint32_min(avail, _num);
     }
-    
 
-    BGFX_API_FUNC(void drawMesh(VertexBufferHandle _vbh, IndexBufferHandle _ibh, ProgramHandle _program, PSOHandle _pso, uint16_t _state, const void* _mtx))
+    BGFX_API_FUNC(uint32_t getAvailTransientVertexBuffer(uint32_t _num, const VertexLayout &_layout))
     {
-        m_renderCtx->drawMesh(_vbh, _ibh, _program, _pso, _state, _mtx);
+        return getAvailTransient(m_transientVb, _num, _layout.getStride());
+    }
+
+    BGFX_API_FUNC(uint32_t getAvailTransientIndexBuffer(uint32_t _num, bool _index32))
+    {
+        return getAvailTransient(m_transientIb, _num, _index32 ? 4 : 2);
+    }
+
+    BGFX_API_FUNC(bool allocTransientVertexBuffer(TransientVertexBuffer *_tvb, uint32_t _num,
+                                                  const VertexLayout &_layout))
+    {
+        const uint16_t stride = _layout.getStride();
+        if (0 == stride || _num > UINT32_MAX / stride)
+        {
+            BX_TRACE("WARNING: Transient vertex buffer size overflows (num: %u, stride: %u).", _num, stride);
+            bx::memSet(_tvb, 0, sizeof(TransientVertexBuffer));
+            return false;
+        }
+
+        const uint32_t size = _num * stride;
+        const uint32_t offset = allocTransient(m_transientVb, size);
+
+        if (UINT32_MAX == offset)
+        {
+            BX_TRACE("WARNING: Transient vertex buffer exhausted (BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE, max: %d).",
+                     BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE);
+            bx::memSet(_tvb, 0, sizeof(TransientVertexBuffer));
+            return false;
+        }
+
+        _tvb->data = &m_transientVb.data[offset];
+        _tvb->size = size;
+        _tvb->offset = offset;
+        _tvb->stride = stride;
+        _tvb->layout = _layout;
+        return true;
+    }
+
+    BGFX_API_FUNC(bool allocTransientIndexBuffer(TransientIndexBuffer *_tib, uint32_t _num, bool _index32))
+    {
+        const uint32_t indexSize = _index32 ? 4 : 2;
+        if (_num > UINT32_MAX / indexSize)
+        {
+            BX_TRACE("WARNING: Transient index buffer size overflows (num: %u).", _num);
+            bx::memSet(_tib, 0, sizeof(TransientIndexBuffer));
+            return false;
+        }
+
+        const uint32_t size = _num * indexSize;
+        const uint32_t offset = allocTransient(m_transientIb, size);
+
+        if (UINT32_MAX == offset)
+        {
+            BX_TRACE("WARNING: Transient index buffer exhausted (BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE, max: %d).",
+                     BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
+            bx::memSet(_tib, 0, sizeof(TransientIndexBuffer));
+            return false;
+        }
+
+        _tib->data = &m_transientIb.data[offset];
+        _tib->size = size;
+        _tib->offset = offset;
+        _tib->isIndex16 = !_index32;
+        return true;
+    }
+
+    BGFX_API_FUNC(void drawMesh(ViewId _id, VertexBufferHandle _vbh, IndexBufferHandle _ibh, uint32_t _firstIndex,
+                                uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso, uint64_t _state,
+                                const void *_mtx))
+    {
+        BGFX_PROFILER_SCOPE("Context::drawMesh");
+        const int64_t start = bx::getHPCounter();
+
+        if (!isValid(_vbh) || !m_vertexBufferHandle.isValid(_vbh.idx))
+        {
+            BX_TRACE("WARNING: Draw with invalid vertex buffer handle %d.", _vbh.idx);
+            m_cpuTimeSubmit += bx::getHPCounter() - start;
+            return;
+        }
+
+        if (!resolvePSO(_pso, _program, m_vertexBufferLayout[_vbh.idx], _state))
+        {
+            m_cpuTimeSubmit += bx::getHPCounter() - start;
+            return;
+        }
+
+        RenderDraw *draw = addDraw(_id, _pso, _state, _mtx);
+        if (NULL != draw)
+        {
+            draw->m_vbh = _vbh;
+            draw->m_ibh = _ibh;
+            draw->m_firstIndex = _firstIndex;
+            draw->m_numIndices = _numIndices;
+            draw->m_program = _program;
+        }
+
+        m_cpuTimeSubmit += bx::getHPCounter() - start;
+    }
+
+    BGFX_API_FUNC(void drawMesh(ViewId _id, const TransientVertexBuffer *_tvb, const TransientIndexBuffer *_tib,
+                                ProgramHandle _program, PSOHandle _pso, uint64_t _state, const void *_mtx))
+    {
+        BGFX_PROFILER_SCOPE("Context::drawMesh");
+        const int64_t start = bx::getHPCounter();
+
+        // Allocation stays lock-free on encoder threads, layout is looked up here on API thread.
+        VertexLayoutHandle layoutHandle = BGFX_INVALID_HANDLE;
+        if (!isValid(_pso))
+        {
+            layoutHandle = findOrCreateVertexLayout(_tvb->layout);
+        }
+
+        if (!resolvePSO(_pso, _program, layoutHandle, _state))
+        {
+            m_cpuTimeSubmit += bx::getHPCounter() - start;
+            return;
+        }
+
+        RenderDraw *draw = addDraw(_id, _pso, _state, _mtx);
+        if (NULL != draw)
+        {
+            draw->m_transient = true;
+            draw->m_tvbOffset = _tvb->offset;
+            draw->m_tvbSize = _tvb->size;
+            draw->m_tvbStride = _tvb->stride;
+            draw->m_tibValid = NULL != _tib;
+            draw->m_tibOffset = NULL != _tib ? _tib->offset : 0;
+            draw->m_tibSize = NULL != _tib ? _tib->size : 0;
+            draw->m_tibIndex16 = NULL != _tib && _tib->isIndex16;
+            draw->m_program = _program;
+        }
+
+        m_cpuTimeSubmit += bx::getHPCounter() - start;
+    }
+
+    BGFX_API_FUNC(void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, DynamicIndexBufferHandle _dibh,
+                                uint32_t _firstIndex, uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso,
+                                uint64_t _state, const void *_mtx))
+    {
+        if (!isValid(_dvbh) || !m_dynamicVertexBufferHandle.isValid(_dvbh.idx) || !isValid(_dibh) ||
+            !m_dynamicIndexBufferHandle.isValid(_dibh.idx))
+        {
+            BX_TRACE("WARNING: Draw with invalid dynamic buffer handle, vb %d, ib %d.", _dvbh.idx, _dibh.idx);
+            return;
+        }
+
+        drawMesh(_id, m_dynamicVertexBuffers[_dvbh.idx].m_handle, m_dynamicIndexBuffers[_dibh.idx].m_handle,
+                 _firstIndex, _numIndices, _program, _pso, _state, _mtx);
+    }
+
+    BGFX_API_FUNC(void drawMesh(ViewId _id, DynamicVertexBufferHandle _dvbh, IndexBufferHandle _ibh,
+                                uint32_t _firstIndex, uint32_t _numIndices, ProgramHandle _program, PSOHandle _pso,
+                                uint64_t _state, const void *_mtx))
+    {
+        if (!isValid(_dvbh) || !m_dynamicVertexBufferHandle.isValid(_dvbh.idx))
+        {
+            BX_TRACE("WARNING: Draw with invalid dynamic vertex buffer handle %d.", _dvbh.idx);
+            return;
+        }
+
+        drawMesh(_id, m_dynamicVertexBuffers[_dvbh.idx].m_handle, _ibh, _firstIndex, _numIndices, _program, _pso,
+                 _state, _mtx);
+    }
+
+    BGFX_API_FUNC(TextureHandle createTexture(uint16_t _width, uint16_t _height, bool _cubeMap, bool _hasMips,
+                                              TextureFormat::Enum _format, const void *_data, uint32_t _size))
+    {
+        TextureInfo info;
+        calcTextureSize(info, _width, _height, _cubeMap, _hasMips, _format);
+
+        // Mip 0 of every side only, rest of chain is generated.
+        const uint32_t numSides = _cubeMap ? 6 : 1;
+        const uint32_t topSize = calcPitch(_format, info.width) * calcNumRows(_format, info.height);
+        const bool generateMips =
+            NULL != _data && 1 < info.numMips && _size == topSize * numSides && mipIsSupported(_format);
+
+        // D3D12 wants top mip of block compressed texture in whole blocks.
+        const uint32_t blockSize = getBlockSize(_format);
+        if (0 != info.width % blockSize || 0 != info.height % blockSize)
+        {
+            BX_TRACE("WARNING: Texture size %dx%d isn't multiple of %dx%d blocks.", info.width, info.height, blockSize,
+                     blockSize);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        if (NULL != _data && _size != info.storageSize && !generateMips)
+        {
+            BX_TRACE("WARNING: Texture data size %d doesn't match texture size %d (%dx%d, %d mips).", _size,
+                     info.storageSize, info.width, info.height, info.numMips);
+            return BGFX_INVALID_HANDLE;
+        }
+
+        TextureHandle handle = {m_textureHandle.alloc()};
+        BX_WARN(isValid(handle), "Failed to allocate texture handle.");
+        if (isValid(handle))
+        {
+            m_textureInfo[handle.idx] = info;
+
+            if (generateMips)
+            {
+                BGFX_PROFILER_SCOPE("Context::createTexture mips");
+
+                bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+                uint8_t *data = (uint8_t *)bx::alloc(allocator, info.storageSize, 16);
+
+                const uint32_t sideSize = info.storageSize / numSides;
+                for (uint32_t side = 0; side < numSides; ++side)
+                {
+                    bx::memCopy(&data[side * sideSize], (const uint8_t *)_data + side * topSize, topSize);
+                }
+
+                mipGenerate(data, info, MipFilter::Box, &m_jobPool, allocator);
+                m_renderCtx->createTexture(handle, info, data);
+                bx::free(allocator, data, 16);
+            }
+            else
+            {
+                m_renderCtx->createTexture(handle, info, _data);
+            }
+        }
+        return handle;
+    }
+
+    BGFX_API_FUNC(void updateTexture2D(TextureHandle _handle, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _width,
+                                       uint16_t _height, const void *_data, uint32_t _pitch))
+    {
+        const TextureInfo &info = m_textureInfo[_handle.idx];
+        const uint32_t mipWidth = bx::max(1, info.width >> _mip);
+        const uint32_t mipHeight = bx::max(1, info.height >> _mip);
+        if (_mip >= info.numMips || uint32_t(_x) + _width > mipWidth || uint32_t(_y) + _height > mipHeight)
+        {
+            BX_TRACE("WARNING: Texture update out of bounds, mip %d rect %d,%d %dx%d, mip size %dx%d.", _mip, _x, _y,
+                     _width, _height, mipWidth, mipHeight);
+            return;
+        }
+
+        // Compressed updates cover whole blocks, partial block only at mip edge.
+        const uint32_t blockSize = getBlockSize(info.format);
+        if (0 != _x % blockSize || 0 != _y % blockSize ||
+            (0 != _width % blockSize && uint32_t(_x) + _width != mipWidth) ||
+            (0 != _height % blockSize && uint32_t(_y) + _height != mipHeight))
+        {
+            BX_TRACE("WARNING: Texture update rect %d,%d %dx%d isn't aligned to %dx%d blocks.", _x, _y, _width, _height,
+                     blockSize, blockSize);
+            return;
+        }
+
+        if (0 == _width || 0 == _height)
+        {
+            return;
+        }
+
+        const uint32_t pitch = UINT32_MAX == _pitch ? calcPitch(info.format, _width) : _pitch;
+        m_renderCtx->updateTexture(_handle, 0, _mip, _x, _y, _width, _height, _data, pitch);
+    }
+
+    BGFX_API_FUNC(void destroy(TextureHandle _handle))
+    {
+        m_freeTextures[m_numFreeTextures++] = _handle;
+    }
+
+    BGFX_API_FUNC(FrameBufferHandle createFrameBuffer(uint16_t _width, uint16_t _height, TextureFormat::Enum _format,
+                                                      TextureFormat::Enum _depthFormat))
+    {
+        BX_ASSERT(!isCompressed(_format), "Frame buffer format %d can't be block compressed.", _format);
+
+        FrameBufferHandle handle = {m_frameBufferHandle.alloc()};
+        BX_WARN(isValid(handle), "Failed to allocate frame buffer handle.");
+        if (isValid(handle))
+        {
+            m_renderCtx->createFrameBuffer(handle, _width, _height, _format, _depthFormat);
+        }
+        return handle;
+    }
+
+    BGFX_API_FUNC(void destroy(FrameBufferHandle _handle))
+    {
+        m_freeFrameBuffers[m_numFreeFrameBuffers++] = _handle;
+    }
+
+    BGFX_API_FUNC(void setViewFrameBuffer(ViewId _id, FrameBufferHandle _handle))
+    {
+        m_view[_id].m_fbh = _handle;
+    }
+
+    BGFX_API_FUNC(bool readFrameBuffer(FrameBufferHandle _handle, ReadbackFn _fn, void *_userData))
+    {
+        for (uint16_t ii = 0; ii < BX_COUNTOF(m_readbacks); ++ii)
+        {
+            ReadbackRequest &request = m_readbacks[ii];
+            if (NULL == request.m_fn)
+            {
+                request.m_handle = _handle;
+                request.m_fn = _fn;
+                request.m_userData = _userData;
+                m_readbackQueue[m_numQueuedReadbacks++] = ii;
+                return true;
+            }
+        }
+
+        BX_TRACE("Too many readbacks in flight (BGFX_CONFIG_MAX_READBACKS, max: %d).", BGFX_CONFIG_MAX_READBACKS);
+        return false;
     }
 
     RendererContextI *m_renderCtx;
 
     bx::HandleAllocT<BGFX_CONFIG_MAX_INDEX_BUFFERS> m_indexBufferHandle;
     bx::HandleAllocT<BGFX_CONFIG_MAX_VERTEX_LAYOUTS> m_layoutHandle;
+    bx::HandleHashMapT<BGFX_CONFIG_MAX_VERTEX_LAYOUTS * 2> m_layoutHashMap;
+    bx::HandleAllocT<BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS> m_dynamicVertexBufferHandle;
+    bx::HandleAllocT<BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS> m_dynamicIndexBufferHandle;
 
     bx::HandleAllocT<BGFX_CONFIG_MAX_VERTEX_BUFFERS> m_vertexBufferHandle;
     bx::HandleAllocT<BGFX_CONFIG_MAX_SHADERS> m_shaderHandle;
     bx::HandleAllocT<BGFX_CONFIG_MAX_PROGRAMS> m_programHandle;
     bx::HandleAllocT<BGFX_CONFIG_MAX_PSOS> m_psoHandle;
-    // bx::HandleAllocT<BGFX_CONFIG_MAX_TEXTURES> m_textureHandle;
-    // bx::HandleAllocT<BGFX_CONFIG_MAX_FRAME_BUFFERS> m_frameBufferHandle;
+    bx::HandleHashMapT<BGFX_CONFIG_MAX_PSOS * 2> m_psoHashMap;
+    bx::HandleAllocT<BGFX_CONFIG_MAX_TEXTURES> m_textureHandle;
+    bx::HandleAllocT<BGFX_CONFIG_MAX_FRAME_BUFFERS> m_frameBufferHandle;
     // bx::HandleAllocT<BGFX_CONFIG_MAX_UNIFORMS> m_uniformHandle;
     // bx::HandleAllocT<BGFX_CONFIG_MAX_OCCLUSION_QUERIES> m_occlusionQueryHandle;
 
+    DynamicVertexBuffer m_dynamicVertexBuffers[BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS];
+    DynamicIndexBuffer m_dynamicIndexBuffers[BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS];
+
     View m_view[BGFX_CONFIG_MAX_VIEWS];
+
+    VertexLayout m_vertexLayouts[BGFX_CONFIG_MAX_VERTEX_LAYOUTS];
+    VertexLayoutHandle m_vertexBufferLayout[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+    PSOKey m_psoKey[BGFX_CONFIG_MAX_PSOS]; //!< Triple PSO was created with, layout is invalid for `createPSO` ones.
+    TextureInfo m_textureInfo[BGFX_CONFIG_MAX_TEXTURES];
+
+    JobPool m_jobPool; //!< Workers for CPU side resource processing, like mip generation.
+
+    // Frame being recorded. Sort values index `m_draws`, draws in depth pre-pass get two keys.
+    RenderDraw m_draws[BGFX_CONFIG_MAX_DRAW_CALLS];
+    uint64_t m_sortKeys[BGFX_CONFIG_MAX_DRAW_CALLS * 2];
+    uint64_t m_tempKeys[BGFX_CONFIG_MAX_DRAW_CALLS * 2];
+    uint32_t m_sortValues[BGFX_CONFIG_MAX_DRAW_CALLS * 2];
+    uint32_t m_tempValues[BGFX_CONFIG_MAX_DRAW_CALLS * 2];
+    Matrix4 m_matrixCache[BGFX_CONFIG_MAX_MATRIX_CACHE];
+    uint32_t m_numDraws;
+    uint32_t m_numKeys;
+    uint32_t m_numMatrices;
+
+    ReadbackRequest m_readbacks[BGFX_CONFIG_MAX_READBACKS];
+    uint16_t m_readbackQueue[BGFX_CONFIG_MAX_READBACKS]; //!< Requests of this frame, issued after views.
+    uint16_t m_numQueuedReadbacks;
+
+    VertexBufferHandle m_freeVertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+    IndexBufferHandle m_freeIndexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
+    ShaderHandle m_freeShaders[BGFX_CONFIG_MAX_SHADERS];
+    DynamicVertexBufferHandle m_freeDynamicVertexBuffers[BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS];
+    DynamicIndexBufferHandle m_freeDynamicIndexBuffers[BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS];
+    FrameBufferHandle m_freeFrameBuffers[BGFX_CONFIG_MAX_FRAME_BUFFERS];
+    TextureHandle m_freeTextures[BGFX_CONFIG_MAX_TEXTURES];
+    uint16_t m_numFreeVertexBuffers;
+    uint16_t m_numFreeIndexBuffers;
+    uint16_t m_numFreeShaders;
+    uint16_t m_numFreeDynamicVertexBuffers;
+    uint16_t m_numFreeDynamicIndexBuffers;
+    uint16_t m_numFreeFrameBuffers;
+    uint16_t m_numFreeTextures;
+
+    TransientBuffer m_transientVb;
+    TransientBuffer m_transientIb;
+
+    Stats m_stats;           //!< Snapshot of last finished frame.
+    int64_t m_frameTime;     //!< Time of last `endFrame`.
+    int64_t m_cpuTimeSubmit; //!< Submit time accumulated during current frame.
+    int64_t m_cpuTimeSort;   //!< Sort time of current frame.
 };
 
 } // namespace TinyRender
@@ -0,0 +1,329 @@
+#include <bx/allocator.h>
+#include <bx/uint32_t.h>
+
+#include "tlsf.h"
+
+namespace TinyRender
+{
+
+static const uint32_t kInvalid = UINT32_MAX;
+
+/// Bin of block with `_size` units, rounding down. Used when inserting free blocks.
+static inline void mapping(uint32_t _size, uint32_t &_fl, uint32_t &_sl)
+{
+    if (_size < TlsfAllocator::SlCount)
+    {
+        _fl = 0;
+        _sl = _size;
+        return;
+    }
+
+    const uint32_t msb = 31 - bx::uint32_cntlz(_size);
+    _fl = msb - TlsfAllocator::SlCountLog2 + 1;
+    _sl = (_size >> (msb - TlsfAllocator::SlCountLog2)) - TlsfAllocator::SlCount;
+}
+
+/// Round `_size` up so every block in its bin is big enough. Used when searching.
+static inline uint32_t roundUpToBin(uint32_t _size)
+{
+    if (_size < TlsfAllocator::SlCount)
+    {
+        return _size;
+    }
+
+    const uint32_t msb = 31 - bx::uint32_cntlz(_size);
+    return _size + (1 << (msb - TlsfAllocator::SlCountLog2)) - 1;
+}
+
+TlsfAllocator::TlsfAllocator() : m_allocator(NULL), m_nodes(NULL), m_freeNodes(NULL), m_size(0), m_numAllocs(0) {}
+
+TlsfAllocator::~TlsfAllocator()
+{
+    destroy();
+}
+
+bool TlsfAllocator::create(uint32_t _size, uint32_t _maxAllocs, uint32_t _granularity, bx::AllocatorI *_allocator)
+{
+    BX_ASSERT(bx::isPowerOf2(_granularity), "Granularity must be power of 2.");
+    BX_ASSERT(NULL == m_nodes, "Allocator already created.");
+
+    m_allocator = _allocator;
+    m_granularityLog2 = bx::uint32_cnttz(_granularity);
+    m_size = _size >> m_granularityLog2;
+    if (0 == m_size)
+    {
+        return false;
+    }
+
+    // Free blocks never outnumber used blocks by more than one.
+    m_maxNodes = _maxAllocs * 2 + 1;
+    m_nodes = (Node *)bx::alloc(m_allocator, m_maxNodes * sizeof(Node));
+    m_freeNodes = (uint32_t *)bx::alloc(m_allocator, m_maxNodes * sizeof(uint32_t));
+
+    for (uint32_t ii = 0; ii < m_maxNodes; ++ii)
+    {
+        m_freeNodes[ii] = m_maxNodes - 1 - ii;
+    }
+    m_numFreeNodes = m_maxNodes;
+
+    m_usedSize = 0;
+    m_numAllocs = 0;
+    m_flBitmap = 0;
+    bx::memSet(m_slBitmap, 0, sizeof(m_slBitmap));
+    bx::memSet(m_heads, 0xff, sizeof(m_heads));
+
+    const uint32_t node = allocNode();
+    Node &block = m_nodes[node];
+    block.m_offset = 0;
+    block.m_size = m_size;
+    block.m_prevPhys = kInvalid;
+    block.m_nextPhys = kInvalid;
+    block.m_used = false;
+    insertFree(node);
+
+    return true;
+}
+
+void TlsfAllocator::destroy()
+{
+    if (NULL != m_nodes)
+    {
+        bx::free(m_allocator, m_nodes);
+        bx::free(m_allocator, m_freeNodes);
+        m_nodes = NULL;
+        m_freeNodes = NULL;
+        m_size = 0;
+        m_numAllocs = 0;
+    }
+}
+
+uint32_t TlsfAllocator::allocNode()
+{
+    return 0 == m_numFreeNodes ? kInvalid : m_freeNodes[--m_numFreeNodes];
+}
+
+void TlsfAllocator::insertFree(uint32_t _node)
+{
+    Node &block = m_nodes[_node];
+
+    uint32_t fl, sl;
+    mapping(block.m_size, fl, sl);
+
+    const uint32_t bin = fl * SlCount + sl;
+    const uint32_t head = m_heads[bin];
+
+    block.m_prevFree = kInvalid;
+    block.m_nextFree = head;
+    if (kInvalid != head)
+    {
+        m_nodes[head].m_prevFree = _node;
+    }
+
+    m_heads[bin] = _node;
+    m_flBitmap |= 1 << fl;
+    m_slBitmap[fl] |= 1 << sl;
+}
+
+void TlsfAllocator::removeFree(uint32_t _node)
+{
+    const Node &block = m_nodes[_node];
+
+    if (kInvalid != block.m_prevFree)
+    {
+        m_nodes[block.m_prevFree].m_nextFree = block.m_nextFree;
+    }
+
+    if (kInvalid != block.m_nextFree)
+    {
+        m_nodes[block.m_nextFree].m_prevFree = block.m_prevFree;
+    }
+
+    uint32_t fl, sl;
+    mapping(block.m_size, fl, sl);
+
+    const uint32_t bin = fl * SlCount + sl;
+    if (m_heads[bin] == _node)
+    {
+        m_heads[bin] = block.m_nextFree;
+        if (kInvalid == block.m_nextFree)
+        {
+            m_slBitmap[fl] &= ~(1 << sl);
+            if (0 == m_slBitmap[fl])
+            {
+                m_flBitmap &= ~(1 << fl);
+            }
+        }
+    }
+}
+
+TlsfAllocation TlsfAllocator::alloc(uint32_t _size)
+{
+    TlsfAllocation result = {0, kInvalid};
+
+    const uint64_t granularity = uint64_t(1) << m_granularityLog2;
+    const uint64_t size64 = bx::max<uint64_t>(1, (uint64_t(_size) + granularity - 1) >> m_granularityLog2);
+    if (size64 > m_size)
+    {
+        return result;
+    }
+
+    const uint32_t size = uint32_t(size64);
+
+    uint32_t fl, sl;
+    mapping(roundUpToBin(size), fl, sl);
+
+    uint32_t node = kInvalid;
+
+    uint32_t slMap = fl < FlCount ? m_slBitmap[fl] & (UINT32_MAX << sl) : 0;
+    if (0 == slMap)
+    {
+        const uint32_t flMap = fl + 1 < FlCount ? m_flBitmap & (UINT32_MAX << (fl + 1)) : 0;
+        if (0 != flMap)
+        {
+            fl = bx::uint32_cnttz(flMap);
+            slMap = m_slBitmap[fl];
+        }
+    }
+
+    if (0 != slMap)
+    {
+        sl = bx::uint32_cnttz(slMap);
+        node = m_heads[fl * SlCount + sl];
+    }
+    else
+    {
+        // Nothing in bins guaranteed to fit, look for a block that happens to fit in request's own bin.
+        mapping(size, fl, sl);
+        for (uint32_t it = m_heads[fl * SlCount + sl]; kInvalid != it; it = m_nodes[it].m_nextFree)
+        {
+            if (m_nodes[it].m_size >= size)
+            {
+                node = it;
+                break;
+            }
+        }
+
+        if (kInvalid == node)
+        {
+            return result;
+        }
+    }
+
+    removeFree(node);
+
+    if (m_nodes[node].m_size > size)
+    {
+        // Without spare node whole block is handed out, remainder is wasted until free.
+        const uint32_t rest = allocNode();
+        if (kInvalid != rest)
+        {
+            Node &block = m_nodes[node];
+            Node &remainder = m_nodes[rest];
+            remainder.m_offset = block.m_offset + size;
+            remainder.m_size = block.m_size - size;
+            remainder.m_prevPhys = node;
+            remainder.m_nextPhys = block.m_nextPhys;
+            remainder.m_used = false;
+
+            if (kInvalid != block.m_nextPhys)
+            {
+                m_nodes[block.m_nextPhys].m_prevPhys = rest;
+            }
+
+            block.m_nextPhys = rest;
+            block.m_size = size;
+            insertFree(rest);
+        }
+    }
+
+    Node &block = m_nodes[node];
+    block.m_used = true;
+    m_usedSize += block.m_size;
+    ++m_numAllocs;
+
+    result.m_offset = block.m_offset << m_granularityLog2;
+    result.m_node = node;
+    return result;
+}
+
+void TlsfAllocator::free(TlsfAllocation _allocation)
+{
+    BX_ASSERT(isValid(_allocation) && m_nodes[_allocation.m_node].m_used, "Invalid allocation.");
+
+    uint32_t node = _allocation.m_node;
+    m_nodes[node].m_used = false;
+    m_usedSize -= m_nodes[node].m_size;
+    --m_numAllocs;
+
+    const uint32_t prev = m_nodes[node].m_prevPhys;
+    if (kInvalid != prev && !m_nodes[prev].m_used)
+    {
+        removeFree(prev);
+
+        Node &block = m_nodes[node];
+        m_nodes[prev].m_size += block.m_size;
+        m_nodes[prev].m_nextPhys = block.m_nextPhys;
+        if (kInvalid != block.m_nextPhys)
+        {
+            m_nodes[block.m_nextPhys].m_prevPhys = prev;
+        }
+
+        m_freeNodes[m_numFreeNodes++] = node;
+        node = prev;
+    }
+
+    const uint32_t next = m_nodes[node].m_nextPhys;
+    if (kInvalid != next && !m_nodes[next].m_used)
+    {
+        removeFree(next);
+
+        Node &block = m_nodes[node];
+        block.m_size += m_nodes[next].m_size;
+        block.m_nextPhys = m_nodes[next].m_nextPhys;
+        if (kInvalid != block.m_nextPhys)
+        {
+            m_nodes[block.m_nextPhys].m_prevPhys = node;
+        }
+
+        m_freeNodes[m_numFreeNodes++] = next;
+    }
+
+    insertFree(node);
+}
+
+uint32_t TlsfAllocator::getSize(TlsfAllocation _allocation) const
+{
+    return m_nodes[_allocation.m_node].m_size << m_granularityLog2;
+}
+
+void TlsfAllocator::getStats(TlsfStats &_stats) const
+{
+    uint32_t largestFree = 0;
+    uint32_t numFreeBlocks = 0;
+
+    for (uint32_t flMap = m_flBitmap; 0 != flMap; flMap &= flMap - 1)
+    {
+        const uint32_t fl = bx::uint32_cnttz(flMap);
+        for (uint32_t slMap = m_slBitmap[fl]; 0 != slMap; slMap &= slMap - 1)
+        {
+            const uint32_t sl = bx::uint32_cnttz(slMap);
+            for (uint32_t it = m_heads[fl * SlCount + sl]; kInvalid != it; it = m_nodes[it].m_nextFree)
+            {
+                largestFree = bx::max(largestFree, m_nodes[it].m_size);
+                ++numFreeBlocks;
+            }
+        }
+    }
+
+    const uint32_t freeSize = m_size - m_usedSize;
+
+    _stats.m_totalSize = m_size << m_granularityLog2;
+    _stats.m_usedSize = m_usedSize << m_granularityLog2;
+    _stats.m_freeSize = freeSize << m_granularityLog2;
+    _stats.m_largestFree = largestFree << m_granularityLog2;
+    _stats.m_numAllocs = m_numAllocs;
+    _stats.m_numFreeBlocks = numFreeBlocks;
+    _stats.m_fragmentation = 0 == freeSize ? 0.0f : 1.0f - float(largestFree) / float(freeSize);
+}
+
+} // namespace TinyRender
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bx/bx.h>
+
+namespace bx
+{
+struct AllocatorI;
+}
+
+namespace TinyRender
+{
+
+/// Allocation returned by `TlsfAllocator`.
+struct TlsfAllocation
+{
+    uint32_t m_offset; //!< Byte offset, multiple of allocator granularity.
+    uint32_t m_node;   //!< Internal block index, `UINT32_MAX` when allocation failed.
+};
+
+/// Allocator statistics.
+struct TlsfStats
+{
+    uint32_t m_totalSize;     //!< Managed range size in bytes.
+    uint32_t m_usedSize;      //!< Bytes in live allocations (after granularity rounding).
+    uint32_t m_freeSize;      //!< Bytes in free blocks.
+    uint32_t m_largestFree;   //!< Largest free block in bytes.
+    uint32_t m_numAllocs;     //!< Live allocations.
+    uint32_t m_numFreeBlocks; //!< Free blocks, 1 when range is not fragmented.
+    float m_fragmentation;    //!< `1 - largestFree/freeSize`, 0 when all free memory is one block.
+};
+
+/// Two-level segregated fit allocator for ranges of memory it doesn't own (GPU heaps and buffers).
+/// Only offsets are handed out, block bookkeeping lives on CPU side. Allocation and free are O(1),
+/// freed blocks are merged with free neighbours immediately.
+///
+struct TlsfAllocator
+{
+    enum
+    {
+        SlCountLog2 = 5,
+        SlCount = 1 << SlCountLog2, //!< Second level bins per power of two.
+        FlCount = 32 - SlCountLog2 + 1,
+    };
+
+    TlsfAllocator();
+    ~TlsfAllocator();
+
+    /// Manage `_size` bytes.
+    ///
+    /// @param[in] _size Range size in bytes.
+    /// @param[in] _maxAllocs Maximum number of live allocations.
+    /// @param[in] _granularity Allocation size and alignment granularity, power of two.
+    /// @param[in] _allocator Allocator for block bookkeeping.
+    ///
+    bool create(uint32_t _size, uint32_t _maxAllocs, uint32_t _granularity, bx::AllocatorI *_allocator);
+
+    void destroy();
+
+    /// Allocate `_size` bytes. Check result with `isValid`.
+    TlsfAllocation alloc(uint32_t _size);
+
+    void free(TlsfAllocation _allocation);
+
+    /// Returns allocation size in bytes.
+    uint32_t getSize(TlsfAllocation _allocation) const;
+
+    bool isEmpty() const
+    {
+        return 0 == m_numAllocs;
+    }
+
+    void getStats(TlsfStats &_stats) const;
+
+    static bool isValid(TlsfAllocation _allocation)
+    {
+        return UINT32_MAX != _allocation.m_node;
+    }
+
+    struct Node
+    {
+        uint32_t m_offset; //!< In granularity units.
+        uint32_t m_size;   //!< In granularity units.
+        uint32_t m_prevPhys;
+        uint32_t m_nextPhys;
+        uint32_t m_prevFree;
+        uint32_t m_nextFree;
+        bool m_used;
+    };
+
+    uint32_t allocNode();
+    void insertFree(uint32_t _node);
+    void removeFree(uint32_t _node);
+
+    bx::AllocatorI *m_allocator;
+    Node *m_nodes;
+    uint32_t *m_freeNodes; //!< Stack of unused node indices.
+    uint32_t m_numFreeNodes;
+    uint32_t m_maxNodes;
+    uint32_t m_granularityLog2;
+    uint32_t m_size;
+    uint32_t m_usedSize; //!< In granularity units.
+    uint32_t m_numAllocs;
+    uint32_t m_flBitmap;
+    uint32_t m_slBitmap[FlCount];
+    uint32_t m_heads[FlCount * SlCount];
+};
+
+} // namespace TinyRender
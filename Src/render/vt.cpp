@@ -0,0 +1,792 @@
+#include <bx/file.h>
+#include <bx/sort.h>
+#include <bx/uint32_t.h>
+
+#include "entry.h"
+#include "mipgen.h"
+#include "tiny_render_p.h"
+#include "vt.h"
+
+namespace TinyRender
+{
+
+#define TINYRENDER_VT_MAGIC BX_MAKEFOURCC('T', 'R', 'V', 'T')
+#define TINYRENDER_VT_VERSION 1
+
+static const uint16_t kNotResident = UINT16_MAX;
+static const uint16_t kLoading = UINT16_MAX - 1;
+static const uint16_t kInvalidSlot = UINT16_MAX;
+
+struct VirtualTextureHeader
+{
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint16_t m_width;
+    uint16_t m_height;
+    uint16_t m_tileSize;
+    uint16_t m_border;
+    uint8_t m_format;
+    uint8_t m_numMips;
+    uint16_t m_reserved;
+};
+
+static bool isTileFormat(TextureFormat::Enum _format)
+{
+    return TextureFormat::RGBA8 == _format || TextureFormat::SRGBA8 == _format || bcIsSupported(_format);
+}
+
+static uint32_t calcTileBytes(TextureFormat::Enum _format, uint16_t _paddedSize)
+{
+    return calcPitch(_format, _paddedSize) * calcNumRows(_format, _paddedSize);
+}
+
+/// Mips until smaller side is one tile, tile counts must be powers of two.
+static uint8_t calcVtNumMips(uint32_t _numTilesX, uint32_t _numTilesY)
+{
+    if (0 == _numTilesX || 0 == _numTilesY || !bx::isPowerOf2(_numTilesX) || !bx::isPowerOf2(_numTilesY))
+    {
+        return 0;
+    }
+
+    return uint8_t(bx::uint32_cnttz(bx::uint32_min(_numTilesX, _numTilesY)) + 1);
+}
+
+bool vtCook(const char *_filePath, const void *_data, uint16_t _width, uint16_t _height, uint16_t _tileSize,
+            uint16_t _border, TextureFormat::Enum _format, BcQuality::Enum _quality, JobPool *_pool)
+{
+    const uint16_t paddedSize = uint16_t(_tileSize + 2 * _border);
+    const uint8_t numMips = 0 != _tileSize && 0 == _width % _tileSize && 0 == _height % _tileSize
+                                ? calcVtNumMips(_width / _tileSize, _height / _tileSize)
+                                : 0;
+    if (0 == numMips || !isTileFormat(_format) || 0 != paddedSize % getBlockSize(_format))
+    {
+        BX_TRACE("WARNING: Can't cook virtual texture %dx%d, tile %d, border %d, format %d.", _width, _height,
+                 _tileSize, _border, _format);
+        return false;
+    }
+
+    // Mips are filtered in sRGB space only when tiles are sRGB.
+    const TextureFormat::Enum mipFormat = TextureFormat::SRGBA8 == _format ? TextureFormat::SRGBA8 : TextureFormat::RGBA8;
+
+    TextureInfo info;
+    calcTextureSize(info, _width, _height, false, true, mipFormat);
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Staging);
+    uint8_t *mips = (uint8_t *)bx::alloc(allocator, info.storageSize, 16);
+    bx::memCopy(mips, _data, uint32_t(_width) * _height * 4);
+    mipGenerate(mips, info, MipFilter::Box, _pool, allocator);
+
+    const uint32_t tileBytes = calcTileBytes(_format, paddedSize);
+    uint8_t *tile = (uint8_t *)bx::alloc(allocator, uint32_t(paddedSize) * paddedSize * 4);
+    uint8_t *encoded = (uint8_t *)bx::alloc(allocator, tileBytes);
+
+    bx::FileWriterI *writer = entry::getFileWriter();
+    if (!bx::open(writer, _filePath))
+    {
+        bx::free(allocator, encoded);
+        bx::free(allocator, tile);
+        bx::free(allocator, mips, 16);
+        return false;
+    }
+
+    VirtualTextureHeader header;
+    header.m_magic = TINYRENDER_VT_MAGIC;
+    header.m_version = TINYRENDER_VT_VERSION;
+    header.m_width = _width;
+    header.m_height = _height;
+    header.m_tileSize = _tileSize;
+    header.m_border = _border;
+    header.m_format = uint8_t(_format);
+    header.m_numMips = numMips;
+    header.m_reserved = 0;
+
+    bx::Error err;
+    bx::write(writer, &header, int32_t(sizeof(header)), &err);
+
+    const uint8_t *mip = mips;
+    for (uint8_t ii = 0; ii < numMips && err.isOk(); ++ii)
+    {
+        const uint32_t mipWidth = uint32_t(_width) >> ii;
+        const uint32_t mipHeight = uint32_t(_height) >> ii;
+
+        for (uint32_t ty = 0; ty < mipHeight / _tileSize && err.isOk(); ++ty)
+        {
+            for (uint32_t tx = 0; tx < mipWidth / _tileSize && err.isOk(); ++tx)
+            {
+                // Border comes from neighbouring tiles, mip edge is replicated.
+                for (uint32_t yy = 0; yy < paddedSize; ++yy)
+                {
+                    const int32_t srcY = int32_t(ty * _tileSize + yy) - _border;
+                    const uint8_t *row = &mip[bx::clamp<int32_t>(srcY, 0, int32_t(mipHeight) - 1) * mipWidth * 4];
+                    for (uint32_t xx = 0; xx < paddedSize; ++xx)
+                    {
+                        const int32_t srcX = int32_t(tx * _tileSize + xx) - _border;
+                        bx::memCopy(&tile[(yy * paddedSize + xx) * 4],
+                                    &row[bx::clamp<int32_t>(srcX, 0, int32_t(mipWidth) - 1) * 4], 4);
+                    }
+                }
+
+                const uint8_t *data = tile;
+                if (bcIsSupported(_format))
+                {
+                    bcEncode(encoded, _format, tile, paddedSize, paddedSize, paddedSize * 4, _quality, _pool);
+                    data = encoded;
+                }
+
+                bx::write(writer, data, int32_t(tileBytes), &err);
+            }
+        }
+
+        mip += mipWidth * mipHeight * 4;
+    }
+
+    bx::close(writer);
+
+    bx::free(allocator, encoded);
+    bx::free(allocator, tile);
+    bx::free(allocator, mips, 16);
+
+    return err.isOk();
+}
+
+VirtualTexture::VirtualTexture()
+    : m_reader(NULL), m_ownReader(false), m_loadData(NULL), m_queueHead(0), m_queueTail(0), m_doneHead(0), m_doneTail(0), m_numFree(0),
+      m_slot(NULL), m_tileSlot(NULL), m_tileRequested(NULL), m_entry(NULL), m_candidate(NULL), m_numCandidates(0),
+      m_numRequested(0), m_numMissing(0), m_numTiles(0), m_tileBytes(0), m_frame(0), m_numSlots(0), m_numSlotsX(0),
+      m_numPinned(0), m_lruHead(kInvalidSlot), m_lruTail(kInvalidSlot), m_numTilesX(0), m_numTilesY(0),
+      m_tileSize(0), m_border(0), m_paddedSize(0), m_numMips(0), m_format(TextureFormat::Count)
+{
+    m_physical.idx = kInvalidHandle;
+    m_pageTable.idx = kInvalidHandle;
+    m_feedback.idx = kInvalidHandle;
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    destroy();
+}
+
+bool VirtualTexture::create(const char *_filePath, uint16_t _numSlotsX, uint16_t _numSlotsY, uint16_t _feedbackWidth,
+                            uint16_t _feedbackHeight, bx::FileReaderI *_reader)
+{
+    BX_ASSERT(0 == m_numSlots, "Virtual texture already created.");
+
+    // Shared reader can't be used from loader thread, main thread may read other files with it.
+    m_ownReader = NULL == _reader;
+    m_reader = m_ownReader ? entry::createFileReader() : _reader;
+    if (!bx::open(m_reader, _filePath))
+    {
+        BX_TRACE("WARNING: Can't open virtual texture %s.", _filePath);
+        destroy();
+        return false;
+    }
+
+    VirtualTextureHeader header;
+    bx::Error err;
+    bx::read(m_reader, &header, int32_t(sizeof(header)), &err);
+
+    const TextureFormat::Enum format = TextureFormat::Enum(header.m_format);
+    const uint16_t paddedSize = uint16_t(header.m_tileSize + 2 * header.m_border);
+    const uint32_t numSlots = uint32_t(_numSlotsX) * _numSlotsY;
+    const bool valid = err.isOk() && TINYRENDER_VT_MAGIC == header.m_magic &&
+                       TINYRENDER_VT_VERSION == header.m_version && 0 != header.m_tileSize &&
+                       header.m_format < TextureFormat::Count && isTileFormat(format) &&
+                       0 == header.m_width % header.m_tileSize && 0 == header.m_height % header.m_tileSize &&
+                       header.m_numMips ==
+                           calcVtNumMips(header.m_width / header.m_tileSize, header.m_height / header.m_tileSize) &&
+                       _numSlotsX <= 256 && _numSlotsY <= 256 && numSlots < kLoading &&
+                       uint32_t(_numSlotsX) * paddedSize <= UINT16_MAX &&
+                       uint32_t(_numSlotsY) * paddedSize <= UINT16_MAX;
+    if (!valid)
+    {
+        BX_TRACE("WARNING: Invalid virtual texture %s, or %dx%d slots don't fit.", _filePath, _numSlotsX, _numSlotsY);
+        bx::close(m_reader);
+        destroy();
+        return false;
+    }
+
+    m_numTilesX = uint16_t(header.m_width / header.m_tileSize);
+    m_numTilesY = uint16_t(header.m_height / header.m_tileSize);
+    m_numMips = header.m_numMips;
+    m_tileSize = header.m_tileSize;
+    m_border = header.m_border;
+    m_paddedSize = paddedSize;
+    m_format = format;
+    m_tileBytes = calcTileBytes(format, paddedSize);
+
+    m_numTiles = 0;
+    for (uint8_t ii = 0; ii < m_numMips; ++ii)
+    {
+        m_mipOffset[ii] = m_numTiles;
+        m_numTiles += uint32_t(getNumTilesX(ii)) * getNumTilesY(ii);
+    }
+
+    // Coarsest mip is fallback of every tile, it must fit with room to spare.
+    const uint8_t lastMip = uint8_t(m_numMips - 1);
+    const uint32_t numPinned = m_numTiles - m_mipOffset[lastMip];
+    if (numSlots <= numPinned)
+    {
+        BX_TRACE("WARNING: Virtual texture cache of %d slots can't hold coarsest mip of %d tiles.", numSlots,
+                 numPinned);
+        bx::close(m_reader);
+        destroy();
+        return false;
+    }
+
+    m_physical = createTexture2D(uint16_t(_numSlotsX * paddedSize), uint16_t(_numSlotsY * paddedSize), false, format,
+                                 NULL, 0);
+    m_pageTable = createTexture2D(m_numTilesX, m_numTilesY, true, TextureFormat::RGBA8, NULL, 0);
+    if (0 != _feedbackWidth && 0 != _feedbackHeight)
+    {
+        m_feedback = createFrameBuffer(_feedbackWidth, _feedbackHeight, TextureFormat::RGBA8, TextureFormat::D32F);
+    }
+
+    if (!isValid(m_physical) || !isValid(m_pageTable) || (0 != _feedbackWidth && !isValid(m_feedback)))
+    {
+        bx::close(m_reader);
+        destroy();
+        return false;
+    }
+
+    bx::AllocatorI *allocator = getAllocator(MemoryCategory::Command);
+    m_slot = (Slot *)bx::alloc(allocator, numSlots * sizeof(Slot));
+    m_tileSlot = (uint16_t *)bx::alloc(allocator, m_numTiles * sizeof(uint16_t));
+    m_tileRequested = (uint32_t *)bx::alloc(allocator, m_numTiles * sizeof(uint32_t));
+    m_entry = (uint32_t *)bx::alloc(allocator, m_numTiles * sizeof(uint32_t));
+    m_candidate = (uint32_t *)bx::alloc(allocator, BGFX_CONFIG_VT_MAX_REQUESTS * sizeof(uint32_t));
+    m_loadData = (uint8_t *)bx::alloc(getAllocator(MemoryCategory::Staging), BGFX_CONFIG_VT_MAX_LOADS * m_tileBytes);
+
+    bx::memSet(m_tileSlot, 0xff, m_numTiles * sizeof(uint16_t));
+    bx::memSet(m_tileRequested, 0, m_numTiles * sizeof(uint32_t));
+    bx::memSet(m_dirty, 0, sizeof(m_dirty));
+    for (uint8_t ii = 0; ii < m_numMips; ++ii)
+    {
+        m_dirty[ii][0] = UINT16_MAX;
+        m_dirty[ii][1] = UINT16_MAX;
+    }
+
+    // Frames start at 2, so free slots with last use 0 are never in use.
+    m_frame = 2;
+    m_numSlots = uint16_t(numSlots);
+    m_numSlotsX = _numSlotsX;
+    m_numPinned = uint16_t(numPinned);
+    m_lruHead = kInvalidSlot;
+    m_lruTail = kInvalidSlot;
+    for (uint16_t ii = 0; ii < m_numSlots; ++ii)
+    {
+        Slot &slot = m_slot[ii];
+        slot.m_tile = UINT32_MAX;
+        slot.m_lastUsed = 0;
+        slot.m_prev = kInvalidSlot;
+        slot.m_next = kInvalidSlot;
+        if (ii >= m_numPinned)
+        {
+            touch(ii);
+            slot.m_lastUsed = 0;
+        }
+    }
+
+    bx::memSet(&m_stats, 0, sizeof(m_stats));
+    m_numCandidates = 0;
+    m_numRequested = 0;
+    m_numMissing = 0;
+
+    // Coarsest mip is read right away, before loader owns reader.
+    bool ok = true;
+    for (uint16_t ii = 0; ii < m_numPinned && ok; ++ii)
+    {
+        const uint32_t tile = m_mipOffset[lastMip] + ii;
+        ok = readTile(m_loadData, tile);
+        if (ok)
+        {
+            upload(ii, tile, m_loadData);
+        }
+    }
+
+    if (!ok)
+    {
+        BX_TRACE("WARNING: Can't read coarsest mip of virtual texture %s.", _filePath);
+        bx::close(m_reader);
+        destroy();
+        return false;
+    }
+
+    flushPageTable();
+
+    m_queueHead = 0;
+    m_queueTail = 0;
+    m_doneHead = 0;
+    m_doneTail = 0;
+    m_numFree = BGFX_CONFIG_VT_MAX_LOADS;
+    for (uint32_t ii = 0; ii < BGFX_CONFIG_VT_MAX_LOADS; ++ii)
+    {
+        m_free[ii] = BGFX_CONFIG_VT_MAX_LOADS - 1 - ii;
+    }
+
+    if (!m_thread.init(loaderFunc, this, 0, "TinyRender VT loader"))
+    {
+        bx::close(m_reader);
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void VirtualTexture::destroy()
+{
+    if (m_thread.isRunning())
+    {
+        // Loader finishes queued reads first, queue being empty on wake up tells it to quit.
+        m_queued.post();
+        m_thread.shutdown();
+
+        for (; m_doneHead != m_doneTail; ++m_doneHead)
+        {
+            m_finished.wait();
+        }
+        m_numFree = BGFX_CONFIG_VT_MAX_LOADS;
+
+        bx::close(m_reader);
+    }
+
+    if (isValid(m_feedback))
+    {
+        TinyRender::destroy(m_feedback);
+        m_feedback.idx = kInvalidHandle;
+    }
+
+    if (isValid(m_pageTable))
+    {
+        TinyRender::destroy(m_pageTable);
+        m_pageTable.idx = kInvalidHandle;
+    }
+
+    if (isValid(m_physical))
+    {
+        TinyRender::destroy(m_physical);
+        m_physical.idx = kInvalidHandle;
+    }
+
+    if (NULL != m_slot)
+    {
+        bx::AllocatorI *allocator = getAllocator(MemoryCategory::Command);
+        bx::free(allocator, m_slot);
+        bx::free(allocator, m_tileSlot);
+        bx::free(allocator, m_tileRequested);
+        bx::free(allocator, m_entry);
+        bx::free(allocator, m_candidate);
+        bx::free(getAllocator(MemoryCategory::Staging), m_loadData);
+        m_slot = NULL;
+        m_tileSlot = NULL;
+        m_tileRequested = NULL;
+        m_entry = NULL;
+        m_candidate = NULL;
+        m_loadData = NULL;
+    }
+
+    if (m_ownReader)
+    {
+        entry::destroyFileReader(m_reader);
+        m_ownReader = false;
+    }
+
+    m_numSlots = 0;
+    m_numTiles = 0;
+    m_reader = NULL;
+}
+
+void VirtualTexture::request(uint8_t _mip, uint16_t _x, uint16_t _y)
+{
+    if (_mip >= m_numMips || _x >= getNumTilesX(_mip) || _y >= getNumTilesY(_mip))
+    {
+        return;
+    }
+
+    // Ancestors are requested too, they keep fallback resident and load before their children.
+    for (uint8_t mip = _mip;; ++mip, _x >>= 1, _y >>= 1)
+    {
+        const uint32_t tile = getTile(mip, _x, _y);
+        if (m_frame == m_tileRequested[tile])
+        {
+            break;
+        }
+        m_tileRequested[tile] = m_frame;
+        ++m_numRequested;
+
+        const uint16_t slot = m_tileSlot[tile];
+        if (slot < kLoading)
+        {
+            touch(slot);
+        }
+        else
+        {
+            ++m_numMissing;
+            if (kNotResident == slot && m_numCandidates < BGFX_CONFIG_VT_MAX_REQUESTS)
+            {
+                m_candidate[m_numCandidates++] = tile;
+            }
+        }
+
+        if (mip + 1 >= m_numMips)
+        {
+            break;
+        }
+    }
+}
+
+void VirtualTexture::addFeedback(const void *_data, uint32_t _pitch, uint16_t _width, uint16_t _height)
+{
+    BGFX_PROFILER_SCOPE("VirtualTexture::addFeedback");
+
+    for (uint32_t yy = 0; yy < _height; ++yy)
+    {
+        const uint8_t *row = (const uint8_t *)_data + yy * _pitch;
+
+        // Neighbouring pixels mostly sample same tile.
+        uint32_t last = UINT32_MAX;
+        for (uint32_t xx = 0; xx < _width; ++xx)
+        {
+            uint32_t texel;
+            bx::memCopy(&texel, &row[xx * 4], 4);
+            if (texel == last || 0xff == (texel >> 24))
+            {
+                continue;
+            }
+            last = texel;
+
+            const uint32_t high = (texel >> 16) & 0xff;
+            request(uint8_t(texel >> 24), uint16_t((texel & 0xff) | ((high & 0xf) << 8)),
+                    uint16_t(((texel >> 8) & 0xff) | ((high >> 4) << 8)));
+        }
+    }
+}
+
+bool VirtualTexture::readFeedback()
+{
+    return isValid(m_feedback) && readFrameBuffer(m_feedback, feedbackCallback, this);
+}
+
+void VirtualTexture::feedbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                      uint16_t _height, TextureFormat::Enum _format, void *_userData)
+{
+    BX_UNUSED(_handle, _format);
+
+    if (NULL != _data)
+    {
+        ((VirtualTexture *)_userData)->addFeedback(_data, _pitch, _width, _height);
+    }
+}
+
+static int32_t compareTileDescending(const void *_lhs, const void *_rhs)
+{
+    const uint32_t lhs = *(const uint32_t *)_lhs;
+    const uint32_t rhs = *(const uint32_t *)_rhs;
+    return lhs < rhs ? 1 : lhs > rhs ? -1 : 0;
+}
+
+void VirtualTexture::update()
+{
+    BGFX_PROFILER_SCOPE("VirtualTexture::update");
+    BX_ASSERT(0 != m_numSlots, "Virtual texture is not created.");
+
+    drainLoads(BGFX_CONFIG_VT_MAX_UPLOADS, false);
+
+    // Coarser mips have higher tile indices, they load first and refine fallback soonest.
+    bx::quickSort(m_candidate, m_numCandidates, sizeof(uint32_t), compareTileDescending);
+
+    for (uint32_t ii = 0; ii < m_numCandidates && 0 != m_numFree; ++ii)
+    {
+        const uint32_t tile = m_candidate[ii];
+        if (kNotResident != m_tileSlot[tile])
+        {
+            continue;
+        }
+
+        const uint32_t idx = m_free[--m_numFree];
+        m_load[idx].m_tile = tile;
+        m_load[idx].m_ok = false;
+        m_tileSlot[tile] = kLoading;
+        {
+            bx::MutexScope lock(m_mutex);
+            m_queue[m_queueTail++ % BGFX_CONFIG_VT_MAX_LOADS] = idx;
+        }
+        m_queued.post();
+    }
+
+    flushPageTable();
+
+    m_stats.numLoading = BGFX_CONFIG_VT_MAX_LOADS - m_numFree;
+    m_stats.numRequested = m_numRequested;
+    m_stats.numMissing = m_numMissing;
+    m_numCandidates = 0;
+    m_numRequested = 0;
+    m_numMissing = 0;
+    ++m_frame;
+}
+
+void VirtualTexture::flush()
+{
+    drainLoads(UINT32_MAX, true);
+    flushPageTable();
+    m_stats.numLoading = BGFX_CONFIG_VT_MAX_LOADS - m_numFree;
+}
+
+bool VirtualTexture::isResident(uint8_t _mip, uint16_t _x, uint16_t _y) const
+{
+    return _mip < m_numMips && _x < getNumTilesX(_mip) && _y < getNumTilesY(_mip) &&
+           m_tileSlot[getTile(_mip, _x, _y)] < kLoading;
+}
+
+int32_t VirtualTexture::loaderFunc(bx::Thread *_self, void *_userData)
+{
+    BX_UNUSED(_self);
+    VirtualTexture *vt = (VirtualTexture *)_userData;
+
+    for (;;)
+    {
+        vt->m_queued.wait();
+
+        uint32_t idx;
+        {
+            bx::MutexScope lock(vt->m_mutex);
+            if (vt->m_queueHead == vt->m_queueTail)
+            {
+                break;
+            }
+            idx = vt->m_queue[vt->m_queueHead++ % BGFX_CONFIG_VT_MAX_LOADS];
+        }
+
+        Load &load = vt->m_load[idx];
+        load.m_ok = vt->readTile(&vt->m_loadData[idx * vt->m_tileBytes], load.m_tile);
+
+        {
+            bx::MutexScope lock(vt->m_mutex);
+            vt->m_done[vt->m_doneTail++ % BGFX_CONFIG_VT_MAX_LOADS] = idx;
+        }
+        vt->m_finished.post();
+    }
+
+    return 0;
+}
+
+uint32_t VirtualTexture::getTile(uint8_t _mip, uint16_t _x, uint16_t _y) const
+{
+    return m_mipOffset[_mip] + uint32_t(_y) * getNumTilesX(_mip) + _x;
+}
+
+bool VirtualTexture::readTile(uint8_t *_dst, uint32_t _tile)
+{
+    const int64_t offset = int64_t(sizeof(VirtualTextureHeader)) + int64_t(_tile) * m_tileBytes;
+    if (offset != bx::seek(m_reader, offset, bx::Whence::Begin))
+    {
+        return false;
+    }
+
+    bx::Error err;
+    return int32_t(m_tileBytes) == bx::read(m_reader, _dst, int32_t(m_tileBytes), &err) && err.isOk();
+}
+
+void VirtualTexture::unlink(uint16_t _slot)
+{
+    Slot &slot = m_slot[_slot];
+    if (kInvalidSlot != slot.m_prev)
+    {
+        m_slot[slot.m_prev].m_next = slot.m_next;
+    }
+    else if (m_lruHead == _slot)
+    {
+        m_lruHead = slot.m_next;
+    }
+
+    if (kInvalidSlot != slot.m_next)
+    {
+        m_slot[slot.m_next].m_prev = slot.m_prev;
+    }
+    else if (m_lruTail == _slot)
+    {
+        m_lruTail = slot.m_prev;
+    }
+
+    slot.m_prev = kInvalidSlot;
+    slot.m_next = kInvalidSlot;
+}
+
+void VirtualTexture::touch(uint16_t _slot)
+{
+    Slot &slot = m_slot[_slot];
+    slot.m_lastUsed = m_frame;
+    if (_slot < m_numPinned || m_lruTail == _slot)
+    {
+        return;
+    }
+
+    unlink(_slot);
+
+    slot.m_prev = m_lruTail;
+    if (kInvalidSlot != m_lruTail)
+    {
+        m_slot[m_lruTail].m_next = _slot;
+    }
+    else
+    {
+        m_lruHead = _slot;
+    }
+    m_lruTail = _slot;
+}
+
+uint16_t VirtualTexture::allocSlot()
+{
+    // Tiles requested this or last frame are on screen, feedback lags a frame behind.
+    const uint16_t slot = m_lruHead;
+    if (kInvalidSlot == slot || m_slot[slot].m_lastUsed + 1 >= m_frame)
+    {
+        return kInvalidSlot;
+    }
+
+    if (UINT32_MAX != m_slot[slot].m_tile)
+    {
+        evict(slot);
+    }
+
+    return slot;
+}
+
+void VirtualTexture::upload(uint16_t _slot, uint32_t _tile, const uint8_t *_data)
+{
+    const uint16_t xx = uint16_t(_slot % m_numSlotsX * m_paddedSize);
+    const uint16_t yy = uint16_t(_slot / m_numSlotsX * m_paddedSize);
+    updateTexture2D(m_physical, 0, xx, yy, m_paddedSize, m_paddedSize, _data, UINT32_MAX);
+
+    m_slot[_slot].m_tile = _tile;
+    m_tileSlot[_tile] = _slot;
+    touch(_slot);
+    resolve(_tile);
+
+    ++m_stats.numResident;
+    ++m_stats.numLoaded;
+}
+
+void VirtualTexture::evict(uint16_t _slot)
+{
+    const uint32_t tile = m_slot[_slot].m_tile;
+    m_slot[_slot].m_tile = UINT32_MAX;
+    m_tileSlot[tile] = kNotResident;
+    resolve(tile);
+
+    --m_stats.numResident;
+    ++m_stats.numEvicted;
+}
+
+void VirtualTexture::resolve(uint32_t _tile)
+{
+    uint8_t mip = 0;
+    while (mip + 1 < m_numMips && _tile >= m_mipOffset[mip + 1])
+    {
+        ++mip;
+    }
+
+    const uint32_t index = _tile - m_mipOffset[mip];
+    const uint32_t tileX = index % getNumTilesX(mip);
+    const uint32_t tileY = index / getNumTilesX(mip);
+
+    // Entries covered by tile in its mip and all finer ones, top down so parent entry is final
+    // before children read it.
+    for (int32_t ii = mip; ii >= 0; --ii)
+    {
+        const uint32_t shift = uint32_t(mip - ii);
+        const uint32_t numTilesX = getNumTilesX(uint8_t(ii));
+        const uint32_t x0 = tileX << shift;
+        const uint32_t y0 = tileY << shift;
+        const uint32_t x1 = bx::uint32_min((tileX + 1) << shift, numTilesX);
+        const uint32_t y1 = bx::uint32_min((tileY + 1) << shift, getNumTilesY(uint8_t(ii)));
+
+        for (uint32_t yy = y0; yy < y1; ++yy)
+        {
+            uint32_t *entry = &m_entry[m_mipOffset[ii] + yy * numTilesX];
+            for (uint32_t xx = x0; xx < x1; ++xx)
+            {
+                const uint16_t slot = m_tileSlot[m_mipOffset[ii] + yy * numTilesX + xx];
+                if (slot < kLoading)
+                {
+                    entry[xx] = (slot % m_numSlotsX) | (slot / m_numSlotsX) << 8 | uint32_t(ii) << 16 | 0xff000000;
+                }
+                else
+                {
+                    // Coarsest mip is pinned, every other tile has parent.
+                    entry[xx] = m_entry[getTile(uint8_t(ii + 1), uint16_t(xx >> 1), uint16_t(yy >> 1))];
+                }
+            }
+        }
+
+        uint16_t *dirty = m_dirty[ii];
+        dirty[0] = uint16_t(bx::uint32_min(dirty[0], x0));
+        dirty[1] = uint16_t(bx::uint32_min(dirty[1], y0));
+        dirty[2] = uint16_t(bx::uint32_max(dirty[2], x1));
+        dirty[3] = uint16_t(bx::uint32_max(dirty[3], y1));
+    }
+}
+
+void VirtualTexture::flushPageTable()
+{
+    for (uint8_t ii = 0; ii < m_numMips; ++ii)
+    {
+        uint16_t *dirty = m_dirty[ii];
+        if (dirty[0] < dirty[2])
+        {
+            const uint32_t numTilesX = getNumTilesX(ii);
+            updateTexture2D(m_pageTable, ii, dirty[0], dirty[1], uint16_t(dirty[2] - dirty[0]),
+                            uint16_t(dirty[3] - dirty[1]), &m_entry[m_mipOffset[ii] + dirty[1] * numTilesX + dirty[0]],
+                            numTilesX * 4);
+        }
+
+        dirty[0] = UINT16_MAX;
+        dirty[1] = UINT16_MAX;
+        dirty[2] = 0;
+        dirty[3] = 0;
+    }
+}
+
+uint32_t VirtualTexture::drainLoads(uint32_t _max, bool _wait)
+{
+    uint32_t num = 0;
+    for (; num < _max && BGFX_CONFIG_VT_MAX_LOADS != m_numFree; ++num)
+    {
+        if (!_wait)
+        {
+            bx::MutexScope lock(m_mutex);
+            if (m_doneHead == m_doneTail)
+            {
+                break;
+            }
+        }
+
+        // Each finished load posts once, after it's in done ring.
+        m_finished.wait();
+
+        uint32_t idx;
+        {
+            bx::MutexScope lock(m_mutex);
+            idx = m_done[m_doneHead++ % BGFX_CONFIG_VT_MAX_LOADS];
+        }
+
+        const Load &load = m_load[idx];
+        const uint16_t slot = load.m_ok ? allocSlot() : kInvalidSlot;
+        if (kInvalidSlot != slot)
+        {
+            upload(slot, load.m_tile, &m_loadData[idx * m_tileBytes]);
+        }
+        else
+        {
+            m_tileSlot[load.m_tile] = kNotResident;
+            ++(load.m_ok ? m_stats.numDropped : m_stats.numFailed);
+        }
+
+        m_free[m_numFree++] = idx;
+    }
+
+    return num;
+}
+
+} // namespace TinyRender
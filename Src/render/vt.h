@@ -0,0 +1,255 @@
+#pragma once
+
+#include <bx/mutex.h>
+#include <bx/semaphore.h>
+#include <bx/thread.h>
+
+#include "bc.h"
+#include "defines.h"
+#include "tiny_render.h"
+
+namespace bx { struct FileReaderI; }
+
+namespace TinyRender
+{
+
+struct JobPool;
+
+/// Virtual texture streaming statistics, counters are totals since `VirtualTexture::create`.
+struct VirtualTextureStats
+{
+    uint32_t numResident;  //!< Tiles in cache, pinned ones included.
+    uint32_t numLoading;   //!< Tiles queued or being read by loader.
+    uint32_t numRequested; //!< Unique tiles requested by feedback in last `update`.
+    uint32_t numMissing;   //!< Tiles requested in last `update` that weren't resident.
+    uint64_t numLoaded;    //!< Tiles uploaded to cache.
+    uint64_t numEvicted;   //!< Tiles evicted to make room.
+    uint64_t numDropped;   //!< Loaded tiles dropped because every slot was in use.
+    uint64_t numFailed;    //!< Tiles loader failed to read.
+};
+
+/// Cook RGBA8 image into virtual texture file. Mips are generated with box filter, tiles get
+/// `_border` texels of neighbouring tiles, or replicated edge, on every side for filtering.
+///
+/// File is header followed by tiles of every mip from largest, each mip row major. Every tile is
+/// `_tileSize + 2 * _border` texels square in `_format`.
+///
+/// @param[in] _filePath Output file, written through `entry::getFileWriter`.
+/// @param[in] _data RGBA8 pixels of mip 0.
+/// @param[in] _width Width, `_tileSize` times power of two.
+/// @param[in] _height Height, `_tileSize` times power of two.
+/// @param[in] _format `TextureFormat::RGBA8`, `TextureFormat::SRGBA8` or BC format, for which
+///   padded tile size must be multiple of 4.
+/// @param[in] _pool Job pool for mips and block compression, NULL runs on calling thread.
+///
+/// @returns False when size or format is invalid or file can't be written.
+///
+bool vtCook(const char *_filePath, const void *_data, uint16_t _width, uint16_t _height, uint16_t _tileSize,
+            uint16_t _border, TextureFormat::Enum _format, BcQuality::Enum _quality = BcQuality::Normal,
+            JobPool *_pool = NULL);
+
+/// Tile based virtual texture, streamed from file cooked by `vtCook` into fixed size cache.
+///
+/// Resources, all owned by virtual texture:
+/// - Physical texture, cache slots laid out in grid, each slot holding one padded tile.
+/// - Page table texture, one texel per tile of each mip, mip `ii` of page table maps mip `ii` of
+///   virtual texture. Texel is RGBA8, red and green are slot column and row, blue is mip of tile in
+///   slot. Tiles that aren't resident point to nearest resident ancestor, coarsest mip is always
+///   resident.
+/// - Feedback frame buffer, RGBA8 with depth. Feedback pass draws tile each pixel samples: red and
+///   green are low 8 bits of tile column and row, blue holds their high 4 bits, column in low
+///   nibble, alpha is mip. Clear it to `0xffffffff`, alpha 255 means no request.
+///
+/// Each frame: render feedback pass and call `readFeedback`, or pass requests in with `request`
+/// and `addFeedback`, then call `update` once before frame is submitted. `update` uploads tiles
+/// loader finished, evicts least recently used tiles to make room, updates page table and queues
+/// missing tiles for loading, coarsest first.
+///
+/// Tiles are read on loader thread through file reader given to `create`, reader is used only by
+/// loader until `destroy`.
+///
+struct VirtualTexture
+{
+    VirtualTexture();
+    ~VirtualTexture();
+
+    /// Open cooked file and load coarsest mip.
+    ///
+    /// @param[in] _filePath File cooked by `vtCook`.
+    /// @param[in] _numSlotsX Cache slot columns, physical texture width is `_numSlotsX` padded tiles.
+    /// @param[in] _numSlotsY Cache slot rows.
+    /// @param[in] _feedbackWidth Feedback frame buffer width, 0 for no feedback buffer.
+    /// @param[in] _feedbackHeight Feedback frame buffer height.
+    /// @param[in] _reader File reader loader thread owns, own one from `entry::createFileReader` when NULL.
+    ///
+    /// @returns False when file is invalid, coarsest mip doesn't fit into cache, or resources can't
+    ///   be created.
+    ///
+    bool create(const char *_filePath, uint16_t _numSlotsX, uint16_t _numSlotsY, uint16_t _feedbackWidth = 0,
+                uint16_t _feedbackHeight = 0, bx::FileReaderI *_reader = NULL);
+
+    /// Stop loader and destroy resources, tiles still loading are dropped.
+    void destroy();
+
+    /// Request tile `_x`, `_y` of mip `_mip` for this frame. Out of range requests are ignored.
+    void request(uint8_t _mip, uint16_t _x, uint16_t _y);
+
+    /// Request tiles of feedback image, encoded as described in `VirtualTexture`.
+    void addFeedback(const void *_data, uint32_t _pitch, uint16_t _width, uint16_t _height);
+
+    /// Read feedback frame buffer back, requests are added when readback completes in `endFrame`
+    /// of a later frame.
+    ///
+    /// @returns False when there is no feedback buffer or readback can't be queued.
+    ///
+    bool readFeedback();
+
+    /// Upload loaded tiles, update page table and queue requested tiles. Call once per frame.
+    void update();
+
+    /// Wait until loader finished every queued tile, and upload them. For tools and tests.
+    void flush();
+
+    TextureHandle getPhysicalTexture() const
+    {
+        return m_physical;
+    }
+
+    TextureHandle getPageTable() const
+    {
+        return m_pageTable;
+    }
+
+    FrameBufferHandle getFeedbackBuffer() const
+    {
+        return m_feedback;
+    }
+
+    uint8_t getNumMips() const
+    {
+        return m_numMips;
+    }
+
+    uint16_t getTileSize() const
+    {
+        return m_tileSize;
+    }
+
+    uint16_t getBorder() const
+    {
+        return m_border;
+    }
+
+    /// Tile columns of mip `_mip`.
+    uint16_t getNumTilesX(uint8_t _mip) const
+    {
+        return uint16_t(bx::max(1, m_numTilesX >> _mip));
+    }
+
+    /// Tile rows of mip `_mip`.
+    uint16_t getNumTilesY(uint8_t _mip) const
+    {
+        return uint16_t(bx::max(1, m_numTilesY >> _mip));
+    }
+
+    /// Returns true when tile is in cache.
+    bool isResident(uint8_t _mip, uint16_t _x, uint16_t _y) const;
+
+    const VirtualTextureStats &getStats() const
+    {
+        return m_stats;
+    }
+
+  private:
+    /// Cache slot, slots that aren't pinned form LRU list, least recently used at head.
+    struct Slot
+    {
+        uint32_t m_tile;     //!< Tile in slot, `UINT32_MAX` for free slot.
+        uint32_t m_lastUsed; //!< Frame tile was last requested in.
+        uint16_t m_prev;
+        uint16_t m_next;
+    };
+
+    /// Tile read, handed between main and loader thread.
+    struct Load
+    {
+        uint32_t m_tile;
+        bool m_ok;
+    };
+
+    static int32_t loaderFunc(bx::Thread *_self, void *_userData);
+
+    static void feedbackCallback(FrameBufferHandle _handle, const void *_data, uint32_t _pitch, uint16_t _width,
+                                 uint16_t _height, TextureFormat::Enum _format, void *_userData);
+
+    uint32_t getTile(uint8_t _mip, uint16_t _x, uint16_t _y) const;
+
+    bool readTile(uint8_t *_dst, uint32_t _tile);
+
+    void unlink(uint16_t _slot);
+
+    void touch(uint16_t _slot);
+
+    uint16_t allocSlot();
+
+    void upload(uint16_t _slot, uint32_t _tile, const uint8_t *_data);
+
+    void evict(uint16_t _slot);
+
+    void resolve(uint32_t _tile);
+
+    void flushPageTable();
+
+    uint32_t drainLoads(uint32_t _max, bool _wait);
+
+    bx::FileReaderI *m_reader;
+    bool m_ownReader; //!< `m_reader` was created by `create`, destroyed with it.
+    bx::Thread m_thread;
+    bx::Mutex m_mutex;
+    bx::Semaphore m_queued;   //!< Posted for each load queued for loader.
+    bx::Semaphore m_finished; //!< Posted for each load loader finished.
+
+    Load m_load[BGFX_CONFIG_VT_MAX_LOADS];
+    uint8_t *m_loadData; //!< Tile data of each load slot.
+    uint32_t m_queue[BGFX_CONFIG_VT_MAX_LOADS]; //!< Loads waiting for loader, ring.
+    uint32_t m_done[BGFX_CONFIG_VT_MAX_LOADS];  //!< Loads loader finished, ring.
+    uint32_t m_free[BGFX_CONFIG_VT_MAX_LOADS];  //!< Free load slots, stack.
+    uint32_t m_queueHead;
+    uint32_t m_queueTail;
+    uint32_t m_doneHead;
+    uint32_t m_doneTail;
+    uint32_t m_numFree;
+
+    TextureHandle m_physical;
+    TextureHandle m_pageTable;
+    FrameBufferHandle m_feedback;
+
+    Slot *m_slot;
+    uint16_t *m_tileSlot;       //!< Slot of each tile, or `kNotResident`, `kLoading`.
+    uint32_t *m_tileRequested;  //!< Frame tile was last requested in, dedups feedback.
+    uint32_t *m_entry;          //!< Page table texels of each tile.
+    uint32_t *m_candidate;      //!< Missing tiles requested this frame.
+    uint32_t m_mipOffset[16];   //!< First tile of each mip.
+    uint16_t m_dirty[16][4];    //!< Page table rectangle to upload per mip, min x, min y, max x, max y.
+    uint32_t m_numCandidates;
+    uint32_t m_numRequested;
+    uint32_t m_numMissing;
+    uint32_t m_numTiles;
+    uint32_t m_tileBytes;
+    uint32_t m_frame;
+    uint16_t m_numSlots;
+    uint16_t m_numSlotsX;
+    uint16_t m_numPinned; //!< Slots `[0, m_numPinned)` hold coarsest mip, never evicted.
+    uint16_t m_lruHead;
+    uint16_t m_lruTail;
+    uint16_t m_numTilesX;
+    uint16_t m_numTilesY;
+    uint16_t m_tileSize;
+    uint16_t m_border;
+    uint16_t m_paddedSize;
+    uint8_t m_numMips;
+    TextureFormat::Enum m_format;
+    VirtualTextureStats m_stats;
+};
+
+} // namespace TinyRender